@@ -544,6 +544,7 @@ endmacro(CheckOpenGLESX11)
 # - nada
 # Optional:
 # - THREADS opt
+# - FUTEX opt
 # Sets:
 # PTHREAD_CFLAGS
 # PTHREAD_LIBS
@@ -649,20 +650,45 @@ macro(CheckPTHREAD)
           int main(int argc, char** argv) { return 0; }" HAVE_PTHREAD_NP_H)
       check_function_exists(pthread_setname_np HAVE_PTHREAD_setNAME_NP)
       check_function_exists(pthread_set_name_np HAVE_PTHREAD_set_NAME_NP)
+
+      if(LINUX AND FUTEX)
+        check_c_source_compiles("
+            #include <time.h>
+            #include <unistd.h>
+            #include <sys/syscall.h>
+            #include <linux/futex.h>
+            int main(int argc, char** argv) {
+                struct timespec ts;
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+                syscall(SYS_futex, &ts, FUTEX_WAKE, 1, NULL, NULL, 0);
+                return 0;
+            }" HAVE_LINUX_FUTEX)
+      endif(LINUX AND FUTEX)
       set(CMAKE_REQUIRED_FLAGS)
 
       set(SOURCE_FILES ${SOURCE_FILES}
           ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_systhread.c
-          ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_sysmutex.c   # Can be faked, if necessary
-          ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_syscond.c    # Can be faked, if necessary
+          ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_systls.c
+          ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_sysrwlock.c
           )
-      if(HAVE_PTHREADS_SEM)
+      if(HAVE_LINUX_FUTEX)
         set(SOURCE_FILES ${SOURCE_FILES}
-            ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_syssem.c)
-      else(HAVE_PTHREADS_SEM)
+            ${SDL2_SOURCE_DIR}/src/thread/linux/SDL_sysmutex.c
+            ${SDL2_SOURCE_DIR}/src/thread/linux/SDL_syscond.c
+            ${SDL2_SOURCE_DIR}/src/thread/linux/SDL_syssem.c)
+      else(HAVE_LINUX_FUTEX)
         set(SOURCE_FILES ${SOURCE_FILES}
-            ${SDL2_SOURCE_DIR}/src/thread/generic/SDL_syssem.c)
-      endif(HAVE_PTHREADS_SEM)
+            ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_sysmutex.c   # Can be faked, if necessary
+            ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_syscond.c    # Can be faked, if necessary
+            )
+        if(HAVE_PTHREADS_SEM)
+          set(SOURCE_FILES ${SOURCE_FILES}
+              ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_syssem.c)
+        else(HAVE_PTHREADS_SEM)
+          set(SOURCE_FILES ${SOURCE_FILES}
+              ${SDL2_SOURCE_DIR}/src/thread/generic/SDL_syssem.c)
+        endif(HAVE_PTHREADS_SEM)
+      endif(HAVE_LINUX_FUTEX)
       set(HAVE_SDL_THREADS TRUE)
     endif(HAVE_PTHREADS)
   endif(PTHREADS)
@@ -52,7 +52,11 @@
  * is not possible the are implemented using locks that *do* use the
  * available atomic operations.
  *
- * All of the atomic operations that modify memory are full memory barriers.
+ * All of the atomic operations that modify memory are full memory barriers,
+ * except for the variants with Relaxed, Acquire or Release in their names.
+ * Those only promise the named ordering, which can be much cheaper on
+ * weakly ordered CPUs, and fall back to full barriers where the compiler
+ * can't express anything weaker.
  */
 
 #ifndef _SDL_atomic_h_
@@ -119,6 +123,61 @@ extern DECLSPEC void SDLCALL SDL_AtomicLock(SDL_SpinLock *lock);
  */
 extern DECLSPEC void SDLCALL SDL_AtomicUnlock(SDL_SpinLock *lock);
 
+/**
+ * \brief A spin lock that can be shared by readers or held by one writer.
+ *
+ * Initialize it to 0 before use.  Once a writer is waiting for the lock
+ * new readers wait as well, so writers aren't starved.
+ */
+typedef int SDL_RWSpinLock;
+
+/**
+ * \brief Try to lock a reader/writer spin lock for shared reading.
+ *
+ * \param lock Points to the lock.
+ *
+ * \return SDL_TRUE if the lock succeeded, SDL_FALSE if a writer holds or
+ *         is waiting for the lock.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicTryLockRead(SDL_RWSpinLock *lock);
+
+/**
+ * \brief Lock a reader/writer spin lock for shared reading.
+ *
+ * \param lock Points to the lock.
+ */
+extern DECLSPEC void SDLCALL SDL_AtomicLockRead(SDL_RWSpinLock *lock);
+
+/**
+ * \brief Release a read lock on a reader/writer spin lock.
+ *
+ * \param lock Points to the lock.
+ */
+extern DECLSPEC void SDLCALL SDL_AtomicUnlockRead(SDL_RWSpinLock *lock);
+
+/**
+ * \brief Try to lock a reader/writer spin lock for exclusive writing.
+ *
+ * \param lock Points to the lock.
+ *
+ * \return SDL_TRUE if the lock succeeded, SDL_FALSE if the lock is held.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicTryLockWrite(SDL_RWSpinLock *lock);
+
+/**
+ * \brief Lock a reader/writer spin lock for exclusive writing.
+ *
+ * \param lock Points to the lock.
+ */
+extern DECLSPEC void SDLCALL SDL_AtomicLockWrite(SDL_RWSpinLock *lock);
+
+/**
+ * \brief Release a write lock on a reader/writer spin lock.
+ *
+ * \param lock Points to the lock.
+ */
+extern DECLSPEC void SDLCALL SDL_AtomicUnlockWrite(SDL_RWSpinLock *lock);
+
 /*@}*//*SDL AtomicLock*/
 
 
@@ -137,6 +196,21 @@ void _ReadWriteBarrier(void);
 ({ SDL_SpinLock _tmp = 0; SDL_AtomicLock(&_tmp); SDL_AtomicUnlock(&_tmp); })
 #endif
 
+/**
+ * Hint to the CPU that we are in a busy-wait loop, so it can save power
+ * or give the other hyperthread on the core a chance to run.
+ */
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define SDL_CPUPauseInstruction()   __asm__ __volatile__ ("pause" : : : "memory")
+#elif defined(__GNUC__) && (defined(__aarch64__) || \
+      (defined(__arm__) && (defined(__ARM_ARCH_7__) || defined(__ARM_ARCH_7A__))))
+#define SDL_CPUPauseInstruction()   __asm__ __volatile__ ("yield" : : : "memory")
+#elif defined(HAVE_MSC_ATOMICS) && (defined(_M_IX86) || defined(_M_X64))
+#define SDL_CPUPauseInstruction()   _mm_pause()
+#else
+#define SDL_CPUPauseInstruction()   SDL_CompilerBarrier()
+#endif
+
 /* Platform specific optimized versions of the atomic functions,
  * you can disable these by defining SDL_DISABLE_ATOMIC_INLINE
  */
@@ -177,6 +251,70 @@ void _ReadWriteBarrier(void);
 
 #endif
 
+#ifdef HAVE_MSC_ATOMICS
+
+#define SDL_AtomicOr(a, v)      _InterlockedOr((long*)&(a)->value, (v))
+#define SDL_AtomicAnd(a, v)     _InterlockedAnd((long*)&(a)->value, (v))
+#define SDL_AtomicXor(a, v)     _InterlockedXor((long*)&(a)->value, (v))
+#define SDL_AtomicCAS64(a, oldval, newval) (_InterlockedCompareExchange64(&(a)->value, (newval), (oldval)) == (oldval))
+#ifdef _M_X64
+#define SDL_AtomicSet64(a, v)   _InterlockedExchange64(&(a)->value, (v))
+#define SDL_AtomicAdd64(a, v)   _InterlockedExchangeAdd64(&(a)->value, (v))
+#endif
+#if defined(_M_IX86) || defined(_M_X64)
+/* x86 never reorders loads with loads or stores with stores */
+#define SDL_MemoryBarrierAcquire()  _ReadWriteBarrier()
+#define SDL_MemoryBarrierRelease()  _ReadWriteBarrier()
+#define SDL_MemoryBarrier()         _mm_mfence()
+#endif
+
+#elif defined(__ATOMIC_ACQUIRE)
+/* GCC 4.7 and newer and clang have builtins for the C11 memory model */
+
+#define SDL_AtomicOr(a, v)      __atomic_fetch_or(&(a)->value, (v), __ATOMIC_SEQ_CST)
+#define SDL_AtomicAnd(a, v)     __atomic_fetch_and(&(a)->value, (v), __ATOMIC_SEQ_CST)
+#define SDL_AtomicXor(a, v)     __atomic_fetch_xor(&(a)->value, (v), __ATOMIC_SEQ_CST)
+#define SDL_AtomicGetRelaxed(a) __atomic_load_n(&(a)->value, __ATOMIC_RELAXED)
+#define SDL_AtomicGetAcquire(a) __atomic_load_n(&(a)->value, __ATOMIC_ACQUIRE)
+#define SDL_AtomicSetRelaxed(a, v) __atomic_store_n(&(a)->value, (v), __ATOMIC_RELAXED)
+#define SDL_AtomicSetRelease(a, v) __atomic_store_n(&(a)->value, (v), __ATOMIC_RELEASE)
+#define SDL_AtomicAddRelaxed(a, v) __atomic_fetch_add(&(a)->value, (v), __ATOMIC_RELAXED)
+#define SDL_AtomicGetPtrAcquire(a) __atomic_load_n((a), __ATOMIC_ACQUIRE)
+#define SDL_AtomicSetPtrRelease(a, v) __atomic_store_n((a), (v), __ATOMIC_RELEASE)
+#define SDL_MemoryBarrierAcquire()  __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define SDL_MemoryBarrierRelease()  __atomic_thread_fence(__ATOMIC_RELEASE)
+#define SDL_MemoryBarrier()         __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* Only inline the 64-bit operations if they don't need libatomic */
+#if defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && (__GCC_ATOMIC_LLONG_LOCK_FREE == 2)
+#define SDL_AtomicSet64(a, v)   __atomic_exchange_n(&(a)->value, (v), __ATOMIC_SEQ_CST)
+#define SDL_AtomicGet64(a)      __atomic_load_n(&(a)->value, __ATOMIC_SEQ_CST)
+#define SDL_AtomicAdd64(a, v)   __atomic_fetch_add(&(a)->value, (v), __ATOMIC_SEQ_CST)
+#define SDL_AtomicOr64(a, v)    __atomic_fetch_or(&(a)->value, (v), __ATOMIC_SEQ_CST)
+#define SDL_AtomicAnd64(a, v)   __atomic_fetch_and(&(a)->value, (v), __ATOMIC_SEQ_CST)
+#define SDL_AtomicXor64(a, v)   __atomic_fetch_xor(&(a)->value, (v), __ATOMIC_SEQ_CST)
+#define SDL_AtomicCAS64(a, oldval, newval) __sync_bool_compare_and_swap(&(a)->value, oldval, newval)
+#define SDL_AtomicGetRelaxed64(a) __atomic_load_n(&(a)->value, __ATOMIC_RELAXED)
+#define SDL_AtomicGetAcquire64(a) __atomic_load_n(&(a)->value, __ATOMIC_ACQUIRE)
+#define SDL_AtomicSetRelaxed64(a, v) __atomic_store_n(&(a)->value, (v), __ATOMIC_RELAXED)
+#define SDL_AtomicSetRelease64(a, v) __atomic_store_n(&(a)->value, (v), __ATOMIC_RELEASE)
+#define SDL_AtomicAddRelaxed64(a, v) __atomic_fetch_add(&(a)->value, (v), __ATOMIC_RELAXED)
+#endif
+
+#elif defined(__MACOSX__)
+
+#define SDL_AtomicCAS64(a, oldval, newval) OSAtomicCompareAndSwap64Barrier((oldval), (newval), &(a)->value)
+#define SDL_MemoryBarrier()     OSMemoryBarrier()
+
+#elif defined(HAVE_GCC_ATOMICS)
+
+#define SDL_AtomicOr(a, v)      __sync_fetch_and_or(&(a)->value, v)
+#define SDL_AtomicAnd(a, v)     __sync_fetch_and_and(&(a)->value, v)
+#define SDL_AtomicXor(a, v)     __sync_fetch_and_xor(&(a)->value, v)
+#define SDL_MemoryBarrier()     __sync_synchronize()
+
+#endif
+
 #endif /* !SDL_DISABLE_ATOMIC_INLINE */
 
 
@@ -188,6 +326,20 @@ void _ReadWriteBarrier(void);
 typedef struct { int value; } SDL_atomic_t;
 #endif
 
+/**
+ * \brief A type representing an atomic 64-bit integer value.
+ *
+ * It is kept 8 byte aligned, which 64-bit atomic instructions need even
+ * on 32-bit CPUs.
+ */
+#ifndef SDL_atomic64_t_defined
+#ifdef __GNUC__
+typedef struct { Sint64 value __attribute__((aligned(8))); } SDL_atomic64_t;
+#else
+typedef struct { Sint64 value; } SDL_atomic64_t;
+#endif
+#endif
+
 /**
  * \brief Set an atomic variable to a new value if it is currently an old value.
  *
@@ -303,6 +455,215 @@ static __inline__ void* SDL_AtomicGetPtr(void* *a)
 }
 #endif
 
+/**
+ * \name Memory barriers
+ *
+ * SDL_MemoryBarrierAcquire() keeps reads and writes after it from moving
+ * before it, SDL_MemoryBarrierRelease() keeps reads and writes before it
+ * from moving after it, and SDL_MemoryBarrier() does both and also keeps
+ * stores before it from being reordered with loads after it.
+ */
+/*@{*/
+#ifndef SDL_MemoryBarrier
+#define SDL_MemoryBarrier SDL_MemoryBarrier_
+#endif
+extern DECLSPEC void SDLCALL SDL_MemoryBarrier_(void);
+
+#ifndef SDL_MemoryBarrierAcquire
+#define SDL_MemoryBarrierAcquire()  SDL_MemoryBarrier()
+#endif
+#ifndef SDL_MemoryBarrierRelease
+#define SDL_MemoryBarrierRelease()  SDL_MemoryBarrier()
+#endif
+/*@}*//*Memory barriers*/
+
+/**
+ * \brief Bitwise OR, AND or XOR a value into an atomic variable.
+ *
+ * \return The previous value of the atomic variable.
+ */
+/*@{*/
+#ifndef SDL_AtomicOr
+static __inline__ int SDL_AtomicOr(SDL_atomic_t *a, int v)
+{
+    int value;
+    do {
+        value = a->value;
+    } while (!SDL_AtomicCAS(a, value, (value | v)));
+    return value;
+}
+#endif
+
+#ifndef SDL_AtomicAnd
+static __inline__ int SDL_AtomicAnd(SDL_atomic_t *a, int v)
+{
+    int value;
+    do {
+        value = a->value;
+    } while (!SDL_AtomicCAS(a, value, (value & v)));
+    return value;
+}
+#endif
+
+#ifndef SDL_AtomicXor
+static __inline__ int SDL_AtomicXor(SDL_atomic_t *a, int v)
+{
+    int value;
+    do {
+        value = a->value;
+    } while (!SDL_AtomicCAS(a, value, (value ^ v)));
+    return value;
+}
+#endif
+/*@}*/
+
+/**
+ * \name Explicitly ordered operations
+ *
+ * Relaxed operations are atomic but don't order any other memory access,
+ * which is all a statistics counter needs.  An acquire load pairs with a
+ * release store of the same variable: everything written before the store
+ * is visible to a thread that sees the stored value with the load.
+ */
+/*@{*/
+#ifndef SDL_AtomicGetRelaxed
+#define SDL_AtomicGetRelaxed(a)     SDL_AtomicGet(a)
+#endif
+
+#ifndef SDL_AtomicGetAcquire
+static __inline__ int SDL_AtomicGetAcquire(SDL_atomic_t *a)
+{
+    int value = a->value;
+    SDL_MemoryBarrierAcquire();
+    return value;
+}
+#endif
+
+#ifndef SDL_AtomicSetRelaxed
+#define SDL_AtomicSetRelaxed(a, v)  ((void)SDL_AtomicSet(a, v))
+#endif
+
+#ifndef SDL_AtomicSetRelease
+#define SDL_AtomicSetRelease(a, v)  ((void)SDL_AtomicSet(a, v))
+#endif
+
+#ifndef SDL_AtomicAddRelaxed
+#define SDL_AtomicAddRelaxed(a, v)  SDL_AtomicAdd(a, v)
+#endif
+
+#ifndef SDL_AtomicGetPtrAcquire
+static __inline__ void* SDL_AtomicGetPtrAcquire(void* *a)
+{
+    void* value = *a;
+    SDL_MemoryBarrierAcquire();
+    return value;
+}
+#endif
+
+#ifndef SDL_AtomicSetPtrRelease
+#define SDL_AtomicSetPtrRelease(a, v)   ((void)SDL_AtomicSetPtr(a, v))
+#endif
+/*@}*//*Explicitly ordered operations*/
+
+/**
+ * \name 64-bit atomic operations
+ *
+ * These work like their 32-bit counterparts.  CPUs without 64-bit atomic
+ * instructions emulate them with locks, so check that they are fast
+ * enough on your target platforms before relying on them.
+ */
+/*@{*/
+#ifndef SDL_AtomicCAS64
+#define SDL_AtomicCAS64 SDL_AtomicCAS64_
+#endif
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicCAS64_(SDL_atomic64_t *a, Sint64 oldval, Sint64 newval);
+
+/* A torn read of a value that is changing can't pass the comparison, so
+   this is safe even where 64-bit loads take two instructions.
+ */
+#ifndef SDL_AtomicGet64
+static __inline__ Sint64 SDL_AtomicGet64(SDL_atomic64_t *a)
+{
+    Sint64 value;
+    do {
+        value = a->value;
+    } while (!SDL_AtomicCAS64(a, value, value));
+    return value;
+}
+#endif
+
+#ifndef SDL_AtomicSet64
+static __inline__ Sint64 SDL_AtomicSet64(SDL_atomic64_t *a, Sint64 v)
+{
+    Sint64 value;
+    do {
+        value = a->value;
+    } while (!SDL_AtomicCAS64(a, value, v));
+    return value;
+}
+#endif
+
+#ifndef SDL_AtomicAdd64
+static __inline__ Sint64 SDL_AtomicAdd64(SDL_atomic64_t *a, Sint64 v)
+{
+    Sint64 value;
+    do {
+        value = a->value;
+    } while (!SDL_AtomicCAS64(a, value, (value + v)));
+    return value;
+}
+#endif
+
+#ifndef SDL_AtomicOr64
+static __inline__ Sint64 SDL_AtomicOr64(SDL_atomic64_t *a, Sint64 v)
+{
+    Sint64 value;
+    do {
+        value = a->value;
+    } while (!SDL_AtomicCAS64(a, value, (value | v)));
+    return value;
+}
+#endif
+
+#ifndef SDL_AtomicAnd64
+static __inline__ Sint64 SDL_AtomicAnd64(SDL_atomic64_t *a, Sint64 v)
+{
+    Sint64 value;
+    do {
+        value = a->value;
+    } while (!SDL_AtomicCAS64(a, value, (value & v)));
+    return value;
+}
+#endif
+
+#ifndef SDL_AtomicXor64
+static __inline__ Sint64 SDL_AtomicXor64(SDL_atomic64_t *a, Sint64 v)
+{
+    Sint64 value;
+    do {
+        value = a->value;
+    } while (!SDL_AtomicCAS64(a, value, (value ^ v)));
+    return value;
+}
+#endif
+
+#ifndef SDL_AtomicGetRelaxed64
+#define SDL_AtomicGetRelaxed64(a)       SDL_AtomicGet64(a)
+#endif
+#ifndef SDL_AtomicGetAcquire64
+#define SDL_AtomicGetAcquire64(a)       SDL_AtomicGet64(a)
+#endif
+#ifndef SDL_AtomicSetRelaxed64
+#define SDL_AtomicSetRelaxed64(a, v)    ((void)SDL_AtomicSet64(a, v))
+#endif
+#ifndef SDL_AtomicSetRelease64
+#define SDL_AtomicSetRelease64(a, v)    ((void)SDL_AtomicSet64(a, v))
+#endif
+#ifndef SDL_AtomicAddRelaxed64
+#define SDL_AtomicAddRelaxed64(a, v)    SDL_AtomicAdd64(a, v)
+#endif
+/*@}*//*64-bit atomic operations*/
+
 
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
@@ -147,6 +147,8 @@
 #cmakedefine HAVE_CLOCK_GETTIME 1
 #cmakedefine HAVE_GETPAGESIZE 1
 #cmakedefine HAVE_MPROTECT 1
+#cmakedefine HAVE_MMAP 1
+#cmakedefine HAVE_MADVISE 1
 #cmakedefine HAVE_ICONV 1
 #cmakedefine HAVE_PTHREAD_SETNAME_NP 1
 #cmakedefine HAVE_PTHREAD_SET_NAME_NP 1
@@ -302,6 +304,9 @@
 #cmakedefine SDL_ASSEMBLY_ROUTINES @SDL_ASSEMBLY_ROUTINES@
 #cmakedefine SDL_ALTIVEC_BLITTERS @SDL_ALTIVEC_BLITTERS@
 
+/* Enable per-thread caches for SDL's internal allocations */
+#cmakedefine SDL_MALLOC_THREAD_CACHE @SDL_MALLOC_THREAD_CACHE@
+
 
 /* Platform specific definitions */
 #if !defined(__WIN32__)
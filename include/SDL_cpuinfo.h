@@ -83,6 +83,15 @@ extern "C" {
  */
 extern DECLSPEC int SDLCALL SDL_GetCPUCount(void);
 
+/**
+ *  This function returns the number of physical CPU cores available.
+ *
+ *  This is smaller than SDL_GetCPUCount() when cores run several hardware
+ *  threads, which share the core's execution units and caches.  If the
+ *  topology can't be determined this returns SDL_GetCPUCount().
+ */
+extern DECLSPEC int SDLCALL SDL_GetCPUPhysicalCoreCount(void);
+
 /**
  *  This function returns the L1 cache line size of the CPU
  *
@@ -91,6 +100,17 @@ extern DECLSPEC int SDLCALL SDL_GetCPUCount(void);
  */
 extern DECLSPEC int SDLCALL SDL_GetCPUCacheLineSize(void);
 
+/**
+ *  This function returns the size in kilobytes of a level of CPU cache.
+ *
+ *  \param level 1 for the L1 data cache, 2 for the L2 cache or 3 for the
+ *               L3 cache.
+ *
+ *  \return The cache size, or 0 if the cache doesn't exist or its size
+ *          couldn't be determined.
+ */
+extern DECLSPEC int SDLCALL SDL_GetCPUCacheSize(int level);
+
 /**
  *  This function returns true if the CPU has the RDTSC instruction.
  */
@@ -136,6 +156,49 @@ extern DECLSPEC SDL_bool SDLCALL SDL_HasSSE41(void);
  */
 extern DECLSPEC SDL_bool SDLCALL SDL_HasSSE42(void);
 
+/**
+ *  This function returns true if the CPU has AVX features.
+ *
+ *  Like the other AVX queries, this is only true if the operating system
+ *  also saves the wide vector registers on context switches.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_HasAVX(void);
+
+/**
+ *  This function returns true if the CPU has AVX2 features.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_HasAVX2(void);
+
+/**
+ *  This function returns true if the CPU has AVX-512 Foundation features.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_HasAVX512F(void);
+
+/**
+ *  This function returns true if the CPU has FMA3 fused multiply-add.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_HasFMA(void);
+
+/**
+ *  This function returns true if the CPU has F16C half float conversions.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_HasF16C(void);
+
+/**
+ *  This function returns true if the CPU has BMI1 bit manipulation features.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_HasBMI1(void);
+
+/**
+ *  This function returns true if the CPU has BMI2 bit manipulation features.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_HasBMI2(void);
+
+/**
+ *  This function returns true if the CPU has ARM NEON features.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_HasNEON(void);
+
 
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
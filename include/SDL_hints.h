@@ -152,6 +152,60 @@ extern "C" {
  */
 #define SDL_HINT_VIDEO_X11_XRANDR           "SDL_VIDEO_X11_XRANDR"
 
+/**
+ *  \brief  A variable controlling how many shared memory images the X11 window framebuffer rotates through.
+ *
+ *  This variable can be set to the following values:
+ *    "1"       - Use one image, waiting for the X server to read it on every update
+ *    "2" or "3" - Draw into one image while the X server reads the others
+ *
+ *  With more than one image, the window surface pixels pointer changes when the
+ *  window surface is updated, and only the areas passed to
+ *  SDL_UpdateWindowSurfaceRects() are carried over to the next image, so
+ *  only set this if the application redraws everything it presents.
+ *
+ *  By default SDL will use 1 image.
+ */
+#define SDL_HINT_VIDEO_X11_SHM_IMAGES       "SDL_VIDEO_X11_SHM_IMAGES"
+
+/**
+ *  \brief  A variable naming a file for the dummy video driver to capture window frames to
+ *
+ *  Frames are written in the background as they are presented.  A name
+ *  ending in ".y4m" gets a YUV4MPEG2 stream with 4:2:0 full range color,
+ *  anything else gets raw frames of 32-bit XRGB8888 pixels in native byte
+ *  order, 4 * width bytes per row.  A "%d" in the name is replaced with a
+ *  number that counts up from 1 each time a capture starts, which happens
+ *  for each window and again whenever a window is resized.
+ *
+ *  \sa SDL_SetWindowCaptureCallback()
+ */
+#define SDL_HINT_VIDEO_DUMMY_CAPTURE        "SDL_VIDEO_DUMMY_CAPTURE"
+
+/**
+ *  \brief  A variable setting how many frames the dummy video driver can hold for capture
+ *
+ *  The default is "4".  The buffers are allocated at the window size when
+ *  capture starts with the first presented frame, and are reused until the
+ *  window framebuffer is recreated or destroyed, as when the window is
+ *  resized or closed.  Presenting copies the frame into a free buffer,
+ *  which becomes free again once the frame has been written.  When all of
+ *  them are full, SDL_HINT_VIDEO_DUMMY_CAPTURE_DROP decides whether
+ *  presenting waits for one or drops the frame.
+ */
+#define SDL_HINT_VIDEO_DUMMY_CAPTURE_BUFFERS "SDL_VIDEO_DUMMY_CAPTURE_BUFFERS"
+
+/**
+ *  \brief  A variable controlling what happens when no capture buffer is free
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Presenting waits for a buffer, so every frame is captured
+ *    "1"       - The frame is dropped and counted in SDL_WindowCaptureStats
+ *
+ *  By default every frame is captured.
+ */
+#define SDL_HINT_VIDEO_DUMMY_CAPTURE_DROP   "SDL_VIDEO_DUMMY_CAPTURE_DROP"
+
 /**
  *  \brief  A variable controlling whether grabbing input grabs the keyboard
  *
@@ -215,6 +269,88 @@ extern "C" {
 #define SDL_HINT_ALLOW_TOPMOST "SDL_ALLOW_TOPMOST"
 
 
+/**
+ *  \brief  A variable controlling how long SDL_DelayPrecise() busy-waits at the end of a delay
+ *
+ *  The variable is the number of microseconds before the deadline at which
+ *  SDL_DelayPrecise() stops sleeping and starts spinning.  The default is "200".
+ *  Setting it to "0" disables spinning entirely.
+ */
+#define SDL_HINT_TIMER_SPIN_TIME "SDL_TIMER_SPIN_TIME"
+
+
+/**
+ *  \brief  A variable setting the number of worker threads in the job system
+ *
+ *  By default the job system starts one worker for each CPU core except
+ *  the calling thread's.  This is read once, when the first job is run.
+ */
+#define SDL_HINT_JOB_THREADS "SDL_JOB_THREADS"
+
+
+/**
+ *  \brief  A variable limiting the CPU features SDL's optimized code paths may use
+ *
+ *  This variable can be set to the following values:
+ *    "scalar"  - Only use plain C code
+ *    "mmx"     - Use up to MMX and 3DNow!
+ *    "sse", "sse2", "sse3", "sse4.1", "sse4.2" - Use up to that SSE level
+ *    "avx"     - Use up to AVX
+ *    "avx2"    - Use up to AVX2, FMA, BMI1 and BMI2
+ *    "avx512"  - Use everything the CPU supports (the default)
+ *
+ *  Any value other than "scalar" allows AltiVec and NEON.  This is useful
+ *  for testing the slower code paths on a fast machine.  The SDL_Has*()
+ *  functions are not affected, and the variable is read once, the first
+ *  time SDL picks an implementation.
+ */
+#define SDL_HINT_CPU_FEATURE_LIMIT "SDL_CPU_FEATURE_LIMIT"
+
+
+/**
+ *  \brief  A variable controlling whether SDL_RWFromFile() memory maps files
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Files are always read through stdio (the default)
+ *    "1"       - Regular files opened with mode "r" or "rb" are memory
+ *                mapped where the platform supports it
+ *
+ *  Mapped files can be accessed in place with SDL_RWGetPointer().  Only
+ *  map files that no other process changes while they are open: a mapped
+ *  file keeps the size it had when it was opened, and reading a part that
+ *  another process truncated away raises SIGBUS instead of failing.
+ */
+#define SDL_HINT_FILE_MMAP "SDL_FILE_MMAP"
+
+
+/**
+ *  \brief  A variable controlling dithering when blitting to paletted surfaces
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Map every pixel to its nearest palette color (the default)
+ *    "1"       - Ordered dithering with a 4x4 Bayer matrix
+ *    "2"       - Floyd-Steinberg error diffusion
+ *
+ *  Dithering is used for blits from RGB surfaces to 8-bit paletted surfaces
+ *  without color keys or blending, including SDL_ConvertSurface().  It is
+ *  read when a surface is mapped for blitting to another surface.
+ */
+#define SDL_HINT_SURFACE_DITHER "SDL_SURFACE_DITHER"
+
+
+/**
+ *  \brief  A variable controlling the alignment of surface pixels, in bytes
+ *
+ *  This variable can be set to "4" (the default), "16", "32" or "64".
+ *
+ *  Rows of pixels of surfaces created by SDL_CreateRGBSurface(), of window
+ *  framebuffers and of streaming textures start on this boundary, which
+ *  lets fills and copies use aligned SIMD stores.  Surfaces aligned beyond
+ *  4 bytes have the ::SDL_SIMD_ALIGNED flag set.
+ */
+#define SDL_HINT_SURFACE_ALIGNMENT "SDL_SURFACE_ALIGNMENT"
+
+
 
 /**
  *  \brief  An enumeration of hint priorities
@@ -233,6 +369,9 @@ typedef enum
  *  The priority controls the behavior when setting a hint that already
  *  has a value.  Hints will replace existing hints of their priority and
  *  lower.  Environment variables are considered to have override priority.
+ *
+ *  A NULL value clears the hint, so that the environment variable or the
+ *  default behavior applies again.
  * 
  *  \return SDL_TRUE if the hint was set, SDL_FALSE otherwise
  */
@@ -241,7 +380,7 @@ extern DECLSPEC SDL_bool SDLCALL SDL_SetHintWithPriority(const char *name,
                                                          SDL_HintPriority priority);
 
 /**
- *  \brief Set a hint with normal priority
+ *  \brief Set a hint with normal priority, or clear it with a NULL value
  * 
  *  \return SDL_TRUE if the hint was set, SDL_FALSE otherwise
  */
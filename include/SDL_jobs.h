@@ -0,0 +1,161 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef _SDL_jobs_h
+#define _SDL_jobs_h
+
+/**
+ *  \file SDL_jobs.h
+ *
+ *  Header for the SDL job system.
+ *
+ *  The job system runs small pieces of work on a fixed pool of worker
+ *  threads, sized to the number of CPU cores.  Each worker keeps its own
+ *  queue of jobs and idle workers steal work from busy ones.  Jobs may
+ *  be grouped with a counter, which can be waited on or used to hold back
+ *  other jobs until the whole group has finished.
+ *
+ *  The pool is started the first time it is needed and stopped by SDL_Quit().
+ */
+
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+
+#include "begin_code.h"
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/* The SDL job counter structure, defined in SDL_jobs.c */
+struct SDL_JobCounter;
+typedef struct SDL_JobCounter SDL_JobCounter;
+
+/**
+ *  The function passed to SDL_RunJob()
+ */
+typedef void (SDLCALL * SDL_JobFunction) (void *data);
+
+/**
+ *  The function passed to SDL_ParallelFor()
+ *
+ *  It is called with a subrange [start, end) of the full range.
+ */
+typedef void (SDLCALL * SDL_ParallelForFunction) (int start, int end, void *data);
+
+/**
+ *  Create a job counter.
+ *
+ *  The counter is incremented for every job started with it and
+ *  decremented as each of those jobs finishes.
+ */
+extern DECLSPEC SDL_JobCounter *SDLCALL SDL_CreateJobCounter(void);
+
+/**
+ *  Destroy a job counter.
+ *
+ *  Wait for the counter first if any of its jobs may still be running.
+ */
+extern DECLSPEC void SDLCALL SDL_DestroyJobCounter(SDL_JobCounter * counter);
+
+/**
+ *  Run a job on the worker threads.
+ *
+ *  \param fn      The function to run.
+ *  \param data    The parameter passed to the function.
+ *  \param counter A counter to add this job to, or NULL.
+ *
+ *  \return 0 on success, or -1 if the job couldn't be queued.
+ *
+ *  If the worker threads can't be started, the job is run immediately
+ *  on the calling thread.
+ */
+extern DECLSPEC int SDLCALL SDL_RunJob(SDL_JobFunction fn, void *data,
+                                       SDL_JobCounter * counter);
+
+/**
+ *  Run a job once all the jobs in another counter have finished.
+ *
+ *  \param fn         The function to run.
+ *  \param data       The parameter passed to the function.
+ *  \param dependency The counter to wait for.
+ *  \param counter    A counter to add this job to, or NULL.
+ *
+ *  \return 0 on success, or -1 if the job couldn't be queued.
+ *
+ *  The job is released the next time the dependency counter drops to zero,
+ *  or right away if it is zero now.
+ */
+extern DECLSPEC int SDLCALL SDL_RunJobAfter(SDL_JobFunction fn, void *data,
+                                            SDL_JobCounter * dependency,
+                                            SDL_JobCounter * counter);
+
+/**
+ *  Wait for all the jobs in a counter to finish.
+ *
+ *  The calling thread runs queued jobs while it waits.
+ */
+extern DECLSPEC void SDLCALL SDL_WaitJobCounter(SDL_JobCounter * counter);
+
+/**
+ *  Run a function over a range of integers, split across the worker threads.
+ *
+ *  \param start The first value in the range.
+ *  \param end   One past the last value in the range.
+ *  \param grain The smallest subrange worth running as its own job, or 0
+ *               to let SDL choose.
+ *  \param fn    The function to run on each subrange.
+ *  \param data  The parameter passed to the function.
+ *
+ *  \return 0 on success, or -1 on error.
+ *
+ *  This returns once the whole range has been processed, with the calling
+ *  thread working on the range too.
+ */
+extern DECLSPEC int SDLCALL SDL_ParallelFor(int start, int end, int grain,
+                                            SDL_ParallelForFunction fn,
+                                            void *data);
+
+/**
+ *  Get the number of worker threads in the job system, starting them if
+ *  they aren't running yet.
+ *
+ *  Once the workers are running, large software blits are also split
+ *  across them.  SDL doesn't start the workers for blits by itself.
+ *
+ *  \return The number of workers, or 0 if jobs run on the calling thread.
+ */
+extern DECLSPEC int SDLCALL SDL_GetJobWorkerCount(void);
+
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+#include "close_code.h"
+
+#endif /* _SDL_jobs_h */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -235,6 +235,71 @@ extern DECLSPEC int SDLCALL SDL_CondWaitTimeout(SDL_cond * cond,
 /*@}*//*Condition variable functions*/
 
 
+/**
+ *  \name Reader/writer lock functions
+ */
+/*@{*/
+
+/* The SDL reader/writer lock structure, defined in SDL_sysrwlock.c */
+struct SDL_rwlock;
+typedef struct SDL_rwlock SDL_rwlock;
+
+/**
+ *  Create a reader/writer lock.
+ *
+ *  Any number of threads can hold the lock for reading at the same time,
+ *  but a thread holding it for writing has it to itself.  Once a writer
+ *  is waiting, new readers wait too so writers aren't starved.
+ *
+ *  Reader/writer locks are not recursive, and a thread holding the lock
+ *  for reading must not try to lock it for writing.
+ */
+extern DECLSPEC SDL_rwlock *SDLCALL SDL_CreateRWLock(void);
+
+/**
+ *  Lock the reader/writer lock for shared reading.
+ *
+ *  \return 0, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_LockRWLockForReading(SDL_rwlock * rwlock);
+
+/**
+ *  Lock the reader/writer lock for exclusive writing.
+ *
+ *  \return 0, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_LockRWLockForWriting(SDL_rwlock * rwlock);
+
+/**
+ *  Try to lock the reader/writer lock for reading without blocking.
+ *
+ *  \return 0, ::SDL_MUTEX_TIMEDOUT if a writer holds or is waiting for
+ *          the lock, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_TryLockRWLockForReading(SDL_rwlock * rwlock);
+
+/**
+ *  Try to lock the reader/writer lock for writing without blocking.
+ *
+ *  \return 0, ::SDL_MUTEX_TIMEDOUT if the lock is held, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_TryLockRWLockForWriting(SDL_rwlock * rwlock);
+
+/**
+ *  Unlock the reader/writer lock, whichever way this thread locked it.
+ *
+ *  \return 0, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_UnlockRWLock(SDL_rwlock * rwlock);
+
+/**
+ *  Destroy a reader/writer lock.
+ */
+extern DECLSPEC void SDLCALL SDL_DestroyRWLock(SDL_rwlock * rwlock);
+
+/*@}*//*Reader/writer lock functions*/
+
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 /* *INDENT-OFF* */
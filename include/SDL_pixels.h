@@ -329,6 +329,9 @@ extern DECLSPEC Uint32 SDLCALL SDL_MasksToPixelFormatEnum(int bpp,
 
 /**
  *  \brief Create an SDL_PixelFormat structure from a pixel format enum.
+ *
+ *  RGB formats are shared and reference counted, so this may be called
+ *  from any thread.  Indexed formats are always allocated separately.
  */
 extern DECLSPEC SDL_PixelFormat * SDLCALL SDL_AllocFormat(Uint32 pixel_format);
 
@@ -412,6 +415,60 @@ extern DECLSPEC void SDLCALL SDL_GetRGBA(Uint32 pixel,
                                          Uint8 * r, Uint8 * g, Uint8 * b,
                                          Uint8 * a);
 
+/**
+ *  \brief Maps an array of RGBA colors to pixel values of the specified
+ *         format.
+ *
+ *  \param format The format of the pixels.
+ *  \param colors The colors, 4 bytes each in R, G, B, A order.
+ *  \param pixels The pixels, packed as they would be in a surface row.
+ *  \param count  The number of colors to map.
+ *
+ *  \return 0 on success, or -1 if the format has less than 8 bits per pixel.
+ *
+ *  Each pixel is the same as SDL_MapRGBA() would return for its color.
+ *
+ *  \sa SDL_MapRGBA
+ *  \sa SDL_GetRGBAArray
+ */
+extern DECLSPEC int SDLCALL SDL_MapRGBAArray(const SDL_PixelFormat * format,
+                                             const Uint8 * colors,
+                                             void * pixels, int count);
+
+/**
+ *  \brief Get the RGBA components from an array of pixels of the specified
+ *         format.
+ *
+ *  \param format The format of the pixels.
+ *  \param pixels The pixels, packed as they would be in a surface row.
+ *  \param colors The colors, 4 bytes each in R, G, B, A order.
+ *  \param count  The number of pixels to read.
+ *
+ *  \return 0 on success, or -1 if the format has less than 8 bits per pixel.
+ *
+ *  Each color is the same as SDL_GetRGBA() would return for its pixel.
+ *
+ *  \sa SDL_GetRGBA
+ *  \sa SDL_MapRGBAArray
+ */
+extern DECLSPEC int SDLCALL SDL_GetRGBAArray(const SDL_PixelFormat * format,
+                                             const void * pixels,
+                                             Uint8 * colors, int count);
+
+/**
+ *  \brief Get the RGBA components from an array of pixels of the specified
+ *         format, as floating point values from 0.0 to 1.0.
+ *
+ *  \param colors The colors, 4 floats each in R, G, B, A order.
+ *
+ *  \return 0 on success, or -1 if the format has less than 8 bits per pixel.
+ *
+ *  \sa SDL_GetRGBAArray
+ */
+extern DECLSPEC int SDLCALL SDL_GetRGBAFloatArray(const SDL_PixelFormat * format,
+                                                  const void * pixels,
+                                                  float * colors, int count);
+
 /**
  *  \brief Calculate a 256 entry gamma ramp for a gamma value.
  */
@@ -40,6 +40,17 @@ extern "C" {
 /* *INDENT-ON* */
 #endif
 
+/* RWops types */
+#define SDL_RWOPS_UNKNOWN   0   /**< Unknown stream type */
+#define SDL_RWOPS_WINFILE   1   /**< Win32 file */
+#define SDL_RWOPS_STDFILE   2   /**< Stdio file */
+#define SDL_RWOPS_JNIFILE   3   /**< Android asset */
+#define SDL_RWOPS_MEMORY    4   /**< Memory stream */
+#define SDL_RWOPS_MEMORY_RO 5   /**< Read-Only memory stream */
+#define SDL_RWOPS_MAPPED    6   /**< Read-Only memory mapped file */
+#define SDL_RWOPS_BUFFERED  7   /**< Buffered stream */
+#define SDL_RWOPS_ASYNC     8   /**< Stream read ahead asynchronously */
+
 /**
  * This is the read/write operation structure -- very basic.
  */
@@ -84,7 +95,7 @@ typedef struct SDL_RWops
      */
     int (SDLCALL * close) (struct SDL_RWops * context);
 
-    Uint32 type;
+    Uint32 type;                /**< One of the SDL_RWOPS_* values */
     union
     {
 #if defined(ANDROID)
@@ -158,9 +169,119 @@ extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromMem(void *mem, int size);
 extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromConstMem(const void *mem,
                                                       int size);
 
+/**
+ *  Create an SDL_RWops that buffers another one, reading ahead and
+ *  holding back writes so that small reads and writes don't each go
+ *  through to \c rw. Seeks within the buffered data don't touch \c rw.
+ *
+ *  \param rw The SDL_RWops to buffer.
+ *  \param buffersize The size of the buffer in bytes, or 0 for the default.
+ *  \param autoclose If SDL_TRUE, \c rw is closed along with the new SDL_RWops.
+ *
+ *  \note Use \c rw only through the new SDL_RWops until that is closed.
+ */
+extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromBufferedRW(SDL_RWops * rw,
+                                                        size_t buffersize,
+                                                        SDL_bool autoclose);
+
+/**
+ *  Create an SDL_RWops that reads ahead of another one on the I/O thread,
+ *  so that reading from it rarely has to wait for \c rw.  Seeks within
+ *  the read-ahead window don't wait for anything, and writes go straight
+ *  through to \c rw.
+ *
+ *  \param rw The SDL_RWops to read ahead of.
+ *  \param window The number of bytes to read ahead, or 0 for the default.
+ *  \param autoclose If SDL_TRUE, \c rw is closed along with the new SDL_RWops.
+ *
+ *  \note Use \c rw only through the new SDL_RWops until that is closed.
+ *
+ *  \sa SDL_RWreadAsync()
+ */
+extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromAsyncRW(SDL_RWops * rw,
+                                                     size_t window,
+                                                     SDL_bool autoclose);
+
 /*@}*//*RWFrom functions*/
 
 
+/**
+ *  Get a pointer to \c size bytes of a stream's data at \c offset from its
+ *  start, without copying them.  This works for memory streams and for
+ *  files that SDL_RWFromFile() memory mapped because SDL_HINT_FILE_MMAP
+ *  was enabled.
+ *
+ *  \return A pointer to the data, or NULL if the range can't be accessed
+ *          in place, in which case it has to be read.  No error is set.
+ *
+ *  \note The data is valid until \c context is closed, and must not be
+ *        modified unless \c context was created with SDL_RWFromMem().
+ */
+extern DECLSPEC const void *SDLCALL SDL_RWGetPointer(SDL_RWops * context,
+                                                     Sint64 offset,
+                                                     size_t size);
+
+
+/**
+ *  \name Asynchronous reads
+ *
+ *  Reads done in the background by the I/O thread, which is started the
+ *  first time it is needed and stopped by SDL_Quit().  Reads are done one
+ *  at a time, in the order they are made.
+ */
+/*@{*/
+
+/* An asynchronous read, defined in SDL_rwasync.c */
+struct SDL_AsyncRead;
+typedef struct SDL_AsyncRead SDL_AsyncRead;
+
+/**
+ *  The function called on the I/O thread when an asynchronous read is
+ *  done, with the destination and the number of bytes read.
+ */
+typedef void (SDLCALL * SDL_AsyncReadCallback) (void *userdata, void *ptr,
+                                                size_t size);
+
+/**
+ *  Start reading \c size bytes at \c offset from the start of a stream
+ *  into \c ptr in the background.
+ *
+ *  \param callback A function to call when the read is done, or NULL.
+ *
+ *  \return A request to poll and wait for, or NULL on error, including
+ *          after SDL_Quit() until SDL_Init() is called again.  Every
+ *          request must be finished with SDL_WaitAsyncRead().
+ *
+ *  \note Leave the stream alone until the read is done, since it is read
+ *        on another thread.  Streams created with SDL_RWFromAsyncRW() are
+ *        the exception: their position isn't changed, and seeking outside
+ *        the read-ahead window or writing waits for the read first.
+ */
+extern DECLSPEC SDL_AsyncRead *SDLCALL SDL_RWreadAsync(SDL_RWops * context,
+                                                       void *ptr,
+                                                       Sint64 offset,
+                                                       size_t size,
+                                                       SDL_AsyncReadCallback callback,
+                                                       void *userdata);
+
+/**
+ *  Check whether an asynchronous read is done, without waiting.
+ *
+ *  \return SDL_TRUE if the read is done, after its callback has returned.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_PollAsyncRead(SDL_AsyncRead * request);
+
+/**
+ *  Wait for an asynchronous read to be done and free the request.
+ *
+ *  \return The number of bytes read, which is less than asked for at the
+ *          end of the stream or on error.
+ */
+extern DECLSPEC size_t SDLCALL SDL_WaitAsyncRead(SDL_AsyncRead * request);
+
+/*@}*//*Asynchronous reads*/
+
+
 extern DECLSPEC SDL_RWops *SDLCALL SDL_AllocRW(void);
 extern DECLSPEC void SDLCALL SDL_FreeRW(SDL_RWops * area);
 
@@ -198,6 +319,23 @@ extern DECLSPEC Uint64 SDLCALL SDL_ReadLE64(SDL_RWops * src);
 extern DECLSPEC Uint64 SDLCALL SDL_ReadBE64(SDL_RWops * src);
 /*@}*//*Read endian functions*/
 
+/**
+ *  \name Read endian array functions
+ *
+ *  Read \c count items of the specified endianness into \c values, in
+ *  native format.
+ *
+ *  \return The number of complete items read.
+ */
+/*@{*/
+extern DECLSPEC size_t SDLCALL SDL_ReadLE16Array(SDL_RWops * src, Uint16 * values, size_t count);
+extern DECLSPEC size_t SDLCALL SDL_ReadBE16Array(SDL_RWops * src, Uint16 * values, size_t count);
+extern DECLSPEC size_t SDLCALL SDL_ReadLE32Array(SDL_RWops * src, Uint32 * values, size_t count);
+extern DECLSPEC size_t SDLCALL SDL_ReadBE32Array(SDL_RWops * src, Uint32 * values, size_t count);
+extern DECLSPEC size_t SDLCALL SDL_ReadLE64Array(SDL_RWops * src, Uint64 * values, size_t count);
+extern DECLSPEC size_t SDLCALL SDL_ReadBE64Array(SDL_RWops * src, Uint64 * values, size_t count);
+/*@}*//*Read endian array functions*/
+
 /** 
  *  \name Write endian functions
  *  
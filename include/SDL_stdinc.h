@@ -226,6 +226,53 @@ extern DECLSPEC void *SDLCALL SDL_realloc(void *mem, size_t size);
 extern DECLSPEC void SDLCALL SDL_free(void *mem);
 #endif
 
+/**
+ *  \brief The parts of SDL whose internal allocations are counted.
+ *
+ *  These cover the allocations SDL makes over and over while running,
+ *  not every allocation in the library.
+ */
+typedef enum
+{
+    SDL_MEMORY_TIMER,       /**< Timers */
+    SDL_MEMORY_EVENTS,      /**< Event watchers and filters */
+    SDL_MEMORY_SURFACE,     /**< Surface pixels */
+    SDL_MEMORY_RENDER,      /**< Texture staging buffers */
+    SDL_MEMORY_JOBS,        /**< Jobs and job counters */
+    SDL_NUM_MEMORY_SUBSYSTEMS
+} SDL_MemorySubsystem;
+
+/**
+ *  \brief Allocation counters for one SDL_MemorySubsystem.
+ */
+typedef struct SDL_MemoryStats
+{
+    Uint64 allocations;     /**< Number of allocations made */
+    Uint64 frees;           /**< Number of allocations freed */
+    Uint64 total_bytes;     /**< Bytes requested by all the allocations */
+    Uint64 current_bytes;   /**< Bytes currently allocated */
+    Uint64 peak_bytes;      /**< The most bytes that were allocated at once */
+} SDL_MemoryStats;
+
+/**
+ *  \brief Get the allocation counters for part of SDL.
+ *
+ *  A subsystem that allocates many times per frame is a good candidate
+ *  for reusing its memory.
+ *
+ *  \return 0 on success, or -1 if the subsystem is invalid.
+ */
+extern DECLSPEC int SDLCALL SDL_GetMemoryStats(SDL_MemorySubsystem subsystem,
+                                               SDL_MemoryStats * stats);
+
+/**
+ *  \brief Reset the allocation counters.
+ *
+ *  The counts and totals go back to zero and the peak to the amount that
+ *  is currently allocated.
+ */
+extern DECLSPEC void SDLCALL SDL_ResetMemoryStats(void);
+
 #if defined(HAVE_ALLOCA) && !defined(alloca)
 # if defined(HAVE_ALLOCA_H)
 #  include <alloca.h>
@@ -270,13 +317,49 @@ extern DECLSPEC int SDLCALL SDL_setenv(const char *name, const char *value,
                                        int overwrite);
 #endif
 
-#ifdef HAVE_QSORT
-#define SDL_qsort	qsort
-#else
+/**
+ *  \brief Sort an array, like qsort().
+ *
+ *  This is an introsort, so it's O(n log n) even for unlucky input, and it
+ *  isn't stable.
+ */
 extern DECLSPEC void SDLCALL SDL_qsort(void *base, size_t nmemb, size_t size,
                                        int (*compare) (const void *,
                                                        const void *));
-#endif
+
+/**
+ *  \brief The types of key that SDL_RadixSort() can sort by.
+ */
+typedef enum
+{
+    SDL_SORTKEY_UINT32,
+    SDL_SORTKEY_SINT32,
+    SDL_SORTKEY_FLOAT,
+    SDL_SORTKEY_UINT64,
+    SDL_SORTKEY_SINT64,
+    SDL_SORTKEY_DOUBLE
+} SDL_SortKeyType;
+
+/**
+ *  \brief Sort an array into ascending order of a number in each element.
+ *
+ *  This is a radix sort, so it takes linear time and doesn't call a
+ *  comparison function. The sort is stable: elements with equal keys stay
+ *  in the order they were in. Negative zero sorts before zero, and NaNs
+ *  sort before or after all other numbers depending on their sign bit.
+ *
+ *  \param base The array to sort.
+ *  \param nmemb The number of elements in the array.
+ *  \param size The size of each element in bytes.
+ *  \param key_offset The offset of the key within each element.
+ *  \param key_type The type of the key.
+ *
+ *  \return 0 on success, or -1 if a parameter is invalid or there isn't
+ *          enough memory for the temporary arrays.
+ */
+extern DECLSPEC int SDLCALL SDL_RadixSort(void *base, size_t nmemb,
+                                          size_t size, size_t key_offset,
+                                          SDL_SortKeyType key_type);
 
 #ifdef HAVE_ABS
 #define SDL_abs		abs
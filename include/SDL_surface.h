@@ -55,6 +55,8 @@ extern "C" {
 #define SDL_PREALLOC        0x00000001  /**< Surface uses preallocated memory */
 #define SDL_RLEACCEL        0x00000002  /**< Surface is RLE encoded */
 #define SDL_DONTFREE        0x00000004  /**< Surface is referenced internally */
+#define SDL_POOLED          0x00000008  /**< Surface belongs to the surface pool */
+#define SDL_SIMD_ALIGNED    0x00000010  /**< Surface rows are aligned for SIMD */
 /*@}*//*Surface flags*/
 
 /**
@@ -124,6 +126,38 @@ extern DECLSPEC SDL_Surface *SDLCALL SDL_CreateRGBSurfaceFrom(void *pixels,
                                                               Uint32 Amask);
 extern DECLSPEC void SDLCALL SDL_FreeSurface(SDL_Surface * surface);
 
+/**
+ *  Get a scratch surface of the given size and pixel format from the
+ *  surface pool, creating one if there isn't a free one.
+ *
+ *  Pooled surfaces keep their pixel format and blit map between uses, so
+ *  reusing one in a frame loop doesn't allocate memory. The pixels are
+ *  aligned to 64 bytes and their contents are undefined. The surface
+ *  otherwise starts out like one from SDL_CreateRGBSurface(); a palette
+ *  of an indexed format keeps the colors it was last given.
+ *
+ *  \return The surface, or NULL if there was an error.
+ *
+ *  \sa SDL_ReleasePooledSurface()
+ */
+extern DECLSPEC SDL_Surface *SDLCALL SDL_AcquirePooledSurface(int width,
+                                                              int height,
+                                                              Uint32 format);
+
+/**
+ *  Return a surface from SDL_AcquirePooledSurface() to the surface pool.
+ *
+ *  This is the same as calling SDL_FreeSurface(), which also returns
+ *  pooled surfaces to the pool rather than freeing them. When the pool
+ *  is full the surface is freed.
+ */
+extern DECLSPEC void SDLCALL SDL_ReleasePooledSurface(SDL_Surface * surface);
+
+/**
+ *  Free all the surfaces waiting in the surface pool.
+ */
+extern DECLSPEC void SDLCALL SDL_ClearSurfacePool(void);
+
 /**
  *  \brief Set the palette used by a surface.
  *  
@@ -64,8 +64,8 @@ extern "C" {
 //!< Function pointer to a test case setup function (run before every test)
 typedef void (*SDLTest_TestCaseSetUpFp)(void *arg);
 
-//!< Function pointer to a test case function
-typedef void (*SDLTest_TestCaseFp)(void *arg);
+//!< Function pointer to a test case function, returning one of the TEST_* values
+typedef int (*SDLTest_TestCaseFp)(void *arg);
 
 //!< Function pointer to a test case teardown function (run after every test)
 typedef void  (*SDLTest_TestCaseTearDownFp)(void *arg);
@@ -46,6 +46,14 @@ extern "C" {
  */
 extern DECLSPEC Uint32 SDLCALL SDL_GetTicks(void);
 
+/**
+ * \brief Get the number of nanoseconds since the SDL library initialization.
+ *
+ * This is based on the same monotonic clock as SDL_DelayNS() and timers
+ * added with SDL_AddTimerNS().
+ */
+extern DECLSPEC Uint64 SDLCALL SDL_GetTicksNS(void);
+
 /**
  * \brief Get the current value of the high resolution counter
  */
@@ -61,6 +69,24 @@ extern DECLSPEC Uint64 SDLCALL SDL_GetPerformanceFrequency(void);
  */
 extern DECLSPEC void SDLCALL SDL_Delay(Uint32 ms);
 
+/**
+ * \brief Wait a specified number of nanoseconds before returning.
+ *
+ * Where the platform supports it, this sleeps until an absolute deadline
+ * on the monotonic clock, so being interrupted doesn't add to the delay.
+ * The actual precision depends on the operating system scheduler.
+ */
+extern DECLSPEC void SDLCALL SDL_DelayNS(Uint64 ns);
+
+/**
+ * \brief Wait a specified number of nanoseconds, spinning for the last part.
+ *
+ * This sleeps until shortly before the deadline and busy-waits the rest,
+ * trading some CPU time for accuracy.  The length of the busy-wait is set
+ * with the SDL_HINT_TIMER_SPIN_TIME hint.
+ */
+extern DECLSPEC void SDLCALL SDL_DelayPrecise(Uint64 ns);
+
 /**
  *  Function prototype for the timer callback function.
  *  
@@ -71,6 +97,14 @@ extern DECLSPEC void SDLCALL SDL_Delay(Uint32 ms);
  */
 typedef Uint32 (SDLCALL * SDL_TimerCallback) (Uint32 interval, void *param);
 
+/**
+ *  Function prototype for the nanosecond timer callback function.
+ *
+ *  This works like SDL_TimerCallback, except that intervals are in
+ *  nanoseconds.
+ */
+typedef Uint64 (SDLCALL * SDL_NSTimerCallback) (Uint64 interval, void *param);
+
 /**
  * Definition of the timer ID type.
  */
@@ -85,6 +119,20 @@ extern DECLSPEC SDL_TimerID SDLCALL SDL_AddTimer(Uint32 interval,
                                                  SDL_TimerCallback callback,
                                                  void *param);
 
+/**
+ * \brief Add a new timer with an interval in nanoseconds.
+ *
+ * Periodic timers are rescheduled relative to their previous deadline
+ * rather than the time the callback ran, so they don't drift.
+ *
+ * \return A timer ID, or NULL when an error occurs.
+ *
+ * \sa SDL_RemoveTimer()
+ */
+extern DECLSPEC SDL_TimerID SDLCALL SDL_AddTimerNS(Uint64 interval,
+                                                   SDL_NSTimerCallback callback,
+                                                   void *param);
+
 /**
  * \brief Remove a timer knowing its ID.
  *
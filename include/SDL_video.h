@@ -262,6 +262,40 @@ extern DECLSPEC void SDLCALL SDL_VideoQuit(void);
  */
 extern DECLSPEC const char *SDLCALL SDL_GetCurrentVideoDriver(void);
 
+/**
+ *  \brief Returns a file descriptor that becomes readable when the current
+ *         video driver has events waiting, such as the X11 connection.
+ *
+ *  \return The file descriptor, or -1 if the driver doesn't have one.
+ *
+ *  This lets a main loop wait for events with poll() or select() alongside
+ *  its own descriptors.  Call SDL_PumpEvents() or SDL_PollEvent() until it
+ *  reports no more events before waiting, because events already read from
+ *  the descriptor don't make it readable again.  Some events are generated
+ *  by timers rather than by the descriptor, so wait no longer than
+ *  SDL_GetVideoEventTimeout() says.
+ *
+ *  \sa SDL_GetVideoEventTimeout()
+ *  \sa SDL_PumpEvents()
+ */
+extern DECLSPEC int SDLCALL SDL_GetVideoEventFD(void);
+
+/**
+ *  \brief Returns how long a main loop waiting on SDL_GetVideoEventFD() may
+ *         wait before it has to call SDL_PumpEvents() anyway.
+ *
+ *  \return The number of milliseconds until the video driver has work to
+ *          do that the descriptor won't signal, such as delivering a
+ *          delayed focus change, 0 if that is due now, or -1 if there is
+ *          none and the wait doesn't need a timeout.
+ *
+ *  The result is suitable as the timeout of poll().  Ask again after each
+ *  SDL_PumpEvents(), since events can start new timers.
+ *
+ *  \sa SDL_GetVideoEventFD()
+ */
+extern DECLSPEC int SDLCALL SDL_GetVideoEventTimeout(void);
+
 /**
  *  \brief Returns the number of available video displays.
  *  
@@ -649,6 +683,10 @@ extern DECLSPEC int SDLCALL SDL_SetWindowFullscreen(SDL_Window * window,
  *
  *  \note You may not combine this with 3D or the rendering API on this window.
  *
+ *  \note If SDL_HINT_VIDEO_X11_SHM_IMAGES is set above 1, the surface
+ *        pixels move when the surface is updated, so read the pixels
+ *        pointer again after each update rather than keeping it.
+ *
  *  \sa SDL_UpdateWindowSurface()
  *  \sa SDL_UpdateWindowSurfaceRects()
  */
@@ -676,6 +714,88 @@ extern DECLSPEC int SDLCALL SDL_UpdateWindowSurfaceRects(SDL_Window * window,
                                                          SDL_Rect * rects,
                                                          int numrects);
 
+/**
+ *  \brief Statistics for the frames captured from a window.
+ *
+ *  \sa SDL_GetWindowCaptureStats()
+ */
+typedef struct SDL_WindowCaptureStats
+{
+    Uint32 frames;          /**< Frames presented since capturing started */
+    Uint32 captured;        /**< Frames written out or passed to the callback */
+    Uint32 dropped;         /**< Frames dropped because no buffer was free */
+    Uint64 copy_ns;         /**< Time spent copying frames into buffers */
+    Uint64 blocked_ns;      /**< Time spent waiting for a free buffer */
+    Uint64 write_ns;        /**< Time the writer spent on frames */
+    Uint64 min_frame_ns;    /**< Shortest time between two presented frames */
+    Uint64 max_frame_ns;    /**< Longest time between two presented frames */
+    Uint64 total_frame_ns;  /**< Time from the first presented frame to the last */
+} SDL_WindowCaptureStats;
+
+/**
+ *  \brief The function called with each captured frame.
+ *
+ *  It is called on the capture thread, in order, with \c frame counting
+ *  every presented frame so that dropped frames leave gaps.  The pixels are
+ *  only valid until it returns.
+ */
+typedef void (SDLCALL * SDL_WindowCaptureCallback) (void *userdata,
+                                                    Uint32 windowID,
+                                                    Uint32 frame,
+                                                    Uint32 format,
+                                                    const void *pixels,
+                                                    int pitch, int w, int h);
+
+/**
+ *  \brief Set a function to pass every frame of every window surface to.
+ *
+ *  Frames are copied into a ring of buffers when they are presented, and
+ *  passed on by a background thread, so slow callbacks don't hold up
+ *  rendering unless every buffer is full.  Only the dummy video driver
+ *  captures frames.
+ *
+ *  \return 0 on success, or -1 if the video driver can't capture frames.
+ *
+ *  \sa SDL_HINT_VIDEO_DUMMY_CAPTURE
+ */
+extern DECLSPEC int SDLCALL SDL_SetWindowCaptureCallback(SDL_WindowCaptureCallback callback,
+                                                         void *userdata);
+
+/**
+ *  \brief Get the statistics for the frames captured from a window.
+ *
+ *  The statistics start over when the window is resized.
+ *
+ *  \return 0 on success, or -1 if the window isn't being captured.
+ */
+extern DECLSPEC int SDLCALL SDL_GetWindowCaptureStats(SDL_Window * window,
+                                                      SDL_WindowCaptureStats * stats);
+
+/**
+ *  \brief The function called after a window surface emulated with a texture
+ *         is presented.
+ *
+ *  \c numrects is the number of rectangles uploaded to the texture after
+ *  merging nearby update rectangles, and \c bytes is the number of pixel
+ *  bytes they held.
+ */
+typedef void (SDLCALL * SDL_WindowUploadCallback) (void *userdata,
+                                                   Uint32 windowID,
+                                                   int numrects,
+                                                   Uint32 bytes);
+
+/**
+ *  \brief Set a function to report how much of each window surface update
+ *         is uploaded.
+ *
+ *  This is only called for window surfaces that are emulated with a
+ *  texture, see SDL_HINT_FRAMEBUFFER_ACCELERATION.
+ *
+ *  \return 0 on success, or -1 if the video subsystem isn't initialized.
+ */
+extern DECLSPEC int SDLCALL SDL_SetWindowUploadCallback(SDL_WindowUploadCallback callback,
+                                                        void *userdata);
+
 /**
  *  \brief Set a window's input grab mode.
  *  
@@ -29,6 +29,8 @@
 #include "SDL_assert_c.h"
 #include "haptic/SDL_haptic_c.h"
 #include "joystick/SDL_joystick_c.h"
+#include "thread/SDL_jobs_c.h"
+#include "file/SDL_rwasync_c.h"
 
 /* Initialization/Cleanup routines */
 #if !SDL_TIMERS_DISABLED
@@ -199,6 +201,9 @@ SDL_Init(Uint32 flags)
     /* Clear the error message */
     SDL_ClearError();
 
+    /* Asynchronous reads may start the I/O thread again */
+    SDL_AsyncIOReset();
+
 #if defined(__WIN32__)
     if (SDL_HelperWindowCreate() < 0) {
         return -1;
@@ -314,6 +319,15 @@ SDL_Quit(void)
 #endif
     SDL_QuitSubSystem(SDL_INIT_EVERYTHING);
 
+    /* Stop the job system worker threads */
+    SDL_JobsQuit();
+
+    /* Finish any asynchronous reads and stop the I/O thread */
+    SDL_AsyncIOQuit();
+
+    /* Free the scratch surfaces kept for reuse */
+    SDL_ClearSurfacePool();
+
     /* Uninstall any parachute signal handlers */
     SDL_UninstallParachute();
 
@@ -59,7 +59,7 @@ SDL_SetHintWithPriority(const char *name, const char *value,
     const char *env;
     SDL_Hint *hint;
 
-    if (!name || !value) {
+    if (!name) {
         return SDL_FALSE;
     }
 
@@ -73,18 +73,24 @@ SDL_SetHintWithPriority(const char *name, const char *value,
             if (priority < hint->priority) {
                 return SDL_FALSE;
             }
-            if (SDL_strcmp(hint->value, value) != 0) {
+            if ((!hint->value != !value) ||
+                (value && SDL_strcmp(hint->value, value) != 0)) {
                 if (hint->callback != NULL) {
                     (*hint->callback)(name, hint->value, value);
                 }
                 SDL_free(hint->value);
-                hint->value = SDL_strdup(value);
+                hint->value = value ? SDL_strdup(value) : NULL;
             }
-            hint->priority = priority;
+            hint->priority = value ? priority : SDL_HINT_DEFAULT;
             return SDL_TRUE;
         }
     }
 
+    /* Couldn't find the hint, there's nothing to clear */
+    if (!value) {
+        return SDL_TRUE;
+    }
+
     /* Couldn't find the hint, add a new one */
     hint = (SDL_Hint *)SDL_malloc(sizeof(*hint));
     if (!hint) {
@@ -114,7 +120,7 @@ SDL_GetHint(const char *name)
     env = SDL_getenv(name);
     for (hint = SDL_hints; hint; hint = hint->next) {
         if (SDL_strcmp(name, hint->name) == 0) {
-            if (!env || hint->priority == SDL_HINT_OVERRIDE) {
+            if (hint->value && (!env || hint->priority == SDL_HINT_OVERRIDE)) {
                 return hint->value;
             }
             break;
@@ -99,4 +99,43 @@ SDL_AtomicCASPtr_(void **a, void *oldval, void *newval)
     return retval;
 }
 
+SDL_bool
+SDL_AtomicCAS64_(SDL_atomic64_t *a, Sint64 oldval, Sint64 newval)
+{
+    SDL_bool retval = SDL_FALSE;
+
+    /* Use the real instruction when the library has one, so that code
+       inlining it and code calling this function can share the variable.
+     */
+#if defined(__GCC_ATOMIC_LLONG_LOCK_FREE) && (__GCC_ATOMIC_LLONG_LOCK_FREE == 2)
+    retval = __sync_bool_compare_and_swap(&a->value, oldval, newval) ? SDL_TRUE : SDL_FALSE;
+#elif defined(HAVE_MSC_ATOMICS)
+    retval = (_InterlockedCompareExchange64(&a->value, newval, oldval) == oldval) ? SDL_TRUE : SDL_FALSE;
+#else
+    enterLock(a);
+    if (a->value == oldval) {
+        a->value = newval;
+        retval = SDL_TRUE;
+    }
+    leaveLock(a);
+#endif
+
+    return retval;
+}
+
+void
+SDL_MemoryBarrier_(void)
+{
+#if defined(__ATOMIC_SEQ_CST)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#elif defined(HAVE_GCC_ATOMICS)
+    __sync_synchronize();
+#else
+    /* Taking and releasing a lock orders memory in both directions */
+    SDL_SpinLock lock = 0;
+    SDL_AtomicLock(&lock);
+    SDL_AtomicUnlock(&lock);
+#endif
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
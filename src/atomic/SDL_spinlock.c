@@ -29,6 +29,34 @@
 #include "../core/windows/SDL_windows.h"
 #endif
 
+/* The longest run of pause instructions before we yield the CPU instead */
+#define SDL_SPINLOCK_MAX_BACKOFF    64
+
+/* Reader/writer spin lock state: a writer holds the lock, a writer is
+   waiting for it, and the number of readers in the low bits.
+ */
+#define SDL_RWSPIN_WRITER           0x40000000
+#define SDL_RWSPIN_WRITER_WAITING   0x20000000
+
+/* Wait a little before looking at a busy lock again, doubling the wait
+   each time so contending threads spread out instead of hammering the
+   cache line.  Once that takes long enough, give up the CPU.
+ */
+static void
+SDL_SpinBackoff(int *backoff)
+{
+    int i;
+
+    if (*backoff <= SDL_SPINLOCK_MAX_BACKOFF) {
+        for (i = 0; i < *backoff; ++i) {
+            SDL_CPUPauseInstruction();
+        }
+        *backoff *= 2;
+    } else {
+        SDL_Delay(0);
+    }
+}
+
 /* This function is where all the magic happens... */
 SDL_bool
 SDL_AtomicTryLock(SDL_SpinLock *lock)
@@ -99,9 +127,14 @@ SDL_AtomicTryLock(SDL_SpinLock *lock)
 void
 SDL_AtomicLock(SDL_SpinLock *lock)
 {
+    int backoff = 1;
+
     /* FIXME: Should we have an eventual timeout? */
     while (!SDL_AtomicTryLock(lock)) {
-        SDL_Delay(0);
+        /* Only retry the atomic exchange once the lock looks free */
+        do {
+            SDL_SpinBackoff(&backoff);
+        } while (*(volatile SDL_SpinLock *)lock);
     }
 }
 
@@ -123,4 +156,75 @@ SDL_AtomicUnlock(SDL_SpinLock *lock)
 #endif
 }
 
+SDL_bool
+SDL_AtomicTryLockRead(SDL_RWSpinLock *lock)
+{
+    SDL_atomic_t *state = (SDL_atomic_t *)lock;
+    int value = SDL_AtomicGet(state);
+
+    while (!(value & (SDL_RWSPIN_WRITER | SDL_RWSPIN_WRITER_WAITING))) {
+        if (SDL_AtomicCAS(state, value, value + 1)) {
+            return SDL_TRUE;
+        }
+        value = SDL_AtomicGet(state);
+    }
+    return SDL_FALSE;
+}
+
+void
+SDL_AtomicLockRead(SDL_RWSpinLock *lock)
+{
+    int backoff = 1;
+
+    while (!SDL_AtomicTryLockRead(lock)) {
+        SDL_SpinBackoff(&backoff);
+    }
+}
+
+void
+SDL_AtomicUnlockRead(SDL_RWSpinLock *lock)
+{
+    SDL_AtomicAdd((SDL_atomic_t *)lock, -1);
+}
+
+SDL_bool
+SDL_AtomicTryLockWrite(SDL_RWSpinLock *lock)
+{
+    SDL_atomic_t *state = (SDL_atomic_t *)lock;
+    int value = SDL_AtomicGet(state);
+
+    /* Taking the lock clears the waiting flag, other writers set it again */
+    while ((value & ~SDL_RWSPIN_WRITER_WAITING) == 0) {
+        if (SDL_AtomicCAS(state, value, SDL_RWSPIN_WRITER)) {
+            return SDL_TRUE;
+        }
+        value = SDL_AtomicGet(state);
+    }
+    return SDL_FALSE;
+}
+
+void
+SDL_AtomicLockWrite(SDL_RWSpinLock *lock)
+{
+    SDL_atomic_t *state = (SDL_atomic_t *)lock;
+    int backoff = 1;
+    int value;
+
+    while (!SDL_AtomicTryLockWrite(lock)) {
+        /* Keep new readers out until we get our turn */
+        value = SDL_AtomicGet(state);
+        if (!(value & SDL_RWSPIN_WRITER_WAITING)) {
+            SDL_AtomicCAS(state, value, value | SDL_RWSPIN_WRITER_WAITING);
+        }
+        SDL_SpinBackoff(&backoff);
+    }
+}
+
+void
+SDL_AtomicUnlockWrite(SDL_RWSpinLock *lock)
+{
+    /* Leave the waiting flag alone if another writer set it meanwhile */
+    SDL_AtomicAdd((SDL_atomic_t *)lock, -SDL_RWSPIN_WRITER);
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
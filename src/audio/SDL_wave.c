@@ -27,6 +27,8 @@
 
 
 static int ReadChunk(SDL_RWops * src, Chunk * chunk);
+static int ReadChunkInPlace(SDL_RWops * src, Chunk * chunk,
+                            const Uint8 ** data);
 
 struct MS_ADPCM_decodestate
 {
@@ -115,11 +117,12 @@ MS_ADPCM_nibble(struct MS_ADPCM_decodestate *state,
     return (new_sample);
 }
 
+/* Decode *audio_len bytes at encoded into a new buffer in *audio_buf */
 static int
-MS_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
+MS_ADPCM_decode(const Uint8 * encoded, Uint8 ** audio_buf, Uint32 * audio_len)
 {
     struct MS_ADPCM_decodestate *state[2];
-    Uint8 *freeable, *encoded, *decoded;
+    Uint8 *decoded;
     Sint32 encoded_len, samplesleft;
     Sint8 nybble, stereo;
     Sint16 *coeff[2];
@@ -127,8 +130,6 @@ MS_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
 
     /* Allocate the proper sized output buffer */
     encoded_len = *audio_len;
-    encoded = *audio_buf;
-    freeable = *audio_buf;
     *audio_len = (encoded_len / MS_ADPCM_state.wavefmt.blockalign) *
         MS_ADPCM_state.wSamplesPerBlock *
         MS_ADPCM_state.wavefmt.channels * sizeof(Sint16);
@@ -211,7 +212,6 @@ MS_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
         }
         encoded_len -= MS_ADPCM_state.wavefmt.blockalign;
     }
-    SDL_free(freeable);
     return (0);
 }
 
@@ -305,7 +305,7 @@ IMA_ADPCM_nibble(struct IMA_ADPCM_decodestate *state, Uint8 nybble)
 
 /* Fill the decode buffer with a channel block of data (8 samples) */
 static void
-Fill_IMA_ADPCM_block(Uint8 * decoded, Uint8 * encoded,
+Fill_IMA_ADPCM_block(Uint8 * decoded, const Uint8 * encoded,
                      int channel, int numchannels,
                      struct IMA_ADPCM_decodestate *state)
 {
@@ -333,11 +333,12 @@ Fill_IMA_ADPCM_block(Uint8 * decoded, Uint8 * encoded,
     }
 }
 
+/* Decode *audio_len bytes at encoded into a new buffer in *audio_buf */
 static int
-IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
+IMA_ADPCM_decode(const Uint8 * encoded, Uint8 ** audio_buf, Uint32 * audio_len)
 {
     struct IMA_ADPCM_decodestate *state;
-    Uint8 *freeable, *encoded, *decoded;
+    Uint8 *decoded;
     Sint32 encoded_len, samplesleft;
     unsigned int c, channels;
 
@@ -352,8 +353,6 @@ IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
 
     /* Allocate the proper sized output buffer */
     encoded_len = *audio_len;
-    encoded = *audio_buf;
-    freeable = *audio_buf;
     *audio_len = (encoded_len / IMA_ADPCM_state.wavefmt.blockalign) *
         IMA_ADPCM_state.wSamplesPerBlock *
         IMA_ADPCM_state.wavefmt.channels * sizeof(Sint16);
@@ -399,7 +398,6 @@ IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
         }
         encoded_len -= IMA_ADPCM_state.wavefmt.blockalign;
     }
-    SDL_free(freeable);
     return (0);
 }
 
@@ -422,6 +420,9 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     /* FMT chunk */
     WaveFMT *format = NULL;
 
+    /* Audio data chunk, possibly still in the data source */
+    const Uint8 *data = NULL;
+
     SDL_zero(chunk);
 
     /* Make sure we are passed a valid data source */
@@ -466,6 +467,7 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
 
     /* Decode the audio data format */
     format = (WaveFMT *) chunk.data;
+    chunk.data = NULL;
     if (chunk.magic != FMT) {
         SDL_SetError("Complex WAVE files not supported");
         was_error = 1;
@@ -548,36 +550,48 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     spec->channels = (Uint8) SDL_SwapLE16(format->channels);
     spec->samples = 4096;       /* Good default buffer size */
 
-    /* Read the audio data chunk */
+    /* Read the audio data chunk.  When the data source is in memory the
+       other chunks are skipped and the data is decoded or copied in place.
+     */
     *audio_buf = NULL;
     do {
-        if (*audio_buf != NULL) {
-            SDL_free(*audio_buf);
-            *audio_buf = NULL;
+        if (chunk.data != NULL) {
+            SDL_free(chunk.data);
+            chunk.data = NULL;
         }
-        lenread = ReadChunk(src, &chunk);
+        lenread = ReadChunkInPlace(src, &chunk, &data);
         if (lenread < 0) {
             was_error = 1;
             goto done;
         }
         *audio_len = lenread;
-        *audio_buf = chunk.data;
         if (chunk.magic != DATA)
             headerDiff += lenread + 2 * sizeof(Uint32);
     } while (chunk.magic != DATA);
     headerDiff += 2 * sizeof(Uint32);   /* for the data chunk and len */
 
     if (MS_ADPCM_encoded) {
-        if (MS_ADPCM_decode(audio_buf, audio_len) < 0) {
+        if (MS_ADPCM_decode(data, audio_buf, audio_len) < 0) {
             was_error = 1;
             goto done;
         }
-    }
-    if (IMA_ADPCM_encoded) {
-        if (IMA_ADPCM_decode(audio_buf, audio_len) < 0) {
+    } else if (IMA_ADPCM_encoded) {
+        if (IMA_ADPCM_decode(data, audio_buf, audio_len) < 0) {
+            was_error = 1;
+            goto done;
+        }
+    } else if (chunk.data != NULL) {
+        *audio_buf = chunk.data;
+        chunk.data = NULL;
+    } else {
+        /* The caller frees the audio data, so it can't stay in place */
+        *audio_buf = (Uint8 *) SDL_malloc(*audio_len);
+        if (*audio_buf == NULL) {
+            SDL_Error(SDL_ENOMEM);
             was_error = 1;
             goto done;
         }
+        SDL_memcpy(*audio_buf, data, *audio_len);
     }
 
     /* Don't return a buffer that isn't a multiple of samplesize */
@@ -585,6 +599,9 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     *audio_len &= ~(samplesize - 1);
 
   done:
+    if (chunk.data != NULL) {
+        SDL_free(chunk.data);
+    }
     if (format != NULL) {
         SDL_free(format);
     }
@@ -614,10 +631,8 @@ SDL_FreeWAV(Uint8 * audio_buf)
 }
 
 static int
-ReadChunk(SDL_RWops * src, Chunk * chunk)
+ReadChunkData(SDL_RWops * src, Chunk * chunk)
 {
-    chunk->magic = SDL_ReadLE32(src);
-    chunk->length = SDL_ReadLE32(src);
     chunk->data = (Uint8 *) SDL_malloc(chunk->length);
     if (chunk->data == NULL) {
         SDL_Error(SDL_ENOMEM);
@@ -632,4 +647,35 @@ ReadChunk(SDL_RWops * src, Chunk * chunk)
     return (chunk->length);
 }
 
+static int
+ReadChunk(SDL_RWops * src, Chunk * chunk)
+{
+    chunk->magic = SDL_ReadLE32(src);
+    chunk->length = SDL_ReadLE32(src);
+    return ReadChunkData(src, chunk);
+}
+
+/* Like ReadChunk(), but if the data can be accessed in place it is skipped
+   over and chunk->data is left NULL.  Either way *data points at it.
+ */
+static int
+ReadChunkInPlace(SDL_RWops * src, Chunk * chunk, const Uint8 ** data)
+{
+    chunk->magic = SDL_ReadLE32(src);
+    chunk->length = SDL_ReadLE32(src);
+    chunk->data = NULL;
+    *data = (const Uint8 *) SDL_RWGetPointer(src, SDL_RWtell(src),
+                                             chunk->length);
+    if (*data == NULL) {
+        if (ReadChunkData(src, chunk) < 0) {
+            return (-1);
+        }
+        *data = chunk->data;
+    } else if (SDL_RWseek(src, chunk->length, RW_SEEK_CUR) < 0) {
+        SDL_Error(SDL_EFSEEK);
+        return (-1);
+    }
+    return (chunk->length);
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
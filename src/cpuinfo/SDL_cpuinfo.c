@@ -23,6 +23,9 @@
 /* CPU feature detection for SDL */
 
 #include "SDL_cpuinfo.h"
+#include "SDL_hints.h"
+#include "SDL_rwops.h"
+#include "SDL_cpuinfo_c.h"
 
 #ifdef HAVE_SYSCONF
 #include <unistd.h>
@@ -41,19 +44,19 @@
 #include <signal.h>
 #include <setjmp.h>
 #endif
+#if defined(__LINUX__) && defined(__arm__) && !defined(__ARM_NEON__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <elf.h>                /* For NEON check */
+#endif
 #ifdef __WIN32__
 #include "../core/windows/SDL_windows.h"
 #endif
 
-#define CPU_HAS_RDTSC   0x00000001
-#define CPU_HAS_ALTIVEC 0x00000002
-#define CPU_HAS_MMX     0x00000004
-#define CPU_HAS_3DNOW   0x00000008
-#define CPU_HAS_SSE     0x00000010
-#define CPU_HAS_SSE2    0x00000020
-#define CPU_HAS_SSE3    0x00000040
-#define CPU_HAS_SSE41   0x00000100
-#define CPU_HAS_SSE42   0x00000200
+#ifndef AT_HWCAP
+#define AT_HWCAP    16
+#endif
+#define ARM_HWCAP_NEON  (1 << 12)
 
 #if SDL_ALTIVEC_BLITTERS && HAVE_SETJMP && !__MACOSX__ && !__OpenBSD__
 /* This is the brute force way of detecting instruction sets...
@@ -110,6 +113,9 @@ CPUid by definition.  But it's nice to be able to prove it.  :)      */
     :
     : "%rax", "%rcx"
     );
+#elif defined(_MSC_VER) && defined(_M_X64)
+    /* Every x86_64 processor has CPUID */
+    has_CPUID = 1;
 #elif (defined(_MSC_VER) && defined(_M_IX86)) || defined(__WATCOMC__)
     __asm {
         pushfd                      ; Get original EFLAGS
@@ -160,37 +166,76 @@ done:
     return has_CPUID;
 }
 
+/* cpuid_count() is for the leaves that take a subleaf number in ECX */
 #if defined(__GNUC__) && defined(i386)
-#define cpuid(func, a, b, c, d) \
+#define cpuid_count(func, sub, a, b, c, d) \
     __asm__ __volatile__ ( \
 "        pushl %%ebx        \n" \
 "        cpuid              \n" \
 "        movl %%ebx, %%esi  \n" \
 "        popl %%ebx         \n" : \
-            "=a" (a), "=S" (b), "=c" (c), "=d" (d) : "a" (func))
+            "=a" (a), "=S" (b), "=c" (c), "=d" (d) : "a" (func), "c" (sub))
 #elif defined(__GNUC__) && defined(__x86_64__)
-#define cpuid(func, a, b, c, d) \
+#define cpuid_count(func, sub, a, b, c, d) \
     __asm__ __volatile__ ( \
 "        pushq %%rbx        \n" \
 "        cpuid              \n" \
 "        movq %%rbx, %%rsi  \n" \
 "        popq %%rbx         \n" : \
-            "=a" (a), "=S" (b), "=c" (c), "=d" (d) : "a" (func))
+            "=a" (a), "=S" (b), "=c" (c), "=d" (d) : "a" (func), "c" (sub))
 #elif (defined(_MSC_VER) && defined(_M_IX86)) || defined(__WATCOMC__)
-#define cpuid(func, a, b, c, d) \
+#define cpuid_count(func, sub, a, b, c, d) \
     __asm { \
         __asm mov eax, func \
+        __asm mov ecx, sub \
         __asm cpuid \
         __asm mov a, eax \
         __asm mov b, ebx \
         __asm mov c, ecx \
         __asm mov d, edx \
     }
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define cpuid_count(func, sub, a, b, c, d) \
+    { \
+        int CPUInfo[4]; \
+        __cpuidex(CPUInfo, func, sub); \
+        a = CPUInfo[0]; \
+        b = CPUInfo[1]; \
+        c = CPUInfo[2]; \
+        d = CPUInfo[3]; \
+    }
 #else
-#define cpuid(func, a, b, c, d) \
+#define cpuid_count(func, sub, a, b, c, d) \
     a = b = c = d = 0
 #endif
 
+#define cpuid(func, a, b, c, d) cpuid_count(func, 0, a, b, c, d)
+
+/* Read the XCR0 register, which says which register sets the OS saves */
+static __inline__ Uint32
+CPU_getXCR0(void)
+{
+    Uint32 xcr0 = 0;
+/* *INDENT-OFF* */
+#if defined(__GNUC__) && (defined(i386) || defined(__x86_64__))
+    Uint32 high;
+    /* This is xgetbv, spelled out for assemblers that don't know it */
+    __asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a" (xcr0), "=d" (high) : "c" (0));
+#elif defined(_MSC_VER) && defined(_M_X64) && (_MSC_FULL_VER >= 160040219)
+    xcr0 = (Uint32)_xgetbv(0);
+#elif defined(_MSC_VER) && defined(_M_IX86)
+    __asm {
+        xor     ecx, ecx
+        _emit   0x0f
+        _emit   0x01
+        _emit   0xd0
+        mov     xcr0, eax
+    }
+#endif
+/* *INDENT-ON* */
+    return xcr0;
+}
+
 static __inline__ int
 CPU_getCPUIDFeatures(void)
 {
@@ -328,6 +373,152 @@ CPU_haveSSE42(void)
     return 0;
 }
 
+/* The CPU says it has XSAVE and the OS has turned it on (OSXSAVE) */
+static __inline__ int
+CPU_haveOSXSAVE(void)
+{
+    if (CPU_haveCPUID()) {
+        int a, b, c, d;
+
+        cpuid(0, a, b, c, d);
+        if (a >= 1) {
+            cpuid(1, a, b, c, d);
+            return ((c & 0x08000000) != 0);
+        }
+    }
+    return 0;
+}
+
+/* The OS saves the XMM and YMM registers across context switches */
+static __inline__ int
+CPU_OSSavesYMM(void)
+{
+    return CPU_haveOSXSAVE() && ((CPU_getXCR0() & 0x06) == 0x06);
+}
+
+/* The OS saves the opmask and ZMM registers as well */
+static __inline__ int
+CPU_OSSavesZMM(void)
+{
+    return CPU_haveOSXSAVE() && ((CPU_getXCR0() & 0xE6) == 0xE6);
+}
+
+static __inline__ int
+CPU_getCPUIDFeaturesECX(void)
+{
+    int features = 0;
+    int a, b, c, d;
+
+    cpuid(0, a, b, c, d);
+    if (a >= 1) {
+        cpuid(1, a, b, c, d);
+        features = c;
+    }
+    return features;
+}
+
+/* The structured extended feature flags in EBX of leaf 7 */
+static __inline__ int
+CPU_getCPUIDExtendedFeatures(void)
+{
+    int features = 0;
+    int a, b, c, d;
+
+    cpuid(0, a, b, c, d);
+    if (a >= 7) {
+        cpuid_count(7, 0, a, b, c, d);
+        features = b;
+    }
+    return features;
+}
+
+static __inline__ int
+CPU_haveAVX(void)
+{
+    if (CPU_haveCPUID() && CPU_OSSavesYMM()) {
+        return (CPU_getCPUIDFeaturesECX() & 0x10000000);
+    }
+    return 0;
+}
+
+static __inline__ int
+CPU_haveAVX2(void)
+{
+    if (CPU_haveCPUID() && CPU_OSSavesYMM()) {
+        return (CPU_getCPUIDExtendedFeatures() & 0x00000020);
+    }
+    return 0;
+}
+
+static __inline__ int
+CPU_haveAVX512F(void)
+{
+    if (CPU_haveCPUID() && CPU_OSSavesZMM()) {
+        return (CPU_getCPUIDExtendedFeatures() & 0x00010000);
+    }
+    return 0;
+}
+
+static __inline__ int
+CPU_haveFMA(void)
+{
+    if (CPU_haveCPUID() && CPU_OSSavesYMM()) {
+        return (CPU_getCPUIDFeaturesECX() & 0x00001000);
+    }
+    return 0;
+}
+
+static __inline__ int
+CPU_haveF16C(void)
+{
+    if (CPU_haveCPUID() && CPU_OSSavesYMM()) {
+        return (CPU_getCPUIDFeaturesECX() & 0x20000000);
+    }
+    return 0;
+}
+
+static __inline__ int
+CPU_haveBMI1(void)
+{
+    if (CPU_haveCPUID()) {
+        return (CPU_getCPUIDExtendedFeatures() & 0x00000008);
+    }
+    return 0;
+}
+
+static __inline__ int
+CPU_haveBMI2(void)
+{
+    if (CPU_haveCPUID()) {
+        return (CPU_getCPUIDExtendedFeatures() & 0x00000100);
+    }
+    return 0;
+}
+
+static __inline__ int
+CPU_haveNEON(void)
+{
+    int neon = 0;
+#if defined(__aarch64__) || defined(__ARM_NEON__) || defined(__ARM_NEON)
+    /* NEON is part of ARMv8, or we were compiled to require it anyway */
+    neon = 1;
+#elif defined(__LINUX__) && defined(__arm__)
+    /* The kernel passes the hardware capabilities in the aux vector */
+    int fd = open("/proc/self/auxv", O_RDONLY);
+    if (fd >= 0) {
+        Uint32 auxv[2];
+        while (read(fd, auxv, sizeof(auxv)) == sizeof(auxv)) {
+            if (auxv[0] == AT_HWCAP) {
+                neon = ((auxv[1] & ARM_HWCAP_NEON) != 0);
+                break;
+            }
+        }
+        close(fd);
+    }
+#endif
+    return neon;
+}
+
 static int SDL_CPUCount = 0;
 
 int
@@ -360,6 +551,77 @@ SDL_GetCPUCount(void)
     return SDL_CPUCount;
 }
 
+#ifdef __WIN32__
+typedef BOOL (WINAPI *GetLogicalProcessorInformation_t)(PSYSTEM_LOGICAL_PROCESSOR_INFORMATION, PDWORD);
+#endif
+
+static int SDL_CPUPhysicalCoreCount = 0;
+
+int
+SDL_GetCPUPhysicalCoreCount(void)
+{
+    if (!SDL_CPUPhysicalCoreCount) {
+#ifdef __LINUX__
+        /* Count each core once, through the first of its hardware threads */
+        int i, count = SDL_GetCPUCount(), cores = 0;
+        for (i = 0; i < count; ++i) {
+            char path[128], buf[32];
+            size_t len;
+            SDL_RWops *rw;
+
+            SDL_snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", i);
+            rw = SDL_RWFromFile(path, "rb");
+            if (!rw) {
+                cores = 0;
+                break;
+            }
+            len = SDL_RWread(rw, buf, 1, sizeof(buf) - 1);
+            SDL_RWclose(rw);
+            buf[len] = '\0';
+            if (SDL_atoi(buf) == i) {
+                ++cores;
+            }
+        }
+        SDL_CPUPhysicalCoreCount = cores;
+#endif
+#ifdef HAVE_SYSCTLBYNAME
+        if (SDL_CPUPhysicalCoreCount <= 0) {
+            size_t size = sizeof(SDL_CPUPhysicalCoreCount);
+            if (sysctlbyname("hw.physicalcpu", &SDL_CPUPhysicalCoreCount, &size, NULL, 0) != 0) {
+                SDL_CPUPhysicalCoreCount = 0;
+            }
+        }
+#endif
+#ifdef __WIN32__
+        if (SDL_CPUPhysicalCoreCount <= 0) {
+            /* Not available before Windows XP SP3 */
+            GetLogicalProcessorInformation_t pGetLogicalProcessorInformation =
+                (GetLogicalProcessorInformation_t) GetProcAddress(GetModuleHandleA("kernel32.dll"), "GetLogicalProcessorInformation");
+            DWORD size = 0;
+            if (pGetLogicalProcessorInformation &&
+                !pGetLogicalProcessorInformation(NULL, &size) &&
+                GetLastError() == ERROR_INSUFFICIENT_BUFFER) {
+                SYSTEM_LOGICAL_PROCESSOR_INFORMATION *info = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION *) SDL_malloc(size);
+                if (info && pGetLogicalProcessorInformation(info, &size)) {
+                    DWORD i;
+                    for (i = 0; i < size / sizeof(*info); ++i) {
+                        if (info[i].Relationship == RelationProcessorCore) {
+                            ++SDL_CPUPhysicalCoreCount;
+                        }
+                    }
+                }
+                SDL_free(info);
+            }
+        }
+#endif
+        if (SDL_CPUPhysicalCoreCount <= 0 ||
+            SDL_CPUPhysicalCoreCount > SDL_GetCPUCount()) {
+            SDL_CPUPhysicalCoreCount = SDL_GetCPUCount();
+        }
+    }
+    return SDL_CPUPhysicalCoreCount;
+}
+
 /* Oh, such a sweet sweet trick, just not very useful. :) */
 static const char *
 SDL_GetCPUType(void)
@@ -488,6 +750,94 @@ SDL_GetCPUCacheLineSize(void)
     }
 }
 
+static int
+CPU_getCacheSizeCPUID(int level)
+{
+    const char *cpuType = SDL_GetCPUType();
+    int a, b, c, d;
+
+    if (SDL_strcmp(cpuType, "GenuineIntel") == 0) {
+        int i;
+
+        /* Walk the deterministic cache parameters, skipping the L1
+           instruction cache.
+         */
+        cpuid(0x00000000, a, b, c, d);
+        if (a < 4) {
+            return 0;
+        }
+        for (i = 0; i < 16; ++i) {
+            int type;
+
+            cpuid_count(0x00000004, i, a, b, c, d);
+            type = (a & 0x1f);
+            if (type == 0) {
+                break;
+            }
+            if (type != 2 && ((a >> 5) & 0x7) == level) {
+                const int ways = ((b >> 22) & 0x3ff) + 1;
+                const int partitions = ((b >> 12) & 0x3ff) + 1;
+                const int line_size = (b & 0xfff) + 1;
+                const int sets = c + 1;
+                return (int)(((Sint64)ways * partitions * line_size * sets) / 1024);
+            }
+        }
+    } else if (SDL_strcmp(cpuType, "AuthenticAMD") == 0) {
+        int max;
+
+        cpuid(0x80000000, max, b, c, d);
+        if (level == 1 && max >= 0x80000005) {
+            cpuid(0x80000005, a, b, c, d);
+            return ((c >> 24) & 0xff);
+        } else if (level == 2 && max >= 0x80000006) {
+            cpuid(0x80000006, a, b, c, d);
+            return ((c >> 16) & 0xffff);
+        } else if (level == 3 && max >= 0x80000006) {
+            cpuid(0x80000006, a, b, c, d);
+            return ((d >> 18) & 0x3fff) * 512;
+        }
+    }
+    return 0;
+}
+
+int
+SDL_GetCPUCacheSize(int level)
+{
+    int size = 0;
+
+    if (level < 1 || level > 3) {
+        return 0;
+    }
+
+    if (CPU_haveCPUID()) {
+        size = CPU_getCacheSizeCPUID(level);
+    }
+#if defined(HAVE_SYSCONF) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    if (size <= 0) {
+        static const int names[] = {
+            _SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL2_CACHE_SIZE, _SC_LEVEL3_CACHE_SIZE
+        };
+        size = (int)(sysconf(names[level - 1]) / 1024);
+    }
+#endif
+#ifdef HAVE_SYSCTLBYNAME
+    if (size <= 0) {
+        static const char *names[] = {
+            "hw.l1dcachesize", "hw.l2cachesize", "hw.l3cachesize"
+        };
+        Sint64 bytes = 0;
+        size_t length = sizeof(bytes);
+        if (sysctlbyname(names[level - 1], &bytes, &length, NULL, 0) == 0) {
+            size = (int)(bytes / 1024);
+        }
+    }
+#endif
+    if (size < 0) {
+        size = 0;
+    }
+    return size;
+}
+
 static Uint32 SDL_CPUFeatures = 0xFFFFFFFF;
 
 static Uint32
@@ -522,10 +872,95 @@ SDL_GetCPUFeatures(void)
         if (CPU_haveSSE42()) {
             SDL_CPUFeatures |= CPU_HAS_SSE42;
         }
+        if (CPU_haveAVX()) {
+            SDL_CPUFeatures |= CPU_HAS_AVX;
+        }
+        if (CPU_haveAVX2()) {
+            SDL_CPUFeatures |= CPU_HAS_AVX2;
+        }
+        if (CPU_haveAVX512F()) {
+            SDL_CPUFeatures |= CPU_HAS_AVX512F;
+        }
+        if (CPU_haveFMA()) {
+            SDL_CPUFeatures |= CPU_HAS_FMA;
+        }
+        if (CPU_haveF16C()) {
+            SDL_CPUFeatures |= CPU_HAS_F16C;
+        }
+        if (CPU_haveBMI1()) {
+            SDL_CPUFeatures |= CPU_HAS_BMI1;
+        }
+        if (CPU_haveBMI2()) {
+            SDL_CPUFeatures |= CPU_HAS_BMI2;
+        }
+        if (CPU_haveNEON()) {
+            SDL_CPUFeatures |= CPU_HAS_NEON;
+        }
     }
     return SDL_CPUFeatures;
 }
 
+/* Each level of SDL_HINT_CPU_FEATURE_LIMIT allows the features of the
+   levels before it plus its own.
+ */
+static const struct
+{
+    const char *name;
+    Uint32 features;
+} SDL_CPUFeatureLevels[] = {
+    { "scalar", CPU_HAS_RDTSC },
+    { "mmx", CPU_HAS_MMX | CPU_HAS_3DNOW },
+    { "sse", CPU_HAS_SSE },
+    { "sse2", CPU_HAS_SSE2 },
+    { "sse3", CPU_HAS_SSE3 },
+    { "sse4.1", CPU_HAS_SSE41 },
+    { "sse4.2", CPU_HAS_SSE42 },
+    { "avx", CPU_HAS_AVX | CPU_HAS_F16C },
+    { "avx2", CPU_HAS_AVX2 | CPU_HAS_FMA | CPU_HAS_BMI1 | CPU_HAS_BMI2 },
+    { "avx512", CPU_HAS_AVX512F }
+};
+
+static Uint32 SDL_CPUDispatchFeatures = 0xFFFFFFFF;
+
+Uint32
+SDL_GetCPUDispatchFeatures(void)
+{
+    if (SDL_CPUDispatchFeatures == 0xFFFFFFFF) {
+        const char *hint = SDL_GetHint(SDL_HINT_CPU_FEATURE_LIMIT);
+        Uint32 allowed = 0xFFFFFFFF;
+
+        if (hint && *hint) {
+            int i;
+            Uint32 features = 0;
+
+            for (i = 0; i < SDL_arraysize(SDL_CPUFeatureLevels); ++i) {
+                features |= SDL_CPUFeatureLevels[i].features;
+                if (SDL_strcasecmp(hint, SDL_CPUFeatureLevels[i].name) == 0) {
+                    allowed = features;
+                    if (i > 0) {
+                        allowed |= (CPU_HAS_ALTIVEC | CPU_HAS_NEON);
+                    }
+                    break;
+                }
+            }
+        }
+        SDL_CPUDispatchFeatures = (SDL_GetCPUFeatures() & allowed);
+    }
+    return SDL_CPUDispatchFeatures;
+}
+
+SDL_CPUFunction
+SDL_SelectCPUImplementation(const SDL_CPUImplementation * impls)
+{
+    const Uint32 features = SDL_GetCPUDispatchFeatures();
+
+    /* The last entry needs no features, so this always finds one */
+    while ((impls->features & features) != impls->features) {
+        ++impls;
+    }
+    return impls->func;
+}
+
 SDL_bool
 SDL_HasRDTSC(void)
 {
@@ -607,6 +1042,78 @@ SDL_HasSSE42(void)
     return SDL_FALSE;
 }
 
+SDL_bool
+SDL_HasAVX(void)
+{
+    if (SDL_GetCPUFeatures() & CPU_HAS_AVX) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+SDL_bool
+SDL_HasAVX2(void)
+{
+    if (SDL_GetCPUFeatures() & CPU_HAS_AVX2) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+SDL_bool
+SDL_HasAVX512F(void)
+{
+    if (SDL_GetCPUFeatures() & CPU_HAS_AVX512F) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+SDL_bool
+SDL_HasFMA(void)
+{
+    if (SDL_GetCPUFeatures() & CPU_HAS_FMA) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+SDL_bool
+SDL_HasF16C(void)
+{
+    if (SDL_GetCPUFeatures() & CPU_HAS_F16C) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+SDL_bool
+SDL_HasBMI1(void)
+{
+    if (SDL_GetCPUFeatures() & CPU_HAS_BMI1) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+SDL_bool
+SDL_HasBMI2(void)
+{
+    if (SDL_GetCPUFeatures() & CPU_HAS_BMI2) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+SDL_bool
+SDL_HasNEON(void)
+{
+    if (SDL_GetCPUFeatures() & CPU_HAS_NEON) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
 #ifdef TEST_MAIN
 
 #include <stdio.h>
@@ -615,9 +1122,12 @@ int
 main()
 {
     printf("CPU count: %d\n", SDL_GetCPUCount());
+    printf("Physical cores: %d\n", SDL_GetCPUPhysicalCoreCount());
     printf("CPU type: %s\n", SDL_GetCPUType());
     printf("CPU name: %s\n", SDL_GetCPUName());
     printf("CacheLine size: %d\n", SDL_GetCPUCacheLineSize());
+    printf("L1/L2/L3 cache: %d/%d/%d KB\n", SDL_GetCPUCacheSize(1),
+           SDL_GetCPUCacheSize(2), SDL_GetCPUCacheSize(3));
     printf("RDTSC: %d\n", SDL_HasRDTSC());
     printf("Altivec: %d\n", SDL_HasAltiVec());
     printf("MMX: %d\n", SDL_HasMMX());
@@ -627,6 +1137,14 @@ main()
     printf("SSE3: %d\n", SDL_HasSSE3());
     printf("SSE4.1: %d\n", SDL_HasSSE41());
     printf("SSE4.2: %d\n", SDL_HasSSE42());
+    printf("AVX: %d\n", SDL_HasAVX());
+    printf("AVX2: %d\n", SDL_HasAVX2());
+    printf("AVX-512F: %d\n", SDL_HasAVX512F());
+    printf("FMA: %d\n", SDL_HasFMA());
+    printf("F16C: %d\n", SDL_HasF16C());
+    printf("BMI1: %d\n", SDL_HasBMI1());
+    printf("BMI2: %d\n", SDL_HasBMI2());
+    printf("NEON: %d\n", SDL_HasNEON());
     return 0;
 }
 
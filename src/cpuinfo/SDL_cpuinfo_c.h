@@ -0,0 +1,73 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_cpuinfo_c_h
+#define _SDL_cpuinfo_c_h
+
+#include "SDL_cpuinfo.h"
+
+/* CPU feature bits, as returned by SDL_GetCPUDispatchFeatures() */
+#define CPU_HAS_RDTSC   0x00000001
+#define CPU_HAS_ALTIVEC 0x00000002
+#define CPU_HAS_MMX     0x00000004
+#define CPU_HAS_3DNOW   0x00000008
+#define CPU_HAS_SSE     0x00000010
+#define CPU_HAS_SSE2    0x00000020
+#define CPU_HAS_SSE3    0x00000040
+#define CPU_HAS_SSE41   0x00000100
+#define CPU_HAS_SSE42   0x00000200
+#define CPU_HAS_AVX     0x00000400
+#define CPU_HAS_AVX2    0x00000800
+#define CPU_HAS_AVX512F 0x00001000
+#define CPU_HAS_FMA     0x00002000
+#define CPU_HAS_F16C    0x00004000
+#define CPU_HAS_BMI1    0x00008000
+#define CPU_HAS_BMI2    0x00010000
+#define CPU_HAS_NEON    0x00020000
+
+/* Returns the CPU features optimized code may use, which are the features
+   of the CPU limited by SDL_HINT_CPU_FEATURE_LIMIT.
+ */
+extern Uint32 SDL_GetCPUDispatchFeatures(void);
+
+/* A kernel with several implementations lists them in a table, best
+   first, ending with a plain C version that needs no features:
+
+    static const SDL_CPUImplementation FooImpls[] = {
+        { CPU_HAS_SSE2, (SDL_CPUFunction) Foo_SSE2 },
+        { 0, (SDL_CPUFunction) Foo_C }
+    };
+
+   and calls SDL_SelectCPUImplementation() once, caching the result.
+ */
+typedef void (*SDL_CPUFunction) (void);
+
+typedef struct
+{
+    Uint32 features;            /* CPU_HAS_* bits this needs, or 0 */
+    SDL_CPUFunction func;
+} SDL_CPUImplementation;
+
+extern SDL_CPUFunction SDL_SelectCPUImplementation(const SDL_CPUImplementation * impls);
+
+#endif /* _SDL_cpuinfo_c_h */
+/* vi: set ts=4 sw=4 expandtab: */
@@ -28,6 +28,7 @@
 #include "SDL_thread.h"
 #include "SDL_events_c.h"
 #include "../timer/SDL_timer_c.h"
+#include "../stdlib/SDL_memory_c.h"
 #if !SDL_JOYSTICK_DISABLED
 #include "../joystick/SDL_joystick_c.h"
 #endif
@@ -109,7 +110,7 @@ SDL_StopEventLoop(void)
     while (SDL_event_watchers) {
         SDL_EventWatcher *tmp = SDL_event_watchers;
         SDL_event_watchers = tmp->next;
-        SDL_free(tmp);
+        SDL_FreeMemory(tmp);
     }
 }
 
@@ -412,7 +413,7 @@ SDL_AddEventWatch(SDL_EventFilter filter, void *userdata)
 {
     SDL_EventWatcher *watcher;
 
-    watcher = (SDL_EventWatcher *)SDL_malloc(sizeof(*watcher));
+    watcher = (SDL_EventWatcher *)SDL_AllocMemory(SDL_MEMORY_EVENTS, sizeof(*watcher));
     if (!watcher) {
         /* Uh oh... */
         return;
@@ -437,7 +438,7 @@ SDL_DelEventWatch(SDL_EventFilter filter, void *userdata)
             } else {
                 SDL_event_watchers = curr->next;
             }
-            SDL_free(curr);
+            SDL_FreeMemory(curr);
             break;
         }
     }
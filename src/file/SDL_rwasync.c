@@ -0,0 +1,695 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* Asynchronous reads of SDL_RWops streams
+
+   Every read is done in order by a single I/O thread, so a stream is only
+   used by one thread at a time and reads queued on the same stream finish
+   in the order they were made.  Each read seeks to its offset first, so
+   it doesn't matter where the stream was left by the one before.
+ */
+
+#include "SDL_rwops.h"
+#include "SDL_atomic.h"
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
+#include "SDL_rwasync_c.h"
+
+#define ASYNC_WINDOW_SIZE   (256 * 1024)
+#define ASYNC_BLOCKS        4
+
+struct SDL_AsyncRead
+{
+    SDL_RWops *context;
+    Uint8 *ptr;
+    Sint64 offset;
+    size_t size;
+    size_t done;                /* Bytes read */
+    SDL_AsyncReadCallback callback;
+    void *userdata;
+    SDL_bool queued;            /* Waiting for the I/O thread */
+    SDL_bool finished;
+    struct SDL_AsyncRead *next;
+};
+
+typedef struct
+{
+    SDL_SpinLock init_lock;
+    SDL_bool active;
+    SDL_bool failed;            /* Couldn't start, so reads are synchronous */
+    SDL_bool stopped;           /* Stopped by SDL_Quit(), until SDL_Init() */
+    SDL_bool quit;
+    SDL_mutex *lock;
+    SDL_cond *work;             /* Signaled when a read is queued */
+    SDL_cond *finished;         /* Broadcast when a read finishes */
+    SDL_Thread *thread;
+    SDL_AsyncRead *head;
+    SDL_AsyncRead *tail;
+    SDL_AsyncRead *current;     /* The read being done right now */
+} SDL_AsyncIOData;
+
+static SDL_AsyncIOData SDL_async_io;
+
+static void
+SDL_DoAsyncRead(SDL_AsyncRead * request)
+{
+    size_t amount;
+
+    request->done = 0;
+    if (SDL_RWseek(request->context, request->offset, RW_SEEK_SET) == request->offset) {
+        /* Streams may return less than we asked for before the end */
+        while (request->done < request->size) {
+            amount = SDL_RWread(request->context, request->ptr + request->done,
+                                1, request->size - request->done);
+            if (amount == 0) {
+                break;
+            }
+            request->done += amount;
+        }
+    }
+    if (request->callback) {
+        request->callback(request->userdata, request->ptr, request->done);
+    }
+}
+
+static int SDLCALL
+SDL_AsyncIOThread(void *unused)
+{
+    SDL_AsyncIOData *data = &SDL_async_io;
+    SDL_AsyncRead *request;
+
+    SDL_LockMutex(data->lock);
+    for ( ; ; ) {
+        while (!data->head && !data->quit) {
+            SDL_CondWait(data->work, data->lock);
+        }
+
+        /* Everything queued is read before quitting */
+        request = data->head;
+        if (!request) {
+            break;
+        }
+        data->head = request->next;
+        if (!data->head) {
+            data->tail = NULL;
+        }
+        request->queued = SDL_FALSE;
+        data->current = request;
+        SDL_UnlockMutex(data->lock);
+
+        SDL_DoAsyncRead(request);
+
+        SDL_LockMutex(data->lock);
+        data->current = NULL;
+        request->finished = SDL_TRUE;
+        SDL_CondBroadcast(data->finished);
+    }
+    SDL_UnlockMutex(data->lock);
+    return 0;
+}
+
+static int
+SDL_AsyncIOInit(void)
+{
+    SDL_AsyncIOData *data = &SDL_async_io;
+
+    if (data->active) {
+        return 0;
+    }
+
+    SDL_AtomicLock(&data->init_lock);
+    if (!data->active && !data->failed) {
+        data->lock = SDL_CreateMutex();
+        data->work = SDL_CreateCond();
+        data->finished = SDL_CreateCond();
+        data->quit = SDL_FALSE;
+        if (data->lock && data->work && data->finished) {
+            /* !!! FIXME: this is nasty. */
+#if defined(__WIN32__) && !defined(HAVE_LIBC)
+#undef SDL_CreateThread
+            data->thread = SDL_CreateThread(SDL_AsyncIOThread, "SDLAsyncIO", NULL, NULL, NULL);
+#else
+            data->thread = SDL_CreateThread(SDL_AsyncIOThread, "SDLAsyncIO", NULL);
+#endif
+        }
+        if (data->thread) {
+            data->active = SDL_TRUE;
+        } else {
+            /* No thread, so reads are done when they are made */
+            data->failed = SDL_TRUE;
+            if (data->lock) {
+                SDL_DestroyMutex(data->lock);
+                data->lock = NULL;
+            }
+            if (data->work) {
+                SDL_DestroyCond(data->work);
+                data->work = NULL;
+            }
+            if (data->finished) {
+                SDL_DestroyCond(data->finished);
+                data->finished = NULL;
+            }
+        }
+    }
+    SDL_AtomicUnlock(&data->init_lock);
+
+    return data->active ? 0 : -1;
+}
+
+void
+SDL_AsyncIOQuit(void)
+{
+    SDL_AsyncIOData *data = &SDL_async_io;
+
+    SDL_AtomicLock(&data->init_lock);
+    if (data->active) {
+        SDL_LockMutex(data->lock);
+        data->quit = SDL_TRUE;
+        SDL_CondSignal(data->work);
+        SDL_UnlockMutex(data->lock);
+        SDL_WaitThread(data->thread, NULL);
+        data->thread = NULL;
+
+        SDL_DestroyCond(data->finished);
+        data->finished = NULL;
+        SDL_DestroyCond(data->work);
+        data->work = NULL;
+        SDL_DestroyMutex(data->lock);
+        data->lock = NULL;
+        data->active = SDL_FALSE;
+    }
+    data->failed = SDL_FALSE;
+    data->stopped = SDL_TRUE;
+    SDL_AtomicUnlock(&data->init_lock);
+}
+
+void
+SDL_AsyncIOReset(void)
+{
+    SDL_AsyncIOData *data = &SDL_async_io;
+
+    SDL_AtomicLock(&data->init_lock);
+    data->stopped = SDL_FALSE;
+    SDL_AtomicUnlock(&data->init_lock);
+}
+
+/* Returns -1 if the I/O thread has been stopped, and the read won't be done */
+static int
+SDL_QueueAsyncRead(SDL_AsyncRead * request)
+{
+    SDL_AsyncIOData *data = &SDL_async_io;
+
+    request->done = 0;
+    request->finished = SDL_FALSE;
+    request->next = NULL;
+
+    if (data->stopped) {
+        /* Starting the thread again would leave nothing to stop it */
+        request->finished = SDL_TRUE;
+        SDL_SetError("Asynchronous reads aren't available after SDL_Quit()");
+        return -1;
+    }
+    if (SDL_AsyncIOInit() < 0) {
+        SDL_DoAsyncRead(request);
+        request->finished = SDL_TRUE;
+        return 0;
+    }
+
+    SDL_LockMutex(data->lock);
+    request->queued = SDL_TRUE;
+    if (data->tail) {
+        data->tail->next = request;
+    } else {
+        data->head = request;
+    }
+    data->tail = request;
+    SDL_CondSignal(data->work);
+    SDL_UnlockMutex(data->lock);
+    return 0;
+}
+
+static void
+SDL_FinishAsyncRead(SDL_AsyncRead * request)
+{
+    SDL_AsyncIOData *data = &SDL_async_io;
+
+    if (!data->active) {
+        /* Read synchronously, or everything was read by SDL_AsyncIOQuit() */
+        return;
+    }
+
+    SDL_LockMutex(data->lock);
+    while (!request->finished) {
+        SDL_CondWait(data->finished, data->lock);
+    }
+    SDL_UnlockMutex(data->lock);
+}
+
+/* Take a read off the queue if the I/O thread hasn't got to it yet,
+   otherwise wait for it to finish.
+ */
+static void
+SDL_CancelAsyncRead(SDL_AsyncRead * request)
+{
+    SDL_AsyncIOData *data = &SDL_async_io;
+    SDL_AsyncRead *prev = NULL, *node;
+
+    if (!data->active) {
+        return;
+    }
+
+    SDL_LockMutex(data->lock);
+    if (request->queued) {
+        for (node = data->head; node != request; node = node->next) {
+            prev = node;
+        }
+        if (prev) {
+            prev->next = request->next;
+        } else {
+            data->head = request->next;
+        }
+        if (data->tail == request) {
+            data->tail = prev;
+        }
+        request->queued = SDL_FALSE;
+        request->finished = SDL_TRUE;
+        request->done = 0;
+    }
+    while (!request->finished) {
+        SDL_CondWait(data->finished, data->lock);
+    }
+    SDL_UnlockMutex(data->lock);
+}
+
+/* Wait until the I/O thread is done with every read of a stream, so the
+   calling thread can use the stream itself.
+ */
+static void
+SDL_FinishAsyncReads(SDL_RWops * context)
+{
+    SDL_AsyncIOData *data = &SDL_async_io;
+    SDL_AsyncRead *node;
+    SDL_bool busy;
+
+    if (!data->active) {
+        return;
+    }
+
+    SDL_LockMutex(data->lock);
+    for ( ; ; ) {
+        busy = (data->current && data->current->context == context);
+        for (node = data->head; node && !busy; node = node->next) {
+            busy = (node->context == context);
+        }
+        if (!busy) {
+            break;
+        }
+        SDL_CondWait(data->finished, data->lock);
+    }
+    SDL_UnlockMutex(data->lock);
+}
+
+
+/* Functions to read ahead of another SDL_RWops
+
+   The window is split into blocks that follow each other in the stream,
+   starting with the block at index 'first', which holds our position.
+   As each block is used up it is queued again to read the data just past
+   the last one, so the I/O thread stays a window ahead of the reader.
+ */
+
+typedef struct
+{
+    SDL_AsyncRead request;
+    SDL_bool busy;              /* Queued or read, not yet cancelled */
+} SDL_AsyncBlock;
+
+typedef struct
+{
+    SDL_RWops *rw;
+    SDL_bool autoclose;
+    Sint64 position;
+    Sint64 size;                /* -1 if unknown */
+    Uint8 *data;
+    size_t blocksize;
+    int first;
+    SDL_bool reading;           /* SDL_TRUE if the blocks are reading ahead */
+    SDL_AsyncBlock blocks[ASYNC_BLOCKS];
+} SDL_AsyncStream;
+
+static void
+async_start(SDL_AsyncStream * stream, Sint64 offset)
+{
+    int i;
+
+    for (i = 0; i < ASYNC_BLOCKS; ++i) {
+        SDL_AsyncBlock *block = &stream->blocks[i];
+        block->request.offset = offset + (Sint64) (i * stream->blocksize);
+        block->busy = SDL_TRUE;
+        SDL_QueueAsyncRead(&block->request);
+    }
+    stream->first = 0;
+    stream->reading = SDL_TRUE;
+}
+
+/* Stop reading ahead, and wait for any SDL_RWreadAsync() of the stream,
+   so the caller can use the stream itself */
+static void
+async_stop(SDL_AsyncStream * stream)
+{
+    int i;
+
+    for (i = 0; i < ASYNC_BLOCKS; ++i) {
+        SDL_AsyncBlock *block = &stream->blocks[i];
+        if (block->busy) {
+            SDL_CancelAsyncRead(&block->request);
+            block->busy = SDL_FALSE;
+        }
+    }
+    stream->reading = SDL_FALSE;
+    SDL_FinishAsyncReads(stream->rw);
+}
+
+/* Queue the first block again, to read just past the last one */
+static void
+async_advance(SDL_AsyncStream * stream)
+{
+    SDL_AsyncBlock *block = &stream->blocks[stream->first];
+
+    block->request.offset += (Sint64) (ASYNC_BLOCKS * stream->blocksize);
+    SDL_QueueAsyncRead(&block->request);
+    stream->first = (stream->first + 1) % ASYNC_BLOCKS;
+}
+
+static Sint64 SDLCALL
+async_size(SDL_RWops * context)
+{
+    SDL_AsyncStream *stream = (SDL_AsyncStream *) context->hidden.unknown.data1;
+
+    return stream->size;
+}
+
+static Sint64 SDLCALL
+async_seek(SDL_RWops * context, Sint64 offset, int whence)
+{
+    SDL_AsyncStream *stream = (SDL_AsyncStream *) context->hidden.unknown.data1;
+    Sint64 newpos, start;
+
+    switch (whence) {
+    case RW_SEEK_SET:
+        newpos = offset;
+        break;
+    case RW_SEEK_CUR:
+        newpos = stream->position + offset;
+        break;
+    case RW_SEEK_END:
+        newpos = (stream->size >= 0) ? stream->size + offset : -1;
+        break;
+    default:
+        SDL_SetError("Unknown value for 'whence'");
+        return (-1);
+    }
+
+    if (newpos == stream->position) {
+        return newpos;
+    }
+
+    /* Seeking within the window just skips blocks */
+    if (stream->reading && stream->size >= 0 && newpos <= stream->size) {
+        start = stream->blocks[stream->first].request.offset;
+        if (newpos >= start &&
+            newpos < start + (Sint64) (ASYNC_BLOCKS * stream->blocksize)) {
+            while (newpos >= start + (Sint64) stream->blocksize) {
+                SDL_CancelAsyncRead(&stream->blocks[stream->first].request);
+                async_advance(stream);
+                start += stream->blocksize;
+            }
+            stream->position = newpos;
+            return newpos;
+        }
+    }
+
+    /* Let the stream decide where we end up */
+    async_stop(stream);
+    if (whence == RW_SEEK_END) {
+        newpos = SDL_RWseek(stream->rw, offset, RW_SEEK_END);
+    } else {
+        newpos = SDL_RWseek(stream->rw, newpos, RW_SEEK_SET);
+    }
+    if (newpos < 0) {
+        return -1;
+    }
+    stream->position = newpos;
+    async_start(stream, newpos);
+    return newpos;
+}
+
+static size_t SDLCALL
+async_read(SDL_RWops * context, void *ptr, size_t size, size_t maxnum)
+{
+    SDL_AsyncStream *stream = (SDL_AsyncStream *) context->hidden.unknown.data1;
+    Uint8 *dst = (Uint8 *) ptr;
+    size_t total = size * maxnum;
+    size_t copied = 0, amount;
+    Sint64 start, available;
+
+    if (size == 0 || maxnum == 0 || total / maxnum != size) {
+        return 0;
+    }
+    if (!stream->reading) {
+        async_start(stream, stream->position);
+    }
+
+    while (copied < total) {
+        SDL_AsyncBlock *block = &stream->blocks[stream->first];
+
+        SDL_FinishAsyncRead(&block->request);
+        start = block->request.offset;
+        available = start + (Sint64) block->request.done - stream->position;
+        if (available <= 0) {
+            if (block->request.done < stream->blocksize) {
+                /* End of the stream */
+                break;
+            }
+            async_advance(stream);
+            continue;
+        }
+
+        amount = SDL_min((size_t) available, total - copied);
+        SDL_memcpy(dst + copied,
+                   block->request.ptr + (size_t) (stream->position - start),
+                   amount);
+        copied += amount;
+        stream->position += amount;
+        if (stream->position == start + (Sint64) stream->blocksize) {
+            async_advance(stream);
+        }
+    }
+    return (copied / size);
+}
+
+static size_t SDLCALL
+async_write(SDL_RWops * context, const void *ptr, size_t size, size_t num)
+{
+    SDL_AsyncStream *stream = (SDL_AsyncStream *) context->hidden.unknown.data1;
+    size_t written;
+
+    /* Writes go straight through, and reading ahead starts over after */
+    async_stop(stream);
+    if (SDL_RWseek(stream->rw, stream->position, RW_SEEK_SET) != stream->position) {
+        return 0;
+    }
+    written = SDL_RWwrite(stream->rw, ptr, size, num);
+    if (written != (size_t) -1) {
+        stream->position += (Sint64) (written * size);
+        if (stream->size >= 0 && stream->position > stream->size) {
+            stream->size = stream->position;
+        }
+    }
+    return written;
+}
+
+static int SDLCALL
+async_close(SDL_RWops * context)
+{
+    int status = 0;
+
+    if (context) {
+        SDL_AsyncStream *stream = (SDL_AsyncStream *) context->hidden.unknown.data1;
+
+        async_stop(stream);
+        if (stream->autoclose) {
+            status = SDL_RWclose(stream->rw);
+        }
+        SDL_free(stream->data);
+        SDL_free(stream);
+        SDL_FreeRW(context);
+    }
+    return status;
+}
+
+SDL_RWops *
+SDL_RWFromAsyncRW(SDL_RWops * rw, size_t window, SDL_bool autoclose)
+{
+    SDL_RWops *rwops;
+    SDL_AsyncStream *stream;
+    int i;
+
+    if (!rw) {
+        SDL_InvalidParamError("rw");
+        return NULL;
+    }
+    if (window == 0) {
+        window = ASYNC_WINDOW_SIZE;
+    }
+    if (window < ASYNC_BLOCKS) {
+        window = ASYNC_BLOCKS;
+    }
+
+    rwops = SDL_AllocRW();
+    if (rwops == NULL) {
+        return NULL;
+    }
+    stream = (SDL_AsyncStream *) SDL_calloc(1, sizeof(*stream));
+    if (stream) {
+        stream->data = (Uint8 *) SDL_malloc(window);
+    }
+    if (!stream || !stream->data) {
+        if (stream) {
+            SDL_free(stream);
+        }
+        SDL_FreeRW(rwops);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    /* Nobody else may use the stream from now on, so its size and our
+       position can be tracked here.
+     */
+    stream->rw = rw;
+    stream->autoclose = autoclose;
+    stream->size = SDL_RWsize(rw);
+    stream->position = SDL_RWtell(rw);
+    if (stream->position < 0) {
+        stream->position = 0;
+    }
+    stream->blocksize = window / ASYNC_BLOCKS;
+    for (i = 0; i < ASYNC_BLOCKS; ++i) {
+        SDL_AsyncRead *request = &stream->blocks[i].request;
+        request->context = rw;
+        request->ptr = stream->data + i * stream->blocksize;
+        request->size = stream->blocksize;
+    }
+
+    rwops->size = async_size;
+    rwops->seek = async_seek;
+    rwops->read = async_read;
+    rwops->write = async_write;
+    rwops->close = async_close;
+    rwops->type = SDL_RWOPS_ASYNC;
+    rwops->hidden.unknown.data1 = stream;
+
+    /* Get going right away, so the data may be ready by the first read */
+    async_start(stream, stream->position);
+    return rwops;
+}
+
+
+/* Explicit asynchronous reads */
+
+SDL_AsyncRead *
+SDL_RWreadAsync(SDL_RWops * context, void *ptr, Sint64 offset, size_t size,
+                SDL_AsyncReadCallback callback, void *userdata)
+{
+    SDL_AsyncRead *request;
+
+    if (!context) {
+        SDL_InvalidParamError("context");
+        return NULL;
+    }
+    if (!ptr && size > 0) {
+        SDL_InvalidParamError("ptr");
+        return NULL;
+    }
+    if (offset < 0) {
+        SDL_InvalidParamError("offset");
+        return NULL;
+    }
+
+    /* The I/O thread already owns the stream under a read-ahead one, and
+       waiting on its own read-ahead would deadlock.
+     */
+    if (context->close == async_close) {
+        context = ((SDL_AsyncStream *) context->hidden.unknown.data1)->rw;
+    }
+
+    request = (SDL_AsyncRead *) SDL_calloc(1, sizeof(*request));
+    if (!request) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    request->context = context;
+    request->ptr = (Uint8 *) ptr;
+    request->offset = offset;
+    request->size = size;
+    request->callback = callback;
+    request->userdata = userdata;
+    if (SDL_QueueAsyncRead(request) < 0) {
+        SDL_free(request);
+        return NULL;
+    }
+    return request;
+}
+
+SDL_bool
+SDL_PollAsyncRead(SDL_AsyncRead * request)
+{
+    SDL_AsyncIOData *data = &SDL_async_io;
+    SDL_bool finished;
+
+    if (!request) {
+        return SDL_FALSE;
+    }
+    if (!data->active) {
+        return SDL_TRUE;
+    }
+    SDL_LockMutex(data->lock);
+    finished = request->finished;
+    SDL_UnlockMutex(data->lock);
+    return finished;
+}
+
+size_t
+SDL_WaitAsyncRead(SDL_AsyncRead * request)
+{
+    size_t done;
+
+    if (!request) {
+        return 0;
+    }
+    SDL_FinishAsyncRead(request);
+    done = request->done;
+    SDL_free(request);
+    return done;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
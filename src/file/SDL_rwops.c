@@ -28,6 +28,12 @@
 
 #include "SDL_endian.h"
 #include "SDL_rwops.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_hints.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #ifdef __APPLE__
 #include "cocoa/SDL_rwopsbundlesupport.h"
@@ -37,6 +43,14 @@
 #include "../core/android/SDL_android.h"
 #endif
 
+#if defined(HAVE_MMAP) && defined(HAVE_STDIO_H) && !defined(__WIN32__) && !defined(ANDROID)
+#define SDL_RWOPS_MMAP
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #ifdef __NDS__
 /* include libfat headers for fatInitDefault(). */
 #include <fat.h>
@@ -463,6 +477,314 @@ mem_close(SDL_RWops * context)
     return (0);
 }
 
+#ifdef SDL_RWOPS_MMAP
+
+/* Functions to read memory mapped files
+
+   A mapped file is read through the memory functions above, so it only
+   needs its own way of being created and closed.
+ */
+
+static int SDLCALL
+mapped_close(SDL_RWops * context)
+{
+    if (context) {
+        munmap(context->hidden.mem.base,
+               context->hidden.mem.stop - context->hidden.mem.base);
+        SDL_FreeRW(context);
+    }
+    return (0);
+}
+
+/* Map the regular file fp is open on if the application asked for it,
+   or return NULL to use stdio */
+static SDL_RWops *
+mapped_open(FILE * fp)
+{
+    SDL_RWops *rwops;
+    struct stat st;
+    void *base;
+    const char *hint;
+
+    /* Mapped files don't see changes to their size, and reading past a
+       truncated end raises SIGBUS, so this is opt-in */
+    hint = SDL_GetHint(SDL_HINT_FILE_MMAP);
+    if (!hint || *hint != '1') {
+        return NULL;
+    }
+
+    /* Empty files can't be mapped, and devices and pipes aren't files */
+    if (fstat(fileno(fp), &st) < 0 || !S_ISREG(st.st_mode) ||
+        st.st_size <= 0 || (Uint64) st.st_size > (Uint64) (~(size_t) 0 >> 1)) {
+        return NULL;
+    }
+
+    base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE,
+                fileno(fp), 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+#ifdef HAVE_MADVISE
+    /* Most files are read from start to finish */
+    madvise(base, (size_t) st.st_size, MADV_SEQUENTIAL);
+#endif
+
+    rwops = SDL_AllocRW();
+    if (rwops == NULL) {
+        munmap(base, (size_t) st.st_size);
+        return NULL;
+    }
+    rwops->size = mem_size;
+    rwops->seek = mem_seek;
+    rwops->read = mem_read;
+    rwops->write = mem_writeconst;
+    rwops->close = mapped_close;
+    rwops->type = SDL_RWOPS_MAPPED;
+    rwops->hidden.mem.base = (Uint8 *) base;
+    rwops->hidden.mem.here = rwops->hidden.mem.base;
+    rwops->hidden.mem.stop = rwops->hidden.mem.base + st.st_size;
+
+    /* The mapping stays valid without the file */
+    fclose(fp);
+    return rwops;
+}
+
+#endif /* SDL_RWOPS_MMAP */
+
+/* Functions to buffer another SDL_RWops
+
+   The buffer either holds data read ahead from the stream, with the
+   stream positioned just after it, or data waiting to be written, with
+   the stream positioned at its start. Either way our position is
+   offset + pos.
+ */
+
+#define RWOPS_BUFFER_SIZE   (64 * 1024)
+
+typedef struct
+{
+    SDL_RWops *rw;
+    SDL_bool autoclose;
+    Uint8 *data;
+    size_t size;                /* Capacity of data */
+    size_t fill;                /* Bytes of read-ahead or unwritten data */
+    size_t pos;                 /* Read position within data */
+    Sint64 offset;              /* Stream position of data[0] */
+    SDL_bool dirty;             /* SDL_TRUE if data hasn't been written */
+} SDL_BufferedStream;
+
+static int
+buffered_flush(SDL_RWops * context)
+{
+    SDL_BufferedStream *stream = (SDL_BufferedStream *) context->hidden.unknown.data1;
+    size_t fill = stream->fill;
+    size_t written;
+
+    if (!stream->dirty) {
+        return 0;
+    }
+
+    written = SDL_RWwrite(stream->rw,
+                          stream->data, 1, fill);
+    if (written > fill) {
+        /* Read-only memory returns -1 */
+        written = 0;
+    }
+    stream->offset += written;
+    stream->fill = 0;
+    stream->pos = 0;
+    stream->dirty = SDL_FALSE;
+    if (written != fill) {
+        SDL_Error(SDL_EFWRITE);
+        return -1;
+    }
+    return 0;
+}
+
+static Sint64 SDLCALL
+buffered_size(SDL_RWops * context)
+{
+    SDL_BufferedStream *stream = (SDL_BufferedStream *) context->hidden.unknown.data1;
+    if (buffered_flush(context) < 0) {
+        return -1;
+    }
+    return SDL_RWsize(stream->rw);
+}
+
+static Sint64 SDLCALL
+buffered_seek(SDL_RWops * context, Sint64 offset, int whence)
+{
+    SDL_BufferedStream *stream = (SDL_BufferedStream *) context->hidden.unknown.data1;
+    Sint64 here = stream->offset + stream->pos;
+    Sint64 newpos;
+
+    switch (whence) {
+    case RW_SEEK_SET:
+        newpos = offset;
+        break;
+    case RW_SEEK_CUR:
+        newpos = here + offset;
+        break;
+    case RW_SEEK_END:
+        newpos = -1;
+        break;
+    default:
+        SDL_SetError("Unknown value for 'whence'");
+        return (-1);
+    }
+
+    if (newpos == here) {
+        return here;
+    }
+
+    /* Seeking around in data we've read ahead is free */
+    if (whence != RW_SEEK_END && !stream->dirty &&
+        newpos >= stream->offset &&
+        newpos <= stream->offset +
+                  (Sint64) stream->fill) {
+        stream->pos =
+            (size_t) (newpos - stream->offset);
+        return newpos;
+    }
+
+    if (buffered_flush(context) < 0) {
+        return -1;
+    }
+    if (whence == RW_SEEK_END) {
+        newpos = SDL_RWseek(stream->rw, offset, RW_SEEK_END);
+    } else {
+        newpos = SDL_RWseek(stream->rw, newpos, RW_SEEK_SET);
+    }
+    stream->fill = 0;
+    stream->pos = 0;
+    if (newpos < 0) {
+        /* Put the stream back where we were, the read-ahead is gone */
+        SDL_RWseek(stream->rw, here, RW_SEEK_SET);
+        stream->offset = here;
+        return -1;
+    }
+    stream->offset = newpos;
+    return newpos;
+}
+
+static size_t SDLCALL
+buffered_read(SDL_RWops * context, void *ptr, size_t size, size_t maxnum)
+{
+    SDL_BufferedStream *stream = (SDL_BufferedStream *) context->hidden.unknown.data1;
+    Uint8 *dst = (Uint8 *) ptr;
+    size_t total_bytes, copied = 0, n;
+
+    total_bytes = (maxnum * size);
+    if ((maxnum <= 0) || (size <= 0)
+        || ((total_bytes / maxnum) != (size_t) size)) {
+        return 0;
+    }
+
+    if (buffered_flush(context) < 0) {
+        return 0;
+    }
+
+    while (copied < total_bytes) {
+        n = stream->fill - stream->pos;
+        if (n > 0) {
+            n = SDL_min(n, total_bytes - copied);
+            SDL_memcpy(&dst[copied],
+                       &stream->data[stream->pos], n);
+            stream->pos += n;
+            copied += n;
+            continue;
+        }
+
+        stream->offset += stream->fill;
+        stream->fill = 0;
+        stream->pos = 0;
+
+        if (total_bytes - copied >= stream->size) {
+            /* Big reads go straight into the caller's memory */
+            n = SDL_RWread(stream->rw, &dst[copied], 1,
+                           total_bytes - copied);
+            stream->offset += n;
+            copied += n;
+        } else {
+            n = SDL_RWread(stream->rw,
+                           stream->data, 1,
+                           stream->size);
+            stream->fill = n;
+        }
+        if (n == 0) {
+            break;
+        }
+    }
+    return (copied / size);
+}
+
+static size_t SDLCALL
+buffered_write(SDL_RWops * context, const void *ptr, size_t size, size_t num)
+{
+    SDL_BufferedStream *stream = (SDL_BufferedStream *) context->hidden.unknown.data1;
+    size_t total_bytes, written;
+
+    total_bytes = (num * size);
+    if ((num <= 0) || (size <= 0) || ((total_bytes / num) != (size_t) size)) {
+        return 0;
+    }
+
+    if (!stream->dirty && stream->fill > 0) {
+        /* Drop the read-ahead, moving the stream back to where we are */
+        Sint64 here = stream->offset + stream->pos;
+        if (stream->pos != stream->fill &&
+            SDL_RWseek(stream->rw, here, RW_SEEK_SET) != here) {
+            return 0;
+        }
+        stream->offset = here;
+        stream->fill = 0;
+        stream->pos = 0;
+    }
+
+    if (stream->fill + total_bytes > stream->size) {
+        if (buffered_flush(context) < 0) {
+            return 0;
+        }
+    }
+
+    if (total_bytes >= stream->size) {
+        /* Big writes go straight to the stream */
+        written = SDL_RWwrite(stream->rw, ptr, 1, total_bytes);
+        if (written > total_bytes) {
+            written = 0;
+        }
+        stream->offset += written;
+        return (written / size);
+    }
+
+    SDL_memcpy(&stream->data[stream->fill],
+               ptr, total_bytes);
+    stream->fill += total_bytes;
+    stream->pos = stream->fill;
+    stream->dirty = SDL_TRUE;
+    return num;
+}
+
+static int SDLCALL
+buffered_close(SDL_RWops * context)
+{
+    int status = 0;
+    if (context) {
+        SDL_BufferedStream *stream = (SDL_BufferedStream *) context->hidden.unknown.data1;
+        if (buffered_flush(context) < 0) {
+            status = -1;
+        }
+        if (stream->autoclose) {
+            if (SDL_RWclose(stream->rw) < 0) {
+                status = -1;
+            }
+        }
+        SDL_free(stream);
+        SDL_FreeRW(context);
+    }
+    return status;
+}
+
 
 /* Functions to create SDL_RWops structures from various data sources */
 
@@ -513,6 +835,7 @@ SDL_RWFromFile(const char *file, const char *mode)
     rwops->read = Android_JNI_FileRead;
     rwops->write = Android_JNI_FileWrite;
     rwops->close = Android_JNI_FileClose;
+    rwops->type = SDL_RWOPS_JNIFILE;
 
 #elif defined(__WIN32__)
     rwops = SDL_AllocRW();
@@ -527,6 +850,7 @@ SDL_RWFromFile(const char *file, const char *mode)
     rwops->read = windows_file_read;
     rwops->write = windows_file_write;
     rwops->close = windows_file_close;
+    rwops->type = SDL_RWOPS_WINFILE;
 
 #elif HAVE_STDIO_H
     {
@@ -538,6 +862,13 @@ SDL_RWFromFile(const char *file, const char *mode)
     	if (fp == NULL) {
             SDL_SetError("Couldn't open %s", file);
         } else {
+#ifdef SDL_RWOPS_MMAP
+            /* Files that are only read can be mapped instead */
+            if (SDL_strcmp(mode, "r") == 0 || SDL_strcmp(mode, "rb") == 0) {
+                rwops = mapped_open(fp);
+            }
+            if (!rwops)
+#endif
             rwops = SDL_RWFromFP(fp, 1);
         }
     }
@@ -568,6 +899,7 @@ SDL_RWFromFP(FILE * fp, SDL_bool autoclose)
         rwops->read = stdio_read;
         rwops->write = stdio_write;
         rwops->close = stdio_close;
+        rwops->type = SDL_RWOPS_STDFILE;
         rwops->hidden.stdio.fp = fp;
         rwops->hidden.stdio.autoclose = autoclose;
     }
@@ -594,6 +926,7 @@ SDL_RWFromMem(void *mem, int size)
         rwops->read = mem_read;
         rwops->write = mem_write;
         rwops->close = mem_close;
+        rwops->type = SDL_RWOPS_MEMORY;
         rwops->hidden.mem.base = (Uint8 *) mem;
         rwops->hidden.mem.here = rwops->hidden.mem.base;
         rwops->hidden.mem.stop = rwops->hidden.mem.base + size;
@@ -613,6 +946,7 @@ SDL_RWFromConstMem(const void *mem, int size)
         rwops->read = mem_read;
         rwops->write = mem_writeconst;
         rwops->close = mem_close;
+        rwops->type = SDL_RWOPS_MEMORY_RO;
         rwops->hidden.mem.base = (Uint8 *) mem;
         rwops->hidden.mem.here = rwops->hidden.mem.base;
         rwops->hidden.mem.stop = rwops->hidden.mem.base + size;
@@ -620,6 +954,56 @@ SDL_RWFromConstMem(const void *mem, int size)
     return (rwops);
 }
 
+SDL_RWops *
+SDL_RWFromBufferedRW(SDL_RWops * rw, size_t buffersize, SDL_bool autoclose)
+{
+    SDL_BufferedStream *stream;
+    SDL_RWops *rwops;
+    Sint64 offset;
+
+    if (!rw) {
+        SDL_InvalidParamError("rw");
+        return NULL;
+    }
+    if (buffersize == 0) {
+        buffersize = RWOPS_BUFFER_SIZE;
+    }
+
+    /* The buffer follows the stream state in the same allocation */
+    stream = (SDL_BufferedStream *) SDL_malloc(sizeof(*stream) + buffersize);
+    if (!stream) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    rwops = SDL_AllocRW();
+    if (rwops != NULL) {
+        /* Streams that can't tell where they are start counting at zero */
+        offset = SDL_RWtell(rw);
+        if (offset < 0) {
+            offset = 0;
+        }
+        stream->rw = rw;
+        stream->autoclose = autoclose;
+        stream->data = (Uint8 *) (stream + 1);
+        stream->size = buffersize;
+        stream->fill = 0;
+        stream->pos = 0;
+        stream->offset = offset;
+        stream->dirty = SDL_FALSE;
+
+        rwops->size = buffered_size;
+        rwops->seek = buffered_seek;
+        rwops->read = buffered_read;
+        rwops->write = buffered_write;
+        rwops->close = buffered_close;
+        rwops->type = SDL_RWOPS_BUFFERED;
+        rwops->hidden.unknown.data1 = stream;
+    } else {
+        SDL_free(stream);
+    }
+    return (rwops);
+}
+
 SDL_RWops *
 SDL_AllocRW(void)
 {
@@ -628,6 +1012,8 @@ SDL_AllocRW(void)
     area = (SDL_RWops *) SDL_malloc(sizeof *area);
     if (area == NULL) {
         SDL_OutOfMemory();
+    } else {
+        area->type = SDL_RWOPS_UNKNOWN;
     }
     return (area);
 }
@@ -638,6 +1024,37 @@ SDL_FreeRW(SDL_RWops * area)
     SDL_free(area);
 }
 
+const void *
+SDL_RWGetPointer(SDL_RWops * context, Sint64 offset, size_t size)
+{
+    Uint8 *data;
+
+    /* Applications may fill in their own SDL_RWops without setting the
+       type, so recognize memory streams by how they're read.
+     */
+    if (!context || context->read != mem_read) {
+        return NULL;
+    }
+    if (offset < 0 || offset > mem_size(context) ||
+        (Uint64) size > (Uint64) (mem_size(context) - offset)) {
+        return NULL;
+    }
+    data = context->hidden.mem.base + offset;
+
+#if defined(SDL_RWOPS_MMAP) && defined(HAVE_MADVISE)
+    /* Start reading the range in before it's touched */
+    if (context->close == mapped_close && size > 0) {
+        long pagesize = sysconf(_SC_PAGESIZE);
+        if (pagesize > 0) {
+            Uint8 *start = context->hidden.mem.base +
+                ((data - context->hidden.mem.base) & ~(pagesize - 1));
+            madvise(start, (data + size) - start, MADV_WILLNEED);
+        }
+    }
+#endif
+    return data;
+}
+
 /* Functions for dynamically reading and writing endian-specific values */
 
 Uint8
@@ -703,6 +1120,140 @@ SDL_ReadBE64(SDL_RWops * src)
     return (SDL_SwapBE64(value));
 }
 
+/* Byte swap arrays of values in place */
+
+static void
+SDL_SwapArray16(Uint16 * values, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *) &values[i]);
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i *) &values[i], v);
+    }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; i + 8 <= count; i += 8) {
+        uint8x16_t v = vreinterpretq_u8_u16(vld1q_u16(&values[i]));
+        vst1q_u16(&values[i], vreinterpretq_u16_u8(vrev16q_u8(v)));
+    }
+#endif
+    for (; i < count; ++i) {
+        values[i] = SDL_Swap16(values[i]);
+    }
+}
+
+static void
+SDL_SwapArray32(Uint32 * values, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *) &values[i]);
+        /* Swap the bytes of each half, then the halves */
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128((__m128i *) &values[i], v);
+    }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t v = vreinterpretq_u8_u32(vld1q_u32(&values[i]));
+        vst1q_u32(&values[i], vreinterpretq_u32_u8(vrev32q_u8(v)));
+    }
+#endif
+    for (; i < count; ++i) {
+        values[i] = SDL_Swap32(values[i]);
+    }
+}
+
+static void
+SDL_SwapArray64(Uint64 * values, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 2 <= count; i += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i *) &values[i]);
+        /* Swap the bytes of each quarter, then reverse the quarters */
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        _mm_storeu_si128((__m128i *) &values[i], v);
+    }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; i + 2 <= count; i += 2) {
+        uint8x16_t v = vreinterpretq_u8_u64(vld1q_u64(&values[i]));
+        vst1q_u64(&values[i], vreinterpretq_u64_u8(vrev64q_u8(v)));
+    }
+#endif
+    for (; i < count; ++i) {
+        values[i] = SDL_Swap64(values[i]);
+    }
+}
+
+size_t
+SDL_ReadLE16Array(SDL_RWops * src, Uint16 * values, size_t count)
+{
+    count = SDL_RWread(src, values, sizeof(*values), count);
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    SDL_SwapArray16(values, count);
+#endif
+    return count;
+}
+
+size_t
+SDL_ReadBE16Array(SDL_RWops * src, Uint16 * values, size_t count)
+{
+    count = SDL_RWread(src, values, sizeof(*values), count);
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    SDL_SwapArray16(values, count);
+#endif
+    return count;
+}
+
+size_t
+SDL_ReadLE32Array(SDL_RWops * src, Uint32 * values, size_t count)
+{
+    count = SDL_RWread(src, values, sizeof(*values), count);
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    SDL_SwapArray32(values, count);
+#endif
+    return count;
+}
+
+size_t
+SDL_ReadBE32Array(SDL_RWops * src, Uint32 * values, size_t count)
+{
+    count = SDL_RWread(src, values, sizeof(*values), count);
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    SDL_SwapArray32(values, count);
+#endif
+    return count;
+}
+
+size_t
+SDL_ReadLE64Array(SDL_RWops * src, Uint64 * values, size_t count)
+{
+    count = SDL_RWread(src, values, sizeof(*values), count);
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    SDL_SwapArray64(values, count);
+#endif
+    return count;
+}
+
+size_t
+SDL_ReadBE64Array(SDL_RWops * src, Uint64 * values, size_t count)
+{
+    count = SDL_RWread(src, values, sizeof(*values), count);
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    SDL_SwapArray64(values, count);
+#endif
+    return count;
+}
+
 size_t
 SDL_WriteU8(SDL_RWops * dst, Uint8 value)
 {
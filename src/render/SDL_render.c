@@ -27,6 +27,8 @@
 #include "SDL_render.h"
 #include "SDL_sysrender.h"
 #include "software/SDL_render_sw_c.h"
+#include "../video/SDL_pixels_c.h"
+#include "../stdlib/SDL_memory_c.h"
 
 
 #define SDL_WINDOWRENDERDATA    "_SDL_WindowRenderData"
@@ -436,13 +438,17 @@ SDL_CreateTexture(SDL_Renderer * renderer, Uint32 format, int access, int w, int
                 return NULL;
             }
         } else if (access == SDL_TEXTUREACCESS_STREAMING) {
-            /* The pitch is 4 byte aligned */
-            texture->pitch = (((w * SDL_BYTESPERPIXEL(format)) + 3) & ~3);
-            texture->pixels = SDL_calloc(1, texture->pitch * h);
+            /* The pitch is aligned like surfaces, at least 4 bytes */
+            const int alignment = SDL_GetSurfaceAlignment();
+
+            texture->pitch = (w * SDL_BYTESPERPIXEL(format) + alignment - 1) & ~(alignment - 1);
+            texture->pixels = SDL_AllocAlignedMemory(SDL_MEMORY_RENDER, alignment,
+                                                     (size_t) texture->pitch * h);
             if (!texture->pixels) {
                 SDL_DestroyTexture(texture);
                 return NULL;
             }
+            SDL_memset(texture->pixels, 0, (size_t) texture->pitch * h);
         }
     }
     return texture;
@@ -1689,7 +1695,7 @@ SDL_DestroyTexture(SDL_Texture * texture)
         SDL_SW_DestroyYUVTexture(texture->yuv);
     }
     if (texture->pixels) {
-        SDL_free(texture->pixels);
+        SDL_FreeMemory(texture->pixels);
     }
 
     renderer->DestroyTexture(renderer, texture);
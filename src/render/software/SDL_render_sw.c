@@ -545,7 +545,8 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
     SDL_Rect final_rect, tmp_rect;
     SDL_Surface *surface_rotated, *surface_scaled;
     Uint32 colorkey;
-    int retval, dstwidth, dstheight, abscenterx, abscentery;
+    int retval = -1;
+    int dstwidth, dstheight, abscenterx, abscentery;
     double cangle, sangle, px, py, p1x, p1y, p2x, p2y, p3x, p3y, p4x, p4y;
 
     if (!surface) {
@@ -562,12 +563,16 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
     final_rect.w = (int)dstrect->w;
     final_rect.h = (int)dstrect->h;
 
-    surface_scaled = SDL_CreateRGBSurface(SDL_SWSURFACE, final_rect.w, final_rect.h, src->format->BitsPerPixel,
-                                          src->format->Rmask, src->format->Gmask,
-                                          src->format->Bmask, src->format->Amask );
+    /* These scratch surfaces come from the surface pool, so spinning
+       sprites don't allocate memory every frame.
+     */
+    surface_scaled = SDL_AcquirePooledSurface(final_rect.w, final_rect.h, src->format->format);
     if (surface_scaled) {
-        SDL_GetColorKey(src, &colorkey);
-        SDL_SetColorKey(surface_scaled, SDL_TRUE, colorkey);
+        /* The scaled copy is blended onto transparent black */
+        SDL_memset(surface_scaled->pixels, 0, surface_scaled->h * surface_scaled->pitch);
+        if (SDL_GetColorKey(src, &colorkey) == 0) {
+            SDL_SetColorKey(surface_scaled, SDL_TRUE, colorkey);
+        }
         tmp_rect = final_rect;
         tmp_rect.x = 0;
         tmp_rect.y = 0;
@@ -613,15 +618,15 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
                 tmp_rect.h = dstheight;
 
                 retval = SDL_BlitSurface(surface_rotated, NULL, surface, &tmp_rect);
-                SDL_FreeSurface(surface_scaled);
-                SDL_FreeSurface(surface_rotated);
-                return retval;
+                SDL_ReleasePooledSurface(surface_rotated);
+            } else {
+                retval = -1;
             }
         }
-        return retval;
+        SDL_ReleasePooledSurface(surface_scaled);
     }
 
-    return -1;
+    return retval;
 }
 
 static int
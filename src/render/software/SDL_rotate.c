@@ -357,9 +357,8 @@ SDL_Surface *_rotateSurface(SDL_Surface * src, double angle, int centerx, int ce
     if (src == NULL)
         return (NULL);
 
-    if (src->flags & SDL_TRUE/*SDL_SRCCOLORKEY*/)
+    if (SDL_GetColorKey(src, &colorkey) == 0)
     {
-        colorkey = _colorkey(src);
         SDL_GetRGB(colorkey, src->format, &r, &g, &b);
         colorKeyAvailable = 1;
     }
@@ -377,14 +376,16 @@ SDL_Surface *_rotateSurface(SDL_Surface * src, double angle, int centerx, int ce
         /*
         * New source surface is 32bit with a defined RGBA ordering
         */
-        rz_src =
-            SDL_CreateRGBSurface(SDL_SWSURFACE, src->w, src->h, 32,
+        rz_src = SDL_AcquirePooledSurface(src->w, src->h,
 #if SDL_BYTEORDER == SDL_LIL_ENDIAN
-            0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000
+            SDL_PIXELFORMAT_ABGR8888
 #else
-            0xff000000,  0x00ff0000, 0x0000ff00, 0x000000ff
+            SDL_PIXELFORMAT_RGBA8888
 #endif
             );
+        if (rz_src == NULL)
+            return NULL;
+        SDL_memset(rz_src->pixels, 0, rz_src->h * rz_src->pitch);
         if(colorKeyAvailable)
             SDL_SetColorKey(src, 0, 0);
 
@@ -414,20 +415,20 @@ SDL_Surface *_rotateSurface(SDL_Surface * src, double angle, int centerx, int ce
         /*
         * Target surface is 32bit with source RGBA/ABGR ordering
         */
-        rz_dst =
-            SDL_CreateRGBSurface(SDL_SWSURFACE, dstwidth, dstheight + GUARD_ROWS, 32,
-            rz_src->format->Rmask, rz_src->format->Gmask,
-            rz_src->format->Bmask, rz_src->format->Amask);
+        rz_dst = SDL_AcquirePooledSurface(dstwidth, dstheight + GUARD_ROWS, rz_src->format->format);
     } else {
         /*
         * Target surface is 8bit
         */
-        rz_dst = SDL_CreateRGBSurface(SDL_SWSURFACE, dstwidth, dstheight + GUARD_ROWS, 8, 0, 0, 0, 0);
+        rz_dst = SDL_AcquirePooledSurface(dstwidth, dstheight + GUARD_ROWS, SDL_PIXELFORMAT_INDEX8);
     }
 
     /* Check target */
-    if (rz_dst == NULL)
+    if (rz_dst == NULL) {
+        if (src_converted)
+            SDL_FreeSurface(rz_src);
         return NULL;
+    }
 
     /* Adjust for guard rows */
     rz_dst->h = dstheight;
@@ -436,6 +437,9 @@ SDL_Surface *_rotateSurface(SDL_Surface * src, double angle, int centerx, int ce
         colorkey = SDL_MapRGB(rz_dst->format, r, g, b);
 
         SDL_FillRect(rz_dst, NULL, colorkey );
+    } else if (is32bit) {
+        /* Pooled surfaces aren't cleared, and not every pixel is written */
+        SDL_memset(rz_dst->pixels, 0, (dstheight + GUARD_ROWS) * rz_dst->pitch);
     }
 
     /*
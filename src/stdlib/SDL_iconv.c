@@ -24,6 +24,547 @@
 
 #include "SDL_stdinc.h"
 #include "SDL_endian.h"
+#include "SDL_cpuinfo.h"
+
+/* Direct converters between UTF-8 and host order UTF-16 and UTF-32.
+
+   These only handle well-formed text, copying runs of ASCII in bulk, and
+   stop at anything else so the general converter can deal with malformed
+   input, byte swapping and the other encodings.
+ */
+enum
+{
+    DIRECT_NONE,
+    DIRECT_UTF8,
+    DIRECT_UTF16,
+    DIRECT_UTF32
+};
+
+static const size_t direct_unit_size[] = { 0, 1, 2, 4 };
+
+static SDL_bool
+SDL_IsDirectAligned(int format, const void *ptr)
+{
+    return ((size_t) ptr & (direct_unit_size[format] - 1)) == 0;
+}
+
+/* Return the number of ASCII bytes at the start of src */
+static size_t
+SDL_ScanASCII(const Uint8 * src, size_t srclen)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    while (i + 16 <= srclen &&
+           !_mm_movemask_epi8(_mm_loadu_si128((const __m128i *) &src[i]))) {
+        i += 16;
+    }
+#else
+    Uint32 block[2];
+
+    while (i + 8 <= srclen) {
+        SDL_memcpy(block, &src[i], sizeof(block));
+        if ((block[0] | block[1]) & 0x80808080) {
+            break;
+        }
+        i += 8;
+    }
+#endif
+    while (i < srclen && src[i] < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+#ifdef __SSE2__
+static SDL_bool
+SDL_IsZero128(__m128i value)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_setzero_si128())) == 0xFFFF;
+}
+#endif
+
+/* Copy the run of ASCII characters at the start of src, returning the
+   number of characters copied.
+ */
+static size_t
+SDL_CopyASCII(int src_fmt, int dst_fmt, const Uint8 * src, size_t srclen,
+              Uint8 * dst, size_t dstlen)
+{
+    size_t i = 0, n;
+
+    if (src_fmt == DIRECT_UTF8) {
+        n = dstlen / direct_unit_size[dst_fmt];
+        n = SDL_ScanASCII(src, SDL_min(srclen, n));
+        if (dst_fmt == DIRECT_UTF8) {
+            SDL_memcpy(dst, src, n);
+        } else if (dst_fmt == DIRECT_UTF16) {
+            Uint16 *p = (Uint16 *) dst;
+#ifdef __SSE2__
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= n; i += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i *) &src[i]);
+                _mm_storeu_si128((__m128i *) &p[i], _mm_unpacklo_epi8(v, zero));
+                _mm_storeu_si128((__m128i *) &p[i + 8], _mm_unpackhi_epi8(v, zero));
+            }
+#endif
+            for (; i < n; ++i) {
+                p[i] = src[i];
+            }
+        } else {
+            Uint32 *p = (Uint32 *) dst;
+#ifdef __SSE2__
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= n; i += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i *) &src[i]);
+                __m128i lo = _mm_unpacklo_epi8(v, zero);
+                __m128i hi = _mm_unpackhi_epi8(v, zero);
+                _mm_storeu_si128((__m128i *) &p[i], _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128((__m128i *) &p[i + 4], _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128((__m128i *) &p[i + 8], _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128((__m128i *) &p[i + 12], _mm_unpackhi_epi16(hi, zero));
+            }
+#endif
+            for (; i < n; ++i) {
+                p[i] = src[i];
+            }
+        }
+        return n;
+    }
+
+    if (dst_fmt != DIRECT_UTF8) {
+        /* Wide to wide conversions go a character at a time */
+        return 0;
+    }
+
+    n = SDL_min(srclen / direct_unit_size[src_fmt], dstlen);
+    if (src_fmt == DIRECT_UTF16) {
+        const Uint16 *p = (const Uint16 *) src;
+#ifdef __SSE2__
+        const __m128i mask = _mm_set1_epi16((short) 0xFF80);
+        for (; i + 16 <= n; i += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i *) &p[i]);
+            __m128i b = _mm_loadu_si128((const __m128i *) &p[i + 8]);
+            if (!SDL_IsZero128(_mm_and_si128(_mm_or_si128(a, b), mask))) {
+                break;
+            }
+            _mm_storeu_si128((__m128i *) &dst[i], _mm_packus_epi16(a, b));
+        }
+#endif
+        for (; i < n && p[i] < 0x80; ++i) {
+            dst[i] = (Uint8) p[i];
+        }
+    } else {
+        const Uint32 *p = (const Uint32 *) src;
+#ifdef __SSE2__
+        const __m128i mask = _mm_set1_epi32((int) 0xFFFFFF80);
+        for (; i + 16 <= n; i += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i *) &p[i]);
+            __m128i b = _mm_loadu_si128((const __m128i *) &p[i + 4]);
+            __m128i c = _mm_loadu_si128((const __m128i *) &p[i + 8]);
+            __m128i d = _mm_loadu_si128((const __m128i *) &p[i + 12]);
+            __m128i any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+            if (!SDL_IsZero128(_mm_and_si128(any, mask))) {
+                break;
+            }
+            _mm_storeu_si128((__m128i *) &dst[i],
+                             _mm_packus_epi16(_mm_packs_epi32(a, b),
+                                              _mm_packs_epi32(c, d)));
+        }
+#endif
+        for (; i < n && p[i] < 0x80; ++i) {
+            dst[i] = (Uint8) p[i];
+        }
+    }
+    return i;
+}
+
+/* Decode one well-formed character, returning the number of bytes used,
+   or 0 if the input is malformed or incomplete.
+ */
+static __inline__ size_t
+SDL_DecodeDirect(int src_fmt, const Uint8 * src, size_t srclen, Uint32 * ch)
+{
+    Uint32 c;
+
+    switch (src_fmt) {
+    case DIRECT_UTF8:          /* RFC 3629 */
+        c = src[0];
+        if (c < 0x80) {
+            *ch = c;
+            return 1;
+        }
+        if (c < 0xC2) {
+            /* Continuation byte or overlong two byte sequence */
+            return 0;
+        }
+        if (c < 0xE0) {
+            if (srclen < 2 || (src[1] & 0xC0) != 0x80) {
+                return 0;
+            }
+            *ch = ((c & 0x1F) << 6) | (src[1] & 0x3F);
+            return 2;
+        }
+        if (c < 0xF0) {
+            if (srclen < 3 ||
+                (src[1] & 0xC0) != 0x80 || (src[2] & 0xC0) != 0x80) {
+                return 0;
+            }
+            c = ((c & 0x0F) << 12) | ((src[1] & 0x3F) << 6) | (src[2] & 0x3F);
+            /* The general converter replaces U+FFFE and U+FFFF */
+            if (c < 0x800 || (c >= 0xD800 && c <= 0xDFFF) || c >= 0xFFFE) {
+                return 0;
+            }
+            *ch = c;
+            return 3;
+        }
+        if (c < 0xF5) {
+            if (srclen < 4 || (src[1] & 0xC0) != 0x80 ||
+                (src[2] & 0xC0) != 0x80 || (src[3] & 0xC0) != 0x80) {
+                return 0;
+            }
+            c = ((c & 0x07) << 18) | ((src[1] & 0x3F) << 12) |
+                ((src[2] & 0x3F) << 6) | (src[3] & 0x3F);
+            if (c < 0x10000 || c > 0x10FFFF) {
+                return 0;
+            }
+            *ch = c;
+            return 4;
+        }
+        return 0;
+    case DIRECT_UTF16:         /* RFC 2781 */
+        {
+            const Uint16 *p = (const Uint16 *) src;
+            if (srclen < 2) {
+                return 0;
+            }
+            if (p[0] < 0xD800 || p[0] > 0xDFFF) {
+                *ch = p[0];
+                return 2;
+            }
+            if (p[0] > 0xDBFF || srclen < 4 ||
+                p[1] < 0xDC00 || p[1] > 0xDFFF) {
+                return 0;
+            }
+            *ch = (((Uint32) (p[0] & 0x3FF) << 10) |
+                   (Uint32) (p[1] & 0x3FF)) + 0x10000;
+            return 4;
+        }
+    case DIRECT_UTF32:
+        if (srclen < 4) {
+            return 0;
+        }
+        c = *(const Uint32 *) src;
+        if ((c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF) {
+            return 0;
+        }
+        *ch = c;
+        return 4;
+    }
+    return 0;
+}
+
+/* Return the number of bytes needed to encode a valid character */
+static __inline__ size_t
+SDL_EncodedSize(int dst_fmt, Uint32 ch)
+{
+    switch (dst_fmt) {
+    case DIRECT_UTF8:
+        return (ch <= 0x7F) ? 1 : (ch <= 0x7FF) ? 2 : (ch <= 0xFFFF) ? 3 : 4;
+    case DIRECT_UTF16:
+        return (ch < 0x10000) ? 2 : 4;
+    default:
+        return 4;
+    }
+}
+
+/* Encode a valid character, returning the number of bytes written, or 0
+   if there isn't enough room for it.
+ */
+static __inline__ size_t
+SDL_EncodeDirect(int dst_fmt, Uint32 ch, Uint8 * dst, size_t dstlen)
+{
+    size_t size = SDL_EncodedSize(dst_fmt, ch);
+
+    if (dstlen < size) {
+        return 0;
+    }
+    switch (dst_fmt) {
+    case DIRECT_UTF8:          /* RFC 3629 */
+        switch (size) {
+        case 1:
+            dst[0] = (Uint8) ch;
+            break;
+        case 2:
+            dst[0] = 0xC0 | (Uint8) (ch >> 6);
+            dst[1] = 0x80 | (Uint8) (ch & 0x3F);
+            break;
+        case 3:
+            dst[0] = 0xE0 | (Uint8) (ch >> 12);
+            dst[1] = 0x80 | (Uint8) ((ch >> 6) & 0x3F);
+            dst[2] = 0x80 | (Uint8) (ch & 0x3F);
+            break;
+        default:
+            dst[0] = 0xF0 | (Uint8) (ch >> 18);
+            dst[1] = 0x80 | (Uint8) ((ch >> 12) & 0x3F);
+            dst[2] = 0x80 | (Uint8) ((ch >> 6) & 0x3F);
+            dst[3] = 0x80 | (Uint8) (ch & 0x3F);
+            break;
+        }
+        break;
+    case DIRECT_UTF16:         /* RFC 2781 */
+        {
+            Uint16 *p = (Uint16 *) dst;
+            if (size == 2) {
+                p[0] = (Uint16) ch;
+            } else {
+                ch -= 0x10000;
+                p[0] = 0xD800 | (Uint16) ((ch >> 10) & 0x3FF);
+                p[1] = 0xDC00 | (Uint16) (ch & 0x3FF);
+            }
+        }
+        break;
+    default:
+        *(Uint32 *) dst = ch;
+        break;
+    }
+    return size;
+}
+
+static __inline__ SDL_bool
+SDL_IsASCIIUnit(int src_fmt, const Uint8 * src)
+{
+    switch (src_fmt) {
+    case DIRECT_UTF8:
+        return src[0] < 0x80;
+    case DIRECT_UTF16:
+        return *(const Uint16 *) src < 0x80;
+    default:
+        return *(const Uint32 *) src < 0x80;
+    }
+}
+
+/* The conversion loops, inlined below for each source encoding */
+static __inline__ size_t
+SDL_ConvertDirectLoop(int src_fmt, int dst_fmt,
+                      const Uint8 ** srcp, size_t * srclenp,
+                      Uint8 ** dstp, size_t * dstlenp)
+{
+    const Uint8 *src = *srcp;
+    size_t srclen = *srclenp;
+    Uint8 *dst = *dstp;
+    size_t dstlen = *dstlenp;
+    size_t total = 0;
+    size_t n, used;
+    Uint32 ch;
+
+    while (srclen >= direct_unit_size[src_fmt]) {
+        if (SDL_IsASCIIUnit(src_fmt, src)) {
+            n = SDL_CopyASCII(src_fmt, dst_fmt, src, srclen, dst, dstlen);
+            if (n) {
+                src += n * direct_unit_size[src_fmt];
+                srclen -= n * direct_unit_size[src_fmt];
+                dst += n * direct_unit_size[dst_fmt];
+                dstlen -= n * direct_unit_size[dst_fmt];
+                total += n;
+                continue;
+            }
+        }
+
+        used = SDL_DecodeDirect(src_fmt, src, srclen, &ch);
+        if (!used) {
+            break;
+        }
+        n = SDL_EncodeDirect(dst_fmt, ch, dst, dstlen);
+        if (!n) {
+            break;
+        }
+        src += used;
+        srclen -= used;
+        dst += n;
+        dstlen -= n;
+        ++total;
+    }
+
+    *srcp = src;
+    *srclenp = srclen;
+    *dstp = dst;
+    *dstlenp = dstlen;
+    return total;
+}
+
+/* Convert characters until the input runs out or something needs the
+   general converter, returning the number of characters converted.
+ */
+static size_t
+SDL_ConvertDirect(int src_fmt, int dst_fmt,
+                  const char **inbuf, size_t * inbytesleft,
+                  char **outbuf, size_t * outbytesleft)
+{
+    const Uint8 **src = (const Uint8 **) inbuf;
+    Uint8 **dst = (Uint8 **) outbuf;
+
+    if (!SDL_IsDirectAligned(src_fmt, *src) ||
+        !SDL_IsDirectAligned(dst_fmt, *dst)) {
+        return 0;
+    }
+
+    switch (src_fmt) {
+    case DIRECT_UTF8:
+        return SDL_ConvertDirectLoop(DIRECT_UTF8, dst_fmt,
+                                     src, inbytesleft, dst, outbytesleft);
+    case DIRECT_UTF16:
+        return SDL_ConvertDirectLoop(DIRECT_UTF16, dst_fmt,
+                                     src, inbytesleft, dst, outbytesleft);
+    default:
+        return SDL_ConvertDirectLoop(DIRECT_UTF32, dst_fmt,
+                                     src, inbytesleft, dst, outbytesleft);
+    }
+}
+
+/* Count the characters in UTF-8 text, and how many of them are outside
+   the basic multilingual plane, assuming that the text is well-formed.
+ */
+static void
+SDL_CountUTF8(const Uint8 * src, size_t srclen, size_t * chars, size_t * wide)
+{
+    size_t i = 0, leads = 0, fours = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i continuation = _mm_set1_epi8(-64);
+    const __m128i four = _mm_set1_epi8(-17);
+
+    while (i + 16 <= srclen) {
+        /* Per byte counts are gathered for up to 255 blocks at a time */
+        __m128i sum_leads = zero, sum_fours = zero;
+        size_t blocks = SDL_min((srclen - i) / 16, 255);
+
+        for (; blocks--; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *) &src[i]);
+            /* Continuation bytes are 0x80-0xBF, four byte leads 0xF0-0xFF */
+            sum_leads = _mm_sub_epi8(sum_leads, _mm_cmplt_epi8(v, continuation));
+            sum_fours = _mm_sub_epi8(sum_fours,
+                                     _mm_and_si128(_mm_cmpgt_epi8(v, four),
+                                                   _mm_cmplt_epi8(v, zero)));
+        }
+        sum_leads = _mm_sad_epu8(sum_leads, zero);
+        sum_fours = _mm_sad_epu8(sum_fours, zero);
+        leads += _mm_cvtsi128_si32(sum_leads) +
+                 _mm_cvtsi128_si32(_mm_srli_si128(sum_leads, 8));
+        fours += _mm_cvtsi128_si32(sum_fours) +
+                 _mm_cvtsi128_si32(_mm_srli_si128(sum_fours, 8));
+    }
+    /* Those were the continuation bytes, count the others */
+    leads = i - leads;
+#endif
+    for (; i < srclen; ++i) {
+        leads += ((src[i] & 0xC0) != 0x80);
+        fours += (src[i] >= 0xF0);
+    }
+    *chars = leads;
+    *wide = fours;
+}
+
+/* Work out the size of the converted text, which is exact as long as the
+   input is well-formed. This runs without decoding anything, so that the
+   buffer can be allocated once and the text converted in a single pass.
+ */
+static size_t
+SDL_MeasureDirect(int src_fmt, int dst_fmt, const char *inbuf, size_t inbytesleft)
+{
+    size_t size = 0;
+    size_t i, n, chars, wide;
+
+    if (src_fmt == dst_fmt) {
+        return inbytesleft;
+    }
+
+    switch (src_fmt) {
+    case DIRECT_UTF8:
+        SDL_CountUTF8((const Uint8 *) inbuf, inbytesleft, &chars, &wide);
+        if (dst_fmt == DIRECT_UTF16) {
+            size = (chars + wide) * 2;
+        } else {
+            size = chars * 4;
+        }
+        break;
+    case DIRECT_UTF16:
+        {
+            const Uint16 *src = (const Uint16 *) inbuf;
+            n = inbytesleft / 2;
+            for (i = 0; i < n; ++i) {
+                Uint16 W = src[i];
+                if (dst_fmt == DIRECT_UTF8) {
+                    /* Each half of a surrogate pair makes two bytes */
+                    size += 1 + (W >= 0x80) + (W >= 0x800) -
+                            (W >= 0xD800 && W <= 0xDFFF);
+                } else {
+                    size += (W < 0xDC00 || W > 0xDFFF) * 4;
+                }
+            }
+        }
+        break;
+    case DIRECT_UTF32:
+        {
+            const Uint32 *src = (const Uint32 *) inbuf;
+            n = inbytesleft / 4;
+            for (i = 0; i < n; ++i) {
+                Uint32 ch = src[i];
+                if (dst_fmt == DIRECT_UTF8) {
+                    size += 1 + (ch >= 0x80) + (ch >= 0x800) + (ch >= 0x10000);
+                } else {
+                    size += 2 + (ch >= 0x10000) * 2;
+                }
+            }
+        }
+        break;
+    }
+    return size;
+}
+
+/* Encodings that SDL_iconv_string() can convert directly */
+static struct
+{
+    const char *name;
+    int format;
+} direct_encodings[] = {
+/* *INDENT-OFF* */
+    { "UTF8", DIRECT_UTF8 },
+    { "UTF-8", DIRECT_UTF8 },
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    { "UTF16BE", DIRECT_UTF16 },
+    { "UTF-16BE", DIRECT_UTF16 },
+    { "UTF32BE", DIRECT_UTF32 },
+    { "UTF-32BE", DIRECT_UTF32 },
+    { "UCS4", DIRECT_UTF32 },
+    { "UCS-4", DIRECT_UTF32 },
+    { "UCS-4BE", DIRECT_UTF32 },
+#else
+    { "UTF16LE", DIRECT_UTF16 },
+    { "UTF-16LE", DIRECT_UTF16 },
+    { "UTF32LE", DIRECT_UTF32 },
+    { "UTF-32LE", DIRECT_UTF32 },
+    { "UCS-4LE", DIRECT_UTF32 },
+#endif
+    { "UCS-4-INTERNAL", DIRECT_UTF32 },
+/* *INDENT-ON* */
+};
+
+static int
+SDL_GetDirectEncoding(const char *code)
+{
+    int i;
+
+    if (code) {
+        for (i = 0; i < SDL_arraysize(direct_encodings); ++i) {
+            if (SDL_strcasecmp(code, direct_encodings[i].name) == 0) {
+                return direct_encodings[i].format;
+            }
+        }
+    }
+    return DIRECT_NONE;
+}
 
 #ifdef HAVE_ICONV
 
@@ -75,6 +616,13 @@ SDL_iconv(SDL_iconv_t cd,
 #define UNKNOWN_ASCII	'?'
 #define UNKNOWN_UNICODE	0xFFFD
 
+/* The smallest character that needs a UTF-8 sequence of each length,
+   indexed by the number of continuation bytes.
+ */
+static const Uint32 utf8_minimum[] = {
+    0, 0x80, 0x800, 0x10000, 0x200000, 0x4000000
+};
+
 enum
 {
     ENCODING_UNKNOWN,
@@ -110,6 +658,22 @@ struct _SDL_iconv_t
     int dst_fmt;
 };
 
+static int
+SDL_DirectFormat(int format)
+{
+    switch (format) {
+    case ENCODING_UTF8:
+        return DIRECT_UTF8;
+    case ENCODING_UTF16NATIVE:
+        return DIRECT_UTF16;
+    case ENCODING_UTF32NATIVE:
+    case ENCODING_UCS4NATIVE:
+        return DIRECT_UTF32;
+    default:
+        return DIRECT_NONE;
+    }
+}
+
 static struct
 {
     const char *name;
@@ -233,6 +797,7 @@ SDL_iconv(SDL_iconv_t cd,
     size_t srclen, dstlen;
     Uint32 ch = 0;
     size_t total;
+    int src_direct, dst_direct;
 
     if (!inbuf || !*inbuf) {
         /* Reset the context */
@@ -318,8 +883,24 @@ SDL_iconv(SDL_iconv_t cd,
         break;
     }
 
+    src_direct = SDL_DirectFormat(cd->src_fmt);
+    dst_direct = SDL_DirectFormat(cd->dst_fmt);
+
     total = 0;
     while (srclen > 0) {
+        if (src_direct != DIRECT_NONE && dst_direct != DIRECT_NONE) {
+            /* Convert well-formed text without going through UCS-4 */
+            total += SDL_ConvertDirect(src_direct, dst_direct,
+                                       &src, &srclen, &dst, &dstlen);
+            *inbuf = src;
+            *inbytesleft = srclen;
+            *outbuf = dst;
+            *outbytesleft = dstlen;
+            if (srclen == 0) {
+                break;
+            }
+        }
+
         /* Decode a character */
         switch (cd->src_fmt) {
         case ENCODING_ASCII:
@@ -342,7 +923,7 @@ SDL_iconv(SDL_iconv_t cd,
             {
                 Uint8 *p = (Uint8 *) src;
                 size_t left = 0;
-                SDL_bool overlong = SDL_FALSE;
+                Uint32 minimum;
                 if (p[0] >= 0xFC) {
                     if ((p[0] & 0xFE) != 0xFC) {
                         /* Skip illegal sequences
@@ -350,9 +931,6 @@ SDL_iconv(SDL_iconv_t cd,
                          */
                         ch = UNKNOWN_UNICODE;
                     } else {
-                        if (p[0] == 0xFC) {
-                            overlong = SDL_TRUE;
-                        }
                         ch = (Uint32) (p[0] & 0x01);
                         left = 5;
                     }
@@ -363,9 +941,6 @@ SDL_iconv(SDL_iconv_t cd,
                          */
                         ch = UNKNOWN_UNICODE;
                     } else {
-                        if (p[0] == 0xF8) {
-                            overlong = SDL_TRUE;
-                        }
                         ch = (Uint32) (p[0] & 0x03);
                         left = 4;
                     }
@@ -376,9 +951,6 @@ SDL_iconv(SDL_iconv_t cd,
                          */
                         ch = UNKNOWN_UNICODE;
                     } else {
-                        if (p[0] == 0xF0) {
-                            overlong = SDL_TRUE;
-                        }
                         ch = (Uint32) (p[0] & 0x07);
                         left = 3;
                     }
@@ -389,9 +961,6 @@ SDL_iconv(SDL_iconv_t cd,
                          */
                         ch = UNKNOWN_UNICODE;
                     } else {
-                        if (p[0] == 0xE0) {
-                            overlong = SDL_TRUE;
-                        }
                         ch = (Uint32) (p[0] & 0x0F);
                         left = 2;
                     }
@@ -402,9 +971,6 @@ SDL_iconv(SDL_iconv_t cd,
                          */
                         ch = UNKNOWN_UNICODE;
                     } else {
-                        if ((p[0] & 0xDE) == 0xC0) {
-                            overlong = SDL_TRUE;
-                        }
                         ch = (Uint32) (p[0] & 0x1F);
                         left = 1;
                     }
@@ -418,6 +984,7 @@ SDL_iconv(SDL_iconv_t cd,
                         ch = (Uint32) p[0];
                     }
                 }
+                minimum = utf8_minimum[left];
                 ++src;
                 --srclen;
                 if (srclen < left) {
@@ -437,7 +1004,7 @@ SDL_iconv(SDL_iconv_t cd,
                     ++src;
                     --srclen;
                 }
-                if (overlong) {
+                if (ch < minimum) {
                     /* Potential security risk
                        return SDL_ICONV_EILSEQ;
                      */
@@ -847,6 +1414,7 @@ SDL_iconv_string(const char *tocode, const char *fromcode, const char *inbuf,
     char *outbuf;
     size_t outbytesleft;
     size_t retCode = 0;
+    int src_fmt, dst_fmt;
 
     cd = SDL_iconv_open(tocode, fromcode);
     if (cd == (SDL_iconv_t) - 1) {
@@ -863,14 +1431,35 @@ SDL_iconv_string(const char *tocode, const char *fromcode, const char *inbuf,
         return NULL;
     }
 
-    stringsize = inbytesleft > 4 ? inbytesleft : 4;
-    string = SDL_malloc(stringsize);
-    if (!string) {
-        SDL_iconv_close(cd);
-        return NULL;
+    src_fmt = SDL_GetDirectEncoding(fromcode);
+    dst_fmt = SDL_GetDirectEncoding(tocode);
+    if (inbuf && src_fmt != DIRECT_NONE && dst_fmt != DIRECT_NONE &&
+        SDL_IsDirectAligned(src_fmt, inbuf)) {
+        /* Well-formed text is converted in one pass into an exactly sized
+           buffer, with room left over for a wide terminating zero.
+         */
+        stringsize = SDL_MeasureDirect(src_fmt, dst_fmt, inbuf, inbytesleft) + 4;
+        string = SDL_malloc(stringsize);
+        if (!string) {
+            SDL_iconv_close(cd);
+            return NULL;
+        }
+        outbuf = string;
+        outbytesleft = stringsize - 4;
+        SDL_ConvertDirect(src_fmt, dst_fmt,
+                          &inbuf, &inbytesleft, &outbuf, &outbytesleft);
+        outbytesleft += 4;
+        /* Anything left over is malformed and handled below */
+    } else {
+        stringsize = inbytesleft > 4 ? inbytesleft : 4;
+        string = SDL_malloc(stringsize);
+        if (!string) {
+            SDL_iconv_close(cd);
+            return NULL;
+        }
+        outbuf = string;
+        outbytesleft = stringsize;
     }
-    outbuf = string;
-    outbytesleft = stringsize;
     SDL_memset(outbuf, 0, 4);
 
     while (inbytesleft > 0) {
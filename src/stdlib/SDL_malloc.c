@@ -23,8 +23,22 @@
 /* This file contains portable memory management functions for SDL */
 
 #include "SDL_stdinc.h"
+#include "SDL_atomic.h"
+#include "SDL_malloc_c.h"
 
-#ifndef HAVE_MALLOC
+/* dlmalloc provides SDL_malloc() when there is no C library malloc(), and
+   the mspaces under the thread caching allocator when that is enabled.
+ */
+#if !defined(HAVE_MALLOC) || SDL_MALLOC_THREAD_CACHE
+
+#ifdef HAVE_MALLOC
+#define ONLY_MSPACES 1
+#elif SDL_MALLOC_THREAD_CACHE
+#define MSPACES 1
+#endif
+#define USE_LOCKS 1
+/* mremap() needs _GNU_SOURCE, which SDL doesn't build with */
+#define HAVE_MREMAP 0
 
 #define LACKS_SYS_TYPES_H
 #define LACKS_STDIO_H
@@ -1441,56 +1455,19 @@ win32munmap(void *ptr, size_t size)
     unique mparams values are initialized only once.
 */
 
-#ifndef WIN32
-/* By default use posix locks */
-#include <pthread.h>
-#define MLOCK_T pthread_mutex_t
-#define INITIAL_LOCK(l)      pthread_mutex_init(l, NULL)
-#define ACQUIRE_LOCK(l)      pthread_mutex_lock(l)
-#define RELEASE_LOCK(l)      pthread_mutex_unlock(l)
-
-#if HAVE_MORECORE
-static MLOCK_T morecore_mutex = PTHREAD_MUTEX_INITIALIZER;
-#endif /* HAVE_MORECORE */
-
-static MLOCK_T magic_init_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-#else /* WIN32 */
 /*
    Because lock-protected regions have bounded times, and there
-   are no recursive lock calls, we can use simple spinlocks.
+   are no recursive lock calls, we can use SDL's spinlocks, which
+   work everywhere SDL does.
 */
-
-#define MLOCK_T long
-static int
-win32_acquire_lock(MLOCK_T * sl)
-{
-    for (;;) {
-#ifdef InterlockedCompareExchangePointer
-        if (!InterlockedCompareExchange(sl, 1, 0))
-            return 0;
-#else /* Use older void* version */
-        if (!InterlockedCompareExchange((void **) sl, (void *) 1, (void *) 0))
-            return 0;
-#endif /* InterlockedCompareExchangePointer */
-        Sleep(0);
-    }
-}
-
-static void
-win32_release_lock(MLOCK_T * sl)
-{
-    InterlockedExchange(sl, 0);
-}
-
+#define MLOCK_T SDL_SpinLock
 #define INITIAL_LOCK(l)      *(l)=0
-#define ACQUIRE_LOCK(l)      win32_acquire_lock(l)
-#define RELEASE_LOCK(l)      win32_release_lock(l)
+#define ACQUIRE_LOCK(l)      (SDL_AtomicLock(l), 0)
+#define RELEASE_LOCK(l)      SDL_AtomicUnlock(l)
 #if HAVE_MORECORE
 static MLOCK_T morecore_mutex;
 #endif /* HAVE_MORECORE */
 static MLOCK_T magic_init_mutex;
-#endif /* WIN32 */
 
 #define USE_LOCK_BIT               (2U)
 #else /* USE_LOCKS */
@@ -5231,6 +5208,6 @@ History:
  
 */
 
-#endif /* !HAVE_MALLOC */
+#endif /* !HAVE_MALLOC || SDL_MALLOC_THREAD_CACHE */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,60 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_malloc_c_h
+#define _SDL_malloc_c_h
+
+#if SDL_MALLOC_THREAD_CACHE
+
+/* The dlmalloc mspaces under the thread caching allocator, renamed so they
+   can't clash with an application's own copy of dlmalloc.
+ */
+#define create_mspace               SDL_create_mspace
+#define create_mspace_with_base     SDL_create_mspace_with_base
+#define destroy_mspace              SDL_destroy_mspace
+#define mspace_malloc               SDL_mspace_malloc
+#define mspace_free                 SDL_mspace_free
+#define mspace_realloc              SDL_mspace_realloc
+#define mspace_calloc               SDL_mspace_calloc
+#define mspace_memalign             SDL_mspace_memalign
+#define mspace_independent_calloc   SDL_mspace_independent_calloc
+#define mspace_independent_comalloc SDL_mspace_independent_comalloc
+#define mspace_footprint            SDL_mspace_footprint
+#define mspace_max_footprint        SDL_mspace_max_footprint
+#define mspace_mallinfo             SDL_mspace_mallinfo
+#define mspace_malloc_stats         SDL_mspace_malloc_stats
+#define mspace_trim                 SDL_mspace_trim
+#define mspace_mallopt              SDL_mspace_mallopt
+
+/* An mspace is a void *, spelled out so this doesn't clash with the
+   typedef in SDL_malloc.c
+ */
+extern void *create_mspace(size_t capacity, int locked);
+extern void *mspace_malloc(void *msp, size_t bytes);
+extern void mspace_free(void *msp, void *mem);
+extern void *mspace_calloc(void *msp, size_t n_elements, size_t elem_size);
+extern void *mspace_memalign(void *msp, size_t alignment, size_t bytes);
+
+#endif /* SDL_MALLOC_THREAD_CACHE */
+
+#endif /* _SDL_malloc_c_h */
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,473 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* Counted allocations for SDL's own frequently allocated objects */
+
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+#include "SDL_malloc_c.h"
+#include "SDL_memory_c.h"
+
+/* Every allocation starts with a header saying where it came from.  It is
+   16 bytes so the memory after it keeps the alignment of the allocator.
+ */
+typedef union
+{
+    struct
+    {
+        Uint32 size_class;      /* index + 1 of the size class, or 0 */
+        Uint32 subsystem;
+        size_t size;            /* bytes the caller asked for */
+    } info;
+    Uint8 padding[16];
+} SDL_MemoryHeader;
+
+/* The header in front of memory from SDL_AllocAlignedMemory() has this
+   size class, and its size is the distance back to the real allocation.
+ */
+#define SDL_ALIGNED_SIZE_CLASS  0xFFFFFFFF
+
+typedef struct
+{
+    SDL_atomic64_t allocations;
+    SDL_atomic64_t frees;
+    SDL_atomic64_t total_bytes;
+    SDL_atomic64_t current_bytes;
+    SDL_atomic64_t peak_bytes;
+} SDL_MemoryCounters;
+
+static SDL_MemoryCounters SDL_memory_counters[SDL_NUM_MEMORY_SUBSYSTEMS];
+
+static void
+SDL_CountAlloc(Uint32 subsystem, size_t size)
+{
+    SDL_MemoryCounters *counters = &SDL_memory_counters[subsystem];
+    Sint64 current, peak;
+
+    SDL_AtomicAddRelaxed64(&counters->allocations, 1);
+    SDL_AtomicAddRelaxed64(&counters->total_bytes, (Sint64) size);
+    current = SDL_AtomicAdd64(&counters->current_bytes, (Sint64) size) + (Sint64) size;
+
+    peak = SDL_AtomicGetRelaxed64(&counters->peak_bytes);
+    while (current > peak && !SDL_AtomicCAS64(&counters->peak_bytes, peak, current)) {
+        peak = SDL_AtomicGetRelaxed64(&counters->peak_bytes);
+    }
+}
+
+static void
+SDL_CountFree(Uint32 subsystem, size_t size)
+{
+    SDL_MemoryCounters *counters = &SDL_memory_counters[subsystem];
+
+    SDL_AtomicAddRelaxed64(&counters->frees, 1);
+    SDL_AtomicAdd64(&counters->current_bytes, -(Sint64) size);
+}
+
+#if SDL_MALLOC_THREAD_CACHE
+
+/* Small allocations are carved out of slabs in size classes that include
+   the header.  Each thread keeps a free list per class, and moves objects
+   to and from a shared list per class in batches, so most allocations and
+   frees don't touch any lock.  Larger allocations go straight to the
+   mspace, which has its own lock.
+ */
+#define SDL_SLAB_SIZE           (64 * 1024)
+#define SDL_CACHE_BATCH_BYTES   (8 * 1024)
+
+static const size_t SDL_size_classes[] = {
+    32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096
+};
+#define SDL_NUM_SIZE_CLASSES    SDL_arraysize(SDL_size_classes)
+
+typedef struct SDL_FreeObject
+{
+    struct SDL_FreeObject *next;
+} SDL_FreeObject;
+
+typedef struct
+{
+    SDL_SpinLock lock;
+    SDL_FreeObject *objects;
+} SDL_SharedList;
+
+typedef struct
+{
+    SDL_FreeObject *objects[SDL_NUM_SIZE_CLASSES];
+    int count[SDL_NUM_SIZE_CLASSES];
+} SDL_ThreadCache;
+
+static SDL_SharedList SDL_shared_lists[SDL_NUM_SIZE_CLASSES];
+static void *SDL_memory_space;
+static SDL_TLSID SDL_thread_cache_id;
+
+static void *
+SDL_GetMemorySpace(void)
+{
+    static SDL_SpinLock lock;
+
+    if (!SDL_AtomicGetPtrAcquire(&SDL_memory_space)) {
+        SDL_AtomicLock(&lock);
+        if (!SDL_memory_space) {
+            SDL_AtomicSetPtrRelease(&SDL_memory_space, create_mspace(0, 1));
+        }
+        SDL_AtomicUnlock(&lock);
+    }
+    return SDL_memory_space;
+}
+
+static int
+SDL_GetSizeClass(size_t size)
+{
+    int i;
+
+    for (i = 0; i < SDL_NUM_SIZE_CLASSES; ++i) {
+        if (size <= SDL_size_classes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* How many objects move between a thread and the shared list at once */
+static int
+SDL_GetBatchSize(int size_class)
+{
+    int batch = (int)(SDL_CACHE_BATCH_BYTES / SDL_size_classes[size_class]);
+    return SDL_max(4, SDL_min(batch, 32));
+}
+
+/* Push a chain of objects onto the shared list */
+static void
+SDL_ReleaseObjects(int size_class, SDL_FreeObject *head, SDL_FreeObject *tail)
+{
+    SDL_SharedList *shared = &SDL_shared_lists[size_class];
+
+    SDL_AtomicLock(&shared->lock);
+    tail->next = shared->objects;
+    shared->objects = head;
+    SDL_AtomicUnlock(&shared->lock);
+}
+
+/* Get up to count objects from the shared list, or a new slab's worth.
+   Returns the number of objects in the chain starting at *objects.
+ */
+static int
+SDL_AcquireObjects(int size_class, int count, SDL_FreeObject **objects)
+{
+    SDL_SharedList *shared = &SDL_shared_lists[size_class];
+    const size_t size = SDL_size_classes[size_class];
+    SDL_FreeObject *head, *tail;
+    Uint8 *slab;
+    int i, n;
+
+    SDL_AtomicLock(&shared->lock);
+    head = shared->objects;
+    n = 0;
+    if (head) {
+        tail = head;
+        for (n = 1; n < count && tail->next; ++n) {
+            tail = tail->next;
+        }
+        shared->objects = tail->next;
+        tail->next = NULL;
+    }
+    SDL_AtomicUnlock(&shared->lock);
+    if (n > 0) {
+        *objects = head;
+        return n;
+    }
+
+    /* Slabs are never given back, their objects just get reused */
+    slab = (Uint8 *) mspace_memalign(SDL_GetMemorySpace(), 64, SDL_SLAB_SIZE);
+    if (!slab) {
+        *objects = NULL;
+        return 0;
+    }
+    n = (int)(SDL_SLAB_SIZE / size);
+    for (i = 0; i < n - 1; ++i) {
+        ((SDL_FreeObject *) (slab + i * size))->next = (SDL_FreeObject *) (slab + (i + 1) * size);
+    }
+    ((SDL_FreeObject *) (slab + i * size))->next = NULL;
+
+    /* Keep one batch and share the rest */
+    if (n > count) {
+        SDL_ReleaseObjects(size_class,
+                           (SDL_FreeObject *) (slab + count * size),
+                           (SDL_FreeObject *) (slab + (n - 1) * size));
+        ((SDL_FreeObject *) (slab + (count - 1) * size))->next = NULL;
+        n = count;
+    }
+    *objects = (SDL_FreeObject *) slab;
+    return n;
+}
+
+/* Hand everything a thread cached back when the thread exits */
+static void SDLCALL
+SDL_DestroyThreadCache(void *data)
+{
+    SDL_ThreadCache *cache = (SDL_ThreadCache *) data;
+    int i;
+
+    for (i = 0; i < SDL_NUM_SIZE_CLASSES; ++i) {
+        SDL_FreeObject *tail = cache->objects[i];
+        if (tail) {
+            while (tail->next) {
+                tail = tail->next;
+            }
+            SDL_ReleaseObjects(i, cache->objects[i], tail);
+        }
+    }
+    mspace_free(SDL_GetMemorySpace(), cache);
+}
+
+static SDL_ThreadCache *
+SDL_GetThreadCache(void)
+{
+    static SDL_SpinLock lock;
+    SDL_ThreadCache *cache;
+
+    if (!SDL_thread_cache_id) {
+        SDL_AtomicLock(&lock);
+        if (!SDL_thread_cache_id) {
+            SDL_thread_cache_id = SDL_TLSCreate();
+        }
+        SDL_AtomicUnlock(&lock);
+    }
+
+    cache = (SDL_ThreadCache *) SDL_TLSGet(SDL_thread_cache_id);
+    if (!cache) {
+        cache = (SDL_ThreadCache *) mspace_calloc(SDL_GetMemorySpace(), 1, sizeof(*cache));
+        if (cache && SDL_TLSSet(SDL_thread_cache_id, cache, SDL_DestroyThreadCache) < 0) {
+            mspace_free(SDL_GetMemorySpace(), cache);
+            cache = NULL;
+        }
+    }
+    return cache;
+}
+
+static SDL_MemoryHeader *
+SDL_AllocBlock(size_t size, Uint32 *size_class)
+{
+    const int c = SDL_GetSizeClass(size);
+    SDL_ThreadCache *cache;
+    SDL_FreeObject *object;
+
+    if (c < 0) {
+        *size_class = 0;
+        return (SDL_MemoryHeader *) mspace_memalign(SDL_GetMemorySpace(), sizeof(SDL_MemoryHeader), size);
+    }
+    *size_class = (Uint32) (c + 1);
+
+    cache = SDL_GetThreadCache();
+    if (!cache) {
+        /* No thread local storage, so take objects one at a time */
+        SDL_AcquireObjects(c, 1, &object);
+        return (SDL_MemoryHeader *) object;
+    }
+
+    object = cache->objects[c];
+    if (!object) {
+        cache->count[c] = SDL_AcquireObjects(c, SDL_GetBatchSize(c), &object);
+        if (!object) {
+            return NULL;
+        }
+    }
+    cache->objects[c] = object->next;
+    --cache->count[c];
+    return (SDL_MemoryHeader *) object;
+}
+
+static void
+SDL_FreeBlock(SDL_MemoryHeader *header)
+{
+    const int c = (int) header->info.size_class - 1;
+    SDL_FreeObject *object = (SDL_FreeObject *) header;
+    SDL_ThreadCache *cache;
+
+    if (c < 0) {
+        mspace_free(SDL_GetMemorySpace(), header);
+        return;
+    }
+
+    cache = SDL_GetThreadCache();
+    if (!cache) {
+        object->next = NULL;
+        SDL_ReleaseObjects(c, object, object);
+        return;
+    }
+
+    object->next = cache->objects[c];
+    cache->objects[c] = object;
+
+    /* Don't let one thread hoard memory that it frees for others */
+    if (++cache->count[c] > 2 * SDL_GetBatchSize(c)) {
+        const int batch = SDL_GetBatchSize(c);
+        SDL_FreeObject *head = cache->objects[c], *tail = head;
+        int i;
+
+        for (i = 1; i < batch; ++i) {
+            tail = tail->next;
+        }
+        cache->objects[c] = tail->next;
+        cache->count[c] -= batch;
+        SDL_ReleaseObjects(c, head, tail);
+    }
+}
+
+#else
+
+static SDL_MemoryHeader *
+SDL_AllocBlock(size_t size, Uint32 *size_class)
+{
+    *size_class = 0;
+    return (SDL_MemoryHeader *) SDL_malloc(size);
+}
+
+static void
+SDL_FreeBlock(SDL_MemoryHeader *header)
+{
+    SDL_free(header);
+}
+
+#endif /* SDL_MALLOC_THREAD_CACHE */
+
+void *
+SDL_AllocMemory(SDL_MemorySubsystem subsystem, size_t size)
+{
+    SDL_MemoryHeader *header;
+    Uint32 size_class;
+
+    if (size > (~(size_t)0) - sizeof(*header)) {
+        return NULL;
+    }
+
+    header = SDL_AllocBlock(sizeof(*header) + size, &size_class);
+    if (!header) {
+        return NULL;
+    }
+    header->info.size_class = size_class;
+    header->info.subsystem = (Uint32) subsystem;
+    header->info.size = size;
+    SDL_CountAlloc(subsystem, size);
+    return header + 1;
+}
+
+void *
+SDL_CallocMemory(SDL_MemorySubsystem subsystem, size_t nmemb, size_t size)
+{
+    void *mem;
+
+    if (size && nmemb > (~(size_t)0) / size) {
+        return NULL;
+    }
+
+    mem = SDL_AllocMemory(subsystem, nmemb * size);
+    if (mem) {
+        SDL_memset(mem, 0, nmemb * size);
+    }
+    return mem;
+}
+
+void *
+SDL_AllocAlignedMemory(SDL_MemorySubsystem subsystem, size_t alignment, size_t size)
+{
+    SDL_MemoryHeader *header;
+    Uint8 *mem, *aligned;
+
+    if (alignment <= sizeof(*header)) {
+        return SDL_AllocMemory(subsystem, size);
+    }
+    if (size > (~(size_t)0) - alignment - sizeof(*header)) {
+        return NULL;
+    }
+
+    mem = (Uint8 *) SDL_AllocMemory(subsystem, size + alignment + sizeof(*header));
+    if (!mem) {
+        return NULL;
+    }
+    aligned = mem + sizeof(*header);
+    aligned += (alignment - ((uintptr_t) aligned & (alignment - 1))) & (alignment - 1);
+
+    header = (SDL_MemoryHeader *) aligned - 1;
+    header->info.size_class = SDL_ALIGNED_SIZE_CLASS;
+    header->info.subsystem = (Uint32) subsystem;
+    header->info.size = (size_t) (aligned - mem);
+    return aligned;
+}
+
+void
+SDL_FreeMemory(void *mem)
+{
+    SDL_MemoryHeader *header;
+
+    if (!mem) {
+        return;
+    }
+
+    header = (SDL_MemoryHeader *) mem - 1;
+    if (header->info.size_class == SDL_ALIGNED_SIZE_CLASS) {
+        mem = (Uint8 *) mem - header->info.size;
+        header = (SDL_MemoryHeader *) mem - 1;
+    }
+    SDL_CountFree(header->info.subsystem, header->info.size);
+    SDL_FreeBlock(header);
+}
+
+int
+SDL_GetMemoryStats(SDL_MemorySubsystem subsystem, SDL_MemoryStats * stats)
+{
+    SDL_MemoryCounters *counters;
+
+    if ((int) subsystem < 0 || subsystem >= SDL_NUM_MEMORY_SUBSYSTEMS) {
+        SDL_InvalidParamError("subsystem");
+        return -1;
+    }
+    if (!stats) {
+        SDL_InvalidParamError("stats");
+        return -1;
+    }
+
+    counters = &SDL_memory_counters[subsystem];
+    stats->allocations = (Uint64) SDL_AtomicGet64(&counters->allocations);
+    stats->frees = (Uint64) SDL_AtomicGet64(&counters->frees);
+    stats->total_bytes = (Uint64) SDL_AtomicGet64(&counters->total_bytes);
+    stats->current_bytes = (Uint64) SDL_AtomicGet64(&counters->current_bytes);
+    stats->peak_bytes = (Uint64) SDL_AtomicGet64(&counters->peak_bytes);
+    return 0;
+}
+
+void
+SDL_ResetMemoryStats(void)
+{
+    int i;
+
+    for (i = 0; i < SDL_NUM_MEMORY_SUBSYSTEMS; ++i) {
+        SDL_MemoryCounters *counters = &SDL_memory_counters[i];
+
+        SDL_AtomicSet64(&counters->allocations, 0);
+        SDL_AtomicSet64(&counters->frees, 0);
+        SDL_AtomicSet64(&counters->total_bytes, 0);
+        SDL_AtomicSet64(&counters->peak_bytes, SDL_AtomicGet64(&counters->current_bytes));
+    }
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
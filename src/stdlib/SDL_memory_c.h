@@ -0,0 +1,46 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_memory_c_h
+#define _SDL_memory_c_h
+
+#include "SDL_stdinc.h"
+
+/* Allocations that are counted against a subsystem by SDL_GetMemoryStats().
+   With SDL_MALLOC_THREAD_CACHE these come from per-thread caches of size
+   class slabs instead of the C library heap.
+
+   Memory from these must be freed with SDL_FreeMemory(), which may be
+   called from any thread.
+ */
+extern void *SDL_AllocMemory(SDL_MemorySubsystem subsystem, size_t size);
+extern void *SDL_CallocMemory(SDL_MemorySubsystem subsystem, size_t nmemb, size_t size);
+extern void SDL_FreeMemory(void *mem);
+
+/* Like SDL_AllocMemory(), with the memory starting on a multiple of
+   alignment, which must be a power of two.  This is freed with
+   SDL_FreeMemory() as well.
+ */
+extern void *SDL_AllocAlignedMemory(SDL_MemorySubsystem subsystem, size_t alignment, size_t size);
+
+#endif /* _SDL_memory_c_h */
+/* vi: set ts=4 sw=4 expandtab: */
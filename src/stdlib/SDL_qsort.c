@@ -1,470 +1,485 @@
-/* qsort.c
- * (c) 1998 Gareth McCaughan
- *
- * This is a drop-in replacement for the C library's |qsort()| routine.
- *
- * Features:
- *   - Median-of-three pivoting (and more)
- *   - Truncation and final polishing by a single insertion sort
- *   - Early truncation when no swaps needed in pivoting step
- *   - Explicit recursion, guaranteed not to overflow
- *   - A few little wrinkles stolen from the GNU |qsort()|.
- *   - separate code for non-aligned / aligned / word-size objects
- *
- * This code may be reproduced freely provided
- *   - this file is retained unaltered apart from minor
- *     changes for portability and efficiency
- *   - no changes are made to this comment
- *   - any changes that *are* made are clearly flagged
- *   - the _ID string below is altered by inserting, after
- *     the date, the string " altered" followed at your option
- *     by other material. (Exceptions: you may change the name
- *     of the exported routine without changing the ID string.
- *     You may change the values of the macros TRUNC_* and
- *     PIVOT_THRESHOLD without changing the ID string, provided
- *     they remain constants with TRUNC_nonaligned, TRUNC_aligned
- *     and TRUNC_words/WORD_BYTES between 8 and 24, and
- *     PIVOT_THRESHOLD between 32 and 200.)
- *
- * You may use it in anything you like; you may make money
- * out of it; you may distribute it in object form or as
- * part of an executable without including source code;
- * you don't have to credit me. (But it would be nice if
- * you did.)
- *
- * If you find problems with this code, or find ways of
- * making it significantly faster, please let me know!
- * My e-mail address, valid as of early 1998 and certainly
- * OK for at least the next 18 months, is
- *    gjm11@dpmms.cam.ac.uk
- * Thanks!
- *
- * Gareth McCaughan   Peterhouse   Cambridge   1998
- */
-#include "SDL_config.h"
-
 /*
-#include <assert.h>
-#include <stdlib.h>
-#include <string.h>
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
 */
-#include "SDL_stdinc.h"
-#include "SDL_assert.h"
-
-#ifdef assert
-#undef assert
-#endif
-#define assert(X) SDL_assert(X)
-#ifdef malloc
-#undef malloc
-#endif
-#define malloc	SDL_malloc
-#ifdef free
-#undef free
-#endif
-#define free	SDL_free
-#ifdef memcpy
-#undef memcpy
-#endif
-#define memcpy	SDL_memcpy
-#ifdef memmove
-#undef memmove
-#endif
-#define memmove	SDL_memmove
-#ifdef qsort
-#undef qsort
-#endif
-#define qsort	SDL_qsort
-
-
-#ifndef HAVE_QSORT
-
-static const char _ID[] = "<qsort.c gjm 1.12 1998-03-19>";
-
-/* How many bytes are there per word? (Must be a power of 2,
- * and must in fact equal sizeof(int).)
- */
-#define WORD_BYTES sizeof(int)
+#include "SDL_config.h"
 
-/* How big does our stack need to be? Answer: one entry per
- * bit in a |size_t|.
- */
-#define STACK_SIZE (8*sizeof(size_t))
-
-/* Different situations have slightly different requirements,
- * and we make life epsilon easier by using different truncation
- * points for the three different cases.
- * So far, I have tuned TRUNC_words and guessed that the same
- * value might work well for the other two cases. Of course
- * what works well on my machine might work badly on yours.
- */
-#define TRUNC_nonaligned	12
-#define TRUNC_aligned		12
-#define TRUNC_words		12*WORD_BYTES   /* nb different meaning */
+/* Sorting routines for SDL.
 
-/* We use a simple pivoting algorithm for shortish sub-arrays
- * and a more complicated one for larger ones. The threshold
- * is PIVOT_THRESHOLD.
- */
-#define PIVOT_THRESHOLD 40
+   SDL_qsort() is an introsort: quicksort with median of three pivots (a
+   median of medians on large partitions), insertion sort once partitions
+   get small, and heapsort if the recursion gets too deep, so the worst
+   case is O(n log n). The sort is instantiated for each way of swapping
+   elements, so 4, 8 and 16 byte elements are swapped as whole words
+   instead of a byte at a time.
 
-typedef struct
-{
-    char *first;
-    char *last;
-} stack_entry;
-#define pushLeft {stack[stacktop].first=ffirst;stack[stacktop++].last=last;}
-#define pushRight {stack[stacktop].first=first;stack[stacktop++].last=llast;}
-#define doLeft {first=ffirst;llast=last;continue;}
-#define doRight {ffirst=first;last=llast;continue;}
-#define pop {if (--stacktop<0) break;\
-  first=ffirst=stack[stacktop].first;\
-  last=llast=stack[stacktop].last;\
-  continue;}
-
-/* Some comments on the implementation.
- * 1. When we finish partitioning the array into "low"
- *    and "high", we forget entirely about short subarrays,
- *    because they'll be done later by insertion sort.
- *    Doing lots of little insertion sorts might be a win
- *    on large datasets for locality-of-reference reasons,
- *    but it makes the code much nastier and increases
- *    bookkeeping overhead.
- * 2. We always save the shorter and get to work on the
- *    longer. This guarantees that every time we push
- *    an item onto the stack its size is <= 1/2 of that
- *    of its parent; so the stack can't need more than
- *    log_2(max-array-size) entries.
- * 3. We choose a pivot by looking at the first, last
- *    and middle elements. We arrange them into order
- *    because it's easy to do that in conjunction with
- *    choosing the pivot, and it makes things a little
- *    easier in the partitioning step. Anyway, the pivot
- *    is the middle of these three. It's still possible
- *    to construct datasets where the algorithm takes
- *    time of order n^2, but it simply never happens in
- *    practice.
- * 3' Newsflash: On further investigation I find that
- *    it's easy to construct datasets where median-of-3
- *    simply isn't good enough. So on large-ish subarrays
- *    we do a more sophisticated pivoting: we take three
- *    sets of 3 elements, find their medians, and then
- *    take the median of those.
- * 4. We copy the pivot element to a separate place
- *    because that way we can always do our comparisons
- *    directly against a pointer to that separate place,
- *    and don't have to wonder "did we move the pivot
- *    element?". This makes the inner loop better.
- * 5. It's possible to make the pivoting even more
- *    reliable by looking at more candidates when n
- *    is larger. (Taking this to its logical conclusion
- *    results in a variant of quicksort that doesn't
- *    have that n^2 worst case.) However, the overhead
- *    from the extra bookkeeping means that it's just
- *    not worth while.
- * 6. This is pretty clean and portable code. Here are
- *    all the potential portability pitfalls and problems
- *    I know of:
- *      - In one place (the insertion sort) I construct
- *        a pointer that points just past the end of the
- *        supplied array, and assume that (a) it won't
- *        compare equal to any pointer within the array,
- *        and (b) it will compare equal to a pointer
- *        obtained by stepping off the end of the array.
- *        These might fail on some segmented architectures.
- *      - I assume that there are 8 bits in a |char| when
- *        computing the size of stack needed. This would
- *        fail on machines with 9-bit or 16-bit bytes.
- *      - I assume that if |((int)base&(sizeof(int)-1))==0|
- *        and |(size&(sizeof(int)-1))==0| then it's safe to
- *        get at array elements via |int*|s, and that if
- *        actually |size==sizeof(int)| as well then it's
- *        safe to treat the elements as |int|s. This might
- *        fail on systems that convert pointers to integers
- *        in non-standard ways.
- *      - I assume that |8*sizeof(size_t)<=INT_MAX|. This
- *        would be false on a machine with 8-bit |char|s,
- *        16-bit |int|s and 4096-bit |size_t|s. :-)
+   SDL_RadixSort() is a stable LSD radix sort of (key, index) pairs, after
+   which the elements themselves are moved once into place.
  */
 
-/* The recursion logic is the same in each case: */
-#define Recurse(Trunc)				\
-      { size_t l=last-ffirst,r=llast-first;	\
-        if (l<Trunc) {				\
-          if (r>=Trunc) doRight			\
-          else pop				\
-        }					\
-        else if (l<=r) { pushLeft; doRight }	\
-        else if (r>=Trunc) { pushRight; doLeft }\
-        else doLeft				\
-      }
-
-/* and so is the pivoting logic: */
-#define Pivot(swapper,sz)			\
-  if ((size_t)(last-first)>PIVOT_THRESHOLD*sz) mid=pivot_big(first,mid,last,sz,compare);\
-  else {	\
-    if (compare(first,mid)<0) {			\
-      if (compare(mid,last)>0) {		\
-        swapper(mid,last);			\
-        if (compare(first,mid)>0) swapper(first,mid);\
-      }						\
-    }						\
-    else {					\
-      if (compare(mid,last)>0) swapper(first,last)\
-      else {					\
-        swapper(first,mid);			\
-        if (compare(mid,last)>0) swapper(mid,last);\
-      }						\
-    }						\
-    first+=sz; last-=sz;			\
-  }
-
-#ifdef DEBUG_QSORT
-#include <stdio.h>
-#endif
-
-/* and so is the partitioning logic: */
-#define Partition(swapper,sz) {			\
-  int swapped=0;				\
-  do {						\
-    while (compare(first,pivot)<0) first+=sz;	\
-    while (compare(pivot,last)<0) last-=sz;	\
-    if (first<last) {				\
-      swapper(first,last); swapped=1;		\
-      first+=sz; last-=sz; }			\
-    else if (first==last) { first+=sz; last-=sz; break; }\
-  } while (first<=last);			\
-  if (!swapped) pop				\
-}
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+
+/* Partitions this small are finished with insertion sort */
+#define SDL_INSERTION_SORT_THRESHOLD    16
+
+/* Partitions this big use the median of three medians as the pivot */
+#define SDL_NINTHER_THRESHOLD           128
 
-/* and so is the pre-insertion-sort operation of putting
- * the smallest element into place as a sentinel.
- * Doing this makes the inner loop nicer. I got this
- * idea from the GNU implementation of qsort().
+/* When a partition needed no swaps the input is probably already sorted,
+   and insertion sort is tried with this many moves before giving up.
  */
-#define PreInsertion(swapper,limit,sz)		\
-  first=base;					\
-  last=first + (nmemb>limit ? limit : nmemb-1)*sz;\
-  while (last!=base) {				\
-    if (compare(first,last)>0) first=last;	\
-    last-=sz; }					\
-  if (first!=base) swapper(first,(char*)base);
-
-/* and so is the insertion sort, in the first two cases: */
-#define Insertion(swapper)			\
-  last=((char*)base)+nmemb*size;		\
-  for (first=((char*)base)+size;first!=last;first+=size) {	\
-    char *test;					\
-    /* Find the right place for |first|.	\
-     * My apologies for var reuse. */		\
-    for (test=first-size;compare(test,first)>0;test-=size) ;	\
-    test+=size;					\
-    if (test!=first) {				\
-      /* Shift everything in [test,first)	\
-       * up by one, and place |first|		\
-       * where |test| is. */			\
-      memcpy(pivot,first,size);			\
-      memmove(test+size,test,first-test);	\
-      memcpy(test,pivot,size);			\
-    }						\
-  }
-
-#define SWAP_nonaligned(a,b) { \
-  register char *aa=(a),*bb=(b); \
-  register size_t sz=size; \
-  do { register char t=*aa; *aa++=*bb; *bb++=t; } while (--sz); }
-
-#define SWAP_aligned(a,b) { \
-  register int *aa=(int*)(a),*bb=(int*)(b); \
-  register size_t sz=size; \
-  do { register int t=*aa;*aa++=*bb; *bb++=t; } while (sz-=WORD_BYTES); }
-
-#define SWAP_words(a,b) { \
-  register int t=*((int*)a); *((int*)a)=*((int*)b); *((int*)b)=t; }
-
-/* ---------------------------------------------------------------------- */
+#define SDL_PARTIAL_INSERTION_LIMIT     8
+
+typedef int (*SDL_CompareFunc) (const void *, const void *);
+
+#define SDL_SWAP_TYPE(T, a, b) \
+    { T _tmp = *(T *)(a); *(T *)(a) = *(T *)(b); *(T *)(b) = _tmp; }
+
+#define SDL_SWAP_32(a, b)   SDL_SWAP_TYPE(Uint32, a, b)
+#define SDL_SWAP_64(a, b)   SDL_SWAP_TYPE(Uint64, a, b)
+#define SDL_SWAP_128(a, b) \
+    { SDL_SWAP_TYPE(Uint64, a, b); SDL_SWAP_TYPE(Uint64, (a) + 8, (b) + 8); }
+#define SDL_SWAP_WORDS(a, b) \
+    { \
+        Uint64 *_pa = (Uint64 *)(a), *_pb = (Uint64 *)(b); \
+        size_t _n = size / sizeof(Uint64); \
+        do { SDL_SWAP_TYPE(Uint64, _pa, _pb); ++_pa; ++_pb; } while (--_n); \
+    }
+#define SDL_SWAP_BYTES(a, b) \
+    { \
+        char *_pa = (a), *_pb = (b); \
+        size_t _n = size; \
+        do { SDL_SWAP_TYPE(char, _pa, _pb); ++_pa; ++_pb; } while (--_n); \
+    }
 
 static char *
-pivot_big(char *first, char *mid, char *last, size_t size,
-          int compare(const void *, const void *))
+SDL_Median3(char *a, char *b, char *c, SDL_CompareFunc compare)
 {
-    size_t d = (((last - first) / size) >> 3) * size;
-    char *m1, *m2, *m3;
-    {
-        char *a = first, *b = first + d, *c = first + 2 * d;
-#ifdef DEBUG_QSORT
-        fprintf(stderr, "< %d %d %d\n", *(int *) a, *(int *) b, *(int *) c);
-#endif
-        m1 = compare(a, b) < 0 ?
-            (compare(b, c) < 0 ? b : (compare(a, c) < 0 ? c : a))
-            : (compare(a, c) < 0 ? a : (compare(b, c) < 0 ? c : b));
-    }
-    {
-        char *a = mid - d, *b = mid, *c = mid + d;
-#ifdef DEBUG_QSORT
-        fprintf(stderr, ". %d %d %d\n", *(int *) a, *(int *) b, *(int *) c);
-#endif
-        m2 = compare(a, b) < 0 ?
-            (compare(b, c) < 0 ? b : (compare(a, c) < 0 ? c : a))
-            : (compare(a, c) < 0 ? a : (compare(b, c) < 0 ? c : b));
+    if (compare(a, b) < 0) {
+        if (compare(b, c) < 0) {
+            return b;
+        }
+        return (compare(a, c) < 0) ? c : a;
+    } else {
+        if (compare(a, c) < 0) {
+            return a;
+        }
+        return (compare(b, c) < 0) ? c : b;
     }
-    {
-        char *a = last - 2 * d, *b = last - d, *c = last;
-#ifdef DEBUG_QSORT
-        fprintf(stderr, "> %d %d %d\n", *(int *) a, *(int *) b, *(int *) c);
-#endif
-        m3 = compare(a, b) < 0 ?
-            (compare(b, c) < 0 ? b : (compare(a, c) < 0 ? c : a))
-            : (compare(a, c) < 0 ? a : (compare(b, c) < 0 ? c : b));
+}
+
+static char *
+SDL_ChoosePivot(char *base, size_t nmemb, size_t size, SDL_CompareFunc compare)
+{
+    char *first = base;
+    char *middle = base + (nmemb / 2) * size;
+    char *last = base + (nmemb - 1) * size;
+
+    if (nmemb >= SDL_NINTHER_THRESHOLD) {
+        size_t step = (nmemb / 8) * size;
+
+        first = SDL_Median3(first, first + step, first + 2 * step, compare);
+        middle = SDL_Median3(middle - step, middle, middle + step, compare);
+        last = SDL_Median3(last - 2 * step, last - step, last, compare);
     }
-#ifdef DEBUG_QSORT
-    fprintf(stderr, "-> %d %d %d\n", *(int *) m1, *(int *) m2, *(int *) m3);
-#endif
-    return compare(m1, m2) < 0 ?
-        (compare(m2, m3) < 0 ? m2 : (compare(m1, m3) < 0 ? m3 : m1))
-        : (compare(m1, m3) < 0 ? m1 : (compare(m2, m3) < 0 ? m3 : m2));
+    return SDL_Median3(first, middle, last, compare);
 }
 
-/* ---------------------------------------------------------------------- */
+/* Defines SDL_IntroSort<name>() and its helpers, moving elements with SWAP */
+#define SDL_DEFINE_SORT(name, SWAP) \
+static void \
+SDL_InsertionSort##name(char *base, size_t nmemb, size_t size, \
+                        SDL_CompareFunc compare) \
+{ \
+    char *end = base + nmemb * size; \
+    char *i, *j; \
+\
+    for (i = base + size; i < end; i += size) { \
+        for (j = i; j > base && compare(j - size, j) > 0; j -= size) { \
+            SWAP(j - size, j); \
+        } \
+    } \
+} \
+\
+static SDL_bool \
+SDL_PartialInsertionSort##name(char *base, size_t nmemb, size_t size, \
+                               SDL_CompareFunc compare) \
+{ \
+    char *end = base + nmemb * size; \
+    char *i, *j; \
+    int moves = 0; \
+\
+    for (i = base + size; i < end; i += size) { \
+        for (j = i; j > base && compare(j - size, j) > 0; j -= size) { \
+            SWAP(j - size, j); \
+            if (++moves > SDL_PARTIAL_INSERTION_LIMIT) { \
+                return SDL_FALSE; \
+            } \
+        } \
+    } \
+    return SDL_TRUE; \
+} \
+\
+static void \
+SDL_SiftDown##name(char *base, size_t root, size_t nmemb, size_t size, \
+                   SDL_CompareFunc compare) \
+{ \
+    size_t child; \
+\
+    while ((child = 2 * root + 1) < nmemb) { \
+        if (child + 1 < nmemb && \
+            compare(base + child * size, base + (child + 1) * size) < 0) { \
+            ++child; \
+        } \
+        if (compare(base + root * size, base + child * size) >= 0) { \
+            return; \
+        } \
+        SWAP(base + root * size, base + child * size); \
+        root = child; \
+    } \
+} \
+\
+static void \
+SDL_HeapSort##name(char *base, size_t nmemb, size_t size, \
+                   SDL_CompareFunc compare) \
+{ \
+    size_t i; \
+\
+    for (i = nmemb / 2; i-- > 0; ) { \
+        SDL_SiftDown##name(base, i, nmemb, size, compare); \
+    } \
+    for (i = nmemb - 1; i > 0; --i) { \
+        SWAP(base, base + i * size); \
+        SDL_SiftDown##name(base, 0, i, size, compare); \
+    } \
+} \
+\
+static void \
+SDL_IntroSort##name(char *base, size_t nmemb, size_t size, \
+                    SDL_CompareFunc compare, int depth) \
+{ \
+    while (nmemb > SDL_INSERTION_SORT_THRESHOLD) { \
+        char *pivot, *i, *j, *end; \
+        size_t left, right; \
+        SDL_bool swapped = SDL_FALSE; \
+\
+        if (depth-- == 0) { \
+            SDL_HeapSort##name(base, nmemb, size, compare); \
+            return; \
+        } \
+\
+        /* Partition around the pivot, which is kept at the start */ \
+        pivot = SDL_ChoosePivot(base, nmemb, size, compare); \
+        if (pivot != base) { \
+            SWAP(base, pivot); \
+        } \
+        i = base; \
+        j = end = base + nmemb * size; \
+        for (;;) { \
+            do { \
+                i += size; \
+            } while (i < end && compare(i, base) < 0); \
+            do { \
+                j -= size; \
+            } while (compare(j, base) > 0); \
+            if (i >= j) { \
+                break; \
+            } \
+            SWAP(i, j); \
+            swapped = SDL_TRUE; \
+        } \
+        if (j != base) { \
+            SWAP(base, j); \
+        } \
+\
+        /* Recurse into the smaller side and loop on the larger one, \
+           which keeps the stack depth logarithmic. \
+         */ \
+        left = (size_t)(j - base) / size; \
+        right = nmemb - left - 1; \
+        if (!swapped && \
+            SDL_PartialInsertionSort##name(base, left, size, compare) && \
+            SDL_PartialInsertionSort##name(j + size, right, size, compare)) { \
+            return; \
+        } \
+        if (left < right) { \
+            SDL_IntroSort##name(base, left, size, compare, depth); \
+            base = j + size; \
+            nmemb = right; \
+        } else { \
+            SDL_IntroSort##name(j + size, right, size, compare, depth); \
+            nmemb = left; \
+        } \
+    } \
+    SDL_InsertionSort##name(base, nmemb, size, compare); \
+}
 
-static void
-qsort_nonaligned(void *base, size_t nmemb, size_t size,
-                 int (*compare) (const void *, const void *))
+SDL_DEFINE_SORT(32, SDL_SWAP_32)
+SDL_DEFINE_SORT(64, SDL_SWAP_64)
+SDL_DEFINE_SORT(128, SDL_SWAP_128)
+SDL_DEFINE_SORT(Words, SDL_SWAP_WORDS)
+SDL_DEFINE_SORT(Bytes, SDL_SWAP_BYTES)
+
+void
+SDL_qsort(void *base, size_t nmemb, size_t size,
+          int (*compare) (const void *, const void *))
 {
+    size_t align;
+    int depth = 0;
 
-    stack_entry stack[STACK_SIZE];
-    int stacktop = 0;
-    char *first, *last;
-    char *pivot = malloc(size);
-    size_t trunc = TRUNC_nonaligned * size;
-    assert(pivot != 0);
-
-    first = (char *) base;
-    last = first + (nmemb - 1) * size;
-
-    if ((size_t) (last - first) > trunc) {
-        char *ffirst = first, *llast = last;
-        while (1) {
-            /* Select pivot */
-            {
-                char *mid = first + size * ((last - first) / size >> 1);
-                Pivot(SWAP_nonaligned, size);
-                memcpy(pivot, mid, size);
-            }
-            /* Partition. */
-            Partition(SWAP_nonaligned, size);
-            /* Prepare to recurse/iterate. */
-        Recurse(trunc)}
+    if (!base || !compare || nmemb <= 1 || size == 0) {
+        return;
+    }
+
+    /* Give up on quicksort after 2*log2(n) levels of bad pivots */
+    for (align = nmemb; align > 1; align >>= 1) {
+        depth += 2;
+    }
+
+    align = (size_t) (uintptr_t) base | size;
+    if (size == 4 && (align & 3) == 0) {
+        SDL_IntroSort32((char *) base, nmemb, size, compare, depth);
+    } else if (size == 8 && (align & 7) == 0) {
+        SDL_IntroSort64((char *) base, nmemb, size, compare, depth);
+    } else if (size == 16 && (align & 7) == 0) {
+        SDL_IntroSort128((char *) base, nmemb, size, compare, depth);
+    } else if ((align & 7) == 0) {
+        SDL_IntroSortWords((char *) base, nmemb, size, compare, depth);
+    } else {
+        SDL_IntroSortBytes((char *) base, nmemb, size, compare, depth);
     }
-    PreInsertion(SWAP_nonaligned, TRUNC_nonaligned, size);
-    Insertion(SWAP_nonaligned);
-    free(pivot);
 }
 
-static void
-qsort_aligned(void *base, size_t nmemb, size_t size,
-              int (*compare) (const void *, const void *))
+
+/* The keys are converted to unsigned integers that sort in the same order,
+   and sorted a byte at a time along with the index of their element.
+ */
+typedef struct
 {
+    Uint32 key;
+    Uint32 index;
+} SDL_RadixKey32;
 
-    stack_entry stack[STACK_SIZE];
-    int stacktop = 0;
-    char *first, *last;
-    char *pivot = malloc(size);
-    size_t trunc = TRUNC_aligned * size;
-    assert(pivot != 0);
-
-    first = (char *) base;
-    last = first + (nmemb - 1) * size;
-
-    if ((size_t) (last - first) > trunc) {
-        char *ffirst = first, *llast = last;
-        while (1) {
-            /* Select pivot */
-            {
-                char *mid = first + size * ((last - first) / size >> 1);
-                Pivot(SWAP_aligned, size);
-                memcpy(pivot, mid, size);
-            }
-            /* Partition. */
-            Partition(SWAP_aligned, size);
-            /* Prepare to recurse/iterate. */
-        Recurse(trunc)}
+typedef struct
+{
+    Uint64 key;
+    Uint32 index;
+    Uint32 unused;
+} SDL_RadixKey64;
+
+static Uint32
+SDL_GetRadixKey32(const char *key, SDL_SortKeyType key_type)
+{
+    Uint32 value;
+
+    SDL_memcpy(&value, key, sizeof(value));
+    switch (key_type) {
+    case SDL_SORTKEY_SINT32:
+        return value ^ 0x80000000;
+    case SDL_SORTKEY_FLOAT:
+        /* Negative numbers sort backwards, so flip all their bits */
+        return value ^ ((value & 0x80000000) ? 0xFFFFFFFF : 0x80000000);
+    default:
+        return value;
     }
-    PreInsertion(SWAP_aligned, TRUNC_aligned, size);
-    Insertion(SWAP_aligned);
-    free(pivot);
 }
 
-static void
-qsort_words(void *base, size_t nmemb,
-            int (*compare) (const void *, const void *))
+static Uint64
+SDL_GetRadixKey64(const char *key, SDL_SortKeyType key_type)
 {
+    Uint64 value;
+
+    SDL_memcpy(&value, key, sizeof(value));
+    switch (key_type) {
+    case SDL_SORTKEY_SINT64:
+        return value ^ 0x8000000000000000ULL;
+    case SDL_SORTKEY_DOUBLE:
+        return value ^ ((value & 0x8000000000000000ULL) ?
+                        0xFFFFFFFFFFFFFFFFULL : 0x8000000000000000ULL);
+    default:
+        return value;
+    }
+}
 
-    stack_entry stack[STACK_SIZE];
-    int stacktop = 0;
-    char *first, *last;
-    char *pivot = malloc(WORD_BYTES);
-    assert(pivot != 0);
-
-    first = (char *) base;
-    last = first + (nmemb - 1) * WORD_BYTES;
-
-    if (last - first > TRUNC_words) {
-        char *ffirst = first, *llast = last;
-        while (1) {
-#ifdef DEBUG_QSORT
-            fprintf(stderr, "Doing %d:%d: ",
-                    (first - (char *) base) / WORD_BYTES,
-                    (last - (char *) base) / WORD_BYTES);
-#endif
-            /* Select pivot */
-            {
-                char *mid =
-                    first + WORD_BYTES * ((last - first) / (2 * WORD_BYTES));
-                Pivot(SWAP_words, WORD_BYTES);
-                *(int *) pivot = *(int *) mid;
-            }
-#ifdef DEBUG_QSORT
-            fprintf(stderr, "pivot=%d\n", *(int *) pivot);
-#endif
-            /* Partition. */
-            Partition(SWAP_words, WORD_BYTES);
-            /* Prepare to recurse/iterate. */
-        Recurse(TRUNC_words)}
+static SDL_RadixKey32 *
+SDL_RadixSortKeys32(SDL_RadixKey32 *keys, SDL_RadixKey32 *temp, size_t nmemb)
+{
+    Uint32 counts[4][256];
+    SDL_RadixKey32 *swap;
+    size_t i;
+    int pass;
+
+    /* Count every digit in one pass over the keys */
+    SDL_zero(counts);
+    for (i = 0; i < nmemb; ++i) {
+        Uint32 key = keys[i].key;
+        ++counts[0][key & 0xFF];
+        ++counts[1][(key >> 8) & 0xFF];
+        ++counts[2][(key >> 16) & 0xFF];
+        ++counts[3][key >> 24];
     }
-    PreInsertion(SWAP_words, (TRUNC_words / WORD_BYTES), WORD_BYTES);
-    /* Now do insertion sort. */
-    last = ((char *) base) + nmemb * WORD_BYTES;
-    for (first = ((char *) base) + WORD_BYTES; first != last;
-         first += WORD_BYTES) {
-        /* Find the right place for |first|. My apologies for var reuse */
-        int *pl = (int *) (first - WORD_BYTES), *pr = (int *) first;
-        *(int *) pivot = *(int *) first;
-        for (; compare(pl, pivot) > 0; pr = pl, --pl) {
-            *pr = *pl;
+
+    for (pass = 0; pass < 4; ++pass) {
+        Uint32 *offsets = counts[pass];
+        Uint32 offset = 0, count;
+        int shift = pass * 8;
+
+        /* Skip digits that are the same in every key */
+        if (offsets[(keys[0].key >> shift) & 0xFF] == nmemb) {
+            continue;
+        }
+        for (i = 0; i < 256; ++i) {
+            count = offsets[i];
+            offsets[i] = offset;
+            offset += count;
+        }
+        for (i = 0; i < nmemb; ++i) {
+            temp[offsets[(keys[i].key >> shift) & 0xFF]++] = keys[i];
         }
-        if (pr != (int *) first)
-            *pr = *(int *) pivot;
+        swap = keys;
+        keys = temp;
+        temp = swap;
     }
-    free(pivot);
+    return keys;
 }
 
-/* ---------------------------------------------------------------------- */
+static SDL_RadixKey64 *
+SDL_RadixSortKeys64(SDL_RadixKey64 *keys, SDL_RadixKey64 *temp, size_t nmemb)
+{
+    Uint32 counts[8][256];
+    SDL_RadixKey64 *swap;
+    size_t i;
+    int pass;
+
+    SDL_zero(counts);
+    for (i = 0; i < nmemb; ++i) {
+        Uint64 key = keys[i].key;
+        for (pass = 0; pass < 8; ++pass) {
+            ++counts[pass][(key >> (pass * 8)) & 0xFF];
+        }
+    }
 
-void
-qsort(void *base, size_t nmemb, size_t size,
-      int (*compare) (const void *, const void *))
+    for (pass = 0; pass < 8; ++pass) {
+        Uint32 *offsets = counts[pass];
+        Uint32 offset = 0, count;
+        int shift = pass * 8;
+
+        if (offsets[(keys[0].key >> shift) & 0xFF] == nmemb) {
+            continue;
+        }
+        for (i = 0; i < 256; ++i) {
+            count = offsets[i];
+            offsets[i] = offset;
+            offset += count;
+        }
+        for (i = 0; i < nmemb; ++i) {
+            temp[offsets[(keys[i].key >> shift) & 0xFF]++] = keys[i];
+        }
+        swap = keys;
+        keys = temp;
+        temp = swap;
+    }
+    return keys;
+}
+
+int
+SDL_RadixSort(void *base, size_t nmemb, size_t size, size_t key_offset,
+              SDL_SortKeyType key_type)
 {
+    char *elements = (char *) base;
+    char *sorted;
+    size_t value_size, key_size, i;
+    void *memory;
+
+    switch (key_type) {
+    case SDL_SORTKEY_UINT32:
+    case SDL_SORTKEY_SINT32:
+    case SDL_SORTKEY_FLOAT:
+        value_size = sizeof(Uint32);
+        key_size = sizeof(SDL_RadixKey32);
+        break;
+    case SDL_SORTKEY_UINT64:
+    case SDL_SORTKEY_SINT64:
+    case SDL_SORTKEY_DOUBLE:
+        value_size = sizeof(Uint64);
+        key_size = sizeof(SDL_RadixKey64);
+        break;
+    default:
+        SDL_InvalidParamError("key_type");
+        return -1;
+    }
+    if (!base && nmemb > 0) {
+        SDL_InvalidParamError("base");
+        return -1;
+    }
+    if (size < value_size || key_offset > size - value_size) {
+        SDL_InvalidParamError("key_offset");
+        return -1;
+    }
+    if (nmemb > 0xFFFFFFFF || nmemb > ~(size_t)0 / (2 * key_size + size)) {
+        SDL_InvalidParamError("nmemb");
+        return -1;
+    }
+    if (nmemb <= 1) {
+        return 0;
+    }
 
-    if (nmemb <= 1)
-        return;
-    if (((uintptr_t) base | size) & (WORD_BYTES - 1))
-        qsort_nonaligned(base, nmemb, size, compare);
-    else if (size != WORD_BYTES)
-        qsort_aligned(base, nmemb, size, compare);
-    else
-        qsort_words(base, nmemb, compare);
+    /* Two arrays of keys to sort between, and room for the sorted elements */
+    memory = SDL_malloc(nmemb * (2 * key_size + size));
+    if (!memory) {
+        SDL_OutOfMemory();
+        return -1;
+    }
+    sorted = (char *) memory + nmemb * 2 * key_size;
+
+    if (key_size == sizeof(SDL_RadixKey32)) {
+        SDL_RadixKey32 *keys = (SDL_RadixKey32 *) memory;
+
+        for (i = 0; i < nmemb; ++i) {
+            keys[i].key = SDL_GetRadixKey32(elements + i * size + key_offset,
+                                            key_type);
+            keys[i].index = (Uint32) i;
+        }
+        keys = SDL_RadixSortKeys32(keys, keys + nmemb, nmemb);
+        for (i = 0; i < nmemb; ++i) {
+            SDL_memcpy(sorted + i * size, elements + keys[i].index * size,
+                       size);
+        }
+    } else {
+        SDL_RadixKey64 *keys = (SDL_RadixKey64 *) memory;
+
+        for (i = 0; i < nmemb; ++i) {
+            keys[i].key = SDL_GetRadixKey64(elements + i * size + key_offset,
+                                            key_type);
+            keys[i].index = (Uint32) i;
+        }
+        keys = SDL_RadixSortKeys64(keys, keys + nmemb, nmemb);
+        for (i = 0; i < nmemb; ++i) {
+            SDL_memcpy(sorted + i * size,
+                       elements + (size_t) keys[i].index * size, size);
+        }
+    }
+    SDL_memcpy(elements, sorted, nmemb * size);
+
+    SDL_free(memory);
+    return 0;
 }
 
-#endif /* !HAVE_QSORT */
 /* vi: set ts=4 sw=4 expandtab: */
@@ -224,6 +224,7 @@ int
 SDLTest_RunTest(SDLTest_TestSuiteReference *testSuite, SDLTest_TestCaseReference *testCase, Uint64 execKey)
 {
 	SDL_TimerID timer = 0;
+	int testCaseResult;
 	int testResult = 0;
 	int fuzzerCount;
 
@@ -259,9 +260,14 @@ SDLTest_RunTest(SDLTest_TestSuiteReference *testSuite, SDLTest_TestCaseReference
 	}
 
 	// Run test case function
-	testCase->testCase(0x0);
+	testCaseResult = testCase->testCase(0x0);
 	testResult = SDLTest_AssertSummaryToTestResult();
 
+	// A test that skips itself is skipped unless an assert already failed
+	if (testCaseResult == TEST_SKIPPED && testResult != TEST_RESULT_FAILED) {
+		testResult = TEST_RESULT_SKIPPED;
+	}
+
 	// Maybe run suite cleanup function (ignore failed asserts)
 	if (testSuite->testTearDown) {
 		testSuite->testTearDown(0x0);
@@ -550,6 +556,9 @@ int SDLTest_RunSuites(SDLTest_TestSuiteReference *testSuites[], const char *user
 					case TEST_RESULT_NO_ASSERT:
 						SDLTest_LogError((char *)SDLTest_FinalResultFormat,"Test", currentTestName, "No Asserts");
 						break;
+					case TEST_RESULT_SKIPPED:
+						SDLTest_Log((char *)SDLTest_FinalResultFormat, "Test", currentTestName, "Skipped");
+						break;
 					}
 
 				}
@@ -0,0 +1,681 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* The SDL job system: a fixed pool of workers with work stealing */
+
+#include "SDL_jobs.h"
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_thread.h"
+#include "SDL_timer.h"
+#include "SDL_hints.h"
+#include "SDL_jobs_c.h"
+#include "../stdlib/SDL_memory_c.h"
+
+/* Each worker deque holds this many jobs, extra jobs go to the global queue */
+#define SDL_JOB_DEQUE_SIZE  1024
+#define SDL_JOB_DEQUE_MASK  (SDL_JOB_DEQUE_SIZE - 1)
+
+/* SDL_ParallelFor() splits a range into at most this many jobs per thread */
+#define SDL_JOB_SPLITS_PER_THREAD   4
+
+typedef struct SDL_Job
+{
+    SDL_JobFunction function;
+    void *data;
+    SDL_ParallelForFunction range_function;
+    int start;
+    int end;
+    SDL_JobCounter *counter;
+    SDL_bool allocated;
+    struct SDL_Job *next;
+} SDL_Job;
+
+struct SDL_JobCounter
+{
+    SDL_atomic_t count;
+    SDL_atomic_t waiting;
+    SDL_sem *sem;
+
+    /* Threads still touching the counter after the count dropped */
+    SDL_atomic_t busy;
+
+    /* Jobs waiting for this counter to reach zero */
+    SDL_SpinLock lock;
+    SDL_Job *dependents;
+};
+
+/* A Chase-Lev work stealing deque.
+ *
+ * The owning worker pushes and pops jobs at the bottom, other threads
+ * steal jobs from the top.  The only contended operation is taking the
+ * last job, which is settled with a compare-and-swap on the top index.
+ */
+typedef struct
+{
+    SDL_atomic_t top;
+    char cache_pad1[SDL_CACHELINE_SIZE - sizeof(SDL_atomic_t)];
+    SDL_atomic_t bottom;
+    char cache_pad2[SDL_CACHELINE_SIZE - sizeof(SDL_atomic_t)];
+    SDL_Job * volatile jobs[SDL_JOB_DEQUE_SIZE];
+} SDL_JobDeque;
+
+typedef struct
+{
+    SDL_Thread *thread;
+    SDL_threadID threadID;
+    Uint32 seed;
+    SDL_JobDeque deque;
+} SDL_JobWorker;
+
+typedef struct
+{
+    SDL_SpinLock init_lock;
+    volatile SDL_bool active;
+    volatile SDL_bool failed;
+    int num_workers;
+    SDL_JobWorker *workers;
+
+    /* Jobs queued by threads outside the pool, or that didn't fit */
+    SDL_SpinLock lock;
+    SDL_Job * volatile head;
+    SDL_Job *tail;
+
+    /* Workers sleep on this when there is nothing to do */
+    SDL_atomic_t sleeping;
+    SDL_sem *wakeup;
+} SDL_JobData;
+
+static SDL_JobData SDL_job_data;
+
+
+/* Index arithmetic is done unsigned so the indices may wrap around */
+#define SDL_JobDequeSize(t, b)  ((int)((Uint32)(b) - (Uint32)(t)))
+
+/* Reading with an atomic add is a full memory barrier on every platform */
+#define SDL_JobAtomicLoad(a)    SDL_AtomicAdd(a, 0)
+
+static SDL_bool
+SDL_PushJobDeque(SDL_JobDeque *deque, SDL_Job *job)
+{
+    int b = deque->bottom.value;
+    int t = SDL_AtomicGet(&deque->top);
+
+    if (SDL_JobDequeSize(t, b) >= SDL_JOB_DEQUE_SIZE) {
+        return SDL_FALSE;
+    }
+    deque->jobs[b & SDL_JOB_DEQUE_MASK] = job;
+
+    /* Publish the job before the new bottom becomes visible */
+    SDL_AtomicSet(&deque->bottom, (int)((Uint32)b + 1));
+    return SDL_TRUE;
+}
+
+static SDL_Job *
+SDL_PopJobDeque(SDL_JobDeque *deque)
+{
+    int b = (int)((Uint32)deque->bottom.value - 1);
+    int t;
+    SDL_Job *job;
+
+    /* Reserve the bottom job before looking at the top */
+    SDL_AtomicSet(&deque->bottom, b);
+    t = SDL_JobAtomicLoad(&deque->top);
+
+    if (SDL_JobDequeSize(t, b) < 0) {
+        /* The deque was empty */
+        SDL_AtomicSet(&deque->bottom, t);
+        return NULL;
+    }
+
+    job = deque->jobs[b & SDL_JOB_DEQUE_MASK];
+    if (SDL_JobDequeSize(t, b) == 0) {
+        /* This is the last job, race the thieves for it */
+        if (!SDL_AtomicCAS(&deque->top, t, (int)((Uint32)t + 1))) {
+            job = NULL;
+        }
+        SDL_AtomicSet(&deque->bottom, (int)((Uint32)t + 1));
+    }
+    return job;
+}
+
+static SDL_Job *
+SDL_StealJobDeque(SDL_JobDeque *deque)
+{
+    int t = SDL_JobAtomicLoad(&deque->top);
+    int b = SDL_JobAtomicLoad(&deque->bottom);
+    SDL_Job *job;
+
+    if (SDL_JobDequeSize(t, b) <= 0) {
+        return NULL;
+    }
+
+    job = deque->jobs[t & SDL_JOB_DEQUE_MASK];
+    if (!SDL_AtomicCAS(&deque->top, t, (int)((Uint32)t + 1))) {
+        /* Lost the race with another thief or the owner */
+        return NULL;
+    }
+    return job;
+}
+
+static SDL_JobWorker *
+SDL_GetCurrentJobWorker(SDL_JobData *data)
+{
+    SDL_threadID threadID;
+    int i;
+
+    if (!data->active) {
+        return NULL;
+    }
+
+    threadID = SDL_ThreadID();
+    for (i = 0; i < data->num_workers; ++i) {
+        if (data->workers[i].threadID == threadID) {
+            return &data->workers[i];
+        }
+    }
+    return NULL;
+}
+
+static void
+SDL_QueueJob(SDL_JobData *data, SDL_Job *job)
+{
+    SDL_JobWorker *worker = SDL_GetCurrentJobWorker(data);
+
+    if (!worker || !SDL_PushJobDeque(&worker->deque, job)) {
+        job->next = NULL;
+        SDL_AtomicLock(&data->lock);
+        if (data->head) {
+            data->tail->next = job;
+        } else {
+            data->head = job;
+        }
+        data->tail = job;
+        SDL_AtomicUnlock(&data->lock);
+    }
+
+    /* Wake up a worker if they're all asleep */
+    if (SDL_JobAtomicLoad(&data->sleeping) > 0) {
+        SDL_SemPost(data->wakeup);
+    }
+}
+
+static SDL_Job *
+SDL_GetJob(SDL_JobData *data, SDL_JobWorker *worker)
+{
+    SDL_Job *job = NULL;
+    int i, victim;
+
+    /* Newest work from our own deque first, it's likely still in cache */
+    if (worker) {
+        job = SDL_PopJobDeque(&worker->deque);
+        if (job) {
+            return job;
+        }
+    }
+
+    /* Then anything queued from outside the pool */
+    if (SDL_AtomicGetPtr((void **)&data->head)) {
+        SDL_AtomicLock(&data->lock);
+        job = data->head;
+        if (job) {
+            data->head = job->next;
+        }
+        SDL_AtomicUnlock(&data->lock);
+        if (job) {
+            return job;
+        }
+    }
+
+    /* Then try to steal the oldest work from somebody else */
+    if (worker) {
+        worker->seed = worker->seed * 1103515245 + 12345;
+        victim = (int)((worker->seed >> 16) % data->num_workers);
+    } else {
+        victim = 0;
+    }
+    for (i = 0; i < data->num_workers; ++i) {
+        SDL_JobWorker *other = &data->workers[(victim + i) % data->num_workers];
+        if (other != worker) {
+            job = SDL_StealJobDeque(&other->deque);
+            if (job) {
+                break;
+            }
+        }
+    }
+    return job;
+}
+
+static void
+SDL_FinishJobCounter(SDL_JobData *data, SDL_JobCounter *counter)
+{
+    SDL_Job *dependents, *job;
+
+    /* The counter may be destroyed as soon as the count reaches zero,
+       so let waiters know we're still using it.
+     */
+    SDL_AtomicIncRef(&counter->busy);
+    if (!SDL_AtomicDecRef(&counter->count)) {
+        SDL_AtomicAdd(&counter->busy, -1);
+        return;
+    }
+
+    /* Release any jobs that were waiting for this counter */
+    SDL_AtomicLock(&counter->lock);
+    dependents = counter->dependents;
+    counter->dependents = NULL;
+    SDL_AtomicUnlock(&counter->lock);
+
+    while (dependents) {
+        job = dependents;
+        dependents = job->next;
+        SDL_QueueJob(data, job);
+    }
+
+    if (SDL_JobAtomicLoad(&counter->waiting) > 0) {
+        SDL_SemPost(counter->sem);
+    }
+    SDL_AtomicAdd(&counter->busy, -1);
+}
+
+static void
+SDL_RunJobInternal(SDL_JobData *data, SDL_Job *job)
+{
+    SDL_JobCounter *counter = job->counter;
+
+    if (job->range_function) {
+        job->range_function(job->start, job->end, job->data);
+    } else {
+        job->function(job->data);
+    }
+
+    if (job->allocated) {
+        SDL_FreeMemory(job);
+    }
+    if (counter) {
+        SDL_FinishJobCounter(data, counter);
+    }
+}
+
+static int
+SDL_JobWorkerThread(void *_worker)
+{
+    SDL_JobData *data = &SDL_job_data;
+    SDL_JobWorker *worker = (SDL_JobWorker *)_worker;
+    SDL_Job *job;
+
+    worker->threadID = SDL_ThreadID();
+
+    while (data->active) {
+        job = SDL_GetJob(data, worker);
+        if (!job) {
+            /* Announce that we're going to sleep, then check one last time
+               so we don't miss a job queued in the meantime.
+             */
+            SDL_AtomicIncRef(&data->sleeping);
+            job = SDL_GetJob(data, worker);
+            if (!job && data->active) {
+                SDL_SemWait(data->wakeup);
+            }
+            SDL_AtomicAdd(&data->sleeping, -1);
+        }
+        if (job) {
+            SDL_RunJobInternal(data, job);
+        }
+    }
+    return 0;
+}
+
+static int
+SDL_JobsInit(void)
+{
+    SDL_JobData *data = &SDL_job_data;
+    int i, num_workers;
+
+    if (data->active) {
+        return 0;
+    }
+
+    SDL_AtomicLock(&data->init_lock);
+    if (!data->active && !data->failed) {
+        const char *hint = SDL_GetHint(SDL_HINT_JOB_THREADS);
+        if (hint) {
+            num_workers = SDL_atoi(hint);
+        } else {
+            num_workers = SDL_GetCPUCount() - 1;
+        }
+        if (num_workers < 1) {
+            num_workers = 1;
+        }
+
+        data->wakeup = SDL_CreateSemaphore(0);
+        data->workers = (SDL_JobWorker *)SDL_calloc(num_workers, sizeof(*data->workers));
+        if (!data->wakeup || !data->workers) {
+            data->failed = SDL_TRUE;
+        } else {
+            data->num_workers = num_workers;
+            data->active = SDL_TRUE;
+            for (i = 0; i < num_workers; ++i) {
+                const char *name = "SDLJobWorker";
+                SDL_JobWorker *worker = &data->workers[i];
+
+                worker->seed = (Uint32)i;
+                /* !!! FIXME: this is nasty. */
+#if defined(__WIN32__) && !defined(HAVE_LIBC)
+#undef SDL_CreateThread
+                worker->thread = SDL_CreateThread(SDL_JobWorkerThread, name, worker, NULL, NULL);
+#else
+                worker->thread = SDL_CreateThread(SDL_JobWorkerThread, name, worker);
+#endif
+                if (!worker->thread) {
+                    break;
+                }
+            }
+            if (i == 0) {
+                /* No threads at all, run jobs on the calling thread */
+                data->active = SDL_FALSE;
+                data->failed = SDL_TRUE;
+            }
+            data->num_workers = i;
+        }
+
+        if (data->failed) {
+            if (data->wakeup) {
+                SDL_DestroySemaphore(data->wakeup);
+                data->wakeup = NULL;
+            }
+            if (data->workers) {
+                SDL_free(data->workers);
+                data->workers = NULL;
+            }
+            data->num_workers = 0;
+        }
+    }
+    SDL_AtomicUnlock(&data->init_lock);
+
+    return data->active ? 0 : -1;
+}
+
+void
+SDL_JobsQuit(void)
+{
+    SDL_JobData *data = &SDL_job_data;
+    SDL_Job *job;
+    int i;
+
+    SDL_AtomicLock(&data->init_lock);
+    if (data->active) {
+        data->active = SDL_FALSE;
+
+        /* Wake everybody up and wait for them to finish */
+        for (i = 0; i < data->num_workers; ++i) {
+            SDL_SemPost(data->wakeup);
+        }
+        for (i = 0; i < data->num_workers; ++i) {
+            SDL_WaitThread(data->workers[i].thread, NULL);
+        }
+
+        /* Run whatever was left over, so counters still finish */
+        for (i = 0; i < data->num_workers; ++i) {
+            while ((job = SDL_PopJobDeque(&data->workers[i].deque)) != NULL) {
+                SDL_RunJobInternal(data, job);
+            }
+        }
+        while (data->head) {
+            job = data->head;
+            data->head = job->next;
+            SDL_RunJobInternal(data, job);
+        }
+
+        SDL_free(data->workers);
+        data->workers = NULL;
+        data->num_workers = 0;
+        SDL_DestroySemaphore(data->wakeup);
+        data->wakeup = NULL;
+    }
+    data->failed = SDL_FALSE;
+    SDL_AtomicUnlock(&data->init_lock);
+}
+
+/* Wait for the last job to let go of a counter that has reached zero */
+static void
+SDL_ReleaseJobCounter(SDL_JobCounter *counter)
+{
+    while (SDL_JobAtomicLoad(&counter->busy) > 0) {
+        SDL_Delay(0);
+    }
+}
+
+SDL_JobCounter *
+SDL_CreateJobCounter(void)
+{
+    SDL_JobCounter *counter;
+
+    counter = (SDL_JobCounter *)SDL_CallocMemory(SDL_MEMORY_JOBS, 1, sizeof(*counter));
+    if (!counter) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    counter->sem = SDL_CreateSemaphore(0);
+    if (!counter->sem) {
+        SDL_FreeMemory(counter);
+        return NULL;
+    }
+    return counter;
+}
+
+void
+SDL_DestroyJobCounter(SDL_JobCounter * counter)
+{
+    if (counter) {
+        SDL_ReleaseJobCounter(counter);
+        SDL_DestroySemaphore(counter->sem);
+        SDL_FreeMemory(counter);
+    }
+}
+
+static int
+SDL_StartJob(SDL_JobFunction fn, void *data, SDL_JobCounter * dependency,
+             SDL_JobCounter * counter)
+{
+    SDL_Job *job;
+
+    if (!fn) {
+        SDL_InvalidParamError("fn");
+        return -1;
+    }
+
+    job = (SDL_Job *)SDL_AllocMemory(SDL_MEMORY_JOBS, sizeof(*job));
+    if (!job) {
+        SDL_OutOfMemory();
+        return -1;
+    }
+    job->function = fn;
+    job->data = data;
+    job->range_function = NULL;
+    job->counter = counter;
+    job->allocated = SDL_TRUE;
+    job->next = NULL;
+
+    if (counter) {
+        SDL_AtomicIncRef(&counter->count);
+    }
+
+    if (SDL_JobsInit() < 0) {
+        /* No worker threads, just run it here */
+        if (dependency) {
+            SDL_WaitJobCounter(dependency);
+        }
+        SDL_RunJobInternal(&SDL_job_data, job);
+        return 0;
+    }
+
+    if (dependency) {
+        SDL_AtomicLock(&dependency->lock);
+        if (SDL_AtomicGet(&dependency->count) > 0) {
+            job->next = dependency->dependents;
+            dependency->dependents = job;
+            job = NULL;
+        }
+        SDL_AtomicUnlock(&dependency->lock);
+    }
+    if (job) {
+        SDL_QueueJob(&SDL_job_data, job);
+    }
+    return 0;
+}
+
+int
+SDL_RunJob(SDL_JobFunction fn, void *data, SDL_JobCounter * counter)
+{
+    return SDL_StartJob(fn, data, NULL, counter);
+}
+
+int
+SDL_RunJobAfter(SDL_JobFunction fn, void *data, SDL_JobCounter * dependency,
+                SDL_JobCounter * counter)
+{
+    return SDL_StartJob(fn, data, dependency, counter);
+}
+
+void
+SDL_WaitJobCounter(SDL_JobCounter * counter)
+{
+    SDL_JobData *data = &SDL_job_data;
+    SDL_JobWorker *worker;
+    SDL_Job *job;
+
+    if (!counter) {
+        return;
+    }
+
+    worker = SDL_GetCurrentJobWorker(data);
+    while (SDL_AtomicGet(&counter->count) > 0) {
+        /* Help out while we wait */
+        if (data->active) {
+            job = SDL_GetJob(data, worker);
+            if (job) {
+                SDL_RunJobInternal(data, job);
+                continue;
+            }
+        }
+
+        /* Everything left is running on other threads, block until it's
+           done, but check back for new work every now and then.
+         */
+        SDL_AtomicIncRef(&counter->waiting);
+        if (SDL_JobAtomicLoad(&counter->count) > 0) {
+            SDL_SemWaitTimeout(counter->sem, 1);
+        }
+        SDL_AtomicAdd(&counter->waiting, -1);
+    }
+
+    SDL_ReleaseJobCounter(counter);
+}
+
+int
+SDL_ParallelFor(int start, int end, int grain, SDL_ParallelForFunction fn,
+                void *data)
+{
+    SDL_JobCounter *counter;
+    SDL_Job *jobs;
+    int i, count, num_jobs, max_jobs;
+
+    if (!fn) {
+        SDL_InvalidParamError("fn");
+        return -1;
+    }
+    if (end <= start) {
+        return 0;
+    }
+
+    count = end - start;
+    if (SDL_JobsInit() < 0) {
+        fn(start, end, data);
+        return 0;
+    }
+
+    /* Split the range up, but not into more jobs than we can use */
+    max_jobs = (SDL_job_data.num_workers + 1) * SDL_JOB_SPLITS_PER_THREAD;
+    if (grain <= 0) {
+        grain = 1;
+    }
+    if (grain < (count + max_jobs - 1) / max_jobs) {
+        grain = (count + max_jobs - 1) / max_jobs;
+    }
+    num_jobs = (count + grain - 1) / grain;
+    if (num_jobs <= 1) {
+        fn(start, end, data);
+        return 0;
+    }
+
+    counter = SDL_CreateJobCounter();
+    jobs = (SDL_Job *)SDL_AllocMemory(SDL_MEMORY_JOBS, num_jobs * sizeof(*jobs));
+    if (!counter || !jobs) {
+        SDL_DestroyJobCounter(counter);
+        SDL_FreeMemory(jobs);
+        fn(start, end, data);
+        return 0;
+    }
+
+    SDL_AtomicSet(&counter->count, num_jobs);
+    for (i = 0; i < num_jobs; ++i) {
+        SDL_Job *job = &jobs[i];
+
+        job->function = NULL;
+        job->data = data;
+        job->range_function = fn;
+        job->start = start + i * grain;
+        job->end = SDL_min(job->start + grain, end);
+        job->counter = counter;
+        job->allocated = SDL_FALSE;
+        job->next = NULL;
+    }
+
+    /* Queue all but the first chunk, which we'll run ourselves */
+    for (i = 1; i < num_jobs; ++i) {
+        SDL_QueueJob(&SDL_job_data, &jobs[i]);
+    }
+    SDL_RunJobInternal(&SDL_job_data, &jobs[0]);
+    SDL_WaitJobCounter(counter);
+
+    SDL_DestroyJobCounter(counter);
+    SDL_FreeMemory(jobs);
+    return 0;
+}
+
+SDL_bool
+SDL_JobWorkersRunning(void)
+{
+    return SDL_job_data.active;
+}
+
+int
+SDL_GetJobWorkerCount(void)
+{
+    if (SDL_JobsInit() < 0) {
+        return 0;
+    }
+    return SDL_job_data.num_workers;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
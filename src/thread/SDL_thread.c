@@ -22,158 +22,248 @@
 
 /* System independent thread management routines for SDL */
 
+#include "SDL_atomic.h"
 #include "SDL_mutex.h"
 #include "SDL_thread.h"
 #include "SDL_thread_c.h"
 #include "SDL_systhread.h"
 #include "../SDL_error_c.h"
 
-#define ARRAY_CHUNKSIZE	32
-/* The array of threads currently active in the application
-   (except the main thread)
-   The manipulation of an array here is safer than using a linked list.
-*/
-static int SDL_maxthreads = 0;
-static int SDL_numthreads = 0;
-static SDL_Thread **SDL_Threads = NULL;
-static SDL_mutex *thread_lock = NULL;
+SDL_TLSID
+SDL_TLSCreate(void)
+{
+    static SDL_atomic_t SDL_tls_id;
+    return SDL_AtomicIncRef(&SDL_tls_id)+1;
+}
 
-static int
-SDL_ThreadsInit(void)
+void *
+SDL_TLSGet(SDL_TLSID id)
 {
-    int retval;
+    SDL_TLSData *storage;
 
-    retval = 0;
-    thread_lock = SDL_CreateMutex();
-    if (thread_lock == NULL) {
-        retval = -1;
+    storage = SDL_SYS_GetTLSData();
+    if (!storage || id == 0 || id > storage->limit) {
+        return NULL;
     }
-    return (retval);
+    return storage->array[id-1].data;
 }
 
-/* This should never be called...
-   If this is called by SDL_Quit(), we don't know whether or not we should
-   clean up threads here.  If any threads are still running after this call,
-   they will no longer have access to any per-thread data.
- */
-#if 0
-static void
-SDL_ThreadsQuit(void)
+/* This doesn't set an error, so it's safe to use for the error buffer */
+static int
+SDL_TLSSetInternal(SDL_TLSID id, const void *value, void (SDLCALL *destructor)(void *))
 {
-    SDL_mutex *mutex;
+    SDL_TLSData *storage;
+
+    storage = SDL_SYS_GetTLSData();
+    if (!storage || (id > storage->limit)) {
+        unsigned int i, oldlimit, newlimit;
 
-    mutex = thread_lock;
-    thread_lock = NULL;
-    if (mutex != NULL) {
-        SDL_DestroyMutex(mutex);
+        oldlimit = storage ? storage->limit : 0;
+        newlimit = (id + TLS_ALLOC_CHUNKSIZE);
+        storage = (SDL_TLSData *)SDL_realloc(storage, sizeof(*storage)+(newlimit-1)*sizeof(storage->array[0]));
+        if (!storage) {
+            return -1;
+        }
+        storage->limit = newlimit;
+        for (i = oldlimit; i < newlimit; ++i) {
+            storage->array[i].data = NULL;
+            storage->array[i].destructor = NULL;
+        }
+        if (SDL_SYS_SetTLSData(storage) != 0) {
+            /* The old block is gone, don't leave the thread pointing at it */
+            SDL_free(storage);
+            SDL_SYS_SetTLSData(NULL);
+            return -1;
+        }
     }
+
+    storage->array[id-1].data = (void *)value;
+    storage->array[id-1].destructor = destructor;
+    return 0;
 }
-#endif
 
-/* Routines for manipulating the thread list */
-static void
-SDL_AddThread(SDL_Thread * thread)
+int
+SDL_TLSSet(SDL_TLSID id, const void *value, void (SDLCALL *destructor)(void *))
 {
-    /* WARNING:
-       If the very first threads are created simultaneously, then
-       there could be a race condition causing memory corruption.
-       In practice, this isn't a problem because by definition there
-       is only one thread running the first time this is called.
-     */
-    if (!thread_lock) {
-        if (SDL_ThreadsInit() < 0) {
-            return;
-        }
+    if (id == 0) {
+        SDL_InvalidParamError("id");
+        return -1;
+    }
+    if (SDL_TLSSetInternal(id, value, destructor) < 0) {
+        SDL_SetError("Couldn't set thread local storage");
+        return -1;
     }
-    SDL_mutexP(thread_lock);
+    return 0;
+}
 
-    /* Expand the list of threads, if necessary */
-#ifdef DEBUG_THREADS
-    printf("Adding thread (%d already - %d max)\n",
-           SDL_numthreads, SDL_maxthreads);
-#endif
-    if (SDL_numthreads == SDL_maxthreads) {
-        SDL_Thread **threads;
-        threads = (SDL_Thread **) SDL_realloc(SDL_Threads,
-                                              (SDL_maxthreads +
-                                               ARRAY_CHUNKSIZE) *
-                                              (sizeof *threads));
-        if (threads == NULL) {
-            SDL_OutOfMemory();
-            goto done;
+void
+SDL_TLSDestroyData(SDL_TLSData *storage)
+{
+    unsigned int i;
+
+    for (i = 0; i < storage->limit; ++i) {
+        if (storage->array[i].destructor) {
+            storage->array[i].destructor(storage->array[i].data);
         }
-        SDL_maxthreads += ARRAY_CHUNKSIZE;
-        SDL_Threads = threads;
     }
-    SDL_Threads[SDL_numthreads++] = thread;
-  done:
-    SDL_mutexV(thread_lock);
+    SDL_free(storage);
 }
 
-static void
-SDL_DelThread(SDL_Thread * thread)
+void
+SDL_TLSCleanup()
 {
-    int i;
+    SDL_TLSData *storage;
 
-    if (!thread_lock) {
-        return;
+    storage = SDL_SYS_GetTLSData();
+    if (storage) {
+        SDL_SYS_SetTLSData(NULL);
+        SDL_TLSDestroyData(storage);
     }
-    SDL_mutexP(thread_lock);
-    for (i = 0; i < SDL_numthreads; ++i) {
-        if (thread == SDL_Threads[i]) {
+}
+
+
+/* This is a generic implementation of thread-local storage which doesn't
+   require additional OS support.
+
+   It is not especially efficient, and it only cleans up after threads
+   created with SDL_CreateThread().  If there is a real OS that doesn't
+   support thread-local storage this implementation should be improved
+   to be production quality.
+*/
+
+typedef struct SDL_TLSEntry {
+    SDL_threadID thread;
+    SDL_TLSData *storage;
+    struct SDL_TLSEntry *next;
+} SDL_TLSEntry;
+
+static SDL_mutex *SDL_generic_TLS_mutex;
+static SDL_TLSEntry *SDL_generic_TLS;
+
+
+SDL_TLSData *
+SDL_Generic_GetTLSData()
+{
+    SDL_threadID thread = SDL_ThreadID();
+    SDL_TLSEntry *entry;
+    SDL_TLSData *storage = NULL;
+
+    if (!SDL_generic_TLS_mutex) {
+        static SDL_SpinLock tls_lock;
+        SDL_AtomicLock(&tls_lock);
+        if (!SDL_generic_TLS_mutex) {
+            SDL_mutex *mutex = SDL_CreateMutex();
+            SDL_generic_TLS_mutex = mutex;
+            if (!SDL_generic_TLS_mutex) {
+                SDL_AtomicUnlock(&tls_lock);
+                return NULL;
+            }
+        }
+        SDL_AtomicUnlock(&tls_lock);
+    }
+
+    SDL_LockMutex(SDL_generic_TLS_mutex);
+    for (entry = SDL_generic_TLS; entry; entry = entry->next) {
+        if (entry->thread == thread) {
+            storage = entry->storage;
             break;
         }
     }
-    if (i < SDL_numthreads) {
-        if (--SDL_numthreads > 0) {
-            while (i < SDL_numthreads) {
-                SDL_Threads[i] = SDL_Threads[i + 1];
-                ++i;
+    SDL_UnlockMutex(SDL_generic_TLS_mutex);
+
+    return storage;
+}
+
+int
+SDL_Generic_SetTLSData(SDL_TLSData *storage)
+{
+    SDL_threadID thread = SDL_ThreadID();
+    SDL_TLSEntry *prev, *entry;
+
+    /* SDL_Generic_GetTLSData() is always called first, so we can assume SDL_generic_TLS_mutex */
+    SDL_LockMutex(SDL_generic_TLS_mutex);
+    prev = NULL;
+    for (entry = SDL_generic_TLS; entry; entry = entry->next) {
+        if (entry->thread == thread) {
+            if (storage) {
+                entry->storage = storage;
+            } else {
+                if (prev) {
+                    prev->next = entry->next;
+                } else {
+                    SDL_generic_TLS = entry->next;
+                }
+                SDL_free(entry);
             }
-        } else {
-            SDL_maxthreads = 0;
-            SDL_free(SDL_Threads);
-            SDL_Threads = NULL;
+            break;
         }
-#ifdef DEBUG_THREADS
-        printf("Deleting thread (%d left - %d max)\n",
-               SDL_numthreads, SDL_maxthreads);
-#endif
+        prev = entry;
     }
-    SDL_mutexV(thread_lock);
+    if (!entry && storage) {
+        entry = (SDL_TLSEntry *)SDL_malloc(sizeof(*entry));
+        if (entry) {
+            entry->thread = thread;
+            entry->storage = storage;
+            entry->next = SDL_generic_TLS;
+            SDL_generic_TLS = entry;
+        }
+    }
+    SDL_UnlockMutex(SDL_generic_TLS_mutex);
 
-#if 0   /* There could be memory corruption if another thread is starting */
-    if (SDL_Threads == NULL) {
-        SDL_ThreadsQuit();
+    if (!entry && storage) {
+        return -1;
     }
-#endif
+    return 0;
 }
 
-/* The default (non-thread-safe) global error variable */
-static SDL_error SDL_global_error;
-
 /* Routine to get the thread-specific error variable */
 SDL_error *
 SDL_GetErrBuf(void)
 {
+    static SDL_SpinLock tls_lock;
+    static SDL_bool tls_being_created;
+    static SDL_TLSID tls_errbuf;
+    static SDL_error SDL_global_errbuf;
+    const SDL_error *ALLOCATION_IN_PROGRESS = (SDL_error *)-1;
     SDL_error *errbuf;
 
-    errbuf = &SDL_global_error;
-    if (SDL_Threads) {
-        int i;
-        SDL_threadID this_thread;
-
-        this_thread = SDL_ThreadID();
-        SDL_mutexP(thread_lock);
-        for (i = 0; i < SDL_numthreads; ++i) {
-            if (this_thread == SDL_Threads[i]->threadid) {
-                errbuf = &SDL_Threads[i]->errbuf;
-                break;
-            }
+    /* tls_being_created is there simply to prevent recursion if SDL_TLSCreate() fails.
+       It also means it's possible for another thread to also use SDL_global_errbuf,
+       but that's very unlikely and hopefully won't cause issues.
+     */
+    if (!tls_errbuf && !tls_being_created) {
+        SDL_AtomicLock(&tls_lock);
+        if (!tls_errbuf) {
+            SDL_TLSID slot;
+            tls_being_created = SDL_TRUE;
+            slot = SDL_TLSCreate();
+            tls_being_created = SDL_FALSE;
+            tls_errbuf = slot;
+        }
+        SDL_AtomicUnlock(&tls_lock);
+    }
+    if (!tls_errbuf) {
+        return &SDL_global_errbuf;
+    }
+
+    errbuf = (SDL_error *)SDL_TLSGet(tls_errbuf);
+    if (errbuf == ALLOCATION_IN_PROGRESS) {
+        return &SDL_global_errbuf;
+    }
+    if (!errbuf) {
+        /* Mark that we're in the middle of allocating our buffer */
+        if (SDL_TLSSetInternal(tls_errbuf, ALLOCATION_IN_PROGRESS, NULL) < 0) {
+            return &SDL_global_errbuf;
         }
-        SDL_mutexV(thread_lock);
+        errbuf = (SDL_error *)SDL_malloc(sizeof(*errbuf));
+        if (!errbuf) {
+            SDL_TLSSetInternal(tls_errbuf, NULL, NULL);
+            return &SDL_global_errbuf;
+        }
+        SDL_zerop(errbuf);
+        SDL_TLSSetInternal(tls_errbuf, errbuf, SDL_free);
     }
-    return (errbuf);
+    return errbuf;
 }
 
 
@@ -207,6 +297,9 @@ SDL_RunThread(void *data)
 
     /* Run the function */
     *statusloc = userfunc(userdata);
+
+    /* Clean up thread-local storage */
+    SDL_TLSCleanup();
 }
 
 #ifdef SDL_PASSED_BEGINTHREAD_ENDTHREAD
@@ -264,9 +357,6 @@ SDL_CreateThread(int (SDLCALL * fn) (void *),
         return (NULL);
     }
 
-    /* Add the thread to the list of available threads */
-    SDL_AddThread(thread);
-
     /* Create the thread and go! */
 #ifdef SDL_PASSED_BEGINTHREAD_ENDTHREAD
     ret = SDL_SYS_CreateThread(thread, args, pfnBeginThread, pfnEndThread);
@@ -278,7 +368,6 @@ SDL_CreateThread(int (SDLCALL * fn) (void *),
         SDL_SemWait(args->wait);
     } else {
         /* Oops, failed.  Gotta free everything */
-        SDL_DelThread(thread);
         SDL_free(thread->name);
         SDL_free(thread);
         thread = NULL;
@@ -323,7 +412,6 @@ SDL_WaitThread(SDL_Thread * thread, int *status)
         if (status) {
             *status = thread->status;
         }
-        SDL_DelThread(thread);
         SDL_free(thread->name);
         SDL_free(thread);
     }
@@ -0,0 +1,191 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* An implementation of reader/writer locks using a mutex and condition
+   variables.  Writers waiting for the lock hold off new readers, so a
+   steady stream of readers can't starve them.
+ */
+
+#include "SDL_thread.h"
+
+struct SDL_rwlock
+{
+    SDL_mutex *lock;
+    SDL_cond *readers_cond;
+    SDL_cond *writers_cond;
+    int readers;
+    int writers_waiting;
+    SDL_threadID writer;
+};
+
+/* Create a reader/writer lock */
+SDL_rwlock *
+SDL_CreateRWLock(void)
+{
+    SDL_rwlock *rwlock;
+
+    rwlock = (SDL_rwlock *) SDL_calloc(1, sizeof(*rwlock));
+    if (rwlock) {
+        rwlock->lock = SDL_CreateMutex();
+        rwlock->readers_cond = SDL_CreateCond();
+        rwlock->writers_cond = SDL_CreateCond();
+        if (!rwlock->lock || !rwlock->readers_cond || !rwlock->writers_cond) {
+            SDL_DestroyRWLock(rwlock);
+            rwlock = NULL;
+        }
+    } else {
+        SDL_OutOfMemory();
+    }
+    return rwlock;
+}
+
+/* Free the reader/writer lock */
+void
+SDL_DestroyRWLock(SDL_rwlock * rwlock)
+{
+    if (rwlock) {
+        if (rwlock->writers_cond) {
+            SDL_DestroyCond(rwlock->writers_cond);
+        }
+        if (rwlock->readers_cond) {
+            SDL_DestroyCond(rwlock->readers_cond);
+        }
+        if (rwlock->lock) {
+            SDL_DestroyMutex(rwlock->lock);
+        }
+        SDL_free(rwlock);
+    }
+}
+
+int
+SDL_LockRWLockForReading(SDL_rwlock * rwlock)
+{
+    if (rwlock == NULL) {
+        SDL_SetError("Passed a NULL rwlock");
+        return -1;
+    }
+
+    SDL_LockMutex(rwlock->lock);
+    while (rwlock->writer || rwlock->writers_waiting) {
+        SDL_CondWait(rwlock->readers_cond, rwlock->lock);
+    }
+    ++rwlock->readers;
+    SDL_UnlockMutex(rwlock->lock);
+    return 0;
+}
+
+int
+SDL_LockRWLockForWriting(SDL_rwlock * rwlock)
+{
+    if (rwlock == NULL) {
+        SDL_SetError("Passed a NULL rwlock");
+        return -1;
+    }
+
+    SDL_LockMutex(rwlock->lock);
+    ++rwlock->writers_waiting;
+    while (rwlock->writer || rwlock->readers) {
+        SDL_CondWait(rwlock->writers_cond, rwlock->lock);
+    }
+    --rwlock->writers_waiting;
+    rwlock->writer = SDL_ThreadID();
+    SDL_UnlockMutex(rwlock->lock);
+    return 0;
+}
+
+int
+SDL_TryLockRWLockForReading(SDL_rwlock * rwlock)
+{
+    int retval = 0;
+
+    if (rwlock == NULL) {
+        SDL_SetError("Passed a NULL rwlock");
+        return -1;
+    }
+
+    SDL_LockMutex(rwlock->lock);
+    if (rwlock->writer || rwlock->writers_waiting) {
+        retval = SDL_MUTEX_TIMEDOUT;
+    } else {
+        ++rwlock->readers;
+    }
+    SDL_UnlockMutex(rwlock->lock);
+    return retval;
+}
+
+int
+SDL_TryLockRWLockForWriting(SDL_rwlock * rwlock)
+{
+    int retval = 0;
+
+    if (rwlock == NULL) {
+        SDL_SetError("Passed a NULL rwlock");
+        return -1;
+    }
+
+    SDL_LockMutex(rwlock->lock);
+    if (rwlock->writer || rwlock->readers) {
+        retval = SDL_MUTEX_TIMEDOUT;
+    } else {
+        rwlock->writer = SDL_ThreadID();
+    }
+    SDL_UnlockMutex(rwlock->lock);
+    return retval;
+}
+
+int
+SDL_UnlockRWLock(SDL_rwlock * rwlock)
+{
+    int retval = 0;
+
+    if (rwlock == NULL) {
+        SDL_SetError("Passed a NULL rwlock");
+        return -1;
+    }
+
+    SDL_LockMutex(rwlock->lock);
+    if (rwlock->writer) {
+        if (rwlock->writer == SDL_ThreadID()) {
+            rwlock->writer = 0;
+            /* Hand the lock to the next writer, or let all readers in */
+            if (rwlock->writers_waiting) {
+                SDL_CondSignal(rwlock->writers_cond);
+            } else {
+                SDL_CondBroadcast(rwlock->readers_cond);
+            }
+        } else {
+            SDL_SetError("rwlock not owned by this thread");
+            retval = -1;
+        }
+    } else if (rwlock->readers > 0) {
+        if (--rwlock->readers == 0 && rwlock->writers_waiting) {
+            SDL_CondSignal(rwlock->writers_cond);
+        }
+    } else {
+        SDL_SetError("rwlock not locked");
+        retval = -1;
+    }
+    SDL_UnlockMutex(rwlock->lock);
+    return retval;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
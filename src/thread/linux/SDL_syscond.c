@@ -0,0 +1,147 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* Condition variables implemented directly on Linux futexes.
+
+   Waiters sample a sequence number before releasing the mutex and sleep
+   until it changes. Every signal bumps the sequence, so a signal sent
+   between the release and the sleep is never lost.
+ */
+
+#include <limits.h>
+
+#include "SDL_sysmutex_c.h"
+
+struct SDL_cond
+{
+    SDL_atomic_t sequence;
+    SDL_atomic_t waiters;
+};
+
+/* Create a condition variable */
+SDL_cond *
+SDL_CreateCond(void)
+{
+    SDL_cond *cond;
+
+    cond = (SDL_cond *) SDL_calloc(1, sizeof(SDL_cond));
+    if (!cond) {
+        SDL_OutOfMemory();
+    }
+    return (cond);
+}
+
+/* Destroy a condition variable */
+void
+SDL_DestroyCond(SDL_cond * cond)
+{
+    if (cond) {
+        SDL_free(cond);
+    }
+}
+
+/* Restart one of the threads that are waiting on the condition variable */
+int
+SDL_CondSignal(SDL_cond * cond)
+{
+    if (!cond) {
+        SDL_SetError("Passed a NULL condition variable");
+        return -1;
+    }
+
+    if (SDL_AtomicGet(&cond->waiters) > 0) {
+        SDL_AtomicIncRef(&cond->sequence);
+        SDL_FutexWake(&cond->sequence, 1);
+    }
+    return 0;
+}
+
+/* Restart all threads that are waiting on the condition variable */
+int
+SDL_CondBroadcast(SDL_cond * cond)
+{
+    if (!cond) {
+        SDL_SetError("Passed a NULL condition variable");
+        return -1;
+    }
+
+    if (SDL_AtomicGet(&cond->waiters) > 0) {
+        SDL_AtomicIncRef(&cond->sequence);
+        SDL_FutexWake(&cond->sequence, INT_MAX);
+    }
+    return 0;
+}
+
+static int
+SDL_CondWaitDeadline(SDL_cond * cond, SDL_mutex * mutex,
+                     const struct timespec *deadline)
+{
+    int sequence, recursive, retval;
+
+    if (!cond) {
+        SDL_SetError("Passed a NULL condition variable");
+        return -1;
+    }
+    if (!mutex) {
+        SDL_SetError("Passed a NULL mutex");
+        return -1;
+    }
+
+    sequence = SDL_AtomicGet(&cond->sequence);
+    SDL_AtomicIncRef(&cond->waiters);
+
+    recursive = SDL_FutexUnlockForWait(mutex);
+    if (recursive < 0) {
+        SDL_AtomicAdd(&cond->waiters, -1);
+        return -1;
+    }
+
+    retval = SDL_FutexWait(&cond->sequence, sequence, deadline);
+
+    SDL_AtomicAdd(&cond->waiters, -1);
+    SDL_FutexRelockAfterWait(mutex, recursive);
+    return retval;
+}
+
+int
+SDL_CondWaitTimeout(SDL_cond * cond, SDL_mutex * mutex, Uint32 ms)
+{
+    struct timespec deadline;
+
+    if (ms == SDL_MUTEX_MAXWAIT) {
+        return SDL_CondWaitDeadline(cond, mutex, NULL);
+    }
+
+    SDL_FutexDeadline(&deadline, ms);
+    return SDL_CondWaitDeadline(cond, mutex, &deadline);
+}
+
+/* Wait on the condition variable, unlocking the provided mutex.
+   The mutex must be locked before entering this function!
+ */
+int
+SDL_CondWait(SDL_cond * cond, SDL_mutex * mutex)
+{
+    return SDL_CondWaitDeadline(cond, mutex, NULL);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,231 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* Mutexes implemented directly on Linux futexes.
+
+   The lock word follows "Futexes Are Tricky" by Ulrich Drepper: an
+   uncontended lock is a single compare-and-swap and an uncontended unlock
+   is a single atomic decrement. Contended lockers spin briefly and then
+   sleep in the kernel, marking the lock so the owner knows to wake them.
+ */
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "SDL_cpuinfo.h"
+#include "SDL_sysmutex_c.h"
+
+#ifndef FUTEX_PRIVATE_FLAG
+#define FUTEX_WAIT_PRIVATE  FUTEX_WAIT
+#define FUTEX_WAKE_PRIVATE  FUTEX_WAKE
+#endif
+
+int
+SDL_FutexSpinCount(void)
+{
+    static int spin_count = -1;
+
+    if (spin_count < 0) {
+        spin_count = (SDL_GetCPUCount() > 1) ? SDL_FUTEX_SPIN_COUNT : 0;
+    }
+    return spin_count;
+}
+
+void
+SDL_FutexDeadline(struct timespec *deadline, Uint32 ms)
+{
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += ms / 1000;
+    deadline->tv_nsec += (ms % 1000) * 1000000;
+    if (deadline->tv_nsec >= 1000000000) {
+        deadline->tv_sec += 1;
+        deadline->tv_nsec -= 1000000000;
+    }
+}
+
+int
+SDL_FutexWait(SDL_atomic_t *futex, int value, const struct timespec *deadline)
+{
+    struct timespec now, remaining, *timeout = NULL;
+
+    if (deadline) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        remaining.tv_sec = deadline->tv_sec - now.tv_sec;
+        remaining.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+        if (remaining.tv_nsec < 0) {
+            remaining.tv_sec -= 1;
+            remaining.tv_nsec += 1000000000;
+        }
+        if (remaining.tv_sec < 0) {
+            return SDL_MUTEX_TIMEDOUT;
+        }
+        timeout = &remaining;
+    }
+
+    /* EAGAIN (the value changed) and EINTR are just early wakeups */
+    if (syscall(SYS_futex, &futex->value, FUTEX_WAIT_PRIVATE, value,
+                timeout, NULL, 0) < 0 && errno == ETIMEDOUT) {
+        return SDL_MUTEX_TIMEDOUT;
+    }
+    return 0;
+}
+
+void
+SDL_FutexWake(SDL_atomic_t *futex, int count)
+{
+    syscall(SYS_futex, &futex->value, FUTEX_WAKE_PRIVATE, count,
+            NULL, NULL, 0);
+}
+
+SDL_mutex *
+SDL_CreateMutex(void)
+{
+    SDL_mutex *mutex;
+
+    /* Allocate the structure */
+    mutex = (SDL_mutex *) SDL_calloc(1, sizeof(*mutex));
+    if (!mutex) {
+        SDL_OutOfMemory();
+    }
+    return (mutex);
+}
+
+void
+SDL_DestroyMutex(SDL_mutex * mutex)
+{
+    if (mutex) {
+        SDL_free(mutex);
+    }
+}
+
+static void
+SDL_LockFutex(SDL_mutex * mutex)
+{
+    int spins, spin_count;
+
+    /* Fast path, nobody holds the lock */
+    if (SDL_AtomicCAS(&mutex->futex, 0, 1)) {
+        return;
+    }
+
+    /* The owner is probably about to let go, so poll for a little while */
+    spin_count = SDL_FutexSpinCount();
+    for (spins = 0; spins < spin_count; ++spins) {
+        SDL_CPUPauseInstruction();
+        if (SDL_AtomicGet(&mutex->futex) == 0 &&
+            SDL_AtomicCAS(&mutex->futex, 0, 1)) {
+            return;
+        }
+    }
+
+    /* Mark the lock as contended and sleep until we grab it */
+    while (SDL_AtomicSet(&mutex->futex, 2) != 0) {
+        SDL_FutexWait(&mutex->futex, 2, NULL);
+    }
+}
+
+static void
+SDL_UnlockFutex(SDL_mutex * mutex)
+{
+    /* If the lock was contended, hand it back and wake one sleeper */
+    if (SDL_AtomicAdd(&mutex->futex, -1) != 1) {
+        SDL_AtomicSet(&mutex->futex, 0);
+        SDL_FutexWake(&mutex->futex, 1);
+    }
+}
+
+/* Lock the mutex */
+int
+SDL_mutexP(SDL_mutex * mutex)
+{
+    SDL_threadID this_thread;
+
+    if (mutex == NULL) {
+        SDL_SetError("Passed a NULL mutex");
+        return -1;
+    }
+
+    /* Only this thread could have stored its own id in the owner field */
+    this_thread = SDL_ThreadID();
+    if (mutex->owner == this_thread) {
+        ++mutex->recursive;
+        return 0;
+    }
+
+    SDL_LockFutex(mutex);
+    mutex->owner = this_thread;
+    mutex->recursive = 0;
+    return 0;
+}
+
+int
+SDL_mutexV(SDL_mutex * mutex)
+{
+    if (mutex == NULL) {
+        SDL_SetError("Passed a NULL mutex");
+        return -1;
+    }
+
+    /* We can only unlock the mutex if we own it */
+    if (mutex->owner != SDL_ThreadID()) {
+        SDL_SetError("mutex not owned by this thread");
+        return -1;
+    }
+
+    if (mutex->recursive) {
+        --mutex->recursive;
+    } else {
+        /* Reset the owner before another thread can take the lock */
+        mutex->owner = 0;
+        SDL_UnlockFutex(mutex);
+    }
+    return 0;
+}
+
+int
+SDL_FutexUnlockForWait(SDL_mutex * mutex)
+{
+    int recursive;
+
+    if (mutex->owner != SDL_ThreadID()) {
+        SDL_SetError("mutex not owned by this thread");
+        return -1;
+    }
+
+    /* Fully release a recursively held mutex, like pthread_cond_wait() */
+    recursive = mutex->recursive;
+    mutex->owner = 0;
+    SDL_UnlockFutex(mutex);
+    return recursive;
+}
+
+void
+SDL_FutexRelockAfterWait(SDL_mutex * mutex, int recursive)
+{
+    SDL_LockFutex(mutex);
+    mutex->owner = SDL_ThreadID();
+    mutex->recursive = recursive;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
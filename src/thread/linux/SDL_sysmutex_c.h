@@ -0,0 +1,64 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_mutex_c_h
+#define _SDL_mutex_c_h
+
+#include <time.h>
+
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+
+/* How many times to poll a busy lock before going to sleep in the kernel */
+#define SDL_FUTEX_SPIN_COUNT    100
+
+struct SDL_mutex
+{
+    /* 0 = unlocked, 1 = locked, 2 = locked and there may be sleepers */
+    SDL_atomic_t futex;
+    SDL_threadID owner;
+    int recursive;
+};
+
+/* The number of times to spin, which is zero on single processor systems
+   where the lock holder can't make progress while we spin.
+ */
+extern int SDL_FutexSpinCount(void);
+
+/* Fill in an absolute CLOCK_MONOTONIC deadline ms milliseconds from now */
+extern void SDL_FutexDeadline(struct timespec *deadline, Uint32 ms);
+
+/* Sleep while futex->value == value, until woken or the optional deadline
+   passes. Returns 0 if woken (possibly spuriously), or SDL_MUTEX_TIMEDOUT.
+ */
+extern int SDL_FutexWait(SDL_atomic_t *futex, int value,
+                         const struct timespec *deadline);
+
+/* Wake up to count threads sleeping on the futex */
+extern void SDL_FutexWake(SDL_atomic_t *futex, int count);
+
+/* Release and reacquire a mutex around a condition variable wait */
+extern int SDL_FutexUnlockForWait(SDL_mutex *mutex);
+extern void SDL_FutexRelockAfterWait(SDL_mutex *mutex, int recursive);
+
+#endif /* _SDL_mutex_c_h */
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,176 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+/* Semaphores implemented directly on Linux futexes.
+
+   The count lives in the futex word, so posting without sleepers is a
+   single atomic add. Waiters register themselves before they sleep so
+   SDL_SemPost() only enters the kernel when somebody needs waking.
+ */
+
+#include "SDL_sysmutex_c.h"
+
+struct SDL_semaphore
+{
+    SDL_atomic_t count;
+    SDL_atomic_t waiters;
+};
+
+/* Create a semaphore, initialized with value */
+SDL_sem *
+SDL_CreateSemaphore(Uint32 initial_value)
+{
+    SDL_sem *sem = (SDL_sem *) SDL_malloc(sizeof(SDL_sem));
+    if (sem) {
+        SDL_AtomicSet(&sem->count, (int) initial_value);
+        SDL_AtomicSet(&sem->waiters, 0);
+    } else {
+        SDL_OutOfMemory();
+    }
+    return sem;
+}
+
+void
+SDL_DestroySemaphore(SDL_sem * sem)
+{
+    if (sem) {
+        SDL_free(sem);
+    }
+}
+
+static SDL_bool
+SDL_SemTryDecrement(SDL_sem * sem)
+{
+    int count;
+
+    while ((count = SDL_AtomicGet(&sem->count)) > 0) {
+        if (SDL_AtomicCAS(&sem->count, count, count - 1)) {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+static int
+SDL_SemWaitDeadline(SDL_sem * sem, const struct timespec *deadline)
+{
+    int spins, spin_count;
+    int retval = 0;
+
+    if (!sem) {
+        SDL_SetError("Passed a NULL semaphore");
+        return -1;
+    }
+
+    if (SDL_SemTryDecrement(sem)) {
+        return 0;
+    }
+
+    /* Somebody may post soon, so poll for a little while */
+    spin_count = SDL_FutexSpinCount();
+    for (spins = 0; spins < spin_count; ++spins) {
+        SDL_CPUPauseInstruction();
+        if (SDL_SemTryDecrement(sem)) {
+            return 0;
+        }
+    }
+
+    SDL_AtomicIncRef(&sem->waiters);
+    while (!SDL_SemTryDecrement(sem)) {
+        if (SDL_FutexWait(&sem->count, 0, deadline) == SDL_MUTEX_TIMEDOUT) {
+            /* A post may have slipped in just as we timed out */
+            if (!SDL_SemTryDecrement(sem)) {
+                retval = SDL_MUTEX_TIMEDOUT;
+            }
+            break;
+        }
+    }
+    SDL_AtomicAdd(&sem->waiters, -1);
+
+    return retval;
+}
+
+int
+SDL_SemTryWait(SDL_sem * sem)
+{
+    if (!sem) {
+        SDL_SetError("Passed a NULL semaphore");
+        return -1;
+    }
+    return SDL_SemTryDecrement(sem) ? 0 : SDL_MUTEX_TIMEDOUT;
+}
+
+int
+SDL_SemWait(SDL_sem * sem)
+{
+    return SDL_SemWaitDeadline(sem, NULL);
+}
+
+int
+SDL_SemWaitTimeout(SDL_sem * sem, Uint32 timeout)
+{
+    struct timespec deadline;
+
+    /* Try the easy cases first */
+    if (timeout == 0) {
+        return SDL_SemTryWait(sem);
+    }
+    if (timeout == SDL_MUTEX_MAXWAIT) {
+        return SDL_SemWait(sem);
+    }
+
+    /* The deadline is on the monotonic clock, so it is immune to
+       changes of the wall clock time while we wait.
+     */
+    SDL_FutexDeadline(&deadline, timeout);
+    return SDL_SemWaitDeadline(sem, &deadline);
+}
+
+Uint32
+SDL_SemValue(SDL_sem * sem)
+{
+    int ret = 0;
+    if (sem) {
+        ret = SDL_AtomicGet(&sem->count);
+        if (ret < 0) {
+            ret = 0;
+        }
+    }
+    return (Uint32) ret;
+}
+
+int
+SDL_SemPost(SDL_sem * sem)
+{
+    if (!sem) {
+        SDL_SetError("Passed a NULL semaphore");
+        return -1;
+    }
+
+    SDL_AtomicIncRef(&sem->count);
+    if (SDL_AtomicGet(&sem->waiters) > 0) {
+        SDL_FutexWake(&sem->count, 1);
+    }
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
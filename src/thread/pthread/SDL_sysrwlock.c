@@ -0,0 +1,150 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#define _GNU_SOURCE
+#include "SDL_config.h"
+
+#include <errno.h>
+#include <pthread.h>
+
+#include "SDL_thread.h"
+
+struct SDL_rwlock
+{
+    pthread_rwlock_t id;
+};
+
+SDL_rwlock *
+SDL_CreateRWLock(void)
+{
+    SDL_rwlock *rwlock;
+    pthread_rwlockattr_t attr;
+
+    /* Allocate the structure */
+    rwlock = (SDL_rwlock *) SDL_calloc(1, sizeof(*rwlock));
+    if (rwlock) {
+        pthread_rwlockattr_init(&attr);
+#if defined(__LINUX__) && defined(__GLIBC__)
+        /* glibc prefers readers by default, which can starve writers */
+        pthread_rwlockattr_setkind_np(&attr,
+            PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+        if (pthread_rwlock_init(&rwlock->id, &attr) != 0) {
+            SDL_SetError("pthread_rwlock_init() failed");
+            SDL_free(rwlock);
+            rwlock = NULL;
+        }
+        pthread_rwlockattr_destroy(&attr);
+    } else {
+        SDL_OutOfMemory();
+    }
+    return (rwlock);
+}
+
+void
+SDL_DestroyRWLock(SDL_rwlock * rwlock)
+{
+    if (rwlock) {
+        pthread_rwlock_destroy(&rwlock->id);
+        SDL_free(rwlock);
+    }
+}
+
+int
+SDL_LockRWLockForReading(SDL_rwlock * rwlock)
+{
+    if (rwlock == NULL) {
+        SDL_SetError("Passed a NULL rwlock");
+        return -1;
+    }
+    if (pthread_rwlock_rdlock(&rwlock->id) != 0) {
+        SDL_SetError("pthread_rwlock_rdlock() failed");
+        return -1;
+    }
+    return 0;
+}
+
+int
+SDL_LockRWLockForWriting(SDL_rwlock * rwlock)
+{
+    if (rwlock == NULL) {
+        SDL_SetError("Passed a NULL rwlock");
+        return -1;
+    }
+    if (pthread_rwlock_wrlock(&rwlock->id) != 0) {
+        SDL_SetError("pthread_rwlock_wrlock() failed");
+        return -1;
+    }
+    return 0;
+}
+
+int
+SDL_TryLockRWLockForReading(SDL_rwlock * rwlock)
+{
+    int result;
+
+    if (rwlock == NULL) {
+        SDL_SetError("Passed a NULL rwlock");
+        return -1;
+    }
+    result = pthread_rwlock_tryrdlock(&rwlock->id);
+    if (result == EBUSY) {
+        return SDL_MUTEX_TIMEDOUT;
+    } else if (result != 0) {
+        SDL_SetError("pthread_rwlock_tryrdlock() failed");
+        return -1;
+    }
+    return 0;
+}
+
+int
+SDL_TryLockRWLockForWriting(SDL_rwlock * rwlock)
+{
+    int result;
+
+    if (rwlock == NULL) {
+        SDL_SetError("Passed a NULL rwlock");
+        return -1;
+    }
+    result = pthread_rwlock_trywrlock(&rwlock->id);
+    if (result == EBUSY) {
+        return SDL_MUTEX_TIMEDOUT;
+    } else if (result != 0) {
+        SDL_SetError("pthread_rwlock_trywrlock() failed");
+        return -1;
+    }
+    return 0;
+}
+
+int
+SDL_UnlockRWLock(SDL_rwlock * rwlock)
+{
+    if (rwlock == NULL) {
+        SDL_SetError("Passed a NULL rwlock");
+        return -1;
+    }
+    if (pthread_rwlock_unlock(&rwlock->id) != 0) {
+        SDL_SetError("pthread_rwlock_unlock() failed");
+        return -1;
+    }
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -25,6 +25,8 @@
 #include "SDL_atomic.h"
 #include "SDL_cpuinfo.h"
 #include "SDL_thread.h"
+#include "SDL_hints.h"
+#include "../stdlib/SDL_memory_c.h"
 
 /* #define DEBUG_TIMERS */
 
@@ -32,26 +34,36 @@ typedef struct _SDL_Timer
 {
     int timerID;
     SDL_TimerCallback callback;
+    SDL_NSTimerCallback callback_ns;
     void *param;
-    Uint32 interval;
-    Uint32 scheduled;
+    Uint64 interval;
+    Uint64 scheduled;
     volatile SDL_bool canceled;
     struct _SDL_Timer *next;
+    struct _SDL_Timer *mapnext;
+    SDL_bool mapped;
 } SDL_Timer;
 
-typedef struct _SDL_TimerMap
-{
-    int timerID;
-    SDL_Timer *timer;
-    struct _SDL_TimerMap *next;
-} SDL_TimerMap;
+/* Timer intervals and deadlines are kept in nanoseconds */
+#define SDL_NS_PER_MS   1000000
+
+/* The timer thread delay when there are no timers */
+#define SDL_TIMER_FOREVER   (~(Uint64)0)
 
-/* The timers are kept in a sorted list */
+/* The default busy-wait at the end of SDL_DelayPrecise(), in nanoseconds */
+#define SDL_DEFAULT_SPIN_TIME   (200 * 1000)
+
+/* The ID map starts out this big and doubles as it fills up */
+#define SDL_TIMERMAP_MIN_BUCKETS    64
+
+/* Timers are kept in a binary heap ordered by scheduled time */
 typedef struct {
     /* Data used by the main thread */
     SDL_Thread *thread;
     SDL_atomic_t nextID;
-    SDL_TimerMap *timermap;
+    SDL_Timer **timermap;
+    int timermap_buckets;
+    int timermap_count;
     SDL_mutex *timermap_lock;
 
     /* Padding to separate cache lines between threads */
@@ -64,8 +76,10 @@ typedef struct {
     SDL_Timer * volatile freelist;
     volatile SDL_bool active;
 
-    /* List of timers - this is only touched by the timer thread */
-    SDL_Timer *timers;
+    /* Heap of timers - this is only touched by the timer thread */
+    SDL_Timer **timers;
+    int num_timers;
+    int max_timers;
 } SDL_TimerData;
 
 static SDL_TimerData SDL_timer_data;
@@ -77,25 +91,128 @@ static SDL_TimerData SDL_timer_data;
  * Timers are removed by simply setting a canceled flag
  */
 
-static void
+#define SDL_TimerBefore(A, B) ((Sint64)((A)->scheduled - (B)->scheduled) < 0)
+
+static SDL_bool
 SDL_AddTimerInternal(SDL_TimerData *data, SDL_Timer *timer)
 {
-    SDL_Timer *prev, *curr;
+    int i, parent;
 
-    prev = NULL;
-    for (curr = data->timers; curr; prev = curr, curr = curr->next) {
-        if ((Sint32)(timer->scheduled-curr->scheduled) < 0) {
+    if (data->num_timers == data->max_timers) {
+        int max_timers = data->max_timers ? data->max_timers * 2 : 64;
+        SDL_Timer **timers;
+
+        timers = (SDL_Timer **)SDL_realloc(data->timers, max_timers * sizeof(*timers));
+        if (!timers) {
+            return SDL_FALSE;
+        }
+        data->timers = timers;
+        data->max_timers = max_timers;
+    }
+
+    /* Sift the new timer up from the bottom of the heap */
+    i = data->num_timers++;
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (!SDL_TimerBefore(timer, data->timers[parent])) {
             break;
         }
+        data->timers[i] = data->timers[parent];
+        i = parent;
     }
+    data->timers[i] = timer;
+    return SDL_TRUE;
+}
 
-    /* Insert the timer here! */
-    if (prev) {
-        prev->next = timer;
-    } else {
-        data->timers = timer;
+static SDL_Timer *
+SDL_RemoveFirstTimer(SDL_TimerData *data)
+{
+    SDL_Timer *first = data->timers[0];
+    SDL_Timer *last = data->timers[--data->num_timers];
+    int i, child;
+
+    /* Sift the last timer down from the top of the heap */
+    i = 0;
+    for ( ; ; ) {
+        child = 2 * i + 1;
+        if (child >= data->num_timers) {
+            break;
+        }
+        if (child + 1 < data->num_timers &&
+            SDL_TimerBefore(data->timers[child + 1], data->timers[child])) {
+            ++child;
+        }
+        if (!SDL_TimerBefore(data->timers[child], last)) {
+            break;
+        }
+        data->timers[i] = data->timers[child];
+        i = child;
     }
-    timer->next = curr;
+    data->timers[i] = last;
+    return first;
+}
+
+/* These must be called with the timermap lock held */
+static void
+SDL_MapTimer(SDL_TimerData *data, SDL_Timer *timer)
+{
+    int bucket;
+
+    if (data->timermap_count >= data->timermap_buckets * 2) {
+        /* Timer IDs are sequential, so the low bits spread them evenly */
+        int i, buckets = data->timermap_buckets * 2;
+        SDL_Timer **timermap, *entry;
+
+        timermap = (SDL_Timer **)SDL_calloc(buckets, sizeof(*timermap));
+        if (timermap) {
+            for (i = 0; i < data->timermap_buckets; ++i) {
+                while (data->timermap[i]) {
+                    entry = data->timermap[i];
+                    data->timermap[i] = entry->mapnext;
+                    bucket = entry->timerID & (buckets - 1);
+                    entry->mapnext = timermap[bucket];
+                    timermap[bucket] = entry;
+                }
+            }
+            SDL_free(data->timermap);
+            data->timermap = timermap;
+            data->timermap_buckets = buckets;
+        }
+    }
+
+    bucket = timer->timerID & (data->timermap_buckets - 1);
+    timer->mapnext = data->timermap[bucket];
+    data->timermap[bucket] = timer;
+    timer->mapped = SDL_TRUE;
+    ++data->timermap_count;
+}
+
+static SDL_Timer *
+SDL_UnmapTimer(SDL_TimerData *data, SDL_TimerID id)
+{
+    SDL_Timer *prev, *entry;
+    int bucket;
+
+    if (!data->timermap) {
+        return NULL;
+    }
+
+    bucket = id & (data->timermap_buckets - 1);
+    prev = NULL;
+    for (entry = data->timermap[bucket]; entry; prev = entry, entry = entry->mapnext) {
+        if (entry->timerID == id) {
+            if (prev) {
+                prev->mapnext = entry->mapnext;
+            } else {
+                data->timermap[bucket] = entry->mapnext;
+            }
+            entry->mapnext = NULL;
+            entry->mapped = SDL_FALSE;
+            --data->timermap_count;
+            break;
+        }
+    }
+    return entry;
 }
 
 static int
@@ -106,7 +223,7 @@ SDL_TimerThread(void *_data)
     SDL_Timer *current;
     SDL_Timer *freelist_head = NULL;
     SDL_Timer *freelist_tail = NULL;
-    Uint32 tick, now, interval, delay;
+    Uint64 tick, now, interval, delay;
 
     /* Threaded timer loop:
      *  1. Queue timers added by other threads
@@ -129,14 +246,25 @@ SDL_TimerThread(void *_data)
         }
         SDL_AtomicUnlock(&data->lock);
 
-        /* Sort the pending timers into our list */
+        /* Sort the pending timers into our heap */
+        freelist_head = NULL;
+        freelist_tail = NULL;
         while (pending) {
             current = pending;
             pending = pending->next;
-            SDL_AddTimerInternal(data, current);
+            if (!SDL_AddTimerInternal(data, current)) {
+                /* Out of memory, put the pending timers back and retry */
+                SDL_AtomicLock(&data->lock);
+                while (current) {
+                    pending = current->next;
+                    current->next = data->pending;
+                    data->pending = current;
+                    current = pending;
+                }
+                SDL_AtomicUnlock(&data->lock);
+                break;
+            }
         }
-        freelist_head = NULL;
-        freelist_tail = NULL;
 
         /* Check to see if we're still running, after maintenance */
         if (!data->active) {
@@ -144,32 +272,42 @@ SDL_TimerThread(void *_data)
         }
 
         /* Initial delay if there are no timers */
-        delay = SDL_MUTEX_MAXWAIT;
+        delay = SDL_TIMER_FOREVER;
 
-        tick = SDL_GetTicks();
+        tick = SDL_GetTicksNS();
 
         /* Process all the pending timers for this tick */
-        while (data->timers) {
-            current = data->timers;
+        while (data->num_timers > 0) {
+            current = data->timers[0];
 
-            if ((Sint32)(tick-current->scheduled) < 0) {
+            if ((Sint64)(tick-current->scheduled) < 0) {
                 /* Scheduled for the future, wait a bit */
                 delay = (current->scheduled - tick);
                 break;
             }
 
             /* We're going to do something with this timer */
-            data->timers = current->next;
+            SDL_RemoveFirstTimer(data);
 
             if (current->canceled) {
                 interval = 0;
+            } else if (current->callback_ns) {
+                interval = current->callback_ns(current->interval, current->param);
             } else {
-                interval = current->callback(current->interval, current->param);
+                interval = current->callback((Uint32)(current->interval / SDL_NS_PER_MS), current->param);
+                interval *= SDL_NS_PER_MS;
             }
 
             if (interval > 0) {
-                /* Reschedule this timer */
-                current->scheduled = tick + interval;
+                /* Reschedule this timer from its previous deadline so it
+                   doesn't drift, unless it has fallen a whole interval
+                   behind, in which case the missed ticks are skipped.
+                   There is always room for it in the heap.
+                 */
+                current->scheduled += interval;
+                if ((Sint64)(tick-current->scheduled) >= 0) {
+                    current->scheduled = tick + interval;
+                }
                 SDL_AddTimerInternal(data, current);
             } else {
                 if (!freelist_head) {
@@ -185,20 +323,34 @@ SDL_TimerThread(void *_data)
         }
 
         /* Adjust the delay based on processing time */
-        now = SDL_GetTicks();
-        interval = (now - tick);
-        if (interval > delay) {
-            delay = 0;
-        } else {
-            delay -= interval;
+        if (delay != SDL_TIMER_FOREVER) {
+            now = SDL_GetTicksNS();
+            interval = (now - tick);
+            if (interval > delay) {
+                delay = 0;
+            } else {
+                delay -= interval;
+            }
         }
 
         /* Note that each time a timer is added, this will return
            immediately, but we process the timers added all at once.
            That's okay, it just means we run through the loop a few
            extra times.
+
+           The semaphore timeout is in milliseconds, so we wait for the
+           whole milliseconds and then sleep off the remainder without
+           listening for new timers.
          */
-        SDL_SemWaitTimeout(data->sem, delay);
+        if (delay == SDL_TIMER_FOREVER) {
+            SDL_SemWait(data->sem);
+        } else if (delay >= SDL_NS_PER_MS) {
+            SDL_SemWaitTimeout(data->sem, (Uint32)SDL_min(delay / SDL_NS_PER_MS, SDL_MUTEX_MAXWAIT - 1));
+        } else if (delay > 0) {
+            SDL_DelayNS(delay);
+        } else {
+            SDL_SemTryWait(data->sem);
+        }
     }
     return 0;
 }
@@ -215,8 +367,19 @@ SDL_TimerInit(void)
             return -1;
         }
 
+        data->timermap = (SDL_Timer **)SDL_calloc(SDL_TIMERMAP_MIN_BUCKETS, sizeof(*data->timermap));
+        if (!data->timermap) {
+            SDL_DestroyMutex(data->timermap_lock);
+            SDL_OutOfMemory();
+            return -1;
+        }
+        data->timermap_buckets = SDL_TIMERMAP_MIN_BUCKETS;
+        data->timermap_count = 0;
+
         data->sem = SDL_CreateSemaphore(0);
         if (!data->sem) {
+            SDL_free(data->timermap);
+            data->timermap = NULL;
             SDL_DestroyMutex(data->timermap_lock);
             return -1;
         }
@@ -244,7 +407,6 @@ SDL_TimerQuit(void)
 {
     SDL_TimerData *data = &SDL_timer_data;
     SDL_Timer *timer;
-    SDL_TimerMap *entry;
 
     if (data->active) {
         data->active = SDL_FALSE;
@@ -260,33 +422,34 @@ SDL_TimerQuit(void)
         data->sem = NULL;
 
         /* Clean up the timer entries */
-        while (data->timers) {
-            timer = data->timers;
-            data->timers = timer->next;
-            SDL_free(timer);
+        while (data->num_timers > 0) {
+            SDL_FreeMemory(data->timers[--data->num_timers]);
         }
+        SDL_free(data->timers);
+        data->timers = NULL;
+        data->max_timers = 0;
         while (data->freelist) {
             timer = data->freelist;
             data->freelist = timer->next;
-            SDL_free(timer);
-        }
-        while (data->timermap) {
-            entry = data->timermap;
-            data->timermap = entry->next;
-            SDL_free(entry);
+            SDL_FreeMemory(timer);
         }
+        SDL_free(data->timermap);
+        data->timermap = NULL;
+        data->timermap_buckets = 0;
+        data->timermap_count = 0;
 
         SDL_DestroyMutex(data->timermap_lock);
         data->timermap_lock = NULL;
     }
 }
 
-SDL_TimerID
-SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
+static SDL_TimerID
+SDL_CreateTimer(Uint64 interval, SDL_TimerCallback callback,
+                SDL_NSTimerCallback callback_ns, void *param)
 {
     SDL_TimerData *data = &SDL_timer_data;
     SDL_Timer *timer;
-    SDL_TimerMap *entry;
+    SDL_TimerID id;
 
     if (!data->active) {
         int status = 0;
@@ -310,34 +473,33 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     SDL_AtomicUnlock(&data->lock);
 
     if (timer) {
-        SDL_RemoveTimer(timer->timerID);
+        /* Forget the ID of the expired timer, if nobody removed it yet */
+        if (timer->mapped) {
+            SDL_LockMutex(data->timermap_lock);
+            SDL_UnmapTimer(data, timer->timerID);
+            SDL_UnlockMutex(data->timermap_lock);
+        }
     } else {
-        timer = (SDL_Timer *)SDL_malloc(sizeof(*timer));
+        timer = (SDL_Timer *)SDL_AllocMemory(SDL_MEMORY_TIMER, sizeof(*timer));
         if (!timer) {
             SDL_OutOfMemory();
             return 0;
         }
+        timer->mapped = SDL_FALSE;
+        timer->mapnext = NULL;
     }
-    timer->timerID = SDL_AtomicIncRef(&data->nextID);
+    id = SDL_AtomicIncRef(&data->nextID);
+    timer->timerID = id;
     timer->callback = callback;
+    timer->callback_ns = callback_ns;
     timer->param = param;
     timer->interval = interval;
-    timer->scheduled = SDL_GetTicks() + interval;
+    timer->scheduled = SDL_GetTicksNS() + interval;
     timer->canceled = SDL_FALSE;
- 
-    entry = (SDL_TimerMap *)SDL_malloc(sizeof(*entry));
-    if (!entry) {
-        SDL_free(timer);
-        SDL_OutOfMemory();
-        return 0;
-    }
-    entry->timer = timer;
-    entry->timerID = timer->timerID;
 
-    SDL_mutexP(data->timermap_lock);
-    entry->next = data->timermap;
-    data->timermap = entry;
-    SDL_mutexV(data->timermap_lock);
+    SDL_LockMutex(data->timermap_lock);
+    SDL_MapTimer(data, timer);
+    SDL_UnlockMutex(data->timermap_lock);
 
     /* Add the timer to the pending list for the timer thread */
     SDL_AtomicLock(&data->lock);
@@ -348,39 +510,58 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     /* Wake up the timer thread if necessary */
     SDL_SemPost(data->sem);
 
-    return entry->timerID;
+    return id;
+}
+
+SDL_TimerID
+SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
+{
+    return SDL_CreateTimer((Uint64)interval * SDL_NS_PER_MS, callback, NULL, param);
+}
+
+SDL_TimerID
+SDL_AddTimerNS(Uint64 interval, SDL_NSTimerCallback callback, void *param)
+{
+    return SDL_CreateTimer(interval, NULL, callback, param);
 }
 
 SDL_bool
 SDL_RemoveTimer(SDL_TimerID id)
 {
     SDL_TimerData *data = &SDL_timer_data;
-    SDL_TimerMap *prev, *entry;
+    SDL_Timer *timer;
     SDL_bool canceled = SDL_FALSE;
 
     /* Find the timer */
-    SDL_mutexP(data->timermap_lock);
-    prev = NULL;
-    for (entry = data->timermap; entry; prev = entry, entry = entry->next) {
-        if (entry->timerID == id) {
-            if (prev) {
-                prev->next = entry->next;
-            } else {
-                data->timermap = entry->next;
-            }
-            break;
-        }
+    SDL_LockMutex(data->timermap_lock);
+    timer = SDL_UnmapTimer(data, id);
+    if (timer && !timer->canceled) {
+        timer->canceled = SDL_TRUE;
+        canceled = SDL_TRUE;
     }
-    SDL_mutexV(data->timermap_lock);
+    SDL_UnlockMutex(data->timermap_lock);
 
-    if (entry) {
-        if (!entry->timer->canceled) {
-            entry->timer->canceled = SDL_TRUE;
-            canceled = SDL_TRUE;
-        }
-        SDL_free(entry);
-    }
     return canceled;
 }
 
+void
+SDL_DelayPrecise(Uint64 ns)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_TIMER_SPIN_TIME);
+    Uint64 spin = SDL_DEFAULT_SPIN_TIME;
+    Uint64 deadline;
+
+    if (hint) {
+        spin = (Uint64)SDL_atoi(hint) * 1000;
+    }
+
+    deadline = SDL_GetTicksNS() + ns;
+    if (ns > spin) {
+        SDL_DelayNS(ns - spin);
+    }
+    while ((Sint64)(SDL_GetTicksNS() - deadline) < 0) {
+        /* Spin */
+    }
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
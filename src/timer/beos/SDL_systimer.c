@@ -41,6 +41,12 @@ SDL_GetTicks(void)
     return ((system_time() - start) / 1000);
 }
 
+Uint64
+SDL_GetTicksNS(void)
+{
+    return (Uint64)(system_time() - start) * 1000;
+}
+
 Uint64
 SDL_GetPerformanceCounter(void)
 {
@@ -59,6 +65,12 @@ SDL_Delay(Uint32 ms)
     snooze(ms * 1000);
 }
 
+void
+SDL_DelayNS(Uint64 ns)
+{
+    snooze_until(system_time() + (bigtime_t)(ns / 1000), B_SYSTEM_TIMEBASE);
+}
+
 #endif /* SDL_TIMER_BEOS */
 
 /* vi: set ts=4 sw=4 expandtab: */
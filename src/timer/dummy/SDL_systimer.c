@@ -36,6 +36,13 @@ SDL_GetTicks(void)
     return 0;
 }
 
+Uint64
+SDL_GetTicksNS(void)
+{
+    SDL_Unsupported();
+    return 0;
+}
+
 Uint64
 SDL_GetPerformanceCounter(void)
 {
@@ -54,6 +61,12 @@ SDL_Delay(Uint32 ms)
     SDL_Unsupported();
 }
 
+void
+SDL_DelayNS(Uint64 ns)
+{
+    SDL_Unsupported();
+}
+
 #endif /* SDL_TIMER_DUMMY || SDL_TIMERS_DISABLED */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -51,6 +51,12 @@ SDL_GetTicks(void)
     return timer_ticks;
 }
 
+Uint64
+SDL_GetTicksNS(void)
+{
+    return (Uint64)SDL_GetTicks() * 1000000;
+}
+
 Uint64
 SDL_GetPerformanceCounter(void)
 {
@@ -73,6 +79,12 @@ SDL_Delay(Uint32 ms)
     }
 }
 
+void
+SDL_DelayNS(Uint64 ns)
+{
+    SDL_Delay((Uint32)((ns + 999999) / 1000000));
+}
+
 #endif /* SDL_TIMER_NDS */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -81,6 +81,28 @@ SDL_GetTicks(void)
 #endif
 }
 
+Uint64
+SDL_GetTicksNS(void)
+{
+#if HAVE_CLOCK_GETTIME
+    Sint64 ticks;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ticks = (Sint64)(now.tv_sec - start.tv_sec) * 1000000000;
+    ticks += (now.tv_nsec - start.tv_nsec);
+    return (Uint64) ticks;
+#else
+    Sint64 ticks;
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    ticks = (Sint64)(now.tv_sec - start.tv_sec) * 1000000000;
+    ticks += (Sint64)(now.tv_usec - start.tv_usec) * 1000;
+    return (Uint64) ticks;
+#endif
+}
+
 Uint64
 SDL_GetPerformanceCounter(void)
 {
@@ -158,6 +180,62 @@ SDL_Delay(Uint32 ms)
     } while (was_error && (errno == EINTR));
 }
 
+/* clock_nanosleep() is part of the POSIX clock selection option */
+#if HAVE_CLOCK_GETTIME && defined(TIMER_ABSTIME) && \
+    defined(_POSIX_CLOCK_SELECTION) && (_POSIX_CLOCK_SELECTION > 0)
+#define USE_CLOCK_NANOSLEEP
+#endif
+
+void
+SDL_DelayNS(Uint64 ns)
+{
+#ifdef USE_CLOCK_NANOSLEEP
+    struct timespec deadline;
+
+    /* Sleep until an absolute deadline, so interruptions don't add up */
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += (time_t)(ns / 1000000000);
+    deadline.tv_nsec += (long)(ns % 1000000000);
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+        continue;
+    }
+#else
+    Uint64 deadline, now, remaining;
+#if HAVE_NANOSLEEP
+    struct timespec tv;
+#else
+    struct timeval tv;
+#endif
+
+    /* Recompute the remaining time against the deadline after interrupts */
+    deadline = SDL_GetTicksNS() + ns;
+    for ( ; ; ) {
+        now = SDL_GetTicksNS();
+        if (now >= deadline) {
+            break;
+        }
+        remaining = (deadline - now);
+
+#if HAVE_NANOSLEEP
+        tv.tv_sec = (time_t)(remaining / 1000000000);
+        tv.tv_nsec = (long)(remaining % 1000000000);
+        nanosleep(&tv, NULL);
+#else
+        tv.tv_sec = (time_t)(remaining / 1000000000);
+        tv.tv_usec = (long)((remaining % 1000000000) / 1000);
+        if (!tv.tv_sec && !tv.tv_usec) {
+            tv.tv_usec = 1;
+        }
+        select(0, NULL, NULL, NULL, &tv);
+#endif /* HAVE_NANOSLEEP */
+    }
+#endif /* USE_CLOCK_NANOSLEEP */
+}
+
 #endif /* SDL_TIMER_UNIX */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -32,6 +32,9 @@
 /* The first (low-resolution) ticks value of the application */
 static DWORD start;
 
+/* The first performance counter value of the application */
+static Uint64 start_counter;
+
 #ifndef USE_GETTICKCOUNT
 /* Store if a high-resolution performance counter exists on the system */
 static BOOL hires_timer_available;
@@ -44,6 +47,8 @@ static LARGE_INTEGER hires_ticks_per_second;
 void
 SDL_StartTicks(void)
 {
+    start_counter = SDL_GetPerformanceCounter();
+
     /* Set first ticks value */
 #ifdef USE_GETTICKCOUNT
     start = GetTickCount();
@@ -116,12 +121,36 @@ SDL_GetPerformanceFrequency(void)
     return frequency.QuadPart;
 }
 
+Uint64
+SDL_GetTicksNS(void)
+{
+    Uint64 ticks = SDL_GetPerformanceCounter() - start_counter;
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    /* Split the conversion so the multiply can't overflow */
+    return ((ticks / frequency) * 1000000000) +
+           (((ticks % frequency) * 1000000000) / frequency);
+}
+
 void
 SDL_Delay(Uint32 ms)
 {
     Sleep(ms);
 }
 
+void
+SDL_DelayNS(Uint64 ns)
+{
+    Uint64 deadline = SDL_GetTicksNS() + ns;
+
+    /* Sleep() only has millisecond granularity, so sleep the whole
+       milliseconds and spin for the rest, never returning early */
+    Sleep((DWORD)(ns / 1000000));
+    while (SDL_GetTicksNS() < deadline) {
+        continue;
+    }
+}
+
 #endif /* SDL_TIMER_WINDOWS */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -89,6 +89,8 @@
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_RLEaccel_c.h"
+#include "SDL_pixels_c.h"
+#include "../stdlib/SDL_memory_c.h"
 
 #ifndef MAX
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
@@ -1215,7 +1217,7 @@ RLEAlphaSurface(SDL_Surface * surface)
 
     /* Now that we have it encoded, release the original pixels */
     if (!(surface->flags & SDL_PREALLOC)) {
-        SDL_free(surface->pixels);
+        SDL_FreeMemory(surface->pixels);
         surface->pixels = NULL;
     }
 
@@ -1376,7 +1378,7 @@ RLEColorkeySurface(SDL_Surface * surface)
 
     /* Now that we have it encoded, release the original pixels */
     if (!(surface->flags & SDL_PREALLOC)) {
-        SDL_free(surface->pixels);
+        SDL_FreeMemory(surface->pixels);
         surface->pixels = NULL;
     }
 
@@ -1450,6 +1452,27 @@ SDL_RLESurface(SDL_Surface * surface)
     return (0);
 }
 
+/*
+ * Allocate the pixels of a surface coming back from RLE encoding, aligned
+ * as they were if the surface is marked SDL_SIMD_ALIGNED
+ */
+static void *
+AllocUnRLEPixels(SDL_Surface * surface)
+{
+    size_t size = (size_t) surface->h * surface->pitch;
+    int alignment;
+
+    if (surface->flags & SDL_SIMD_ALIGNED) {
+        alignment = SDL_GetSurfaceAlignment();
+        if (alignment > 4 && !(surface->pitch & (alignment - 1))) {
+            return SDL_AllocAlignedMemory(SDL_MEMORY_SURFACE, alignment, size);
+        }
+        /* The alignment changed since the surface was created */
+        surface->flags &= ~SDL_SIMD_ALIGNED;
+    }
+    return SDL_AllocMemory(SDL_MEMORY_SURFACE, size);
+}
+
 /*
  * Un-RLE a surface with pixel alpha
  * This may not give back exactly the image before RLE-encoding; all
@@ -1477,7 +1500,7 @@ UnRLEAlpha(SDL_Surface * surface)
         uncopy_opaque = uncopy_transl = uncopy_32;
     }
 
-    surface->pixels = SDL_malloc(surface->h * surface->pitch);
+    surface->pixels = AllocUnRLEPixels(surface);
     if (!surface->pixels) {
         return (SDL_FALSE);
     }
@@ -1540,7 +1563,7 @@ SDL_UnRLESurface(SDL_Surface * surface, int recode)
                 SDL_Rect full;
 
                 /* re-create the original surface */
-                surface->pixels = SDL_malloc(surface->h * surface->pitch);
+                surface->pixels = AllocUnRLEPixels(surface);
                 if (!surface->pixels) {
                     /* Oh crap... */
                     surface->flags |= SDL_RLEACCEL;
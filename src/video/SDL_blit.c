@@ -21,6 +21,7 @@
 #include "SDL_config.h"
 
 #include "SDL_video.h"
+#include "SDL_jobs.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_blit_auto.h"
@@ -28,6 +29,34 @@
 #include "SDL_blit_slow.h"
 #include "SDL_RLEaccel_c.h"
 #include "SDL_pixels_c.h"
+#include "../cpuinfo/SDL_cpuinfo_c.h"
+#include "../thread/SDL_jobs_c.h"
+
+/* Unscaled blits at least this big are split by rows across the job system,
+   if the application has already started it */
+#define SDL_PARALLEL_BLIT_PIXELS    (512 * 512)
+
+/* The smallest piece of a parallel blit, in pixels */
+#define SDL_PARALLEL_BLIT_GRAIN     (64 * 1024)
+
+typedef struct
+{
+    SDL_BlitInfo *info;
+    SDL_BlitFunc blit;
+} SDL_ParallelBlitData;
+
+static void SDLCALL
+SDL_BlitRows(int start, int end, void *_data)
+{
+    SDL_ParallelBlitData *data = (SDL_ParallelBlitData *)_data;
+    SDL_BlitInfo info = *data->info;
+
+    info.src += start * info.src_pitch;
+    info.dst += start * info.dst_pitch;
+    info.dst_y += start;
+    info.src_h = info.dst_h = (end - start);
+    data->blit(&info);
+}
 
 /* The general purpose software blit routine */
 static int
@@ -82,10 +111,30 @@ SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
         info->dst_pitch = dst->pitch;
         info->dst_skip =
             info->dst_pitch - info->dst_w * info->dst_fmt->BytesPerPixel;
+        info->dst_x = dstrect->x;
+        info->dst_y = dstrect->y;
         RunBlit = (SDL_BlitFunc) src->map->data;
 
-        /* Run the actual software blit */
-        RunBlit(info);
+        /* Run the actual software blit, in parallel if it's big enough
+           and the job workers are already running.  Scaled blits depend
+           on the full height, blits within one surface may depend on the
+           order the rows are copied in, and dithering carries state from
+           one row to the next.
+         */
+        if (src != dst && info->dither == SDL_DITHER_NONE &&
+            info->src_w == info->dst_w && info->src_h == info->dst_h &&
+            (info->dst_w * info->dst_h) >= SDL_PARALLEL_BLIT_PIXELS &&
+            SDL_JobWorkersRunning() && SDL_GetJobWorkerCount() > 0) {
+            SDL_ParallelBlitData data;
+
+            data.info = info;
+            data.blit = RunBlit;
+            SDL_ParallelFor(0, info->dst_h,
+                            (SDL_PARALLEL_BLIT_GRAIN + info->dst_w - 1) / info->dst_w,
+                            SDL_BlitRows, &data);
+        } else {
+            RunBlit(info);
+        }
     }
 
     /* We need to unlock the surfaces if they're locked */
@@ -141,19 +190,21 @@ SDL_ChooseBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
         if (override) {
             SDL_sscanf(override, "%u", &features);
         } else {
-            if (SDL_HasMMX()) {
+            const Uint32 cpu = SDL_GetCPUDispatchFeatures();
+
+            if (cpu & CPU_HAS_MMX) {
                 features |= SDL_CPU_MMX;
             }
-            if (SDL_Has3DNow()) {
+            if (cpu & CPU_HAS_3DNOW) {
                 features |= SDL_CPU_3DNOW;
             }
-            if (SDL_HasSSE()) {
+            if (cpu & CPU_HAS_SSE) {
                 features |= SDL_CPU_SSE;
             }
-            if (SDL_HasSSE2()) {
+            if (cpu & CPU_HAS_SSE2) {
                 features |= SDL_CPU_SSE2;
             }
-            if (SDL_HasAltiVec()) {
+            if (cpu & CPU_HAS_ALTIVEC) {
                 if (SDL_UseAltivecPrefetch()) {
                     features |= SDL_CPU_ALTIVEC_PREFETCH;
                 } else {
@@ -43,6 +43,11 @@ extern Uint8* SDL_expand_byte[9];
 #define SDL_COPY_RLE_ALPHAKEY       0x00004000
 #define SDL_COPY_RLE_MASK           (SDL_COPY_RLE_DESIRED|SDL_COPY_RLE_COLORKEY|SDL_COPY_RLE_ALPHAKEY)
 
+/* Dithering of blits from RGB to paletted surfaces */
+#define SDL_DITHER_NONE             0
+#define SDL_DITHER_ORDERED          1
+#define SDL_DITHER_DIFFUSION        2
+
 /* SDL blit CPU flags */
 #define SDL_CPU_ANY                 0x00000000
 #define SDL_CPU_MMX                 0x00000001
@@ -62,9 +67,11 @@ typedef struct
     int dst_w, dst_h;
     int dst_pitch;
     int dst_skip;
+    int dst_x, dst_y;           /* Where the blit starts in the destination */
     SDL_PixelFormat *src_fmt;
     SDL_PixelFormat *dst_fmt;
     Uint8 *table;
+    int dither;
     int flags;
     Uint32 colorkey;
     Uint8 r, g, b, a;
@@ -2033,6 +2033,94 @@ BlitNto1(SDL_BlitInfo * info)
     }
 }
 
+/* Blit to a paletted surface with dithering, through a 5-6-5 table */
+static void
+BlitNto1Dither(SDL_BlitInfo * info)
+{
+    static const Uint8 bayer[4][4] = {
+        {  0,  8,  2, 10 },
+        { 12,  4, 14,  6 },
+        {  3, 11,  1,  9 },
+        { 15,  7, 13,  5 }
+    };
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint8 *src = info->src;
+    int srcskip = info->src_skip;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    const Uint8 *map = info->table;
+    SDL_PixelFormat *srcfmt = info->src_fmt;
+    int srcbpp = srcfmt->BytesPerPixel;
+    const SDL_Color *colors = info->dst_fmt->palette->colors;
+    int *errors = NULL;
+    int *this_row = NULL;
+    int *next_row = NULL;
+    int x, y, r, g, b;
+
+    if (info->dither == SDL_DITHER_DIFFUSION) {
+        /* Without the memory for it, this falls back to ordered dithering */
+        errors = (int *) SDL_calloc(2 * 3 * (width + 2), sizeof(int));
+    }
+
+    for (y = 0; y < height; ++y) {
+        if (errors) {
+            this_row = &errors[(y & 1) * 3 * (width + 2)];
+            next_row = &errors[((y + 1) & 1) * 3 * (width + 2)];
+            SDL_memset(next_row, 0, 3 * (width + 2) * sizeof(int));
+        }
+        for (x = 0; x < width; ++x) {
+            Uint32 Pixel;
+            unsigned sR, sG, sB;
+            Uint8 index;
+
+            DISEMBLE_RGB(src, srcbpp, srcfmt, Pixel, sR, sG, sB);
+            if (errors) {
+                const int *error = &this_row[3 * (x + 1)];
+                r = (int) sR + error[0] / 16;
+                g = (int) sG + error[1] / 16;
+                b = (int) sB + error[2] / 16;
+            } else {
+                /* Spread over the usual distance between palette levels,
+                   in the same pattern wherever the blit lands */
+                const int offset = bayer[(info->dst_y + y) & 3][(info->dst_x + x) & 3] * 2 - 15;
+                r = (int) sR + offset;
+                g = (int) sG + offset;
+                b = (int) sB + offset;
+            }
+            r = SDL_max(0, SDL_min(r, 255));
+            g = SDL_max(0, SDL_min(g, 255));
+            b = SDL_max(0, SDL_min(b, 255));
+
+            index = map[((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)];
+            *dst++ = index;
+            src += srcbpp;
+
+            if (errors) {
+                /* Pass the error on: 7/16 right, 3/16, 5/16 and 1/16 below */
+                const int error[3] = {
+                    r - colors[index].r,
+                    g - colors[index].g,
+                    b - colors[index].b
+                };
+                int c;
+                for (c = 0; c < 3; ++c) {
+                    this_row[3 * (x + 2) + c] += error[c] * 7;
+                    next_row[3 * x + c] += error[c] * 3;
+                    next_row[3 * (x + 1) + c] += error[c] * 5;
+                    next_row[3 * (x + 2) + c] += error[c];
+                }
+            }
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+
+    if (errors) {
+        SDL_free(errors);
+    }
+}
+
 /* blits 32 bit RGB<->RGBA with both surfaces having the same R,G,B fields */
 static void
 Blit4to4MaskAlpha(SDL_BlitInfo * info)
@@ -2449,6 +2537,10 @@ SDL_CalculateBlitN(SDL_Surface * surface)
             } else {
                 blitfun = BlitNto1;
             }
+            if (surface->map->info.dither != SDL_DITHER_NONE &&
+                surface->map->info.table) {
+                blitfun = BlitNto1Dither;
+            }
         } else {
             /* Now the meat, choose the blitter we want */
             int a_need = NO_ALPHA;
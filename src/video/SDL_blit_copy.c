@@ -23,6 +23,7 @@
 #include "SDL_video.h"
 #include "SDL_blit.h"
 #include "SDL_blit_copy.h"
+#include "../cpuinfo/SDL_cpuinfo_c.h"
 
 
 #ifdef __SSE__
@@ -117,10 +118,17 @@ SDL_BlitCopy(SDL_BlitInfo * info)
         return;
     }
 
+    /* Rows without padding between them can be copied in one go */
+    if (srcskip == w && dstskip == w) {
+        w *= h;
+        h = 1;
+    }
+
 #ifdef __SSE__
-    if (SDL_HasSSE() &&
+    /* Streaming stores are only a win when they fill whole cache lines */
+    if ((SDL_GetCPUDispatchFeatures() & CPU_HAS_SSE) &&
         !((uintptr_t) src & 15) && !(srcskip & 15) &&
-        !((uintptr_t) dst & 15) && !(dstskip & 15)) {
+        !((uintptr_t) dst & 63) && (h == 1 || !(dstskip & 63))) {
         while (h--) {
             SDL_memcpySSE(dst, src, w);
             src += srcskip;
@@ -131,7 +139,7 @@ SDL_BlitCopy(SDL_BlitInfo * info)
 #endif
 
 #ifdef __MMX__
-    if (SDL_HasMMX() && !(srcskip & 7) && !(dstskip & 7)) {
+    if ((SDL_GetCPUDispatchFeatures() & CPU_HAS_MMX) && !(srcskip & 7) && !(dstskip & 7)) {
         while (h--) {
             SDL_memcpyMMX(dst, src, w);
             src += srcskip;
@@ -29,12 +29,14 @@
    and save, and since PNG is so complex that it would bloat the library,
    BMP is a good alternative. 
 
-   This code currently supports Win32 DIBs in uncompressed 8 and 24 bpp.
+   This code currently supports Win32 DIBs in 1, 4, 8, 16, 24 and 32 bpp,
+   uncompressed, with bit fields, or run length encoded in 4 and 8 bpp.
 */
 
 #include "SDL_video.h"
 #include "SDL_endian.h"
 #include "SDL_pixels_c.h"
+#include "SDL_blit.h"
 
 #define SAVE_32BIT_BMP
 
@@ -46,14 +48,195 @@
 #define BI_BITFIELDS	3
 #endif
 
+/* The file header and the largest info header, BITMAPV5HEADER */
+#define BMP_FILE_HEADER_SIZE    14
+#define BMP_MAX_INFO_SIZE       124
+
+/* Images are saved through a buffer holding this many bytes of rows */
+#define BMP_WRITE_BUFFER_SIZE   (64 * 1024)
+
+static __inline__ Uint16
+BMP_GetLE16(const Uint8 * data)
+{
+    return (Uint16) (data[0] | (data[1] << 8));
+}
+
+static __inline__ Uint32
+BMP_GetLE32(const Uint8 * data)
+{
+    return ((Uint32) data[0] | ((Uint32) data[1] << 8) |
+            ((Uint32) data[2] << 16) | ((Uint32) data[3] << 24));
+}
+
+static __inline__ void
+BMP_PutLE16(Uint8 * data, Uint16 value)
+{
+    data[0] = (Uint8) value;
+    data[1] = (Uint8) (value >> 8);
+}
+
+static __inline__ void
+BMP_PutLE32(Uint8 * data, Uint32 value)
+{
+    data[0] = (Uint8) value;
+    data[1] = (Uint8) (value >> 8);
+    data[2] = (Uint8) (value >> 16);
+    data[3] = (Uint8) (value >> 24);
+}
+
+/* Unpack a row of 1 or 4 bit pixels to a byte per pixel */
+static void
+BMP_ExpandRow(Uint8 * dst, const Uint8 * src, int width, int bpp)
+{
+    Uint8 pixel;
+
+    if (bpp == 1) {
+        for (; width >= 8; width -= 8) {
+            pixel = *src++;
+            dst[0] = (pixel >> 7);
+            dst[1] = (pixel >> 6) & 0x01;
+            dst[2] = (pixel >> 5) & 0x01;
+            dst[3] = (pixel >> 4) & 0x01;
+            dst[4] = (pixel >> 3) & 0x01;
+            dst[5] = (pixel >> 2) & 0x01;
+            dst[6] = (pixel >> 1) & 0x01;
+            dst[7] = (pixel & 0x01);
+            dst += 8;
+        }
+        if (width) {
+            pixel = *src;
+            while (width--) {
+                *dst++ = (pixel >> 7);
+                pixel <<= 1;
+            }
+        }
+    } else {
+        for (; width >= 2; width -= 2) {
+            pixel = *src++;
+            dst[0] = (pixel >> 4);
+            dst[1] = (pixel & 0x0F);
+            dst += 2;
+        }
+        if (width) {
+            *dst = (*src >> 4);
+        }
+    }
+}
+
+/* Swap the rows of a bottom-up image in place */
+static int
+BMP_FlipRows(SDL_Surface * surface)
+{
+    Uint8 *top = (Uint8 *) surface->pixels;
+    Uint8 *bottom = top + (surface->h - 1) * surface->pitch;
+    Uint8 *row;
+
+    if (surface->h < 2) {
+        return 0;
+    }
+    row = (Uint8 *) SDL_malloc(surface->pitch);
+    if (!row) {
+        SDL_OutOfMemory();
+        return -1;
+    }
+    while (top < bottom) {
+        SDL_memcpy(row, top, surface->pitch);
+        SDL_memcpy(top, bottom, surface->pitch);
+        SDL_memcpy(bottom, row, surface->pitch);
+        top += surface->pitch;
+        bottom -= surface->pitch;
+    }
+    SDL_free(row);
+    return 0;
+}
+
+/* Decode run length encoded pixels into an 8-bit surface.  Runs are clipped
+   to the surface, and truncated data leaves the rest of the image at 0.
+ */
+static void
+BMP_DecodeRLE(SDL_Surface * surface, const Uint8 * data, size_t size, int bpp)
+{
+    const Uint8 *end = data + size;
+    const int w = surface->w;
+    int x = 0, y = surface->h - 1;
+    int count, length, i;
+    Uint8 *row;
+    Uint8 value;
+
+    while (y >= 0 && (end - data) >= 2) {
+        count = *data++;
+        value = *data++;
+        row = (Uint8 *) surface->pixels + y * surface->pitch;
+        if (count) {
+            /* A run of one value, or two alternating nibbles */
+            if (count > w - x) {
+                count = w - x;
+            }
+            if (bpp == 8) {
+                SDL_memset(row + x, value, count);
+            } else {
+                for (i = 0; i < count; ++i) {
+                    row[x + i] = (i & 1) ? (value & 0x0F) : (value >> 4);
+                }
+            }
+            x += count;
+            continue;
+        }
+
+        switch (value) {
+        case 0:
+            /* End of line */
+            x = 0;
+            --y;
+            break;
+        case 1:
+            /* End of bitmap */
+            return;
+        case 2:
+            /* Move right and up */
+            if ((end - data) < 2) {
+                return;
+            }
+            x = SDL_min(x + data[0], w);
+            y -= data[1];
+            data += 2;
+            break;
+        default:
+            /* Literal pixels, padded to a 16-bit boundary */
+            count = value;
+            length = (bpp == 8) ? count : (count + 1) / 2;
+            if ((end - data) < length) {
+                return;
+            }
+            if (count > w - x) {
+                count = w - x;
+            }
+            if (bpp == 8) {
+                SDL_memcpy(row + x, data, count);
+            } else {
+                for (i = 0; i < count; ++i) {
+                    row[x + i] = (i & 1) ? (data[i / 2] & 0x0F) : (data[i / 2] >> 4);
+                }
+            }
+            x += count;
+            data += (length + 1) & ~1;
+            if (data > end) {
+                return;
+            }
+            break;
+        }
+    }
+}
+
 
 SDL_Surface *
 SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
 {
     SDL_bool was_error;
     Sint64 fp_offset = 0;
-    int bmpPitch;
-    int i, pad;
+    Sint64 data_size;
+    int bmpPitch, rowBytes;
+    int i, ncolors, entrySize;
     SDL_Surface *surface;
     Uint32 Rmask;
     Uint32 Gmask;
@@ -61,12 +244,17 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
     Uint32 Amask;
     SDL_Palette *palette;
     Uint8 *bits;
-    Uint8 *top, *end;
+    const Uint8 *data;
+    Uint8 *buffer;
     SDL_bool topDown;
     int ExpandBMP;
+    Uint8 header[BMP_FILE_HEADER_SIZE + BMP_MAX_INFO_SIZE];
+    Uint8 colors[256 * 4];
+    Uint8 masks[16];
+    const Uint8 *maskdata;
+    size_t infoSize;
 
     /* The Win32 BMP file header (14 bytes) */
-    char magic[2];
     /*Uint32 bfSize = 0;*/
     /*Uint16 bfReserved1 = 0;*/
     /*Uint16 bfReserved2 = 0;*/
@@ -79,7 +267,7 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
     /*Uint16 biPlanes = 0;*/
     Uint16 biBitCount = 0;
     Uint32 biCompression = 0;
-    /*Uint32 biSizeImage = 0;*/
+    Uint32 biSizeImage = 0;
     /*Sint32 biXPelsPerMeter = 0;*/
     /*Sint32 biYPelsPerMeter = 0;*/
     Uint32 biClrUsed = 0;
@@ -87,49 +275,63 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
 
     /* Make sure we are passed a valid data source */
     surface = NULL;
+    buffer = NULL;
     was_error = SDL_FALSE;
     if (src == NULL) {
         was_error = SDL_TRUE;
         goto done;
     }
 
-    /* Read in the BMP file header */
+    /* Read in the BMP file header and the size of the info header */
     fp_offset = SDL_RWtell(src);
-    SDL_ClearError();
-    if (SDL_RWread(src, magic, 1, 2) != 2) {
+    if (SDL_RWread(src, header, 1, BMP_FILE_HEADER_SIZE + 4) !=
+        BMP_FILE_HEADER_SIZE + 4) {
         SDL_Error(SDL_EFREAD);
         was_error = SDL_TRUE;
         goto done;
     }
-    if (SDL_strncmp(magic, "BM", 2) != 0) {
+    if (SDL_strncmp((const char *) header, "BM", 2) != 0) {
         SDL_SetError("File is not a Windows BMP file");
         was_error = SDL_TRUE;
         goto done;
     }
-    /*bfSize =*/ SDL_ReadLE32(src);
-    /*bfReserved1 =*/ SDL_ReadLE16(src);
-    /*bfReserved2 =*/ SDL_ReadLE16(src);
-    bfOffBits = SDL_ReadLE32(src);
+    bfOffBits = BMP_GetLE32(&header[10]);
 
-    /* Read the Win32 BITMAPINFOHEADER */
-    biSize = SDL_ReadLE32(src);
+    /* Read the rest of the Win32 BITMAPINFOHEADER in one go */
+    biSize = BMP_GetLE32(&header[14]);
+    if (biSize != 12 && biSize < 40) {
+        SDL_SetError("Unsupported BMP header size %u", (unsigned int) biSize);
+        was_error = SDL_TRUE;
+        goto done;
+    }
+    infoSize = SDL_min(biSize, BMP_MAX_INFO_SIZE);
+    if (SDL_RWread(src, &header[BMP_FILE_HEADER_SIZE + 4], 1, infoSize - 4) !=
+        infoSize - 4) {
+        SDL_Error(SDL_EFREAD);
+        was_error = SDL_TRUE;
+        goto done;
+    }
+    if (biSize > BMP_MAX_INFO_SIZE &&
+        SDL_RWseek(src, fp_offset + BMP_FILE_HEADER_SIZE + biSize,
+                   RW_SEEK_SET) < 0) {
+        SDL_Error(SDL_EFSEEK);
+        was_error = SDL_TRUE;
+        goto done;
+    }
     if (biSize == 12) {
-        biWidth = (Uint32) SDL_ReadLE16(src);
-        biHeight = (Uint32) SDL_ReadLE16(src);
-        /*biPlanes =*/ SDL_ReadLE16(src);
-        biBitCount = SDL_ReadLE16(src);
+        biWidth = BMP_GetLE16(&header[18]);
+        biHeight = BMP_GetLE16(&header[20]);
+        /*biPlanes = BMP_GetLE16(&header[22]);*/
+        biBitCount = BMP_GetLE16(&header[24]);
         biCompression = BI_RGB;
     } else {
-        biWidth = SDL_ReadLE32(src);
-        biHeight = SDL_ReadLE32(src);
-        /*biPlanes =*/ SDL_ReadLE16(src);
-        biBitCount = SDL_ReadLE16(src);
-        biCompression = SDL_ReadLE32(src);
-        /*biSizeImage =*/ SDL_ReadLE32(src);
-        /*biXPelsPerMeter =*/ SDL_ReadLE32(src);
-        /*biYPelsPerMeter =*/ SDL_ReadLE32(src);
-        biClrUsed = SDL_ReadLE32(src);
-        /*biClrImportant =*/ SDL_ReadLE32(src);
+        biWidth = (Sint32) BMP_GetLE32(&header[18]);
+        biHeight = (Sint32) BMP_GetLE32(&header[22]);
+        /*biPlanes = BMP_GetLE16(&header[26]);*/
+        biBitCount = BMP_GetLE16(&header[28]);
+        biCompression = BMP_GetLE32(&header[30]);
+        biSizeImage = BMP_GetLE32(&header[34]);
+        biClrUsed = BMP_GetLE32(&header[46]);
     }
     if (biHeight < 0) {
         topDown = SDL_TRUE;
@@ -137,13 +339,16 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
     } else {
         topDown = SDL_FALSE;
     }
-
-    /* Check for read error */
-    if (SDL_strcmp(SDL_GetError(), "") != 0) {
+    if (biWidth <= 0 || biHeight <= 0 || biWidth > 0xFFFFFF || biHeight > 0xFFFFFF) {
+        SDL_SetError("Invalid BMP image size %dx%d", (int) biWidth, (int) biHeight);
         was_error = SDL_TRUE;
         goto done;
     }
 
+    /* Rows in the file are padded to 4 bytes */
+    bmpPitch = ((biWidth * biBitCount + 31) / 32) * 4;
+    rowBytes = (biWidth * biBitCount + 7) / 8;
+
     /* Expand 1 and 4 bit bitmaps to 8 bits per pixel */
     switch (biBitCount) {
     case 1:
@@ -156,66 +361,86 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
         break;
     }
 
-    /* We don't support any BMP compression right now */
     Rmask = Gmask = Bmask = Amask = 0;
     switch (biCompression) {
     case BI_RGB:
         /* If there are no masks, use the defaults */
-        if (bfOffBits == (14 + biSize)) {
-            /* Default values for the BMP format */
-            switch (biBitCount) {
-            case 15:
-            case 16:
-                Rmask = 0x7C00;
-                Gmask = 0x03E0;
-                Bmask = 0x001F;
-                break;
-            case 24:
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-                Rmask = 0x000000FF;
-                Gmask = 0x0000FF00;
-                Bmask = 0x00FF0000;
-#else
-                Rmask = 0x00FF0000;
-                Gmask = 0x0000FF00;
-                Bmask = 0x000000FF;
-#endif
-                break;
-            case 32:
-                Amask = 0xFF000000;
-                Rmask = 0x00FF0000;
-                Gmask = 0x0000FF00;
-                Bmask = 0x000000FF;
-                break;
-            default:
-                break;
-            }
+        if (bfOffBits == (BMP_FILE_HEADER_SIZE + biSize)) {
             break;
         }
         /* Fall through -- read the RGB masks */
 
     case BI_BITFIELDS:
+        if (biBitCount != 15 && biBitCount != 16 && biBitCount != 32) {
+            break;
+        }
+        /* Newer info headers hold the masks, otherwise they follow it */
+        if (biSize >= 56 || (biSize >= 52 && biBitCount != 32)) {
+            maskdata = &header[BMP_FILE_HEADER_SIZE + 40];
+        } else {
+            const size_t size = (biBitCount == 32) ? 16 : 12;
+            if (SDL_RWread(src, masks, 1, size) != size) {
+                SDL_Error(SDL_EFREAD);
+                was_error = SDL_TRUE;
+                goto done;
+            }
+            maskdata = masks;
+        }
+        Rmask = BMP_GetLE32(&maskdata[0]);
+        Gmask = BMP_GetLE32(&maskdata[4]);
+        Bmask = BMP_GetLE32(&maskdata[8]);
+        if (biBitCount == 32) {
+            Amask = BMP_GetLE32(&maskdata[12]);
+        }
+        break;
+    case BI_RLE8:
+    case BI_RLE4:
+        if ((biCompression == BI_RLE8) ? (ExpandBMP != 0 || biBitCount != 8)
+                                       : (ExpandBMP != 4)) {
+            SDL_SetError("Invalid bit depth for run length encoded BMP");
+            was_error = SDL_TRUE;
+            goto done;
+        }
+        if (topDown) {
+            SDL_SetError("Run length encoded BMP files can't be top-down");
+            was_error = SDL_TRUE;
+            goto done;
+        }
+        break;
+    default:
+        SDL_SetError("Compressed BMP files not supported");
+        was_error = SDL_TRUE;
+        goto done;
+    }
+    if (!Rmask && !Gmask && !Bmask) {
+        /* Default values for the BMP format */
         switch (biBitCount) {
         case 15:
         case 16:
-            Rmask = SDL_ReadLE32(src);
-            Gmask = SDL_ReadLE32(src);
-            Bmask = SDL_ReadLE32(src);
+            Rmask = 0x7C00;
+            Gmask = 0x03E0;
+            Bmask = 0x001F;
+            break;
+        case 24:
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+            Rmask = 0x000000FF;
+            Gmask = 0x0000FF00;
+            Bmask = 0x00FF0000;
+#else
+            Rmask = 0x00FF0000;
+            Gmask = 0x0000FF00;
+            Bmask = 0x000000FF;
+#endif
             break;
         case 32:
-            Rmask = SDL_ReadLE32(src);
-            Gmask = SDL_ReadLE32(src);
-            Bmask = SDL_ReadLE32(src);
-            Amask = SDL_ReadLE32(src);
+            Amask = 0xFF000000;
+            Rmask = 0x00FF0000;
+            Gmask = 0x0000FF00;
+            Bmask = 0x000000FF;
             break;
         default:
             break;
         }
-        break;
-    default:
-        SDL_SetError("Compressed BMP files not supported");
-        was_error = SDL_TRUE;
-        goto done;
     }
 
     /* Create a compatible surface, note that the colors are RGB ordered */
@@ -227,132 +452,130 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
         goto done;
     }
 
-    /* Load the palette, if any */
+    /* Load the palette, if any, with a single read */
     palette = (surface->format)->palette;
     if (palette) {
         if (biClrUsed == 0) {
-            biClrUsed = 1 << biBitCount;
-        }
-        if ((int) biClrUsed > palette->ncolors) {
-            palette->ncolors = biClrUsed;
-            palette->colors =
-                (SDL_Color *) SDL_realloc(palette->colors,
-                                          palette->ncolors *
-                                          sizeof(*palette->colors));
-            if (!palette->colors) {
-                SDL_OutOfMemory();
-                was_error = SDL_TRUE;
-                goto done;
-            }
-        } else if ((int) biClrUsed < palette->ncolors) {
-            palette->ncolors = biClrUsed;
-        }
-        if (biSize == 12) {
-            for (i = 0; i < (int) biClrUsed; ++i) {
-                SDL_RWread(src, &palette->colors[i].b, 1, 1);
-                SDL_RWread(src, &palette->colors[i].g, 1, 1);
-                SDL_RWread(src, &palette->colors[i].r, 1, 1);
-                palette->colors[i].unused = SDL_ALPHA_OPAQUE;
-            }
-        } else {
-            for (i = 0; i < (int) biClrUsed; ++i) {
-                SDL_RWread(src, &palette->colors[i].b, 1, 1);
-                SDL_RWread(src, &palette->colors[i].g, 1, 1);
-                SDL_RWread(src, &palette->colors[i].r, 1, 1);
-                SDL_RWread(src, &palette->colors[i].unused, 1, 1);
-            }
+            biClrUsed = 1 << (ExpandBMP ? ExpandBMP : biBitCount);
+        }
+        if (biClrUsed > 256) {
+            SDL_SetError("BMP palette has too many colors");
+            was_error = SDL_TRUE;
+            goto done;
+        }
+        ncolors = (int) biClrUsed;
+        entrySize = (biSize == 12) ? 3 : 4;
+        if (SDL_RWread(src, colors, entrySize, ncolors) != (size_t) ncolors) {
+            SDL_Error(SDL_EFREAD);
+            was_error = SDL_TRUE;
+            goto done;
+        }
+        palette->ncolors = ncolors;
+        for (i = 0; i < ncolors; ++i) {
+            const Uint8 *entry = &colors[i * entrySize];
+            palette->colors[i].b = entry[0];
+            palette->colors[i].g = entry[1];
+            palette->colors[i].r = entry[2];
+            palette->colors[i].unused =
+                (entrySize == 4) ? entry[3] : SDL_ALPHA_OPAQUE;
         }
     }
 
-    /* Read the surface pixels.  Note that the bmp image is upside down */
-    if (SDL_RWseek(src, fp_offset + bfOffBits, RW_SEEK_SET) < 0) {
-        SDL_Error(SDL_EFSEEK);
+    /* Find the pixel data: in place for memory and memory mapped files,
+       otherwise read in one go, straight into the surface if it can be */
+    if (biCompression == BI_RLE8 || biCompression == BI_RLE4) {
+        data_size = biSizeImage;
+        if (!data_size) {
+            data_size = SDL_RWsize(src) - (fp_offset + bfOffBits);
+        }
+    } else {
+        data_size = (Sint64) bmpPitch * biHeight;
+    }
+    if (data_size <= 0 || data_size != (Sint64) (size_t) data_size) {
+        SDL_SetError("Couldn't determine the size of the BMP pixel data");
         was_error = SDL_TRUE;
         goto done;
     }
-    top = (Uint8 *)surface->pixels;
-    end = (Uint8 *)surface->pixels+(surface->h*surface->pitch);
-    switch (ExpandBMP) {
-    case 1:
-        bmpPitch = (biWidth + 7) >> 3;
-        pad = (((bmpPitch) % 4) ? (4 - ((bmpPitch) % 4)) : 0);
-        break;
-    case 4:
-        bmpPitch = (biWidth + 1) >> 1;
-        pad = (((bmpPitch) % 4) ? (4 - ((bmpPitch) % 4)) : 0);
-        break;
-    default:
-        pad = ((surface->pitch % 4) ? (4 - (surface->pitch % 4)) : 0);
-        break;
-    }
-    if (topDown) {
-        bits = top;
-    } else {
-        bits = end - surface->pitch;
+    data = (const Uint8 *) SDL_RWGetPointer(src, fp_offset + bfOffBits,
+                                            (size_t) data_size);
+    if (SDL_RWseek(src, fp_offset + bfOffBits + (data ? data_size : 0),
+                   RW_SEEK_SET) < 0) {
+        SDL_Error(SDL_EFSEEK);
+        was_error = SDL_TRUE;
+        goto done;
     }
-    while (bits >= top && bits < end) {
-        switch (ExpandBMP) {
-        case 1:
-        case 4:{
-                Uint8 pixel = 0;
-                int shift = (8 - ExpandBMP);
-                for (i = 0; i < surface->w; ++i) {
-                    if (i % (8 / ExpandBMP) == 0) {
-                        if (!SDL_RWread(src, &pixel, 1, 1)) {
-                            SDL_SetError("Error reading from BMP");
-                            was_error = SDL_TRUE;
-                            goto done;
-                        }
-                    }
-                    *(bits + i) = (pixel >> shift);
-                    pixel <<= ExpandBMP;
-                }
-            }
-            break;
-
-        default:
-            if (SDL_RWread(src, bits, 1, surface->pitch)
-                != surface->pitch) {
-                SDL_Error(SDL_EFREAD);
+    if (!data) {
+        if (!ExpandBMP && biCompression != BI_RLE8 &&
+            bmpPitch == surface->pitch) {
+            bits = (Uint8 *) surface->pixels;
+        } else {
+            buffer = (Uint8 *) SDL_malloc((size_t) data_size);
+            if (!buffer) {
+                SDL_OutOfMemory();
                 was_error = SDL_TRUE;
                 goto done;
             }
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-            /* Byte-swap the pixels if needed. Note that the 24bpp
-               case has already been taken care of above. */
-            switch (biBitCount) {
-            case 15:
-            case 16:{
-                    Uint16 *pix = (Uint16 *) bits;
-                    for (i = 0; i < surface->w; i++)
-                        pix[i] = SDL_Swap16(pix[i]);
-                    break;
-                }
+            bits = buffer;
+        }
+        if (SDL_RWread(src, bits, 1, (size_t) data_size) != (size_t) data_size) {
+            SDL_Error(SDL_EFREAD);
+            was_error = SDL_TRUE;
+            goto done;
+        }
+        data = buffer;
+    }
 
-            case 32:{
-                    Uint32 *pix = (Uint32 *) bits;
-                    for (i = 0; i < surface->w; i++)
-                        pix[i] = SDL_Swap32(pix[i]);
-                    break;
-                }
+    if (biCompression == BI_RLE8 || biCompression == BI_RLE4) {
+        BMP_DecodeRLE(surface, data, (size_t) data_size, ExpandBMP ? 4 : 8);
+    } else if (data) {
+        /* Unpack or copy the rows, flipping the image as we go */
+        for (i = 0; i < surface->h; ++i) {
+            bits = (Uint8 *) surface->pixels +
+                   (topDown ? i : (surface->h - 1 - i)) * surface->pitch;
+            if (ExpandBMP) {
+                BMP_ExpandRow(bits, data, surface->w, ExpandBMP);
+            } else {
+                SDL_memcpy(bits, data, rowBytes);
             }
-#endif
-            break;
+            data += bmpPitch;
         }
-        /* Skip padding bytes, ugh */
-        if (pad) {
-            Uint8 padbyte;
-            for (i = 0; i < pad; ++i) {
-                SDL_RWread(src, &padbyte, 1, 1);
-            }
+    } else if (!topDown) {
+        /* The pixels were read straight into the surface */
+        if (BMP_FlipRows(surface) < 0) {
+            was_error = SDL_TRUE;
+            goto done;
         }
-        if (topDown) {
-            bits += surface->pitch;
-        } else {
-            bits -= surface->pitch;
+    }
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    /* Byte-swap the pixels if needed. Note that the 24bpp
+       case has already been taken care of above. */
+    for (i = 0; i < surface->h; ++i) {
+        bits = (Uint8 *) surface->pixels + i * surface->pitch;
+        switch (biBitCount) {
+        case 15:
+        case 16:{
+                Uint16 *pix = (Uint16 *) bits;
+                int x;
+                for (x = 0; x < surface->w; x++)
+                    pix[x] = SDL_Swap16(pix[x]);
+                break;
+            }
+
+        case 32:{
+                Uint32 *pix = (Uint32 *) bits;
+                int x;
+                for (x = 0; x < surface->w; x++)
+                    pix[x] = SDL_Swap32(pix[x]);
+                break;
+            }
         }
     }
+#endif
   done:
+    if (buffer) {
+        SDL_free(buffer);
+    }
     if (was_error) {
         if (src) {
             SDL_RWseek(src, fp_offset, RW_SEEK_SET);
@@ -371,8 +594,7 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
 int
 SDL_SaveBMP_RW(SDL_Surface * saveme, SDL_RWops * dst, int freedst)
 {
-    Sint64 fp_offset;
-    int i, pad;
+    int i;
     SDL_Surface *surface;
     Uint8 *bits;
 
@@ -453,21 +675,23 @@ SDL_SaveBMP_RW(SDL_Surface * saveme, SDL_RWops * dst, int freedst)
 
     if (surface && (SDL_LockSurface(surface) == 0)) {
         const int bw = surface->w * surface->format->BytesPerPixel;
+        const int bmpPitch = (bw + 3) & ~3;
+        Uint8 header[BMP_FILE_HEADER_SIZE + 40];
+        Uint8 palette[256 * 4];
+        Uint8 *buffer;
+        int ncolors, rows, chunk, y;
+
+        if (surface->format->palette) {
+            ncolors = SDL_min(surface->format->palette->ncolors, 256);
+        } else {
+            ncolors = 0;
+        }
 
         /* Set the BMP file header values */
-        bfSize = 0;             /* We'll write this when we're done */
+        bfOffBits = BMP_FILE_HEADER_SIZE + 40 + ncolors * 4;
+        bfSize = bfOffBits + bmpPitch * surface->h;
         bfReserved1 = 0;
         bfReserved2 = 0;
-        bfOffBits = 0;          /* We'll write this when we're done */
-
-        /* Write the BMP file header values */
-        fp_offset = SDL_RWtell(dst);
-        SDL_ClearError();
-        SDL_RWwrite(dst, magic, 2, 1);
-        SDL_WriteLE32(dst, bfSize);
-        SDL_WriteLE16(dst, bfReserved1);
-        SDL_WriteLE16(dst, bfReserved2);
-        SDL_WriteLE32(dst, bfOffBits);
 
         /* Set the BMP info values */
         biSize = 40;
@@ -476,80 +700,63 @@ SDL_SaveBMP_RW(SDL_Surface * saveme, SDL_RWops * dst, int freedst)
         biPlanes = 1;
         biBitCount = surface->format->BitsPerPixel;
         biCompression = BI_RGB;
-        biSizeImage = surface->h * surface->pitch;
+        biSizeImage = surface->h * bmpPitch;
         biXPelsPerMeter = 0;
         biYPelsPerMeter = 0;
-        if (surface->format->palette) {
-            biClrUsed = surface->format->palette->ncolors;
-        } else {
-            biClrUsed = 0;
-        }
+        biClrUsed = ncolors;
         biClrImportant = 0;
 
-        /* Write the BMP info values */
-        SDL_WriteLE32(dst, biSize);
-        SDL_WriteLE32(dst, biWidth);
-        SDL_WriteLE32(dst, biHeight);
-        SDL_WriteLE16(dst, biPlanes);
-        SDL_WriteLE16(dst, biBitCount);
-        SDL_WriteLE32(dst, biCompression);
-        SDL_WriteLE32(dst, biSizeImage);
-        SDL_WriteLE32(dst, biXPelsPerMeter);
-        SDL_WriteLE32(dst, biYPelsPerMeter);
-        SDL_WriteLE32(dst, biClrUsed);
-        SDL_WriteLE32(dst, biClrImportant);
-
-        /* Write the palette (in BGR color order) */
-        if (surface->format->palette) {
-            SDL_Color *colors;
-            int ncolors;
-
-            colors = surface->format->palette->colors;
-            ncolors = surface->format->palette->ncolors;
-            for (i = 0; i < ncolors; ++i) {
-                SDL_RWwrite(dst, &colors[i].b, 1, 1);
-                SDL_RWwrite(dst, &colors[i].g, 1, 1);
-                SDL_RWwrite(dst, &colors[i].r, 1, 1);
-                SDL_RWwrite(dst, &colors[i].unused, 1, 1);
-            }
-        }
-
-        /* Write the bitmap offset */
-        bfOffBits = (Uint32)(SDL_RWtell(dst) - fp_offset);
-        if (SDL_RWseek(dst, fp_offset + 10, RW_SEEK_SET) < 0) {
-            SDL_Error(SDL_EFSEEK);
+        /* Write the headers and the palette (in BGR color order) */
+        SDL_ClearError();
+        SDL_memcpy(header, magic, 2);
+        BMP_PutLE32(&header[2], bfSize);
+        BMP_PutLE16(&header[6], bfReserved1);
+        BMP_PutLE16(&header[8], bfReserved2);
+        BMP_PutLE32(&header[10], bfOffBits);
+        BMP_PutLE32(&header[14], biSize);
+        BMP_PutLE32(&header[18], biWidth);
+        BMP_PutLE32(&header[22], biHeight);
+        BMP_PutLE16(&header[26], biPlanes);
+        BMP_PutLE16(&header[28], biBitCount);
+        BMP_PutLE32(&header[30], biCompression);
+        BMP_PutLE32(&header[34], biSizeImage);
+        BMP_PutLE32(&header[38], biXPelsPerMeter);
+        BMP_PutLE32(&header[42], biYPelsPerMeter);
+        BMP_PutLE32(&header[46], biClrUsed);
+        BMP_PutLE32(&header[50], biClrImportant);
+        for (i = 0; i < ncolors; ++i) {
+            const SDL_Color *color = &surface->format->palette->colors[i];
+            palette[i * 4 + 0] = color->b;
+            palette[i * 4 + 1] = color->g;
+            palette[i * 4 + 2] = color->r;
+            palette[i * 4 + 3] = color->unused;
         }
-        SDL_WriteLE32(dst, bfOffBits);
-        if (SDL_RWseek(dst, fp_offset + bfOffBits, RW_SEEK_SET) < 0) {
-            SDL_Error(SDL_EFSEEK);
+        if (SDL_RWwrite(dst, header, sizeof(header), 1) != 1 ||
+            (ncolors && SDL_RWwrite(dst, palette, 4, ncolors) != (size_t) ncolors)) {
+            SDL_Error(SDL_EFWRITE);
         }
 
-        /* Write the bitmap image upside down */
-        bits = (Uint8 *) surface->pixels + (surface->h * surface->pitch);
-        pad = ((bw % 4) ? (4 - (bw % 4)) : 0);
-        while (bits > (Uint8 *) surface->pixels) {
-            bits -= surface->pitch;
-            if (SDL_RWwrite(dst, bits, 1, bw) != bw) {
-                SDL_Error(SDL_EFWRITE);
-                break;
-            }
-            if (pad) {
-                const Uint8 padbyte = 0;
-                for (i = 0; i < pad; ++i) {
-                    SDL_RWwrite(dst, &padbyte, 1, 1);
-                }
+        /* Write the bitmap image upside down, a block of rows at a time.
+           An image with no columns has no pixel data at all. */
+        buffer = NULL;
+        if (bmpPitch > 0 && surface->h > 0) {
+            rows = SDL_max(1, SDL_min(surface->h, BMP_WRITE_BUFFER_SIZE / bmpPitch));
+            buffer = (Uint8 *) SDL_calloc(rows, bmpPitch);
+            if (!buffer) {
+                SDL_OutOfMemory();
             }
         }
-
-        /* Write the BMP file size */
-        bfSize = (Uint32)(SDL_RWtell(dst) - fp_offset);
-        if (SDL_RWseek(dst, fp_offset + 2, RW_SEEK_SET) < 0) {
-            SDL_Error(SDL_EFSEEK);
-        }
-        SDL_WriteLE32(dst, bfSize);
-        if (SDL_RWseek(dst, fp_offset + bfSize, RW_SEEK_SET) < 0) {
-            SDL_Error(SDL_EFSEEK);
+        for (y = surface->h; buffer && y > 0 && !*SDL_GetError(); y -= chunk) {
+            chunk = SDL_min(rows, y);
+            for (i = 0; i < chunk; ++i) {
+                bits = (Uint8 *) surface->pixels + (y - 1 - i) * surface->pitch;
+                SDL_memcpy(&buffer[i * bmpPitch], bits, bw);
+            }
+            if (SDL_RWwrite(dst, buffer, bmpPitch, chunk) != (size_t) chunk) {
+                SDL_Error(SDL_EFWRITE);
+            }
         }
+        SDL_free(buffer);
 
         /* Close it up.. */
         SDL_UnlockSurface(surface);
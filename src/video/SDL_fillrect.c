@@ -22,6 +22,7 @@
 
 #include "SDL_video.h"
 #include "SDL_blit.h"
+#include "../cpuinfo/SDL_cpuinfo_c.h"
 
 
 #ifdef __SSE__
@@ -101,7 +102,7 @@ SDL_FillRect1SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h)
         Uint8 *p = pixels;
 
         if (n > 63) {
-            int adjust = 16 - ((uintptr_t)p & 15);
+            int adjust = (16 - ((uintptr_t)p & 15)) & 15;
             if (adjust) {
                 n -= adjust;
                 SDL_memset(p, color, adjust);
@@ -305,6 +306,58 @@ SDL_FillRect4(Uint8 * pixels, int pitch, Uint32 color, int w, int h)
     }
 }
 
+typedef void (*SDL_FillRectFunc) (Uint8 * pixels, int pitch, Uint32 color, int w, int h);
+
+static const SDL_CPUImplementation SDL_FillRect1Impls[] = {
+#ifdef __SSE__
+    { CPU_HAS_SSE, (SDL_CPUFunction) SDL_FillRect1SSE },
+#endif
+#ifdef __MMX__
+    { CPU_HAS_MMX, (SDL_CPUFunction) SDL_FillRect1MMX },
+#endif
+    { 0, (SDL_CPUFunction) SDL_FillRect1 }
+};
+
+static const SDL_CPUImplementation SDL_FillRect2Impls[] = {
+#ifdef __SSE__
+    { CPU_HAS_SSE, (SDL_CPUFunction) SDL_FillRect2SSE },
+#endif
+#ifdef __MMX__
+    { CPU_HAS_MMX, (SDL_CPUFunction) SDL_FillRect2MMX },
+#endif
+    { 0, (SDL_CPUFunction) SDL_FillRect2 }
+};
+
+/* 24-bit RGB is a slow path, at least for now. */
+static const SDL_CPUImplementation SDL_FillRect3Impls[] = {
+    { 0, (SDL_CPUFunction) SDL_FillRect3 }
+};
+
+static const SDL_CPUImplementation SDL_FillRect4Impls[] = {
+#ifdef __SSE__
+    { CPU_HAS_SSE, (SDL_CPUFunction) SDL_FillRect4SSE },
+#endif
+#ifdef __MMX__
+    { CPU_HAS_MMX, (SDL_CPUFunction) SDL_FillRect4MMX },
+#endif
+    { 0, (SDL_CPUFunction) SDL_FillRect4 }
+};
+
+static SDL_FillRectFunc
+SDL_GetFillRectFunc(int bpp)
+{
+    static const SDL_CPUImplementation *impls[] = {
+        SDL_FillRect1Impls, SDL_FillRect2Impls, SDL_FillRect3Impls, SDL_FillRect4Impls
+    };
+    static SDL_FillRectFunc funcs[4];
+
+    /* Pick the best implementation the first time each depth is used */
+    if (!funcs[bpp - 1]) {
+        funcs[bpp - 1] = (SDL_FillRectFunc) SDL_SelectCPUImplementation(impls[bpp - 1]);
+    }
+    return funcs[bpp - 1];
+}
+
 /* 
  * This function performs a fast fill of the given rectangle with 'color'
  */
@@ -313,6 +366,7 @@ SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
 {
     SDL_Rect clipped;
     Uint8 *pixels;
+    int w, h;
 
     if (!dst) {
         SDL_SetError("Passed NULL destination surface");
@@ -345,72 +399,33 @@ SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
     pixels = (Uint8 *) dst->pixels + rect->y * dst->pitch +
                                      rect->x * dst->format->BytesPerPixel;
 
+    /* Replicate the color so the fill can be done a word at a time */
     switch (dst->format->BytesPerPixel) {
     case 1:
-        {
-            color |= (color << 8);
-            color |= (color << 16);
-#ifdef __SSE__
-            if (SDL_HasSSE()) {
-                SDL_FillRect1SSE(pixels, dst->pitch, color, rect->w, rect->h);
-                break;
-            }
-#endif
-#ifdef __MMX__
-            if (SDL_HasMMX()) {
-                SDL_FillRect1MMX(pixels, dst->pitch, color, rect->w, rect->h);
-                break;
-            }
-#endif
-            SDL_FillRect1(pixels, dst->pitch, color, rect->w, rect->h);
-            break;
-        }
-
+        color |= (color << 8);
+        color |= (color << 16);
+        break;
     case 2:
-        {
-            color |= (color << 16);
-#ifdef __SSE__
-            if (SDL_HasSSE()) {
-                SDL_FillRect2SSE(pixels, dst->pitch, color, rect->w, rect->h);
-                break;
-            }
-#endif
-#ifdef __MMX__
-            if (SDL_HasMMX()) {
-                SDL_FillRect2MMX(pixels, dst->pitch, color, rect->w, rect->h);
-                break;
-            }
-#endif
-            SDL_FillRect2(pixels, dst->pitch, color, rect->w, rect->h);
-            break;
-        }
-
-    case 3:
-        /* 24-bit RGB is a slow path, at least for now. */
-        {
-            SDL_FillRect3(pixels, dst->pitch, color, rect->w, rect->h);
-            break;
-        }
+        color |= (color << 16);
+        break;
+    }
 
-    case 4:
-        {
-#ifdef __SSE__
-            if (SDL_HasSSE()) {
-                SDL_FillRect4SSE(pixels, dst->pitch, color, rect->w, rect->h);
-                break;
-            }
-#endif
-#ifdef __MMX__
-            if (SDL_HasMMX()) {
-                SDL_FillRect4MMX(pixels, dst->pitch, color, rect->w, rect->h);
-                break;
-            }
-#endif
-            SDL_FillRect4(pixels, dst->pitch, color, rect->w, rect->h);
-            break;
-        }
+    /* The rows of aligned surfaces are padded with memory of their own,
+       so filling them across their whole width can run through the
+       padding as one long row of aligned stores.
+     */
+    w = rect->w;
+    h = rect->h;
+    if ((dst->flags & SDL_SIMD_ALIGNED) && dst->format->BytesPerPixel != 3 &&
+        rect->x == 0 && rect->w == dst->w && h > 1 &&
+        h <= 0x7FFFFFFF / dst->pitch) {
+        w = (dst->pitch / dst->format->BytesPerPixel) * h;
+        h = 1;
     }
 
+    SDL_GetFillRectFunc(dst->format->BytesPerPixel)(pixels, dst->pitch, color,
+                                                    w, h);
+
     /* We're done! */
     return 0;
 }
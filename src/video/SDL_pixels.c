@@ -22,13 +22,20 @@
 
 /* General (mostly internal) pixel/color manipulation routines for SDL */
 
+#include "SDL_atomic.h"
 #include "SDL_endian.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_hints.h"
 #include "SDL_video.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_pixels_c.h"
 #include "SDL_RLEaccel_c.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 
 /* Lookup tables to expand partial bytes to the full 0..255 range */
 
@@ -480,17 +487,56 @@ SDL_MasksToPixelFormatEnum(int bpp, Uint32 Rmask, Uint32 Gmask, Uint32 Bmask,
     return SDL_PIXELFORMAT_UNKNOWN;
 }
 
-static SDL_PixelFormat *formats;
+/* RGB formats are shared, hashed by pixel format enum.
+   Lookups take the lock for reading and bump the reference count with
+   an atomic add, inserting and removing formats takes it for writing.
+   Indexed formats own their palette, so they are never shared.
+ */
+#define FORMAT_HASH_BITS    6
+#define FORMAT_HASH_SIZE    (1 << FORMAT_HASH_BITS)
+
+static SDL_PixelFormat *formats[FORMAT_HASH_SIZE];
+static SDL_RWSpinLock formats_lock;
+
+#define FORMAT_REFCOUNT(format) ((SDL_atomic_t *)&(format)->refcount)
+
+static __inline__ Uint32
+SDL_HashPixelFormat(Uint32 pixel_format)
+{
+    return (Uint32)(pixel_format * 0x9E3779B1u) >> (32 - FORMAT_HASH_BITS);
+}
+
+/* Must be called with formats_lock held */
+static SDL_PixelFormat *
+SDL_FindCachedFormat(Uint32 pixel_format)
+{
+    SDL_PixelFormat *format;
+
+    for (format = formats[SDL_HashPixelFormat(pixel_format)];
+         format; format = format->next) {
+        if (format->format == pixel_format) {
+            return format;
+        }
+    }
+    return NULL;
+}
 
 SDL_PixelFormat *
 SDL_AllocFormat(Uint32 pixel_format)
 {
     SDL_PixelFormat *format;
+    SDL_PixelFormat *cached;
+    Uint32 hash;
 
-    /* Look it up in our list of previously allocated formats */
-    for (format = formats; format; format = format->next) {
-        if (pixel_format == format->format) {
-            ++format->refcount;
+    if (!SDL_ISPIXELFORMAT_INDEXED(pixel_format)) {
+        /* Look it up in our table of previously allocated formats */
+        SDL_AtomicLockRead(&formats_lock);
+        format = SDL_FindCachedFormat(pixel_format);
+        if (format) {
+            SDL_AtomicIncRef(FORMAT_REFCOUNT(format));
+        }
+        SDL_AtomicUnlockRead(&formats_lock);
+        if (format) {
             return format;
         }
     }
@@ -507,9 +553,21 @@ SDL_AllocFormat(Uint32 pixel_format)
     }
 
     if (!SDL_ISPIXELFORMAT_INDEXED(pixel_format)) {
-        /* Cache the RGB formats */
-        format->next = formats;
-        formats = format;
+        /* Cache the RGB formats, unless another thread beat us to it */
+        hash = SDL_HashPixelFormat(pixel_format);
+        SDL_AtomicLockWrite(&formats_lock);
+        cached = SDL_FindCachedFormat(pixel_format);
+        if (cached) {
+            SDL_AtomicIncRef(FORMAT_REFCOUNT(cached));
+        } else {
+            format->next = formats[hash];
+            formats[hash] = format;
+        }
+        SDL_AtomicUnlockWrite(&formats_lock);
+        if (cached) {
+            SDL_free(format);
+            format = cached;
+        }
     }
     return format;
 }
@@ -517,10 +575,27 @@ SDL_AllocFormat(Uint32 pixel_format)
 int
 SDL_InitFormat(SDL_PixelFormat * format, Uint32 pixel_format)
 {
+    SDL_PixelFormat *cached = NULL;
     int bpp;
     Uint32 Rmask, Gmask, Bmask, Amask;
     Uint32 mask;
 
+    /* Copy the precomputed shifts and losses of a shared format */
+    if (!SDL_ISPIXELFORMAT_INDEXED(pixel_format)) {
+        SDL_AtomicLockRead(&formats_lock);
+        cached = SDL_FindCachedFormat(pixel_format);
+        if (cached) {
+            *format = *cached;
+        }
+        SDL_AtomicUnlockRead(&formats_lock);
+    }
+    if (cached) {
+        format->palette = NULL;
+        format->refcount = 1;
+        format->next = NULL;
+        return 0;
+    }
+
     if (!SDL_PixelFormatEnumToMasks(pixel_format, &bpp,
                                     &Rmask, &Gmask, &Bmask, &Amask)) {
         return -1;
@@ -582,25 +657,44 @@ SDL_InitFormat(SDL_PixelFormat * format, Uint32 pixel_format)
 void
 SDL_FreeFormat(SDL_PixelFormat *format)
 {
-    SDL_PixelFormat *prev;
+    SDL_PixelFormat **prev;
+    int refcount;
 
     if (!format) {
         return;
     }
-    if (--format->refcount > 0) {
-        return;
+
+    /* Drop references without the lock while others remain */
+    for (;;) {
+        refcount = SDL_AtomicGet(FORMAT_REFCOUNT(format));
+        if (refcount <= 1) {
+            break;
+        }
+        if (SDL_AtomicCAS(FORMAT_REFCOUNT(format), refcount, refcount - 1)) {
+            return;
+        }
     }
 
-    /* Remove this format from our list */
-    if (format == formats) {
-        formats = format->next;
-    } else if (formats) {
-        for (prev = formats; prev->next; prev = prev->next) {
-            if (prev->next == format) {
-                prev->next = format->next;
+    if (SDL_ISPIXELFORMAT_INDEXED(format->format)) {
+        if (!SDL_AtomicDecRef(FORMAT_REFCOUNT(format))) {
+            return;
+        }
+    } else {
+        /* The last reference goes away with the format out of the table,
+           so a concurrent lookup can never resurrect it */
+        SDL_AtomicLockWrite(&formats_lock);
+        if (!SDL_AtomicDecRef(FORMAT_REFCOUNT(format))) {
+            SDL_AtomicUnlockWrite(&formats_lock);
+            return;
+        }
+        for (prev = &formats[SDL_HashPixelFormat(format->format)];
+             *prev; prev = &(*prev)->next) {
+            if (*prev == format) {
+                *prev = format->next;
                 break;
             }
         }
+        SDL_AtomicUnlockWrite(&formats_lock);
     }
 
     if (format->palette) {
@@ -609,6 +703,8 @@ SDL_FreeFormat(SDL_PixelFormat *format)
     SDL_free(format);
 }
 
+static void SDL_ForgetInverseColormap(const SDL_Palette * pal);
+
 SDL_Palette *
 SDL_AllocPalette(int ncolors)
 {
@@ -700,6 +796,7 @@ SDL_FreePalette(SDL_Palette * palette)
     if (--palette->refcount > 0) {
         return;
     }
+    SDL_ForgetInverseColormap(palette);
     if (palette->colors) {
         SDL_free(palette->colors);
     }
@@ -734,15 +831,34 @@ SDL_DitherColors(SDL_Color * colors, int bpp)
     }
 }
 
+/*
+ * Get the alignment of surface rows requested with SDL_HINT_SURFACE_ALIGNMENT
+ */
+int
+SDL_GetSurfaceAlignment(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_SURFACE_ALIGNMENT);
+    int alignment;
+
+    if (hint) {
+        alignment = SDL_atoi(hint);
+        if (alignment == 16 || alignment == 32 || alignment == 64) {
+            return alignment;
+        }
+    }
+    return 4;
+}
+
 /* 
  * Calculate the pad-aligned scanline width of a surface
  */
 int
 SDL_CalculatePitch(SDL_Surface * surface)
 {
-    int pitch;
+    int pitch, alignment;
 
-    /* Surface should be 4-byte aligned for speed */
+    /* Surface should be at least 4-byte aligned for speed */
+    alignment = SDL_GetSurfaceAlignment();
     pitch = surface->w * surface->format->BytesPerPixel;
     switch (surface->format->BitsPerPixel) {
     case 1:
@@ -754,15 +870,191 @@ SDL_CalculatePitch(SDL_Surface * surface)
     default:
         break;
     }
-    pitch = (pitch + 3) & ~3;   /* 4-byte aligning */
+    pitch = (pitch + alignment - 1) & ~(alignment - 1);
     return (pitch);
 }
 
 /*
- * Match an RGB value to a particular palette index
+ * Inverse colormaps
+ *
+ * Finding the nearest palette color means measuring the distance to every
+ * color in the palette.  Instead, the RGB cube is split into cells, and each
+ * cell lists only the colors that can be nearest to some point in it, in
+ * palette order so that ties go the same way.  A palette gets one once it
+ * has been searched often enough without changing.
  */
-Uint8
-SDL_FindColor(SDL_Palette * pal, Uint8 r, Uint8 g, Uint8 b)
+#define INVERSE_SHIFT           5       /* Cells are 32 values wide */
+#define INVERSE_SIDE            (256 >> INVERSE_SHIFT)
+#define INVERSE_CELLS           (INVERSE_SIDE * INVERSE_SIDE * INVERSE_SIDE)
+#define INVERSE_CACHE_SIZE      8
+#define INVERSE_MIN_COLORS      32      /* Smaller palettes are searched quickly */
+#define INVERSE_MIN_SEARCHES    1024
+
+typedef struct
+{
+    const SDL_Palette *palette;
+    Uint32 version;
+    int ncolors;
+    int searches;               /* Searches since the palette last changed */
+    Uint32 *cells;              /* Where each cell's colors start and end */
+    Uint8 *colors;
+} SDL_InverseColormap;
+
+static SDL_InverseColormap inverse_cache[INVERSE_CACHE_SIZE];
+static int inverse_next;
+static SDL_SpinLock inverse_lock;
+
+static void
+SDL_ResetInverseColormap(SDL_InverseColormap * inverse, const SDL_Palette * pal)
+{
+    if (inverse->cells) {
+        SDL_free(inverse->cells);
+        inverse->cells = NULL;
+    }
+    if (inverse->colors) {
+        SDL_free(inverse->colors);
+        inverse->colors = NULL;
+    }
+    inverse->palette = pal;
+    inverse->version = pal ? pal->version : 0;
+    inverse->ncolors = pal ? pal->ncolors : 0;
+    inverse->searches = 0;
+}
+
+static void
+SDL_BuildInverseColormap(SDL_InverseColormap * inverse, const SDL_Palette * pal)
+{
+    const int width = (1 << INVERSE_SHIFT) - 1;
+    Uint32 near_distance[256];
+    Uint32 count = 0;
+    int cell, i;
+
+    inverse->cells = (Uint32 *) SDL_malloc((INVERSE_CELLS + 1) * sizeof(Uint32));
+    inverse->colors = (Uint8 *) SDL_malloc(INVERSE_CELLS * pal->ncolors);
+    if (!inverse->cells || !inverse->colors) {
+        /* Keep searching the whole palette */
+        SDL_ResetInverseColormap(inverse, pal);
+        return;
+    }
+
+    for (cell = 0; cell < INVERSE_CELLS; ++cell) {
+        const int rlo = (cell / (INVERSE_SIDE * INVERSE_SIDE)) << INVERSE_SHIFT;
+        const int glo = ((cell / INVERSE_SIDE) % INVERSE_SIDE) << INVERSE_SHIFT;
+        const int blo = (cell % INVERSE_SIDE) << INVERSE_SHIFT;
+        Uint32 bound = ~0;
+
+        /* The nearest color to any point in the cell is no further away
+           than the furthest point of the cell from any one color.
+         */
+        for (i = 0; i < pal->ncolors; ++i) {
+            const SDL_Color *color = &pal->colors[i];
+            int rn = (color->r < rlo) ? rlo - color->r : SDL_max(color->r - (rlo + width), 0);
+            int gn = (color->g < glo) ? glo - color->g : SDL_max(color->g - (glo + width), 0);
+            int bn = (color->b < blo) ? blo - color->b : SDL_max(color->b - (blo + width), 0);
+            int rf = SDL_max(color->r - rlo, rlo + width - color->r);
+            int gf = SDL_max(color->g - glo, glo + width - color->g);
+            int bf = SDL_max(color->b - blo, blo + width - color->b);
+            Uint32 far_distance = (rf * rf) + (gf * gf) + (bf * bf);
+
+            near_distance[i] = (rn * rn) + (gn * gn) + (bn * bn);
+            if (far_distance < bound) {
+                bound = far_distance;
+            }
+        }
+
+        inverse->cells[cell] = count;
+        for (i = 0; i < pal->ncolors; ++i) {
+            if (near_distance[i] <= bound) {
+                inverse->colors[count++] = (Uint8) i;
+            }
+        }
+    }
+    inverse->cells[INVERSE_CELLS] = count;
+
+    /* Give back the space that wasn't needed */
+    {
+        Uint8 *colors = (Uint8 *) SDL_realloc(inverse->colors, count);
+        if (colors) {
+            inverse->colors = colors;
+        }
+    }
+}
+
+/* Find the inverse colormap for a palette, building it once the palette has
+   been searched at least min_searches times.  The lock must be held.
+ */
+static SDL_InverseColormap *
+SDL_GetInverseColormap(const SDL_Palette * pal, int min_searches)
+{
+    SDL_InverseColormap *inverse = NULL;
+    int i;
+
+    for (i = 0; i < INVERSE_CACHE_SIZE; ++i) {
+        if (inverse_cache[i].palette == pal) {
+            inverse = &inverse_cache[i];
+            break;
+        }
+    }
+    if (!inverse) {
+        inverse = &inverse_cache[inverse_next];
+        inverse_next = (inverse_next + 1) % INVERSE_CACHE_SIZE;
+        SDL_ResetInverseColormap(inverse, pal);
+    } else if (inverse->version != pal->version ||
+               inverse->ncolors != pal->ncolors) {
+        SDL_ResetInverseColormap(inverse, pal);
+    }
+    if (!inverse->cells && ++inverse->searches >= min_searches) {
+        SDL_BuildInverseColormap(inverse, pal);
+    }
+    return inverse;
+}
+
+static void
+SDL_ForgetInverseColormap(const SDL_Palette * pal)
+{
+    int i;
+
+    SDL_AtomicLock(&inverse_lock);
+    for (i = 0; i < INVERSE_CACHE_SIZE; ++i) {
+        if (inverse_cache[i].palette == pal) {
+            SDL_ResetInverseColormap(&inverse_cache[i], NULL);
+        }
+    }
+    SDL_AtomicUnlock(&inverse_lock);
+}
+
+static Uint8
+SDL_SearchInverseColormap(const SDL_InverseColormap * inverse,
+                          const SDL_Palette * pal, Uint8 r, Uint8 g, Uint8 b)
+{
+    const int cell = (((r >> INVERSE_SHIFT) * INVERSE_SIDE) +
+                      (g >> INVERSE_SHIFT)) * INVERSE_SIDE + (b >> INVERSE_SHIFT);
+    const Uint8 *index = &inverse->colors[inverse->cells[cell]];
+    const Uint8 *end = &inverse->colors[inverse->cells[cell + 1]];
+    unsigned int smallest;
+    unsigned int distance;
+    int rd, gd, bd;
+    Uint8 pixel = 0;
+
+    smallest = ~0;
+    for ( ; index < end; ++index) {
+        rd = pal->colors[*index].r - r;
+        gd = pal->colors[*index].g - g;
+        bd = pal->colors[*index].b - b;
+        distance = (rd * rd) + (gd * gd) + (bd * bd);
+        if (distance < smallest) {
+            pixel = *index;
+            if (distance == 0) {        /* Perfect match! */
+                break;
+            }
+            smallest = distance;
+        }
+    }
+    return (pixel);
+}
+
+static Uint8
+SDL_SearchPalette(const SDL_Palette * pal, Uint8 r, Uint8 g, Uint8 b)
 {
     /* Do colorspace distance matching */
     unsigned int smallest;
@@ -788,6 +1080,31 @@ SDL_FindColor(SDL_Palette * pal, Uint8 r, Uint8 g, Uint8 b)
     return (pixel);
 }
 
+/*
+ * Match an RGB value to a particular palette index
+ */
+Uint8
+SDL_FindColor(SDL_Palette * pal, Uint8 r, Uint8 g, Uint8 b)
+{
+    SDL_InverseColormap *inverse;
+    Uint8 pixel;
+
+    if (pal->ncolors < INVERSE_MIN_COLORS || pal->ncolors > 256) {
+        return SDL_SearchPalette(pal, r, g, b);
+    }
+
+    SDL_AtomicLock(&inverse_lock);
+    inverse = SDL_GetInverseColormap(pal, INVERSE_MIN_SEARCHES);
+    if (inverse->cells) {
+        pixel = SDL_SearchInverseColormap(inverse, pal, r, g, b);
+        SDL_AtomicUnlock(&inverse_lock);
+    } else {
+        SDL_AtomicUnlock(&inverse_lock);
+        pixel = SDL_SearchPalette(pal, r, g, b);
+    }
+    return (pixel);
+}
+
 /* Find the opaque pixel value corresponding to an RGB triple */
 Uint32
 SDL_MapRGB(const SDL_PixelFormat * format, Uint8 r, Uint8 g, Uint8 b)
@@ -865,6 +1182,450 @@ SDL_GetRGBA(Uint32 pixel, const SDL_PixelFormat * format,
     }
 }
 
+/* Array versions of SDL_MapRGBA() and SDL_GetRGBA()
+
+   The SIMD kernels do the same shifts and masks on four pixels at a time,
+   for formats of 16 or 32 bits per pixel with channels of at most 8 bits.
+   Expanding a channel of fewer bits divides by its largest value, rounding
+   down like SDL_expand_byte, with a multiply and a shift.  Other formats
+   and the pixels left over go through the per-pixel functions.
+ */
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN && \
+    (defined(__SSE2__) || defined(__ARM_NEON__) || defined(__ARM_NEON))
+#define SDL_PIXEL_ARRAY_SIMD
+
+/* How a channel is expanded to 8 bits */
+enum
+{
+    EXPAND_COPY,        /* 8 bits */
+    EXPAND_OPAQUE,      /* no bits, always 255 */
+    EXPAND_ONE_BIT,     /* 0 or 255 */
+    EXPAND_DIVIDE       /* v * 255 / (2^bits - 1) */
+};
+
+typedef struct
+{
+    int shift;
+    Uint32 mask;        /* The mask, shifted down */
+    int expand;
+    Uint32 multiplier;  /* (v * 255 * multiplier) >> (16 + divshift) */
+    int divshift;
+} SDL_ChannelExpand;
+
+static void
+SDL_GetChannelExpand(Uint32 mask, Uint8 shift, Uint8 loss,
+                     SDL_ChannelExpand * channel)
+{
+    const int bits = 8 - loss;
+
+    channel->shift = shift;
+    channel->mask = mask >> shift;
+    channel->multiplier = 0;
+    channel->divshift = 0;
+    if (bits == 8) {
+        channel->expand = EXPAND_COPY;
+    } else if (bits == 0) {
+        channel->expand = EXPAND_OPAQUE;
+    } else if (bits == 1) {
+        channel->expand = EXPAND_ONE_BIT;
+    } else {
+        /* Exact for every v * 255 with this many bits */
+        const Uint32 max = (1 << bits) - 1;
+        channel->expand = EXPAND_DIVIDE;
+        channel->divshift = bits - 1;
+        channel->multiplier = ((1 << (15 + bits)) + max - 1) / max;
+    }
+}
+
+static SDL_bool
+SDL_IsArrayFormatSIMD(const SDL_PixelFormat * format)
+{
+    return (format->palette == NULL &&
+            (format->BytesPerPixel == 2 || format->BytesPerPixel == 4) &&
+            format->Rloss <= 8 && format->Gloss <= 8 &&
+            format->Bloss <= 8 && format->Aloss <= 8);
+}
+#endif /* SDL_PIXEL_ARRAY_SIMD */
+
+#if defined(SDL_PIXEL_ARRAY_SIMD) && defined(__SSE2__)
+
+static int
+SDL_MapRGBAArraySIMD(const SDL_PixelFormat * format, const Uint8 * colors,
+                     void * pixels, int count)
+{
+    const __m128i bytemask = _mm_set1_epi32(0xFF);
+    const __m128i amask = _mm_set1_epi32(format->Amask);
+    const __m128i rloss = _mm_cvtsi32_si128(format->Rloss);
+    const __m128i gloss = _mm_cvtsi32_si128(format->Gloss);
+    const __m128i bloss = _mm_cvtsi32_si128(format->Bloss);
+    const __m128i aloss = _mm_cvtsi32_si128(format->Aloss);
+    const __m128i rshift = _mm_cvtsi32_si128(format->Rshift);
+    const __m128i gshift = _mm_cvtsi32_si128(format->Gshift);
+    const __m128i bshift = _mm_cvtsi32_si128(format->Bshift);
+    const __m128i ashift = _mm_cvtsi32_si128(format->Ashift);
+    int i;
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        const __m128i c = _mm_loadu_si128((const __m128i *) &colors[i * 4]);
+        const __m128i r = _mm_and_si128(c, bytemask);
+        const __m128i g = _mm_and_si128(_mm_srli_epi32(c, 8), bytemask);
+        const __m128i b = _mm_and_si128(_mm_srli_epi32(c, 16), bytemask);
+        const __m128i a = _mm_srli_epi32(c, 24);
+        __m128i p;
+
+        p = _mm_sll_epi32(_mm_srl_epi32(r, rloss), rshift);
+        p = _mm_or_si128(p, _mm_sll_epi32(_mm_srl_epi32(g, gloss), gshift));
+        p = _mm_or_si128(p, _mm_sll_epi32(_mm_srl_epi32(b, bloss), bshift));
+        p = _mm_or_si128(p, _mm_and_si128(_mm_sll_epi32(_mm_srl_epi32(a, aloss), ashift), amask));
+        if (format->BytesPerPixel == 4) {
+            _mm_storeu_si128((__m128i *) ((Uint32 *) pixels + i), p);
+        } else {
+            /* Sign extend so the saturating pack keeps the low halves */
+            p = _mm_srai_epi32(_mm_slli_epi32(p, 16), 16);
+            _mm_storel_epi64((__m128i *) ((Uint16 *) pixels + i), _mm_packs_epi32(p, p));
+        }
+    }
+    return i;
+}
+
+static __inline__ __m128i
+SDL_ExpandChannelSSE2(__m128i p, const SDL_ChannelExpand * channel)
+{
+    __m128i v;
+
+    if (channel->expand == EXPAND_OPAQUE) {
+        return _mm_set1_epi32(0xFF);
+    }
+    v = _mm_and_si128(_mm_srl_epi32(p, _mm_cvtsi32_si128(channel->shift)),
+                      _mm_set1_epi32(channel->mask));
+    switch (channel->expand) {
+    case EXPAND_ONE_BIT:
+        v = _mm_sub_epi32(_mm_slli_epi32(v, 8), v);
+        break;
+    case EXPAND_DIVIDE:
+        /* v * 255 fits in the low 16 bits of each lane */
+        v = _mm_sub_epi32(_mm_slli_epi32(v, 8), v);
+        v = _mm_mulhi_epu16(v, _mm_set1_epi32(channel->multiplier));
+        v = _mm_srl_epi32(v, _mm_cvtsi32_si128(channel->divshift));
+        break;
+    default:
+        break;
+    }
+    return v;
+}
+
+static int
+SDL_GetRGBAArraySIMD(const SDL_PixelFormat * format, const void * pixels,
+                     Uint8 * colors, int count)
+{
+    SDL_ChannelExpand r, g, b, a;
+    int i;
+
+    SDL_GetChannelExpand(format->Rmask, format->Rshift, format->Rloss, &r);
+    SDL_GetChannelExpand(format->Gmask, format->Gshift, format->Gloss, &g);
+    SDL_GetChannelExpand(format->Bmask, format->Bshift, format->Bloss, &b);
+    SDL_GetChannelExpand(format->Amask, format->Ashift, format->Aloss, &a);
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        __m128i p, c;
+
+        if (format->BytesPerPixel == 4) {
+            p = _mm_loadu_si128((const __m128i *) ((const Uint32 *) pixels + i));
+        } else {
+            p = _mm_loadl_epi64((const __m128i *) ((const Uint16 *) pixels + i));
+            p = _mm_unpacklo_epi16(p, _mm_setzero_si128());
+        }
+        c = SDL_ExpandChannelSSE2(p, &r);
+        c = _mm_or_si128(c, _mm_slli_epi32(SDL_ExpandChannelSSE2(p, &g), 8));
+        c = _mm_or_si128(c, _mm_slli_epi32(SDL_ExpandChannelSSE2(p, &b), 16));
+        c = _mm_or_si128(c, _mm_slli_epi32(SDL_ExpandChannelSSE2(p, &a), 24));
+        _mm_storeu_si128((__m128i *) &colors[i * 4], c);
+    }
+    return i;
+}
+
+static int
+SDL_ColorsToFloatSIMD(const Uint8 * colors, float * values, int count)
+{
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128i zero = _mm_setzero_si128();
+    int i;
+
+    /* Four values per color */
+    for (i = 0; i + 16 <= count * 4; i += 16) {
+        const __m128i c = _mm_loadu_si128((const __m128i *) &colors[i]);
+        const __m128i lo = _mm_unpacklo_epi8(c, zero);
+        const __m128i hi = _mm_unpackhi_epi8(c, zero);
+
+        _mm_storeu_ps(&values[i + 0], _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+        _mm_storeu_ps(&values[i + 4], _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+        _mm_storeu_ps(&values[i + 8], _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+        _mm_storeu_ps(&values[i + 12], _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+    }
+    return i / 4;
+}
+
+#elif defined(SDL_PIXEL_ARRAY_SIMD)
+
+static int
+SDL_MapRGBAArraySIMD(const SDL_PixelFormat * format, const Uint8 * colors,
+                     void * pixels, int count)
+{
+    const uint32x4_t bytemask = vdupq_n_u32(0xFF);
+    const uint32x4_t amask = vdupq_n_u32(format->Amask);
+    const int32x4_t rloss = vdupq_n_s32(-(int) format->Rloss);
+    const int32x4_t gloss = vdupq_n_s32(-(int) format->Gloss);
+    const int32x4_t bloss = vdupq_n_s32(-(int) format->Bloss);
+    const int32x4_t aloss = vdupq_n_s32(-(int) format->Aloss);
+    const int32x4_t rshift = vdupq_n_s32(format->Rshift);
+    const int32x4_t gshift = vdupq_n_s32(format->Gshift);
+    const int32x4_t bshift = vdupq_n_s32(format->Bshift);
+    const int32x4_t ashift = vdupq_n_s32(format->Ashift);
+    int i;
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        const uint32x4_t c = vreinterpretq_u32_u8(vld1q_u8(&colors[i * 4]));
+        const uint32x4_t r = vandq_u32(c, bytemask);
+        const uint32x4_t g = vandq_u32(vshrq_n_u32(c, 8), bytemask);
+        const uint32x4_t b = vandq_u32(vshrq_n_u32(c, 16), bytemask);
+        const uint32x4_t a = vshrq_n_u32(c, 24);
+        uint32x4_t p;
+
+        p = vshlq_u32(vshlq_u32(r, rloss), rshift);
+        p = vorrq_u32(p, vshlq_u32(vshlq_u32(g, gloss), gshift));
+        p = vorrq_u32(p, vshlq_u32(vshlq_u32(b, bloss), bshift));
+        p = vorrq_u32(p, vandq_u32(vshlq_u32(vshlq_u32(a, aloss), ashift), amask));
+        if (format->BytesPerPixel == 4) {
+            vst1q_u32((Uint32 *) pixels + i, p);
+        } else {
+            vst1_u16((Uint16 *) pixels + i, vmovn_u32(p));
+        }
+    }
+    return i;
+}
+
+static __inline__ uint32x4_t
+SDL_ExpandChannelNEON(uint32x4_t p, const SDL_ChannelExpand * channel)
+{
+    uint32x4_t v;
+
+    if (channel->expand == EXPAND_OPAQUE) {
+        return vdupq_n_u32(0xFF);
+    }
+    v = vandq_u32(vshlq_u32(p, vdupq_n_s32(-channel->shift)),
+                  vdupq_n_u32(channel->mask));
+    switch (channel->expand) {
+    case EXPAND_ONE_BIT:
+        v = vsubq_u32(vshlq_n_u32(v, 8), v);
+        break;
+    case EXPAND_DIVIDE:
+        /* v * 255 * multiplier fits in 32 bits */
+        v = vsubq_u32(vshlq_n_u32(v, 8), v);
+        v = vmulq_u32(v, vdupq_n_u32(channel->multiplier));
+        v = vshlq_u32(v, vdupq_n_s32(-(16 + channel->divshift)));
+        break;
+    default:
+        break;
+    }
+    return v;
+}
+
+static int
+SDL_GetRGBAArraySIMD(const SDL_PixelFormat * format, const void * pixels,
+                     Uint8 * colors, int count)
+{
+    SDL_ChannelExpand r, g, b, a;
+    int i;
+
+    SDL_GetChannelExpand(format->Rmask, format->Rshift, format->Rloss, &r);
+    SDL_GetChannelExpand(format->Gmask, format->Gshift, format->Gloss, &g);
+    SDL_GetChannelExpand(format->Bmask, format->Bshift, format->Bloss, &b);
+    SDL_GetChannelExpand(format->Amask, format->Ashift, format->Aloss, &a);
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        uint32x4_t p, c;
+
+        if (format->BytesPerPixel == 4) {
+            p = vld1q_u32((const Uint32 *) pixels + i);
+        } else {
+            p = vmovl_u16(vld1_u16((const Uint16 *) pixels + i));
+        }
+        c = SDL_ExpandChannelNEON(p, &r);
+        c = vorrq_u32(c, vshlq_n_u32(SDL_ExpandChannelNEON(p, &g), 8));
+        c = vorrq_u32(c, vshlq_n_u32(SDL_ExpandChannelNEON(p, &b), 16));
+        c = vorrq_u32(c, vshlq_n_u32(SDL_ExpandChannelNEON(p, &a), 24));
+        vst1q_u8(&colors[i * 4], vreinterpretq_u8_u32(c));
+    }
+    return i;
+}
+
+static int
+SDL_ColorsToFloatSIMD(const Uint8 * colors, float * values, int count)
+{
+    int i = 0;
+
+#ifdef __aarch64__
+    const float32x4_t scale = vdupq_n_f32(255.0f);
+
+    /* Four values per color, divided rather than scaled to match C */
+    for (; i + 8 <= count * 4; i += 8) {
+        const uint16x8_t c = vmovl_u8(vld1_u8(&colors[i]));
+        const float32x4_t lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(c)));
+        const float32x4_t hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(c)));
+
+        vst1q_f32(&values[i], vdivq_f32(lo, scale));
+        vst1q_f32(&values[i + 4], vdivq_f32(hi, scale));
+    }
+#endif
+    return i / 4;
+}
+
+#endif /* SDL_PIXEL_ARRAY_SIMD */
+
+/* Store and load pixels as they are laid out in a surface */
+static __inline__ void
+SDL_StoreArrayPixel(Uint8 * pixels, int bpp, int i, Uint32 pixel)
+{
+    switch (bpp) {
+    case 1:
+        pixels[i] = (Uint8) pixel;
+        break;
+    case 2:
+        ((Uint16 *) pixels)[i] = (Uint16) pixel;
+        break;
+    case 3:
+        pixels += i * 3;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        pixels[0] = (Uint8) pixel;
+        pixels[1] = (Uint8) (pixel >> 8);
+        pixels[2] = (Uint8) (pixel >> 16);
+#else
+        pixels[0] = (Uint8) (pixel >> 16);
+        pixels[1] = (Uint8) (pixel >> 8);
+        pixels[2] = (Uint8) pixel;
+#endif
+        break;
+    default:
+        ((Uint32 *) pixels)[i] = pixel;
+        break;
+    }
+}
+
+static __inline__ Uint32
+SDL_LoadArrayPixel(const Uint8 * pixels, int bpp, int i)
+{
+    switch (bpp) {
+    case 1:
+        return pixels[i];
+    case 2:
+        return ((const Uint16 *) pixels)[i];
+    case 3:
+        pixels += i * 3;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        return pixels[0] | (pixels[1] << 8) | (pixels[2] << 16);
+#else
+        return (pixels[0] << 16) | (pixels[1] << 8) | pixels[2];
+#endif
+    default:
+        return ((const Uint32 *) pixels)[i];
+    }
+}
+
+static int
+SDL_CheckArrayArgs(const SDL_PixelFormat * format, const void * pixels,
+                   const void * colors, int count)
+{
+    if (!format) {
+        SDL_InvalidParamError("format");
+        return -1;
+    }
+    if (format->BitsPerPixel < 8) {
+        SDL_SetError("Pixel arrays of less than 8 bits per pixel are not supported");
+        return -1;
+    }
+    if (count < 0) {
+        SDL_InvalidParamError("count");
+        return -1;
+    }
+    if (count > 0 && (!pixels || !colors)) {
+        SDL_InvalidParamError(pixels ? "colors" : "pixels");
+        return -1;
+    }
+    return 0;
+}
+
+int
+SDL_MapRGBAArray(const SDL_PixelFormat * format, const Uint8 * colors,
+                 void * pixels, int count)
+{
+    int i = 0;
+
+    if (SDL_CheckArrayArgs(format, pixels, colors, count) < 0) {
+        return -1;
+    }
+#ifdef SDL_PIXEL_ARRAY_SIMD
+    if (SDL_IsArrayFormatSIMD(format)) {
+        i = SDL_MapRGBAArraySIMD(format, colors, pixels, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        const Uint8 *c = &colors[i * 4];
+        SDL_StoreArrayPixel((Uint8 *) pixels, format->BytesPerPixel, i,
+                            SDL_MapRGBA(format, c[0], c[1], c[2], c[3]));
+    }
+    return 0;
+}
+
+int
+SDL_GetRGBAArray(const SDL_PixelFormat * format, const void * pixels,
+                 Uint8 * colors, int count)
+{
+    int i = 0;
+
+    if (SDL_CheckArrayArgs(format, pixels, colors, count) < 0) {
+        return -1;
+    }
+#ifdef SDL_PIXEL_ARRAY_SIMD
+    if (SDL_IsArrayFormatSIMD(format)) {
+        i = SDL_GetRGBAArraySIMD(format, pixels, colors, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        Uint8 *c = &colors[i * 4];
+        SDL_GetRGBA(SDL_LoadArrayPixel((const Uint8 *) pixels,
+                                       format->BytesPerPixel, i),
+                    format, &c[0], &c[1], &c[2], &c[3]);
+    }
+    return 0;
+}
+
+int
+SDL_GetRGBAFloatArray(const SDL_PixelFormat * format, const void * pixels,
+                      float * colors, int count)
+{
+    Uint8 chunk[256 * 4];
+    int i, j, n;
+
+    if (SDL_CheckArrayArgs(format, pixels, colors, count) < 0) {
+        return -1;
+    }
+
+    /* Unpack to bytes a chunk at a time, then convert those */
+    for (i = 0; i < count; i += n) {
+        n = SDL_min(count - i, 256);
+        SDL_GetRGBAArray(format, (const Uint8 *) pixels + i * format->BytesPerPixel,
+                         chunk, n);
+        j = 0;
+#ifdef SDL_PIXEL_ARRAY_SIMD
+        j = SDL_ColorsToFloatSIMD(chunk, &colors[i * 4], n) * 4;
+#endif
+        for (; j < n * 4; ++j) {
+            colors[i * 4 + j] = chunk[j] / 255.0f;
+        }
+    }
+    return 0;
+}
+
 /* Map from Palette to Palette */
 static Uint8 *
 Map1to1(SDL_Palette * src, SDL_Palette * dst, int *identical)
@@ -942,6 +1703,60 @@ MapNto1(SDL_PixelFormat * src, SDL_PixelFormat * dst, int *identical)
     return (Map1to1(&dithered, pal, identical));
 }
 
+/* Map from BitField to Palette through a 5-6-5 table, for dithering */
+static Uint8 *
+MapNto1Dither(SDL_PixelFormat * dst)
+{
+    SDL_Palette *pal = dst->palette;
+    SDL_InverseColormap *inverse = NULL;
+    Uint8 *map;
+    int r, g, b;
+
+    map = (Uint8 *) SDL_malloc(1 << 16);
+    if (map == NULL) {
+        SDL_OutOfMemory();
+        return (NULL);
+    }
+
+    SDL_AtomicLock(&inverse_lock);
+    if (pal->ncolors >= INVERSE_MIN_COLORS && pal->ncolors <= 256) {
+        inverse = SDL_GetInverseColormap(pal, 0);
+    }
+    for (r = 0; r < 32; ++r) {
+        for (g = 0; g < 64; ++g) {
+            for (b = 0; b < 32; ++b) {
+                const Uint8 R = SDL_expand_byte[3][r];
+                const Uint8 G = SDL_expand_byte[2][g];
+                const Uint8 B = SDL_expand_byte[3][b];
+                map[(r << 11) | (g << 5) | b] = (inverse && inverse->cells) ?
+                    SDL_SearchInverseColormap(inverse, pal, R, G, B) :
+                    SDL_SearchPalette(pal, R, G, B);
+            }
+        }
+    }
+    SDL_AtomicUnlock(&inverse_lock);
+
+    return (map);
+}
+
+static int
+SDL_GetDitherHint(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_SURFACE_DITHER);
+
+    if (hint) {
+        switch (*hint) {
+        case '1':
+            return SDL_DITHER_ORDERED;
+        case '2':
+            return SDL_DITHER_DIFFUSION;
+        default:
+            break;
+        }
+    }
+    return SDL_DITHER_NONE;
+}
+
 SDL_BlitMap *
 SDL_AllocBlitMap(void)
 {
@@ -999,6 +1814,7 @@ SDL_MapSurface(SDL_Surface * src, SDL_Surface * dst)
 
     /* Figure out what kind of mapping we're doing */
     map->identity = 0;
+    map->info.dither = SDL_DITHER_NONE;
     srcfmt = src->format;
     dstfmt = dst->format;
     if (SDL_ISPIXELFORMAT_INDEXED(srcfmt->format)) {
@@ -1025,11 +1841,22 @@ SDL_MapSurface(SDL_Surface * src, SDL_Surface * dst)
     } else {
         if (SDL_ISPIXELFORMAT_INDEXED(dstfmt->format)) {
             /* BitField --> Palette */
-            map->info.table = MapNto1(srcfmt, dstfmt, &map->identity);
-            if (!map->identity) {
+            if ((map->info.flags & ~SDL_COPY_RLE_MASK) == 0 &&
+                dstfmt->BitsPerPixel == 8) {
+                map->info.dither = SDL_GetDitherHint();
+            }
+            if (map->info.dither != SDL_DITHER_NONE) {
+                map->info.table = MapNto1Dither(dstfmt);
                 if (map->info.table == NULL) {
                     return (-1);
                 }
+            } else {
+                map->info.table = MapNto1(srcfmt, dstfmt, &map->identity);
+                if (!map->identity) {
+                    if (map->info.table == NULL) {
+                        return (-1);
+                    }
+                }
             }
             map->identity = 0;  /* Don't optimize to copy */
         } else {
@@ -22,6 +22,7 @@
 
 #include "SDL.h"
 #include "SDL_assert.h"
+#include "SDL_cpuinfo.h"
 #include "SDL_video.h"
 #include "SDL_sysvideo.h"
 #include "SDL_pixels.h"
@@ -29,6 +30,10 @@
 #include "SDL_shape.h"
 #include "SDL_shape_internals.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 SDL_Window*
 SDL_CreateShapedWindow(const char *title,unsigned int x,unsigned int y,unsigned int w,unsigned int h,Uint32 flags) {
     SDL_Window *result = NULL;
@@ -60,105 +65,370 @@ SDL_IsShapedWindow(const SDL_Window *window) {
         return (SDL_bool)(window->shaper != NULL);
 }
 
+/* How the pixels of a shape row are sorted into opaque and transparent */
+enum {
+    SHAPE_ROW_TABLE,    /* 8-bit pixels, looked up in a table */
+    SHAPE_ROW_ALPHA32,  /* 32-bit pixels with 8-bit alpha */
+    SHAPE_ROW_KEY32,    /* 32-bit pixels with 8-bit color channels */
+    SHAPE_ROW_COLORS    /* Anything else, through SDL_GetRGBAArray() */
+};
+
+typedef struct {
+    SDL_WindowShapeMode mode;
+    SDL_Surface *shape;
+    int method;
+    Uint8 table[256];
+    Uint32 ashift,alow,ahigh;
+    Uint32 keymask,key;
+    Uint8 *colors;
+} SDL_ShapeRowContext;
+
+static Uint8
+SDL_ShapePixelOpaque(const SDL_WindowShapeMode *mode,Uint8 r,Uint8 g,Uint8 b,Uint8 a) {
+    switch(mode->mode) {
+        case(ShapeModeDefault):
+            return (a >= 1 ? 1 : 0);
+        case(ShapeModeBinarizeAlpha):
+            return (a >= mode->parameters.binarizationCutoff ? 1 : 0);
+        case(ShapeModeReverseBinarizeAlpha):
+            return (a <= mode->parameters.binarizationCutoff ? 1 : 0);
+        case(ShapeModeColorKey):
+            return ((mode->parameters.colorKey.r != r || mode->parameters.colorKey.g != g || mode->parameters.colorKey.b != b) ? 1 : 0);
+    }
+    return 0;
+}
+
+static int
+SDL_InitShapeRowContext(SDL_ShapeRowContext *context,SDL_WindowShapeMode mode,SDL_Surface *shape) {
+    const SDL_PixelFormat *format = shape->format;
+    int i;
+    Uint8 r,g,b,a;
+
+    context->mode = mode;
+    context->shape = shape;
+    context->colors = NULL;
+    if(format->BytesPerPixel == 1) {
+        context->method = SHAPE_ROW_TABLE;
+        for(i = 0;i < 256;i++) {
+            SDL_GetRGBA(i,format,&r,&g,&b,&a);
+            context->table[i] = SDL_ShapePixelOpaque(&mode,r,g,b,a);
+        }
+    }
+    else if(format->BytesPerPixel == 4 && SDL_SHAPEMODEALPHA(mode.mode) && format->Aloss == 0) {
+        /* The pixel is opaque if its alpha is between alow and ahigh */
+        context->method = SHAPE_ROW_ALPHA32;
+        context->ashift = format->Ashift;
+        context->alow = (mode.mode == ShapeModeDefault ? 1 :
+                         mode.mode == ShapeModeBinarizeAlpha ? mode.parameters.binarizationCutoff : 0);
+        context->ahigh = (mode.mode == ShapeModeReverseBinarizeAlpha ? mode.parameters.binarizationCutoff : 255);
+    }
+    else if(format->BytesPerPixel == 4 && mode.mode == ShapeModeColorKey &&
+            format->Rloss == 0 && format->Gloss == 0 && format->Bloss == 0) {
+        /* The pixel is opaque unless its color matches the key exactly */
+        context->method = SHAPE_ROW_KEY32;
+        context->keymask = format->Rmask | format->Gmask | format->Bmask;
+        context->key = SDL_MapRGB(format,mode.parameters.colorKey.r,mode.parameters.colorKey.g,mode.parameters.colorKey.b) & context->keymask;
+    }
+    else {
+        context->method = SHAPE_ROW_COLORS;
+        context->colors = (Uint8*)SDL_malloc(shape->w * 4);
+        if(context->colors == NULL) {
+            SDL_OutOfMemory();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void
+SDL_QuitShapeRowContext(SDL_ShapeRowContext *context) {
+    SDL_free(context->colors);
+    context->colors = NULL;
+}
+
+#if defined(__SSE2__)
+static int
+SDL_CalculateShapeRow32SSE2(const SDL_ShapeRowContext *context,const Uint32 *pixels,Uint8 *row,int w) {
+    const __m128i ashift = _mm_cvtsi32_si128(context->ashift);
+    const __m128i bytemask = _mm_set1_epi32(0xFF);
+    const __m128i below = _mm_set1_epi32((int)context->alow - 1);
+    const __m128i ahigh = _mm_set1_epi32(context->ahigh);
+    const __m128i keymask = _mm_set1_epi32(context->keymask);
+    const __m128i key = _mm_set1_epi32(context->key);
+    const __m128i ones = _mm_set1_epi8(1);
+    __m128i opaque[2];
+    int x,i;
+
+    for(x = 0;x + 8 <= w;x += 8) {
+        for(i = 0;i < 2;i++) {
+            const __m128i p = _mm_loadu_si128((const __m128i*)&pixels[x + i * 4]);
+            if(context->method == SHAPE_ROW_ALPHA32) {
+                /* Alpha fits in a signed compare */
+                const __m128i a = _mm_and_si128(_mm_srl_epi32(p,ashift),bytemask);
+                opaque[i] = _mm_andnot_si128(_mm_cmpgt_epi32(a,ahigh),_mm_cmpgt_epi32(a,below));
+            }
+            else
+                opaque[i] = _mm_cmpeq_epi32(_mm_and_si128(p,keymask),key);
+        }
+        opaque[0] = _mm_packs_epi32(opaque[0],opaque[1]);
+        opaque[0] = _mm_packs_epi16(opaque[0],opaque[0]);
+        if(context->method == SHAPE_ROW_KEY32)
+            opaque[0] = _mm_andnot_si128(opaque[0],ones);
+        else
+            opaque[0] = _mm_and_si128(opaque[0],ones);
+        _mm_storel_epi64((__m128i*)&row[x],opaque[0]);
+    }
+    return x;
+}
+#define SDL_CalculateShapeRow32SIMD SDL_CalculateShapeRow32SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+static int
+SDL_CalculateShapeRow32NEON(const SDL_ShapeRowContext *context,const Uint32 *pixels,Uint8 *row,int w) {
+    const int32x4_t ashift = vdupq_n_s32(-(int)context->ashift);
+    const uint32x4_t bytemask = vdupq_n_u32(0xFF);
+    const uint32x4_t alow = vdupq_n_u32(context->alow);
+    const uint32x4_t ahigh = vdupq_n_u32(context->ahigh);
+    const uint32x4_t keymask = vdupq_n_u32(context->keymask);
+    const uint32x4_t key = vdupq_n_u32(context->key);
+    uint32x4_t opaque[2];
+    int x,i;
+
+    for(x = 0;x + 8 <= w;x += 8) {
+        for(i = 0;i < 2;i++) {
+            const uint32x4_t p = vld1q_u32(&pixels[x + i * 4]);
+            if(context->method == SHAPE_ROW_ALPHA32) {
+                const uint32x4_t a = vandq_u32(vshlq_u32(p,ashift),bytemask);
+                opaque[i] = vandq_u32(vcgeq_u32(a,alow),vcleq_u32(a,ahigh));
+            }
+            else
+                opaque[i] = vmvnq_u32(vceqq_u32(vandq_u32(p,keymask),key));
+        }
+        vst1_u8(&row[x],vand_u8(vmovn_u16(vcombine_u16(vmovn_u32(opaque[0]),vmovn_u32(opaque[1]))),vdup_n_u8(1)));
+    }
+    return x;
+}
+#define SDL_CalculateShapeRow32SIMD SDL_CalculateShapeRow32NEON
+#endif
+
+/* Sets row[x] to 1 for each opaque pixel in row y of the shape and to 0 for the others. */
+static void
+SDL_CalculateShapeRow(SDL_ShapeRowContext *context,int y,Uint8 *row) {
+    SDL_Surface *shape = context->shape;
+    const Uint8 *pixels = (const Uint8 *)shape->pixels + y * shape->pitch;
+    const Uint32 *pixels32 = (const Uint32 *)pixels;
+    const Uint8 *c;
+    int x = 0;
+
+    switch(context->method) {
+        case(SHAPE_ROW_TABLE):
+            for(x = 0;x < shape->w;x++)
+                row[x] = context->table[pixels[x]];
+            break;
+        case(SHAPE_ROW_ALPHA32):
+#ifdef SDL_CalculateShapeRow32SIMD
+            x = SDL_CalculateShapeRow32SIMD(context,pixels32,row,shape->w);
+#endif
+            for(;x < shape->w;x++) {
+                Uint32 a = (pixels32[x] >> context->ashift) & 0xFF;
+                row[x] = (a >= context->alow && a <= context->ahigh ? 1 : 0);
+            }
+            break;
+        case(SHAPE_ROW_KEY32):
+#ifdef SDL_CalculateShapeRow32SIMD
+            x = SDL_CalculateShapeRow32SIMD(context,pixels32,row,shape->w);
+#endif
+            for(;x < shape->w;x++)
+                row[x] = ((pixels32[x] & context->keymask) != context->key ? 1 : 0);
+            break;
+        default:
+            SDL_GetRGBAArray(shape->format,pixels,context->colors,shape->w);
+            for(x = 0,c = context->colors;x < shape->w;x++,c += 4)
+                row[x] = SDL_ShapePixelOpaque(&context->mode,c[0],c[1],c[2],c[3]);
+            break;
+    }
+}
+
 /* REQUIRES that bitmap point to a w-by-h bitmap with ppb pixels-per-byte. */
 void
 SDL_CalculateShapeBitmap(SDL_WindowShapeMode mode,SDL_Surface *shape,Uint8* bitmap,Uint8 ppb) {
     int x = 0;
     int y = 0;
-    Uint8 r = 0,g = 0,b = 0,alpha = 0;
-    Uint8* pixel = NULL;
-    Uint32 bitmap_pixel,pixel_value = 0,mask_value = 0;
-    SDL_Color key;
+    Uint32 bitmap_pixel = 0;
+    Uint8* row = NULL;
+    SDL_ShapeRowContext context;
+
+    row = (Uint8*)SDL_malloc(shape->w);
+    if(row == NULL) {
+        SDL_OutOfMemory();
+        return;
+    }
+    if(SDL_InitShapeRowContext(&context,mode,shape) < 0) {
+        SDL_free(row);
+        return;
+    }
     if(SDL_MUSTLOCK(shape))
         SDL_LockSurface(shape);
     for(y = 0;y<shape->h;y++) {
+        SDL_CalculateShapeRow(&context,y,row);
         for(x=0;x<shape->w;x++) {
-            alpha = 0;
-            pixel_value = 0;
-            pixel = (Uint8 *)(shape->pixels) + (y*shape->pitch) + (x*shape->format->BytesPerPixel);
-            switch(shape->format->BytesPerPixel) {
-                case(1):
-                    pixel_value = *(Uint8*)pixel;
-                    break;
-                case(2):
-                    pixel_value = *(Uint16*)pixel;
-                    break;
-                case(3):
-                    pixel_value = *(Uint32*)pixel & (~shape->format->Amask);
-                    break;
-                case(4):
-                    pixel_value = *(Uint32*)pixel;
-                    break;
-            }
-            SDL_GetRGBA(pixel_value,shape->format,&r,&g,&b,&alpha);
             bitmap_pixel = y*shape->w + x;
-            switch(mode.mode) {
-                case(ShapeModeDefault):
-                    mask_value = (alpha >= 1 ? 1 : 0);
-                    break;
-                case(ShapeModeBinarizeAlpha):
-                    mask_value = (alpha >= mode.parameters.binarizationCutoff ? 1 : 0);
-                    break;
-                case(ShapeModeReverseBinarizeAlpha):
-                    mask_value = (alpha <= mode.parameters.binarizationCutoff ? 1 : 0);
-                    break;
-                case(ShapeModeColorKey):
-                    key = mode.parameters.colorKey;
-                    mask_value = ((key.r != r || key.g != g || key.b != b) ? 1 : 0);
-                    break;
-            }
-            bitmap[bitmap_pixel / ppb] |= mask_value << (7 - ((ppb - 1) - (bitmap_pixel % ppb)));
+            bitmap[bitmap_pixel / ppb] |= row[x] << (7 - ((ppb - 1) - (bitmap_pixel % ppb)));
+        }
+    }
+    if(SDL_MUSTLOCK(shape))
+        SDL_UnlockSurface(shape);
+    SDL_QuitShapeRowContext(&context);
+    SDL_free(row);
+}
+
+/* Counts the runs of opaque pixels in a row, and stores them if spans isn't NULL. */
+static int
+SDL_CalculateRowSpans(const Uint8 *row,int w,int y,SDL_Rect *spans) {
+    int x = 0,start = 0,count = 0;
+
+    while(x < w) {
+        while(x < w && !row[x])
+            x++;
+        if(x == w)
+            break;
+        start = x;
+        while(x < w && row[x])
+            x++;
+        if(spans != NULL) {
+            spans[count].x = start;
+            spans[count].y = y;
+            spans[count].w = x - start;
+            spans[count].h = 1;
+        }
+        count++;
+    }
+    return count;
+}
+
+static int
+SDL_ResizeShapeSpans(SDL_ShapeSpans *spans,int w,int h) {
+    SDL_FreeShapeSpans(spans);
+    spans->mask = (Uint8*)SDL_malloc(w * h);
+    spans->rowspans = (int*)SDL_calloc(h + 1,sizeof(int));
+    if((w * h > 0 && spans->mask == NULL) || spans->rowspans == NULL) {
+        SDL_FreeShapeSpans(spans);
+        SDL_OutOfMemory();
+        return -1;
+    }
+    spans->w = w;
+    spans->h = h;
+    return 0;
+}
+
+int
+SDL_CalculateShapeSpans(SDL_WindowShapeMode mode,SDL_Surface *shape,SDL_ShapeSpans *spans,SDL_Rect *changed) {
+    SDL_ShapeRowContext context;
+    Uint8 *row = NULL,*last = NULL;
+    SDL_bool full = SDL_FALSE;
+    int y = 0,left = 0,right = 0;
+    int minx = 0,miny = 0,maxx = 0,maxy = 0;
+    int removed = 0,added = 0;
+
+    changed->x = changed->y = changed->w = changed->h = 0;
+    if(spans->mask == NULL || spans->w != shape->w || spans->h != shape->h) {
+        if(SDL_ResizeShapeSpans(spans,shape->w,shape->h) < 0)
+            return -1;
+        full = SDL_TRUE;
+    }
+    row = (Uint8*)SDL_malloc(shape->w);
+    if(row == NULL) {
+        SDL_OutOfMemory();
+        return -1;
+    }
+    if(SDL_InitShapeRowContext(&context,mode,shape) < 0) {
+        SDL_free(row);
+        return -1;
+    }
+
+    /* Find the rows and columns that differ from the last shape */
+    minx = shape->w;
+    miny = shape->h;
+    maxx = maxy = -1;
+    if(SDL_MUSTLOCK(shape))
+        SDL_LockSurface(shape);
+    for(y = 0;y < shape->h;y++) {
+        last = spans->mask + y * shape->w;
+        SDL_CalculateShapeRow(&context,y,row);
+        if(full) {
+            left = 0;
+            right = shape->w - 1;
+        }
+        else {
+            if(SDL_memcmp(row,last,shape->w) == 0)
+                continue;
+            for(left = 0;row[left] == last[left];left++)
+                ;
+            for(right = shape->w - 1;row[right] == last[right];right--)
+                ;
         }
+        minx = SDL_min(minx,left);
+        maxx = SDL_max(maxx,right);
+        miny = SDL_min(miny,y);
+        maxy = y;
+        SDL_memcpy(last,row,shape->w);
     }
     if(SDL_MUSTLOCK(shape))
         SDL_UnlockSurface(shape);
+    SDL_QuitShapeRowContext(&context);
+    SDL_free(row);
+    if(maxy < 0)
+        return 0;
+
+    /* Replace the spans of the changed rows */
+    for(y = miny;y <= maxy;y++)
+        added += SDL_CalculateRowSpans(spans->mask + y * shape->w,shape->w,y,NULL);
+    removed = spans->rowspans[maxy + 1] - spans->rowspans[miny];
+    if(spans->numspans - removed + added > spans->maxspans) {
+        int maxspans = SDL_max(spans->numspans - removed + added,spans->maxspans * 2);
+        SDL_Rect *resized = (SDL_Rect*)SDL_realloc(spans->spans,maxspans * sizeof(SDL_Rect));
+        if(resized == NULL) {
+            /* Start from scratch next time */
+            SDL_FreeShapeSpans(spans);
+            SDL_OutOfMemory();
+            return -1;
+        }
+        spans->spans = resized;
+        spans->maxspans = maxspans;
+    }
+    SDL_memmove(spans->spans + spans->rowspans[miny] + added,spans->spans + spans->rowspans[maxy + 1],
+                (spans->numspans - spans->rowspans[maxy + 1]) * sizeof(SDL_Rect));
+    for(y = miny;y <= maxy;y++)
+        spans->rowspans[y + 1] = spans->rowspans[y] +
+            SDL_CalculateRowSpans(spans->mask + y * shape->w,shape->w,y,spans->spans + spans->rowspans[y]);
+    for(y = maxy + 2;y <= shape->h;y++)
+        spans->rowspans[y] += added - removed;
+    spans->numspans += added - removed;
+
+    changed->x = minx;
+    changed->y = miny;
+    changed->w = maxx - minx + 1;
+    changed->h = maxy - miny + 1;
+    return 0;
+}
+
+void
+SDL_FreeShapeSpans(SDL_ShapeSpans *spans) {
+    SDL_free(spans->mask);
+    SDL_free(spans->spans);
+    SDL_free(spans->rowspans);
+    SDL_zerop(spans);
 }
 
 static SDL_ShapeTree*
-RecursivelyCalculateShapeTree(SDL_WindowShapeMode mode,SDL_Surface* mask,SDL_Rect dimensions) {
+RecursivelyCalculateShapeTree(const Uint8 *mask,int pitch,SDL_Rect dimensions) {
     int x = 0,y = 0;
-    Uint8* pixel = NULL;
-    Uint32 pixel_value = 0;
-    Uint8 r = 0,g = 0,b = 0,a = 0;
-    SDL_bool pixel_opaque = SDL_FALSE;
+    Uint8 pixel_opaque = 0;
     int last_opaque = -1;
-    SDL_Color key;
     SDL_ShapeTree* result = (SDL_ShapeTree*)SDL_malloc(sizeof(SDL_ShapeTree));
     SDL_Rect next = {0,0,0,0};
     for(y=dimensions.y;y<dimensions.y + dimensions.h;y++) {
         for(x=dimensions.x;x<dimensions.x + dimensions.w;x++) {
-            pixel_value = 0;
-            pixel = (Uint8 *)(mask->pixels) + (y*mask->pitch) + (x*mask->format->BytesPerPixel);
-            switch(mask->format->BytesPerPixel) {
-                case(1):
-                    pixel_value = *(Uint8*)pixel;
-                    break;
-                case(2):
-                    pixel_value = *(Uint16*)pixel;
-                    break;
-                case(3):
-                    pixel_value = *(Uint32*)pixel & (~mask->format->Amask);
-                    break;
-                case(4):
-                    pixel_value = *(Uint32*)pixel;
-                    break;
-            }
-            SDL_GetRGBA(pixel_value,mask->format,&r,&g,&b,&a);
-            switch(mode.mode) {
-                case(ShapeModeDefault):
-                    pixel_opaque = (a >= 1 ? SDL_TRUE : SDL_FALSE);
-                    break;
-                case(ShapeModeBinarizeAlpha):
-                    pixel_opaque = (a >= mode.parameters.binarizationCutoff ? SDL_TRUE : SDL_FALSE);
-                    break;
-                case(ShapeModeReverseBinarizeAlpha):
-                    pixel_opaque = (a <= mode.parameters.binarizationCutoff ? SDL_TRUE : SDL_FALSE);
-                    break;
-                case(ShapeModeColorKey):
-                    key = mode.parameters.colorKey;
-                    pixel_opaque = ((key.r != r || key.g != g || key.b != b) ? SDL_TRUE : SDL_FALSE);
-                    break;
-            }
+            pixel_opaque = mask[y * pitch + x];
             if(last_opaque == -1)
                 last_opaque = pixel_opaque;
             if(last_opaque != pixel_opaque) {
@@ -169,22 +439,22 @@ RecursivelyCalculateShapeTree(SDL_WindowShapeMode mode,SDL_Surface* mask,SDL_Rec
                 //These will change from recursion to recursion.
                 next.x = dimensions.x;
                 next.y = dimensions.y;
-                result->data.children.upleft = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mode,mask,next);
+                result->data.children.upleft = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mask,pitch,next);
                 next.x += next.w;
                 //Unneeded: next.y = dimensions.y;
-                result->data.children.upright = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mode,mask,next);
+                result->data.children.upright = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mask,pitch,next);
                 next.x = dimensions.x;
                 next.y += next.h;
-                result->data.children.downleft = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mode,mask,next);
+                result->data.children.downleft = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mask,pitch,next);
                 next.x += next.w;
                 //Unneeded: next.y = dimensions.y + dimensions.h /2;
-                result->data.children.downright = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mode,mask,next);
+                result->data.children.downright = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mask,pitch,next);
                 return result;
             }
         }
     }
     //If we never recursed, all the pixels in this quadrant have the same "value".
-    result->kind = (last_opaque == SDL_TRUE ? OpaqueShape : TransparentShape);
+    result->kind = (last_opaque == 1 ? OpaqueShape : TransparentShape);
     result->data.shape = dimensions;
     return result;
 }
@@ -193,11 +463,29 @@ SDL_ShapeTree*
 SDL_CalculateShapeTree(SDL_WindowShapeMode mode,SDL_Surface* shape) {
     SDL_Rect dimensions = {0,0,shape->w,shape->h};
     SDL_ShapeTree* result = NULL;
+    SDL_ShapeRowContext context;
+    Uint8* mask = NULL;
+    int y = 0;
+
+    /* Sort the pixels once, rather than every time a quadrant is visited */
+    mask = (Uint8*)SDL_malloc(shape->w * shape->h);
+    if(mask == NULL && shape->w * shape->h > 0) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    if(SDL_InitShapeRowContext(&context,mode,shape) < 0) {
+        SDL_free(mask);
+        return NULL;
+    }
     if(SDL_MUSTLOCK(shape))
         SDL_LockSurface(shape);
-    result = RecursivelyCalculateShapeTree(mode,shape,dimensions);
+    for(y = 0;y < shape->h;y++)
+        SDL_CalculateShapeRow(&context,y,mask + y * shape->w);
     if(SDL_MUSTLOCK(shape))
         SDL_UnlockSurface(shape);
+    SDL_QuitShapeRowContext(&context);
+    result = RecursivelyCalculateShapeTree(mask,shape->w,dimensions);
+    SDL_free(mask);
     return result;
 }
 
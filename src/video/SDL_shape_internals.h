@@ -53,10 +53,23 @@ typedef struct {
 	
 typedef void(*SDL_TraversalFunction)(SDL_ShapeTree*,void*);
 
+/* The opaque pixels of a shape as runs one row high, sorted by row and then by column. */
+typedef struct {
+	int w,h;
+	Uint8 *mask;		/* The shape as of the last update, one byte per pixel */
+	SDL_Rect *spans;
+	int numspans,maxspans;
+	int *rowspans;		/* Index of the first span of each row, h+1 entries */
+} SDL_ShapeSpans;
+
 extern void SDL_CalculateShapeBitmap(SDL_WindowShapeMode mode,SDL_Surface *shape,Uint8* bitmap,Uint8 ppb);
 extern SDL_ShapeTree* SDL_CalculateShapeTree(SDL_WindowShapeMode mode,SDL_Surface* shape);
 extern void SDL_TraverseShapeTree(SDL_ShapeTree *tree,SDL_TraversalFunction function,void* closure);
 extern void SDL_FreeShapeTree(SDL_ShapeTree** shape_tree);
+/* Updates the spans to match the shape, and sets changed to the smallest rectangle containing every pixel that
+   changed since the last update.  changed is empty if nothing did.  Returns 0 on success or -1 on error. */
+extern int SDL_CalculateShapeSpans(SDL_WindowShapeMode mode,SDL_Surface *shape,SDL_ShapeSpans *spans,SDL_Rect *changed);
+extern void SDL_FreeShapeSpans(SDL_ShapeSpans *spans);
 
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
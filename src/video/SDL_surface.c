@@ -21,12 +21,45 @@
 #include "SDL_config.h"
 
 #include "SDL_video.h"
+#include "SDL_atomic.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_RLEaccel_c.h"
 #include "SDL_pixels_c.h"
+#include "../stdlib/SDL_memory_c.h"
 
 
+/* Surfaces waiting to be reused are kept in buckets hashed by their size
+   and pixel format, up to this many bytes of pixels in total.
+ */
+#define SDL_SURFACE_POOL_BUCKETS    64
+#define SDL_SURFACE_POOL_MAX_BYTES  (32 * 1024 * 1024)
+
+/* Pixels of pooled surfaces start on a cache line */
+#define SDL_SURFACE_POOL_ALIGNMENT  64
+
+/* This lives just before the pixels of a pooled surface */
+typedef struct SDL_PooledSurface
+{
+    SDL_Surface *surface;
+    void *storage;              /* The allocation holding this and the pixels */
+    size_t size;                /* The size of the pixels */
+    int w, h;
+    Uint32 format;
+    struct SDL_PooledSurface *next;
+} SDL_PooledSurface;
+
+#define SDL_POOLED_SURFACE_HEADER   SDL_SURFACE_POOL_ALIGNMENT
+
+SDL_COMPILE_TIME_ASSERT(pooled_surface_header,
+                        sizeof(SDL_PooledSurface) <= SDL_POOLED_SURFACE_HEADER);
+
+static SDL_SpinLock SDL_surface_pool_lock;
+static SDL_PooledSurface *SDL_surface_pool[SDL_SURFACE_POOL_BUCKETS];
+static size_t SDL_surface_pool_bytes;
+
+static void SDL_RecyclePooledSurface(SDL_Surface * surface);
+
 /* Public routines */
 /*
  * Create an empty RGB surface of the appropriate depth
@@ -38,6 +71,7 @@ SDL_CreateRGBSurface(Uint32 flags,
 {
     SDL_Surface *surface;
     Uint32 format;
+    int alignment;
 
     /* The flags are no longer used, make the compiler happy */
     (void)flags;
@@ -63,6 +97,7 @@ SDL_CreateRGBSurface(Uint32 flags,
     }
     surface->w = width;
     surface->h = height;
+    alignment = SDL_GetSurfaceAlignment();
     surface->pitch = SDL_CalculatePitch(surface);
     SDL_SetClipRect(surface, NULL);
 
@@ -88,14 +123,25 @@ SDL_CreateRGBSurface(Uint32 flags,
 
     /* Get the pixels */
     if (surface->w && surface->h) {
-        surface->pixels = SDL_malloc(surface->h * surface->pitch);
+        if ((size_t) surface->h > (~(size_t)0) / surface->pitch) {
+            SDL_FreeSurface(surface);
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        surface->pixels = SDL_AllocAlignedMemory(SDL_MEMORY_SURFACE, alignment,
+                                                 (size_t) surface->h * surface->pitch);
         if (!surface->pixels) {
             SDL_FreeSurface(surface);
             SDL_OutOfMemory();
             return NULL;
         }
         /* This is important for bitmaps */
-        SDL_memset(surface->pixels, 0, surface->h * surface->pitch);
+        SDL_memset(surface->pixels, 0, (size_t) surface->h * surface->pitch);
+
+        /* The padding at the end of each row belongs to the surface */
+        if (alignment > 4 && !(surface->pitch & (alignment - 1))) {
+            surface->flags |= SDL_SIMD_ALIGNED;
+        }
     }
 
     /* Allocate an empty mapping */
@@ -1004,6 +1050,10 @@ SDL_FreeSurface(SDL_Surface * surface)
     if (surface->flags & SDL_RLEACCEL) {
         SDL_UnRLESurface(surface, 0);
     }
+    if (surface->flags & SDL_POOLED) {
+        SDL_RecyclePooledSurface(surface);
+        return;
+    }
     if (surface->format) {
         SDL_SetSurfacePalette(surface, NULL);
         SDL_FreeFormat(surface->format);
@@ -1014,9 +1064,194 @@ SDL_FreeSurface(SDL_Surface * surface)
         surface->map = NULL;
     }
     if (surface->pixels && ((surface->flags & SDL_PREALLOC) != SDL_PREALLOC)) {
-        SDL_free(surface->pixels);
+        SDL_FreeMemory(surface->pixels);
     }
     SDL_free(surface);
 }
 
+static int
+SDL_SurfacePoolBucket(int width, int height, Uint32 format)
+{
+    Uint32 hash = (Uint32) width * 2654435761u;
+
+    hash ^= (Uint32) height * 40503u;
+    hash ^= format * 2246822519u;
+    return (int) ((hash >> 16) % SDL_SURFACE_POOL_BUCKETS);
+}
+
+static SDL_PooledSurface *
+SDL_GetPooledSurface(SDL_Surface * surface)
+{
+    return (SDL_PooledSurface *) ((Uint8 *) surface->pixels -
+                                  SDL_POOLED_SURFACE_HEADER);
+}
+
+static void
+SDL_DestroyPooledSurface(SDL_PooledSurface * entry)
+{
+    SDL_Surface *surface = entry->surface;
+
+    /* The pixels are preallocated, so this leaves them alone */
+    surface->flags &= ~SDL_POOLED;
+    surface->refcount = 1;
+    SDL_FreeSurface(surface);
+    SDL_FreeMemory(entry->storage);
+}
+
+static void
+SDL_RecyclePooledSurface(SDL_Surface * surface)
+{
+    SDL_PooledSurface *entry = SDL_GetPooledSurface(surface);
+    int bucket;
+
+    /* Put the surface back the way SDL_AcquirePooledSurface() hands it out.
+       These only invalidate the blit map if something actually changes.
+     */
+    surface->refcount = 1;
+    surface->userdata = NULL;
+    surface->h = entry->h;
+    SDL_SetSurfaceRLE(surface, 0);
+    SDL_SetColorKey(surface, SDL_FALSE, 0);
+    SDL_SetSurfaceColorMod(surface, 255, 255, 255);
+    SDL_SetSurfaceAlphaMod(surface, 255);
+    SDL_SetSurfaceBlendMode(surface, surface->format->Amask ?
+                            SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+    SDL_SetClipRect(surface, NULL);
+
+    bucket = SDL_SurfacePoolBucket(entry->w, entry->h, entry->format);
+    SDL_AtomicLock(&SDL_surface_pool_lock);
+    if (SDL_surface_pool_bytes + entry->size <= SDL_SURFACE_POOL_MAX_BYTES) {
+        entry->next = SDL_surface_pool[bucket];
+        SDL_surface_pool[bucket] = entry;
+        SDL_surface_pool_bytes += entry->size;
+        entry = NULL;
+    }
+    SDL_AtomicUnlock(&SDL_surface_pool_lock);
+
+    if (entry) {
+        /* The pool is full */
+        SDL_DestroyPooledSurface(entry);
+    }
+}
+
+SDL_Surface *
+SDL_AcquirePooledSurface(int width, int height, Uint32 format)
+{
+    SDL_PooledSurface *entry, *prev;
+    SDL_Surface *surface;
+    Uint32 Rmask, Gmask, Bmask, Amask;
+    Uint8 *pixels;
+    void *storage;
+    size_t size;
+    int bucket, bpp, alignment;
+
+    if (width <= 0) {
+        SDL_InvalidParamError("width");
+        return NULL;
+    }
+    if (height <= 0) {
+        SDL_InvalidParamError("height");
+        return NULL;
+    }
+
+    /* Look for a free surface that matches */
+    bucket = SDL_SurfacePoolBucket(width, height, format);
+    SDL_AtomicLock(&SDL_surface_pool_lock);
+    prev = NULL;
+    for (entry = SDL_surface_pool[bucket]; entry; entry = entry->next) {
+        if (entry->w == width && entry->h == height &&
+            entry->format == format) {
+            if (prev) {
+                prev->next = entry->next;
+            } else {
+                SDL_surface_pool[bucket] = entry->next;
+            }
+            SDL_surface_pool_bytes -= entry->size;
+            break;
+        }
+        prev = entry;
+    }
+    SDL_AtomicUnlock(&SDL_surface_pool_lock);
+
+    if (entry) {
+        entry->next = NULL;
+        return entry->surface;
+    }
+
+    /* Make a new one */
+    if (SDL_ISPIXELFORMAT_FOURCC(format) ||
+        !SDL_PixelFormatEnumToMasks(format, &bpp,
+                                    &Rmask, &Gmask, &Bmask, &Amask)) {
+        SDL_SetError("Unsupported pixel format");
+        return NULL;
+    }
+    surface = SDL_CreateRGBSurface(0, 0, 0, bpp, Rmask, Gmask, Bmask, Amask);
+    if (!surface) {
+        return NULL;
+    }
+    surface->w = width;
+    surface->h = height;
+    alignment = SDL_GetSurfaceAlignment();
+    surface->pitch = SDL_CalculatePitch(surface);
+    size = (size_t) surface->h * surface->pitch;
+
+    storage = SDL_AllocMemory(SDL_MEMORY_SURFACE,
+                              SDL_POOLED_SURFACE_HEADER + size +
+                              SDL_SURFACE_POOL_ALIGNMENT - 1);
+    if (!storage) {
+        SDL_FreeSurface(surface);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    pixels = (Uint8 *) storage + SDL_POOLED_SURFACE_HEADER;
+    pixels += (SDL_SURFACE_POOL_ALIGNMENT -
+               ((uintptr_t) pixels & (SDL_SURFACE_POOL_ALIGNMENT - 1))) &
+              (SDL_SURFACE_POOL_ALIGNMENT - 1);
+
+    surface->flags |= (SDL_PREALLOC | SDL_POOLED);
+    if (alignment > 4 && !(surface->pitch & (alignment - 1))) {
+        /* SDL_SURFACE_POOL_ALIGNMENT covers every alignment of the hint */
+        surface->flags |= SDL_SIMD_ALIGNED;
+    }
+    surface->pixels = pixels;
+    SDL_SetClipRect(surface, NULL);
+
+    entry = SDL_GetPooledSurface(surface);
+    entry->surface = surface;
+    entry->storage = storage;
+    entry->size = size;
+    entry->w = width;
+    entry->h = height;
+    entry->format = format;
+    entry->next = NULL;
+    return surface;
+}
+
+void
+SDL_ReleasePooledSurface(SDL_Surface * surface)
+{
+    SDL_FreeSurface(surface);
+}
+
+void
+SDL_ClearSurfacePool(void)
+{
+    SDL_PooledSurface *pool[SDL_SURFACE_POOL_BUCKETS];
+    SDL_PooledSurface *entry, *next;
+    int i;
+
+    SDL_AtomicLock(&SDL_surface_pool_lock);
+    SDL_memcpy(pool, SDL_surface_pool, sizeof(pool));
+    SDL_zero(SDL_surface_pool);
+    SDL_surface_pool_bytes = 0;
+    SDL_AtomicUnlock(&SDL_surface_pool_lock);
+
+    for (i = 0; i < SDL_SURFACE_POOL_BUCKETS; ++i) {
+        for (entry = pool[i]; entry; entry = next) {
+            next = entry->next;
+            SDL_DestroyPooledSurface(entry);
+        }
+    }
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -201,6 +201,7 @@ struct SDL_VideoDevice
     int (*CreateWindowFramebuffer) (_THIS, SDL_Window * window, Uint32 * format, void ** pixels, int *pitch);
     int (*UpdateWindowFramebuffer) (_THIS, SDL_Window * window, SDL_Rect * rects, int numrects);
     void (*DestroyWindowFramebuffer) (_THIS, SDL_Window * window);
+    int (*GetWindowCaptureStats) (_THIS, SDL_Window * window, SDL_WindowCaptureStats * stats);
 
     /* * * */
     /*
@@ -232,6 +233,12 @@ struct SDL_VideoDevice
      */
     void (*PumpEvents) (_THIS);
 
+    /* A file descriptor that is readable when events are waiting, or -1 */
+    int (*GetEventFD) (_THIS);
+
+    /* Milliseconds until PumpEvents has timed work to do, or -1 if none */
+    int (*GetEventTimeout) (_THIS);
+
     /* Suspend the screensaver */
     void (*SuspendScreenSaver) (_THIS);
 
@@ -263,6 +270,10 @@ struct SDL_VideoDevice
     Uint8 window_magic;
     Uint32 next_object_id;
     char * clipboard_text;
+    SDL_WindowCaptureCallback capture_callback;
+    void *capture_userdata;
+    SDL_WindowUploadCallback upload_callback;
+    void *upload_userdata;
 
     /* * * */
     /* Data used by the GL drivers */
@@ -29,6 +29,7 @@
 #include "SDL_pixels_c.h"
 #include "SDL_rect_c.h"
 #include "../events/SDL_events_c.h"
+#include "../stdlib/SDL_memory_c.h"
 
 #if SDL_VIDEO_OPENGL
 #include "SDL_opengl.h"
@@ -210,6 +211,7 @@ SDL_CreateWindowTexture(_THIS, SDL_Window * window, Uint32 * format, void ** pix
     SDL_WindowTextureData *data;
     SDL_RendererInfo info;
     Uint32 i;
+    int alignment;
 
     data = SDL_GetWindowData(window, SDL_WINDOWTEXTUREDATA);
     if (!data) {
@@ -264,7 +266,7 @@ SDL_CreateWindowTexture(_THIS, SDL_Window * window, Uint32 * format, void ** pix
         data->texture = NULL;
     }
     if (data->pixels) {
-        SDL_free(data->pixels);
+        SDL_FreeMemory(data->pixels);
         data->pixels = NULL;
     }
 
@@ -291,8 +293,10 @@ SDL_CreateWindowTexture(_THIS, SDL_Window * window, Uint32 * format, void ** pix
 
     /* Create framebuffer data */
     data->bytes_per_pixel = SDL_BYTESPERPIXEL(*format);
-    data->pitch = (((window->w * data->bytes_per_pixel) + 3) & ~3);
-    data->pixels = SDL_malloc(window->h * data->pitch);
+    alignment = SDL_GetSurfaceAlignment();
+    data->pitch = (window->w * data->bytes_per_pixel + alignment - 1) & ~(alignment - 1);
+    data->pixels = SDL_AllocAlignedMemory(SDL_MEMORY_SURFACE, alignment,
+                                          (size_t) window->h * data->pitch);
     if (!data->pixels) {
         SDL_OutOfMemory();
         return -1;
@@ -307,12 +311,83 @@ SDL_CreateWindowTexture(_THIS, SDL_Window * window, Uint32 * format, void ** pix
     return 0;
 }
 
+/* Uploading a rectangle costs about as much as uploading this many more
+   pixels, so nearby rectangles are cheaper to upload together.
+ */
+#define SDL_WINDOWTEXTURE_RECT_COST     4096
+#define SDL_WINDOWTEXTURE_MAX_RECTS     16
+
+static __inline__ int
+SDL_RectArea(const SDL_Rect * rect)
+{
+    return rect->w * rect->h;
+}
+
+/* Clip the update rectangles to the window, and merge them wherever the
+   merged rectangle is cheaper to upload than the separate ones.
+ */
+static int
+SDL_MergeUpdateRects(int w, int h, const SDL_Rect * rects, int numrects,
+                     SDL_Rect * merged)
+{
+    SDL_Rect bounds, rect, area;
+    int i, j, count = 0;
+    SDL_bool merging;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = w;
+    bounds.h = h;
+    for (i = 0; i < numrects; ++i) {
+        if (!SDL_IntersectRect(&rects[i], &bounds, &rect)) {
+            continue;
+        }
+        if (count < SDL_WINDOWTEXTURE_MAX_RECTS) {
+            merged[count++] = rect;
+        } else {
+            /* Grow whichever rectangle grows the least */
+            int best = 0, best_growth = 0;
+            for (j = 0; j < count; ++j) {
+                int growth;
+                SDL_UnionRect(&merged[j], &rect, &area);
+                growth = SDL_RectArea(&area) - SDL_RectArea(&merged[j]);
+                if (j == 0 || growth < best_growth) {
+                    best = j;
+                    best_growth = growth;
+                }
+            }
+            SDL_UnionRect(&merged[best], &rect, &merged[best]);
+        }
+    }
+
+    do {
+        merging = SDL_FALSE;
+        for (i = 0; i < count; ++i) {
+            for (j = i + 1; j < count; ++j) {
+                SDL_UnionRect(&merged[i], &merged[j], &area);
+                if (SDL_RectArea(&area) <= SDL_RectArea(&merged[i]) +
+                                           SDL_RectArea(&merged[j]) +
+                                           SDL_WINDOWTEXTURE_RECT_COST) {
+                    merged[i] = area;
+                    merged[j] = merged[--count];
+                    merging = SDL_TRUE;
+                    j = i;
+                }
+            }
+        }
+    } while (merging);
+
+    return count;
+}
+
 static int
 SDL_UpdateWindowTexture(_THIS, SDL_Window * window, SDL_Rect * rects, int numrects)
 {
     SDL_WindowTextureData *data;
-    SDL_Rect rect;
+    SDL_Rect merged[SDL_WINDOWTEXTURE_MAX_RECTS];
+    Uint32 bytes = 0;
     void *src;
+    int i, count;
 
     data = SDL_GetWindowData(window, SDL_WINDOWTEXTUREDATA);
     if (!data || !data->texture) {
@@ -320,20 +395,30 @@ SDL_UpdateWindowTexture(_THIS, SDL_Window * window, SDL_Rect * rects, int numrec
         return -1;
     }
 
-    /* Update a single rect that contains subrects for best DMA performance */
-    if (SDL_GetSpanEnclosingRect(window->w, window->h, numrects, rects, &rect)) {
+    /* Only upload the parts of the window that changed */
+    count = SDL_MergeUpdateRects(window->w, window->h, rects, numrects, merged);
+    if (count == 0) {
+        return 0;
+    }
+    for (i = 0; i < count; ++i) {
         src = (void *)((Uint8 *)data->pixels +
-                        rect.y * data->pitch +
-                        rect.x * data->bytes_per_pixel);
-        if (SDL_UpdateTexture(data->texture, &rect, src, data->pitch) < 0) {
+                        merged[i].y * data->pitch +
+                        merged[i].x * data->bytes_per_pixel);
+        if (SDL_UpdateTexture(data->texture, &merged[i], src, data->pitch) < 0) {
             return -1;
         }
+        bytes += SDL_RectArea(&merged[i]) * data->bytes_per_pixel;
+    }
 
-        if (SDL_RenderCopy(data->renderer, data->texture, NULL, NULL) < 0) {
-            return -1;
-        }
+    /* The back buffer isn't kept between presents, so all of it is drawn */
+    if (SDL_RenderCopy(data->renderer, data->texture, NULL, NULL) < 0) {
+        return -1;
+    }
+
+    SDL_RenderPresent(data->renderer);
 
-        SDL_RenderPresent(data->renderer);
+    if (_this->upload_callback) {
+        _this->upload_callback(_this->upload_userdata, window->id, count, bytes);
     }
     return 0;
 }
@@ -354,7 +439,7 @@ SDL_DestroyWindowTexture(_THIS, SDL_Window * window)
         SDL_DestroyRenderer(data->renderer);
     }
     if (data->pixels) {
-        SDL_free(data->pixels);
+        SDL_FreeMemory(data->pixels);
     }
     SDL_free(data);
 }
@@ -547,6 +632,33 @@ SDL_GetCurrentVideoDriver()
     return _this->name;
 }
 
+int
+SDL_GetVideoEventFD(void)
+{
+    if (!_this) {
+        SDL_UninitializedVideo();
+        return -1;
+    }
+    if (!_this->GetEventFD) {
+        SDL_Unsupported();
+        return -1;
+    }
+    return _this->GetEventFD(_this);
+}
+
+int
+SDL_GetVideoEventTimeout(void)
+{
+    if (!_this) {
+        SDL_UninitializedVideo();
+        return -1;
+    }
+    if (!_this->GetEventTimeout) {
+        return -1;
+    }
+    return _this->GetEventTimeout(_this);
+}
+
 SDL_VideoDevice *
 SDL_GetVideoDevice(void)
 {
@@ -1860,6 +1972,51 @@ SDL_UpdateWindowSurfaceRects(SDL_Window * window, SDL_Rect * rects,
     return _this->UpdateWindowFramebuffer(_this, window, rects, numrects);
 }
 
+int
+SDL_SetWindowCaptureCallback(SDL_WindowCaptureCallback callback,
+                             void *userdata)
+{
+    if (!_this) {
+        SDL_UninitializedVideo();
+        return -1;
+    }
+    if (!_this->GetWindowCaptureStats) {
+        SDL_Unsupported();
+        return -1;
+    }
+    _this->capture_callback = callback;
+    _this->capture_userdata = userdata;
+    return 0;
+}
+
+int
+SDL_SetWindowUploadCallback(SDL_WindowUploadCallback callback, void *userdata)
+{
+    if (!_this) {
+        SDL_UninitializedVideo();
+        return -1;
+    }
+    _this->upload_callback = callback;
+    _this->upload_userdata = userdata;
+    return 0;
+}
+
+int
+SDL_GetWindowCaptureStats(SDL_Window * window, SDL_WindowCaptureStats * stats)
+{
+    CHECK_WINDOW_MAGIC(window, -1);
+
+    if (!stats) {
+        SDL_InvalidParamError("stats");
+        return -1;
+    }
+    if (!_this->GetWindowCaptureStats) {
+        SDL_Unsupported();
+        return -1;
+    }
+    return _this->GetWindowCaptureStats(_this, window, stats);
+}
+
 int
 SDL_SetWindowBrightness(SDL_Window * window, float brightness)
 {
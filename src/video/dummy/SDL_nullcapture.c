@@ -0,0 +1,461 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "SDL_config.h"
+
+#if SDL_VIDEO_DRIVER_DUMMY
+
+/* Capturing window frames to a file or a callback
+
+   Presenting a frame copies it into the next free buffer of a ring, and a
+   writer thread passes the buffers on in order.  Each buffer keeps a list
+   of the areas updated since it was last filled, so filling it again only
+   copies those.
+ */
+
+#include "SDL_atomic.h"
+#include "SDL_hints.h"
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
+#include "SDL_timer.h"
+#include "../SDL_sysvideo.h"
+#include "SDL_nullcapture_c.h"
+
+#define DUMMY_CAPTURE       "_SDL_DummyCapture"
+#define CAPTURE_BUFFERS     4
+#define CAPTURE_MAX_RECTS   16
+
+typedef struct
+{
+    Uint8 *pixels;
+    Uint32 frame;
+    SDL_WindowCaptureCallback callback;
+    void *userdata;
+    int numrects;               /* -1 if the whole frame needs copying */
+    SDL_Rect rects[CAPTURE_MAX_RECTS];
+} SDL_CaptureBuffer;
+
+typedef struct
+{
+    Uint32 windowID;
+    int w, h, pitch;
+    SDL_bool drop;
+    SDL_RWops *dst;
+    SDL_bool y4m;
+    Uint8 *yuv;                 /* The planes of a YUV4MPEG2 frame */
+
+    int num_buffers;
+    SDL_CaptureBuffer *buffers;
+    SDL_sem *free_buffers;
+    SDL_sem *full_buffers;
+    int head;                   /* The next buffer to fill */
+    SDL_atomic_t filled;        /* Buffers filled so far */
+    SDL_Thread *thread;
+
+    SDL_SpinLock stats_lock;
+    SDL_WindowCaptureStats stats;
+    Uint64 first_present;
+    Uint64 last_present;
+} SDL_DummyCapture;
+
+static int capture_number;
+
+/* Convert to 4:2:0 full range YCbCr, returning the size of the planes */
+static size_t
+SDL_ConvertCaptureYUV(SDL_DummyCapture * capture, const Uint8 * pixels)
+{
+    const int w = capture->w, h = capture->h;
+    const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+    Uint8 *Y = capture->yuv;
+    Uint8 *U = Y + w * h;
+    Uint8 *V = U + cw * ch;
+    int x, y, r, g, b, u, v;
+
+    for (y = 0; y < h; ++y) {
+        const Uint32 *row = (const Uint32 *) (pixels + y * capture->pitch);
+        for (x = 0; x < w; ++x) {
+            r = (row[x] >> 16) & 0xFF;
+            g = (row[x] >> 8) & 0xFF;
+            b = row[x] & 0xFF;
+            *Y++ = (Uint8) ((77 * r + 150 * g + 29 * b + 128) >> 8);
+        }
+    }
+
+    for (y = 0; y < ch; ++y) {
+        const Uint32 *row0 = (const Uint32 *) (pixels + (2 * y) * capture->pitch);
+        const Uint32 *row1 = (const Uint32 *) (pixels + SDL_min(2 * y + 1, h - 1) * capture->pitch);
+        for (x = 0; x < cw; ++x) {
+            const int x0 = 2 * x, x1 = SDL_min(2 * x + 1, w - 1);
+            const Uint32 p[4] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+
+            r = (((p[0] >> 16) & 0xFF) + ((p[1] >> 16) & 0xFF) +
+                 ((p[2] >> 16) & 0xFF) + ((p[3] >> 16) & 0xFF) + 2) >> 2;
+            g = (((p[0] >> 8) & 0xFF) + ((p[1] >> 8) & 0xFF) +
+                 ((p[2] >> 8) & 0xFF) + ((p[3] >> 8) & 0xFF) + 2) >> 2;
+            b = ((p[0] & 0xFF) + (p[1] & 0xFF) +
+                 (p[2] & 0xFF) + (p[3] & 0xFF) + 2) >> 2;
+
+            /* Offset so the shifts are of positive values */
+            u = (-43 * r - 85 * g + 128 * b + 32896) >> 8;
+            v = (128 * r - 107 * g - 21 * b + 32896) >> 8;
+            *U++ = (Uint8) SDL_min(u, 255);
+            *V++ = (Uint8) SDL_min(v, 255);
+        }
+    }
+    return (size_t) (w * h + 2 * cw * ch);
+}
+
+static void
+SDL_WriteCaptureFrame(SDL_DummyCapture * capture, SDL_CaptureBuffer * buffer)
+{
+    if (buffer->callback) {
+        buffer->callback(buffer->userdata, capture->windowID, buffer->frame,
+                         SDL_PIXELFORMAT_RGB888, buffer->pixels,
+                         capture->pitch, capture->w, capture->h);
+    }
+    if (capture->dst) {
+        if (capture->y4m) {
+            size_t size = SDL_ConvertCaptureYUV(capture, buffer->pixels);
+            SDL_RWwrite(capture->dst, "FRAME\n", 6, 1);
+            SDL_RWwrite(capture->dst, capture->yuv, size, 1);
+        } else {
+            SDL_RWwrite(capture->dst, buffer->pixels, capture->pitch, capture->h);
+        }
+    }
+}
+
+static int SDLCALL
+SDL_CaptureThread(void *data)
+{
+    SDL_DummyCapture *capture = (SDL_DummyCapture *) data;
+    SDL_CaptureBuffer *buffer;
+    int tail = 0, written = 0;
+    Uint64 start;
+
+    for ( ; ; ) {
+        SDL_SemWait(capture->full_buffers);
+        if (written == SDL_AtomicGet(&capture->filled)) {
+            /* Woken up without a frame, we're done */
+            break;
+        }
+
+        buffer = &capture->buffers[tail];
+        start = SDL_GetTicksNS();
+        SDL_WriteCaptureFrame(capture, buffer);
+
+        SDL_AtomicLock(&capture->stats_lock);
+        ++capture->stats.captured;
+        capture->stats.write_ns += SDL_GetTicksNS() - start;
+        SDL_AtomicUnlock(&capture->stats_lock);
+
+        tail = (tail + 1) % capture->num_buffers;
+        ++written;
+        SDL_SemPost(capture->free_buffers);
+    }
+    return 0;
+}
+
+static void
+SDL_FreeCapture(SDL_DummyCapture * capture)
+{
+    int i;
+
+    if (capture->dst) {
+        SDL_RWclose(capture->dst);
+    }
+    if (capture->buffers) {
+        for (i = 0; i < capture->num_buffers; ++i) {
+            if (capture->buffers[i].pixels) {
+                SDL_free(capture->buffers[i].pixels);
+            }
+        }
+        SDL_free(capture->buffers);
+    }
+    if (capture->free_buffers) {
+        SDL_DestroySemaphore(capture->free_buffers);
+    }
+    if (capture->full_buffers) {
+        SDL_DestroySemaphore(capture->full_buffers);
+    }
+    if (capture->yuv) {
+        SDL_free(capture->yuv);
+    }
+    SDL_free(capture);
+}
+
+/* Open the capture file, with any "%d" in its name replaced */
+static SDL_RWops *
+SDL_OpenCaptureFile(const char *file, int number)
+{
+    char name[1024];
+    const char *number_pos = SDL_strstr(file, "%d");
+
+    if (number_pos) {
+        size_t len = SDL_min((size_t) (number_pos - file), sizeof(name) - 1);
+        SDL_strlcpy(name, file, len + 1);
+        SDL_snprintf(&name[len], sizeof(name) - len, "%d%s", number, number_pos + 2);
+    } else {
+        SDL_strlcpy(name, file, sizeof(name));
+    }
+    return SDL_RWFromFile(name, "wb");
+}
+
+static SDL_DummyCapture *
+SDL_StartCapture(_THIS, SDL_Window * window, SDL_Surface * surface)
+{
+    SDL_DummyCapture *capture;
+    const char *file = SDL_GetHint(SDL_HINT_VIDEO_DUMMY_CAPTURE);
+    const char *hint;
+    size_t len;
+    int i;
+
+    capture = (SDL_DummyCapture *) SDL_calloc(1, sizeof(*capture));
+    if (!capture) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    capture->windowID = SDL_GetWindowID(window);
+    capture->w = surface->w;
+    capture->h = surface->h;
+    capture->pitch = surface->w * 4;
+
+    hint = SDL_GetHint(SDL_HINT_VIDEO_DUMMY_CAPTURE_DROP);
+    capture->drop = (hint && SDL_atoi(hint)) ? SDL_TRUE : SDL_FALSE;
+    hint = SDL_GetHint(SDL_HINT_VIDEO_DUMMY_CAPTURE_BUFFERS);
+    capture->num_buffers = hint ? SDL_atoi(hint) : CAPTURE_BUFFERS;
+    if (capture->num_buffers < 1) {
+        capture->num_buffers = 1;
+    }
+
+    capture->buffers = (SDL_CaptureBuffer *)
+        SDL_calloc(capture->num_buffers, sizeof(*capture->buffers));
+    if (!capture->buffers) {
+        SDL_FreeCapture(capture);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    for (i = 0; i < capture->num_buffers; ++i) {
+        capture->buffers[i].pixels = (Uint8 *) SDL_malloc(capture->pitch * capture->h);
+        if (!capture->buffers[i].pixels) {
+            SDL_FreeCapture(capture);
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        capture->buffers[i].numrects = -1;
+    }
+
+    capture->free_buffers = SDL_CreateSemaphore(capture->num_buffers);
+    capture->full_buffers = SDL_CreateSemaphore(0);
+    if (!capture->free_buffers || !capture->full_buffers) {
+        SDL_FreeCapture(capture);
+        return NULL;
+    }
+
+    ++capture_number;
+    if (file && *file) {
+        /* Without the file, frames still go to the callback */
+        capture->dst = SDL_OpenCaptureFile(file, capture_number);
+        len = SDL_strlen(file);
+        if (capture->dst && len >= 4 && SDL_strcasecmp(&file[len - 4], ".y4m") == 0) {
+            char header[128];
+            const int cw = (capture->w + 1) / 2, ch = (capture->h + 1) / 2;
+
+            capture->y4m = SDL_TRUE;
+            capture->yuv = (Uint8 *) SDL_malloc(capture->w * capture->h + 2 * cw * ch);
+            if (!capture->yuv) {
+                SDL_FreeCapture(capture);
+                SDL_OutOfMemory();
+                return NULL;
+            }
+            SDL_snprintf(header, sizeof(header),
+                         "YUV4MPEG2 W%d H%d F60:1 Ip A1:1 C420jpeg\n",
+                         capture->w, capture->h);
+            SDL_RWwrite(capture->dst, header, SDL_strlen(header), 1);
+        }
+    }
+
+    /* !!! FIXME: this is nasty. */
+#if defined(__WIN32__) && !defined(HAVE_LIBC)
+#undef SDL_CreateThread
+    capture->thread = SDL_CreateThread(SDL_CaptureThread, "SDLCapture", capture, NULL, NULL);
+#else
+    capture->thread = SDL_CreateThread(SDL_CaptureThread, "SDLCapture", capture);
+#endif
+    if (!capture->thread) {
+        SDL_FreeCapture(capture);
+        return NULL;
+    }
+
+    SDL_SetWindowData(window, DUMMY_CAPTURE, capture);
+    return capture;
+}
+
+/* Remember the updated areas in every buffer */
+static void
+SDL_AddCaptureRects(SDL_DummyCapture * capture, const SDL_Rect * rects, int numrects)
+{
+    SDL_Rect bounds, rect;
+    int i, j;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = capture->w;
+    bounds.h = capture->h;
+    for (i = 0; i < capture->num_buffers; ++i) {
+        SDL_CaptureBuffer *buffer = &capture->buffers[i];
+        for (j = 0; j < numrects && buffer->numrects >= 0; ++j) {
+            if (!SDL_IntersectRect(&rects[j], &bounds, &rect)) {
+                continue;
+            }
+            if (buffer->numrects == CAPTURE_MAX_RECTS) {
+                buffer->numrects = -1;
+            } else {
+                buffer->rects[buffer->numrects++] = rect;
+            }
+        }
+    }
+}
+
+static void
+SDL_FillCaptureBuffer(SDL_DummyCapture * capture, SDL_CaptureBuffer * buffer,
+                      SDL_Surface * surface)
+{
+    int i, y;
+
+    if (buffer->numrects < 0) {
+        for (y = 0; y < capture->h; ++y) {
+            SDL_memcpy(buffer->pixels + y * capture->pitch,
+                       (Uint8 *) surface->pixels + y * surface->pitch,
+                       capture->pitch);
+        }
+    } else {
+        for (i = 0; i < buffer->numrects; ++i) {
+            const SDL_Rect *rect = &buffer->rects[i];
+            for (y = rect->y; y < rect->y + rect->h; ++y) {
+                SDL_memcpy(buffer->pixels + y * capture->pitch + rect->x * 4,
+                           (Uint8 *) surface->pixels + y * surface->pitch + rect->x * 4,
+                           rect->w * 4);
+            }
+        }
+    }
+    buffer->numrects = 0;
+}
+
+void
+SDL_DUMMY_CaptureFrame(_THIS, SDL_Window * window, SDL_Surface * surface,
+                       SDL_Rect * rects, int numrects)
+{
+    SDL_DummyCapture *capture;
+    SDL_CaptureBuffer *buffer;
+    Uint64 now, start, blocked = 0;
+    Uint32 frame;
+
+    capture = (SDL_DummyCapture *) SDL_GetWindowData(window, DUMMY_CAPTURE);
+    if (!capture) {
+        if (!SDL_GetHint(SDL_HINT_VIDEO_DUMMY_CAPTURE) && !_this->capture_callback) {
+            return;
+        }
+        capture = SDL_StartCapture(_this, window, surface);
+        if (!capture) {
+            return;
+        }
+    }
+
+    now = SDL_GetTicksNS();
+    SDL_AtomicLock(&capture->stats_lock);
+    frame = ++capture->stats.frames;
+    if (frame == 1) {
+        capture->first_present = now;
+    } else {
+        Uint64 interval = now - capture->last_present;
+        if (frame == 2 || interval < capture->stats.min_frame_ns) {
+            capture->stats.min_frame_ns = interval;
+        }
+        if (interval > capture->stats.max_frame_ns) {
+            capture->stats.max_frame_ns = interval;
+        }
+        capture->stats.total_frame_ns = now - capture->first_present;
+    }
+    capture->last_present = now;
+    SDL_AtomicUnlock(&capture->stats_lock);
+
+    SDL_AddCaptureRects(capture, rects, numrects);
+
+    if (SDL_SemTryWait(capture->free_buffers) != 0) {
+        if (capture->drop) {
+            SDL_AtomicLock(&capture->stats_lock);
+            ++capture->stats.dropped;
+            SDL_AtomicUnlock(&capture->stats_lock);
+            return;
+        }
+        SDL_SemWait(capture->free_buffers);
+        blocked = SDL_GetTicksNS() - now;
+    }
+
+    start = SDL_GetTicksNS();
+    buffer = &capture->buffers[capture->head];
+    SDL_FillCaptureBuffer(capture, buffer, surface);
+    buffer->frame = frame;
+    buffer->callback = _this->capture_callback;
+    buffer->userdata = _this->capture_userdata;
+    capture->head = (capture->head + 1) % capture->num_buffers;
+    SDL_AtomicIncRef(&capture->filled);
+    SDL_SemPost(capture->full_buffers);
+
+    SDL_AtomicLock(&capture->stats_lock);
+    capture->stats.copy_ns += SDL_GetTicksNS() - start;
+    capture->stats.blocked_ns += blocked;
+    SDL_AtomicUnlock(&capture->stats_lock);
+}
+
+void
+SDL_DUMMY_StopCapture(_THIS, SDL_Window * window)
+{
+    SDL_DummyCapture *capture;
+
+    capture = (SDL_DummyCapture *) SDL_SetWindowData(window, DUMMY_CAPTURE, NULL);
+    if (capture) {
+        /* Wake the writer without a frame once it has written the rest */
+        SDL_SemPost(capture->full_buffers);
+        SDL_WaitThread(capture->thread, NULL);
+        SDL_FreeCapture(capture);
+    }
+}
+
+int
+SDL_DUMMY_GetWindowCaptureStats(_THIS, SDL_Window * window,
+                                SDL_WindowCaptureStats * stats)
+{
+    SDL_DummyCapture *capture;
+
+    capture = (SDL_DummyCapture *) SDL_GetWindowData(window, DUMMY_CAPTURE);
+    if (!capture) {
+        SDL_SetError("Window isn't being captured");
+        return -1;
+    }
+    SDL_AtomicLock(&capture->stats_lock);
+    *stats = capture->stats;
+    SDL_AtomicUnlock(&capture->stats_lock);
+    return 0;
+}
+
+#endif /* SDL_VIDEO_DRIVER_DUMMY */
+
+/* vi: set ts=4 sw=4 expandtab: */
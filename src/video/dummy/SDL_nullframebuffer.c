@@ -24,6 +24,7 @@
 
 #include "../SDL_sysvideo.h"
 #include "SDL_nullframebuffer_c.h"
+#include "SDL_nullcapture_c.h"
 
 
 #define DUMMY_SURFACE   "_SDL_DummySurface"
@@ -36,7 +37,8 @@ int SDL_DUMMY_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * forma
     int bpp;
     Uint32 Rmask, Gmask, Bmask, Amask;
 
-    /* Free the old framebuffer surface */
+    /* Free the old framebuffer surface, finishing any capture of it */
+    SDL_DUMMY_StopCapture(_this, window);
     surface = (SDL_Surface *) SDL_GetWindowData(window, DUMMY_SURFACE);
     if (surface) {
         SDL_FreeSurface(surface);
@@ -76,6 +78,7 @@ int SDL_DUMMY_UpdateWindowFramebuffer(_THIS, SDL_Window * window, SDL_Rect * rec
                      SDL_GetWindowID(window), ++frame_number);
         SDL_SaveBMP(surface, file);
     }
+    SDL_DUMMY_CaptureFrame(_this, window, surface, rects, numrects);
     return 0;
 }
 
@@ -83,6 +86,7 @@ void SDL_DUMMY_DestroyWindowFramebuffer(_THIS, SDL_Window * window)
 {
     SDL_Surface *surface;
 
+    SDL_DUMMY_StopCapture(_this, window);
     surface = (SDL_Surface *) SDL_SetWindowData(window, DUMMY_SURFACE, NULL);
     if (surface) {
         SDL_FreeSurface(surface);
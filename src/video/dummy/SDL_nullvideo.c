@@ -46,6 +46,7 @@
 #include "SDL_nullvideo.h"
 #include "SDL_nullevents_c.h"
 #include "SDL_nullframebuffer_c.h"
+#include "SDL_nullcapture_c.h"
 
 #define DUMMYVID_DRIVER_NAME "dummy"
 
@@ -96,6 +97,7 @@ DUMMY_CreateDevice(int devindex)
     device->CreateWindowFramebuffer = SDL_DUMMY_CreateWindowFramebuffer;
     device->UpdateWindowFramebuffer = SDL_DUMMY_UpdateWindowFramebuffer;
     device->DestroyWindowFramebuffer = SDL_DUMMY_DestroyWindowFramebuffer;
+    device->GetWindowCaptureStats = SDL_DUMMY_GetWindowCaptureStats;
 
     device->free = DUMMY_DeleteDevice;
 
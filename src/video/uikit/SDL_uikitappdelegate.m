@@ -74,7 +74,7 @@ static void SDL_IdleTimerDisabledChanged(const char *name, const char *oldValue,
 {
     SDL_assert(SDL_strcmp(name, SDL_HINT_IDLE_TIMER_DISABLED) == 0);
 
-    BOOL disable = (*newValue != '0');
+    BOOL disable = (newValue && *newValue != '0');
     [UIApplication sharedApplication].idleTimerDisabled = disable;
 }
 
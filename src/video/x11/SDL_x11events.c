@@ -32,6 +32,7 @@
 #include "SDL_x11video.h"
 #include "SDL_x11touch.h"
 #include "SDL_x11xinput2.h"
+#include "SDL_x11framebuffer.h"
 #include "../../events/SDL_events_c.h"
 #include "../../events/SDL_mouse_c.h"
 #include "../../events/SDL_touch_c.h"
@@ -210,6 +211,14 @@ X11_DispatchEvent(_THIS)
         return;
     }
 
+#ifndef NO_SHARED_MEMORY
+    if (videodata->shm_completion && xevent.type == videodata->shm_completion) {
+        /* The X server has finished reading a framebuffer image */
+        X11_HandleShmCompletion(data, &xevent);
+        return;
+    }
+#endif
+
     switch (xevent.type) {
 
         /* Gaining mouse coverage? */
@@ -267,6 +276,7 @@ X11_DispatchEvent(_THIS)
             }
             data->pending_focus = PENDING_FOCUS_IN;
             data->pending_focus_time = SDL_GetTicks() + PENDING_FOCUS_IN_TIME;
+            videodata->pending_focus_changes = SDL_TRUE;
         }
         break;
 
@@ -284,6 +294,7 @@ X11_DispatchEvent(_THIS)
 #endif
             data->pending_focus = PENDING_FOCUS_OUT;
             data->pending_focus_time = SDL_GetTicks() + PENDING_FOCUS_OUT_TIME;
+            videodata->pending_focus_changes = SDL_TRUE;
         }
         break;
 
@@ -625,6 +636,7 @@ static void
 X11_HandleFocusChanges(_THIS)
 {
     SDL_VideoData *videodata = (SDL_VideoData *) _this->driverdata;
+    SDL_bool pending = SDL_FALSE;
     int i;
 
     if (videodata && videodata->windowlist) {
@@ -639,40 +651,76 @@ X11_HandleFocusChanges(_THIS)
                         X11_DispatchFocusOut(data);
                     }
                     data->pending_focus = PENDING_FOCUS_NONE;
+                } else {
+                    pending = SDL_TRUE;
                 }
             }
         }
     }
+    videodata->pending_focus_changes = pending;
 }
-/* Ack!  XPending() actually performs a blocking read if no events available */
-static int
-X11_Pending(Display * display)
+
+/* Handle the events that are queued or can be read without blocking */
+static void
+X11_DispatchQueuedEvents(_THIS)
 {
-    /* Flush the display connection and look to see if events are queued */
+    SDL_VideoData *data = (SDL_VideoData *) _this->driverdata;
+    Display *display = data->display;
+    int count;
+
+    /* Flush once, then read everything the server has sent so far in one go */
     XFlush(display);
-    if (XEventsQueued(display, QueuedAlready)) {
-        return (1);
+    while ((count = XEventsQueued(display, QueuedAfterReading)) > 0) {
+        /* Handlers may take events off the queue themselves, and
+           XNextEvent() would block if the queue ran dry. */
+        while (count-- > 0 && XEventsQueued(display, QueuedAlready)) {
+            X11_DispatchEvent(_this);
+        }
     }
+}
+
+int
+X11_GetEventFD(_THIS)
+{
+    SDL_VideoData *data = (SDL_VideoData *) _this->driverdata;
 
-    /* More drastic measures are required -- see if X is ready to talk */
-    {
-        static struct timeval zero_time;        /* static == 0 */
-        int x11_fd;
-        fd_set fdset;
-
-        x11_fd = ConnectionNumber(display);
-        FD_ZERO(&fdset);
-        FD_SET(x11_fd, &fdset);
-        if (select(x11_fd + 1, &fdset, NULL, NULL, &zero_time) == 1) {
-            return (XPending(display));
+    return ConnectionNumber(data->display);
+}
+
+/* Focus changes and screensaver updates happen in X11_PumpEvents() when
+   their time comes, without anything arriving on the connection */
+int
+X11_GetEventTimeout(_THIS)
+{
+    SDL_VideoData *data = (SDL_VideoData *) _this->driverdata;
+    Uint32 now = SDL_GetTicks();
+    int timeout = -1;
+    int i, left;
+
+    if (data->pending_focus_changes && data->windowlist) {
+        for (i = 0; i < data->numwindows; ++i) {
+            SDL_WindowData *windowdata = data->windowlist[i];
+            if (windowdata && windowdata->pending_focus != PENDING_FOCUS_NONE) {
+                left = SDL_max((int) (windowdata->pending_focus_time - now), 0);
+                if (timeout < 0 || left < timeout) {
+                    timeout = left;
+                }
+            }
         }
     }
 
-    /* Oh well, nothing is ready .. */
-    return (0);
+    if (_this->suspend_screensaver) {
+        left = 0;
+        if (data->screensaver_activity) {
+            left = SDL_max((int) (data->screensaver_activity + 30000 - now), 0);
+        }
+        if (timeout < 0 || left < timeout) {
+            timeout = left;
+        }
+    }
+    return timeout;
 }
 
-
 /* !!! FIXME: this should be exposed in a header, or something. */
 int SDL_GetNumTouch(void);
 void SDL_dbus_screensaver_tickle(_THIS);
@@ -698,12 +746,11 @@ X11_PumpEvents(_THIS)
     }   
 
     /* Keep processing pending events */
-    while (X11_Pending(data->display)) {
-        X11_DispatchEvent(_this);
-    }
+    X11_DispatchQueuedEvents(_this);
 
-    /* FIXME: Only need to do this when there are pending focus changes */
-    X11_HandleFocusChanges(_this);
+    if (data->pending_focus_changes) {
+        X11_HandleFocusChanges(_this);
+    }
 
     /*Dont process evtouch events if XInput2 multitouch is supported*/
     if(X11_Xinput2IsMultitouchSupported()) {
@@ -24,6 +24,8 @@
 #define _SDL_x11events_h
 
 extern void X11_PumpEvents(_THIS);
+extern int X11_GetEventFD(_THIS);
+extern int X11_GetEventTimeout(_THIS);
 extern void X11_SuspendScreenSaver(_THIS);
 
 #endif /* _SDL_x11events_h */
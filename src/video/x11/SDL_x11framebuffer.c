@@ -22,6 +22,7 @@
 
 #if SDL_VIDEO_DRIVER_X11
 
+#include "SDL_hints.h"
 #include "SDL_x11video.h"
 #include "SDL_x11framebuffer.h"
 
@@ -50,6 +51,155 @@ static SDL_bool have_mitshm(void)
     return SDL_FALSE;
 }
 
+/* Create a shared memory image, returning SDL_FALSE if it isn't possible */
+static SDL_bool
+X11_CreateShmImage(Display *display, SDL_WindowData *data, int depth,
+                   int w, int h, int pitch, SDL_ShmImage *image)
+{
+    XShmSegmentInfo *shminfo = &image->shminfo;
+
+    shminfo->shmid = shmget(IPC_PRIVATE, h*pitch, IPC_CREAT | 0777);
+    if ( shminfo->shmid >= 0 ) {
+        shminfo->shmaddr = (char *)shmat(shminfo->shmid, 0, 0);
+        shminfo->readOnly = False;
+        if ( shminfo->shmaddr != (char *)-1 ) {
+            shm_error = False;
+            X_handler = XSetErrorHandler(shm_errhandler);
+            XShmAttach(display, shminfo);
+            XSync(display, True);
+            XSetErrorHandler(X_handler);
+            if ( shm_error )
+                shmdt(shminfo->shmaddr);
+        } else {
+            shm_error = True;
+        }
+        shmctl(shminfo->shmid, IPC_RMID, NULL);
+    } else {
+        shm_error = True;
+    }
+    if (shm_error) {
+        return SDL_FALSE;
+    }
+
+    image->ximage = XShmCreateImage(display, data->visual, depth, ZPixmap,
+                                    shminfo->shmaddr, shminfo, w, h);
+    if (!image->ximage) {
+        XShmDetach(display, shminfo);
+        XSync(display, False);
+        shmdt(shminfo->shmaddr);
+        return SDL_FALSE;
+    }
+    image->busy = SDL_FALSE;
+    image->numrects = -1;
+    return SDL_TRUE;
+}
+
+static Bool
+X11_IsShmCompletion(Display *display, XEvent *event, XPointer arg)
+{
+    SDL_WindowData *data = (SDL_WindowData *) arg;
+
+    return (event->type == data->videodata->shm_completion &&
+            event->xany.window == data->xwindow);
+}
+
+void
+X11_HandleShmCompletion(SDL_WindowData *data, XEvent *event)
+{
+    XShmCompletionEvent *completion = (XShmCompletionEvent *) event;
+    int i;
+
+    for (i = 0; i < data->num_shmimages; ++i) {
+        if (data->shmimages[i].shminfo.shmseg == completion->shmseg) {
+            data->shmimages[i].busy = SDL_FALSE;
+        }
+    }
+}
+
+/* Wait until the X server has finished reading an image */
+static void
+X11_WaitShmImage(Display *display, SDL_WindowData *data, SDL_ShmImage *image)
+{
+    XEvent event;
+
+    while (image->busy &&
+           XCheckIfEvent(display, &event, X11_IsShmCompletion, (XPointer) data)) {
+        X11_HandleShmCompletion(data, &event);
+    }
+    if (image->busy) {
+        /* The server reads the image while handling the request, so once
+           it has handled everything we've sent, the image is free.
+         */
+        XSync(display, False);
+        while (XCheckIfEvent(display, &event, X11_IsShmCompletion, (XPointer) data)) {
+            X11_HandleShmCompletion(data, &event);
+        }
+        image->busy = SDL_FALSE;
+    }
+}
+
+/* Switch to the next image, bringing the parts presented since it was
+   last drawn to up to date.
+ */
+static void
+X11_SwapShmImages(_THIS, SDL_Window * window, SDL_Rect * rects, int numrects)
+{
+    SDL_WindowData *data = (SDL_WindowData *) window->driverdata;
+    Display *display = data->videodata->display;
+    SDL_ShmImage *current = &data->shmimages[data->shmimage];
+    SDL_ShmImage *next;
+    const int bpp = current->ximage->bits_per_pixel / 8;
+    const int pitch = current->ximage->bytes_per_line;
+    SDL_Rect bounds, rect;
+    int i, j, y;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = window->w;
+    bounds.h = window->h;
+
+    for (i = 0; i < data->num_shmimages; ++i) {
+        SDL_ShmImage *image = &data->shmimages[i];
+        if (image == current) {
+            continue;
+        }
+        for (j = 0; j < numrects && image->numrects >= 0; ++j) {
+            if (!SDL_IntersectRect(&rects[j], &bounds, &rect)) {
+                continue;
+            }
+            if (image->numrects == X11_SHMIMAGE_RECTS) {
+                image->numrects = -1;
+            } else {
+                image->rects[image->numrects++] = rect;
+            }
+        }
+    }
+
+    data->shmimage = (data->shmimage + 1) % data->num_shmimages;
+    next = &data->shmimages[data->shmimage];
+    X11_WaitShmImage(display, data, next);
+
+    if (next->numrects < 0 || bpp == 0) {
+        SDL_memcpy(next->ximage->data, current->ximage->data, window->h * pitch);
+    } else {
+        for (i = 0; i < next->numrects; ++i) {
+            const SDL_Rect *dirty = &next->rects[i];
+            const int offset = dirty->x * bpp;
+            for (y = dirty->y; y < dirty->y + dirty->h; ++y) {
+                SDL_memcpy(next->ximage->data + y * pitch + offset,
+                           current->ximage->data + y * pitch + offset,
+                           dirty->w * bpp);
+            }
+        }
+    }
+    next->numrects = 0;
+
+    data->ximage = next->ximage;
+    if (window->surface) {
+        window->surface->pixels = next->ximage->data;
+    }
+}
+
 #endif /* !NO_SHARED_MEMORY */
 
 int
@@ -90,43 +240,31 @@ X11_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * format,
     /* Create the actual image */
 #ifndef NO_SHARED_MEMORY
     if (have_mitshm()) {
-        XShmSegmentInfo *shminfo = &data->shminfo;
-
-        shminfo->shmid = shmget(IPC_PRIVATE, window->h*(*pitch), IPC_CREAT | 0777);
-        if ( shminfo->shmid >= 0 ) {
-            shminfo->shmaddr = (char *)shmat(shminfo->shmid, 0, 0);
-            shminfo->readOnly = False;
-            if ( shminfo->shmaddr != (char *)-1 ) {
-                shm_error = False;
-                X_handler = XSetErrorHandler(shm_errhandler);
-                XShmAttach(display, shminfo);
-                XSync(display, True);
-                XSetErrorHandler(X_handler);
-                if ( shm_error )
-                    shmdt(shminfo->shmaddr);
-            } else {
-                shm_error = True;
-            }
-            shmctl(shminfo->shmid, IPC_RMID, NULL);
-        } else {
-            shm_error = True;
+        const char *hint = SDL_GetHint(SDL_HINT_VIDEO_X11_SHM_IMAGES);
+        int i, count = 1;
+
+        if (hint) {
+            count = SDL_atoi(hint);
         }
-        if (!shm_error) {
-            data->ximage = XShmCreateImage(display, data->visual,
-                             vinfo.depth, ZPixmap,
-                             shminfo->shmaddr, shminfo, 
-                             window->w, window->h);
-            if (!data->ximage) {
-                XShmDetach(display, shminfo);
-                XSync(display, False);
-                shmdt(shminfo->shmaddr);
-            } else {
-                /* Done! */
-                data->use_mitshm = SDL_TRUE;
-                *pixels = shminfo->shmaddr;
-                return 0;
+        count = SDL_max(1, SDL_min(count, X11_MAX_SHMIMAGES));
+        for (i = 0; i < count; ++i) {
+            if (!X11_CreateShmImage(display, data, vinfo.depth,
+                                    window->w, window->h, *pitch,
+                                    &data->shmimages[i])) {
+                break;
             }
         }
+        if (i > 0) {
+            /* Done! */
+            data->use_mitshm = SDL_TRUE;
+            data->num_shmimages = i;
+            data->shmimage = 0;
+            data->ximage = data->shmimages[0].ximage;
+            data->videodata->shm_completion =
+                XShmGetEventBase(display) + ShmCompletion;
+            *pixels = data->ximage->data;
+            return 0;
+        }
     }
 #endif /* not NO_SHARED_MEMORY */
 
@@ -153,69 +291,57 @@ X11_UpdateWindowFramebuffer(_THIS, SDL_Window * window, SDL_Rect * rects,
 {
     SDL_WindowData *data = (SDL_WindowData *) window->driverdata;
     Display *display = data->videodata->display;
+    SDL_Rect bounds, rect;
     int i;
-    int x, y, w ,h;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = window->w;
+    bounds.h = window->h;
+
 #ifndef NO_SHARED_MEMORY
     if (data->use_mitshm) {
-        for (i = 0; i < numrects; ++i) {
-            x = rects[i].x;
-            y = rects[i].y;
-            w = rects[i].w;
-            h = rects[i].h;
+        SDL_ShmImage *image = &data->shmimages[data->shmimage];
+        const SDL_bool swap = (data->num_shmimages > 1);
+        SDL_Rect last;
+        int numput = 0;
 
-            if (w <= 0 || h <= 0 || (x + w) <= 0 || (y + h) <= 0) {
+        for (i = 0; i < numrects; ++i) {
+            if (!SDL_IntersectRect(&rects[i], &bounds, &rect)) {
                 /* Clipped? */
                 continue;
             }
-            if (x < 0)
-            {
-                x += w;
-                w += rects[i].x;
+            /* Only the last request asks for a completion event */
+            if (numput++ > 0) {
+                XShmPutImage(display, data->xwindow, data->gc, data->ximage,
+                    last.x, last.y, last.x, last.y, last.w, last.h, False);
             }
-            if (y < 0)
-            {
-                y += h;
-                h += rects[i].y;
-            }
-            if (x + w > window->w)
-                w = window->w - x;
-            if (y + h > window->h)
-                h = window->h - y;
-
-            XShmPutImage(display, data->xwindow, data->gc, data->ximage,
-                x, y, x, y, w, h, False);
+            last = rect;
+        }
+        if (numput == 0) {
+            return 0;
+        }
+        XShmPutImage(display, data->xwindow, data->gc, data->ximage,
+            last.x, last.y, last.x, last.y, last.w, last.h, swap);
+
+        if (swap) {
+            /* Draw into the next image while the server reads this one */
+            image->busy = SDL_TRUE;
+            XFlush(display);
+            X11_SwapShmImages(_this, window, rects, numrects);
+            return 0;
         }
     }
     else
 #endif /* !NO_SHARED_MEMORY */
     {
         for (i = 0; i < numrects; ++i) {
-            x = rects[i].x;
-            y = rects[i].y;
-            w = rects[i].w;
-            h = rects[i].h;
-
-            if (w <= 0 || h <= 0 || (x + w) <= 0 || (y + h) <= 0) {
+            if (!SDL_IntersectRect(&rects[i], &bounds, &rect)) {
                 /* Clipped? */
                 continue;
             }
-            if (x < 0)
-            {
-                x += w;
-                w += rects[i].x;
-            }
-            if (y < 0)
-            {
-                y += h;
-                h += rects[i].y;
-            }
-            if (x + w > window->w)
-                w = window->w - x;
-            if (y + h > window->h)
-                h = window->h - y;
-
             XPutImage(display, data->xwindow, data->gc, data->ximage,
-                x, y, x, y, w, h);
+                rect.x, rect.y, rect.x, rect.y, rect.w, rect.h);
         }
     }
 
@@ -238,16 +364,23 @@ X11_DestroyWindowFramebuffer(_THIS, SDL_Window * window)
     display = data->videodata->display;
 
     if (data->ximage) {
-        XDestroyImage(data->ximage);
-
 #ifndef NO_SHARED_MEMORY
         if (data->use_mitshm) {
-            XShmDetach(display, &data->shminfo);
+            int i;
+
+            for (i = 0; i < data->num_shmimages; ++i) {
+                XDestroyImage(data->shmimages[i].ximage);
+                XShmDetach(display, &data->shmimages[i].shminfo);
+            }
             XSync(display, False);
-            shmdt(data->shminfo.shmaddr);
+            for (i = 0; i < data->num_shmimages; ++i) {
+                shmdt(data->shmimages[i].shminfo.shmaddr);
+            }
+            data->num_shmimages = 0;
             data->use_mitshm = SDL_FALSE;
-        }
+        } else
 #endif /* !NO_SHARED_MEMORY */
+        XDestroyImage(data->ximage);
 
         data->ximage = NULL;
     }
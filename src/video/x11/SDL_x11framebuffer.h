@@ -28,4 +28,8 @@ extern int X11_UpdateWindowFramebuffer(_THIS, SDL_Window * window,
                                        SDL_Rect * rects, int numrects);
 extern void X11_DestroyWindowFramebuffer(_THIS, SDL_Window * window);
 
+#ifndef NO_SHARED_MEMORY
+extern void X11_HandleShmCompletion(SDL_WindowData *data, XEvent *event);
+#endif
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -46,8 +46,7 @@ X11_CreateShaper(SDL_Window* window) {
         result->userx = result->usery = 0;
         SDL_ShapeData* data = SDL_malloc(sizeof(SDL_ShapeData));
         result->driverdata = data;
-        data->bitmapsize = 0;
-        data->bitmap = NULL;
+        SDL_zerop(data);
         window->shaper = result;
         int resized_properly = X11_ResizeWindowShape(window);
         SDL_assert(resized_properly == 0);
@@ -62,21 +61,8 @@ X11_ResizeWindowShape(SDL_Window* window) {
     SDL_ShapeData* data = window->shaper->driverdata;
     SDL_assert(data != NULL);
     
-    unsigned int bitmapsize = window->w / 8;
-    if(window->w % 8 > 0)
-        bitmapsize += 1;
-    bitmapsize *= window->h;
-    if(data->bitmapsize != bitmapsize || data->bitmap == NULL) {
-        data->bitmapsize = bitmapsize;
-        if(data->bitmap != NULL)
-            free(data->bitmap);
-        data->bitmap = malloc(data->bitmapsize);
-        if(data->bitmap == NULL) {
-            SDL_SetError("Could not allocate memory for shaped-window bitmap.");
-            return -1;
-        }
-    }
-    memset(data->bitmap,0,data->bitmapsize);
+    /* The next shape replaces the whole window shape. */
+    SDL_FreeShapeSpans(&data->spans);
     
     window->shaper->userx = window->x;
     window->shaper->usery = window->y;
@@ -96,17 +82,58 @@ X11_SetWindowShape(SDL_WindowShaper *shaper,SDL_Surface *shape,SDL_WindowShapeMo
     if(shape->w != shaper->window->w || shape->h != shaper->window->h)
         return -3;
     SDL_ShapeData *data = shaper->driverdata;
+    SDL_WindowData *windowdata = (SDL_WindowData*)(shaper->window->driverdata);
+    Display *display = windowdata->videodata->display;
+    SDL_Rect changed;
     
     /* Assume that shaper->alphacutoff already has a value, because SDL_SetWindowShape() should have given it one. */
-    SDL_CalculateShapeBitmap(shaper->mode,shape,data->bitmap,8);
-        
-    SDL_WindowData *windowdata = (SDL_WindowData*)(shaper->window->driverdata);
-    Pixmap shapemask = XCreateBitmapFromData(windowdata->videodata->display,windowdata->xwindow,data->bitmap,shaper->window->w,shaper->window->h);
+    if(SDL_CalculateShapeSpans(shaper->mode,shape,&data->spans,&changed) < 0)
+        return -1;
+    if(changed.h == 0)
+        /* The shape is the same as last time. */
+        return 0;
     
-    XShapeCombineMask(windowdata->videodata->display,windowdata->xwindow, ShapeBounding, 0, 0,shapemask, ShapeSet);
-    XSync(windowdata->videodata->display,False);
-
-    XFreePixmap(windowdata->videodata->display,shapemask);
+    /* Only send the spans of the rows that changed, cut to the columns that changed. */
+    int first = data->spans.rowspans[changed.y];
+    int last = data->spans.rowspans[changed.y + changed.h];
+    int count = 0,i;
+    if(last - first > data->maxrects) {
+        XRectangle *rects = (XRectangle*)SDL_realloc(data->rects,(last - first) * sizeof(XRectangle));
+        if(rects == NULL) {
+            /* The spans already hold the new shape, so forget them and send the whole shape next time. */
+            SDL_FreeShapeSpans(&data->spans);
+            SDL_OutOfMemory();
+            return -1;
+        }
+        data->rects = rects;
+        data->maxrects = last - first;
+    }
+    for(i = first;i < last;i++) {
+        const SDL_Rect *span = &data->spans.spans[i];
+        int x1 = SDL_max(span->x,changed.x);
+        int x2 = SDL_min(span->x + span->w,changed.x + changed.w);
+        if(x1 < x2) {
+            data->rects[count].x = x1;
+            data->rects[count].y = span->y;
+            data->rects[count].width = x2 - x1;
+            data->rects[count].height = 1;
+            count++;
+        }
+    }
+    
+    if(changed.w == shape->w && changed.h == shape->h) {
+        XShapeCombineRectangles(display,windowdata->xwindow,ShapeBounding,0,0,data->rects,count,ShapeSet,YXBanded);
+    }
+    else {
+        XRectangle area;
+        area.x = changed.x;
+        area.y = changed.y;
+        area.width = changed.w;
+        area.height = changed.h;
+        XShapeCombineRectangles(display,windowdata->xwindow,ShapeBounding,0,0,&area,1,ShapeSubtract,Unsorted);
+        XShapeCombineRectangles(display,windowdata->xwindow,ShapeBounding,0,0,data->rects,count,ShapeUnion,YXBanded);
+    }
+    XFlush(display);
 #endif
 
     return 0;
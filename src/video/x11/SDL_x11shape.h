@@ -26,10 +26,12 @@
 #include "SDL_video.h"
 #include "SDL_shape.h"
 #include "../SDL_sysvideo.h"
+#include "../SDL_shape_internals.h"
 
 typedef struct {
-	void* bitmap;
-	Uint32 bitmapsize;
+	SDL_ShapeSpans spans;
+	XRectangle* rects;
+	int maxrects;
 } SDL_ShapeData;
 
 extern SDL_Window* X11_CreateShapedWindow(const char *title,unsigned int x,unsigned int y,unsigned int w,unsigned int h,Uint32 flags);
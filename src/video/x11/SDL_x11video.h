@@ -104,6 +104,13 @@ typedef struct SDL_VideoData
     SDL_Scancode key_layout[256];
     SDL_bool selection_waiting;    
 
+    /* A window has a focus change waiting to be dispatched */
+    SDL_bool pending_focus_changes;
+
+#ifndef NO_SHARED_MEMORY
+    int shm_completion;         /* Event type of XShmCompletionEvent, or 0 */
+#endif
+
 #if SDL_USE_LIBDBUS
     DBusConnection *dbus;
 #endif
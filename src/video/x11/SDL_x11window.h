@@ -37,6 +37,21 @@ typedef enum
     PENDING_FOCUS_OUT
 } PendingFocusEnum;
 
+#ifndef NO_SHARED_MEMORY
+/* Presenting rotates through this many shared memory images at most */
+#define X11_MAX_SHMIMAGES   3
+#define X11_SHMIMAGE_RECTS  16
+
+typedef struct
+{
+    XImage *ximage;
+    XShmSegmentInfo shminfo;
+    SDL_bool busy;              /* The X server may still be reading it */
+    int numrects;               /* -1 if all of it is out of date */
+    SDL_Rect rects[X11_SHMIMAGE_RECTS];
+} SDL_ShmImage;
+#endif
+
 typedef struct
 {
     SDL_Window *window;
@@ -47,7 +62,9 @@ typedef struct
 #ifndef NO_SHARED_MEMORY
     /* MIT shared memory extension information */
     SDL_bool use_mitshm;
-    XShmSegmentInfo shminfo;
+    int num_shmimages;
+    int shmimage;               /* The image being drawn to */
+    SDL_ShmImage shmimages[X11_MAX_SHMIMAGES];
 #endif
     XImage *ximage;
     GC gc;
@@ -41,8 +41,11 @@ void RunBasicTest()
 {
     int value;
     SDL_SpinLock lock = 0;
+    SDL_RWSpinLock rwlock = 0;
 
     SDL_atomic_t v;
+    SDL_atomic64_t v64;
+    Sint64 value64;
     SDL_bool tfret = SDL_FALSE;
 
     printf("\nspin lock---------------------------------------\n\n");
@@ -52,6 +55,24 @@ void RunBasicTest()
     SDL_AtomicUnlock(&lock);
     printf("AtomicUnlock                 lock=%d\n", lock);
 
+    printf("\nreader/writer spin lock-------------------------\n\n");
+
+    SDL_AtomicLockRead(&rwlock);
+    tfret = SDL_AtomicTryLockRead(&rwlock);
+    printf("AtomicTryLockRead    tfret=%s lock=%d\n", tf(tfret), rwlock);
+    tfret = !SDL_AtomicTryLockWrite(&rwlock);
+    printf("AtomicTryLockWrite   tfret=%s lock=%d\n", tf(tfret), rwlock);
+    SDL_AtomicUnlockRead(&rwlock);
+    SDL_AtomicUnlockRead(&rwlock);
+    tfret = (rwlock == 0);
+    printf("AtomicUnlockRead     tfret=%s lock=%d\n", tf(tfret), rwlock);
+    SDL_AtomicLockWrite(&rwlock);
+    tfret = !SDL_AtomicTryLockRead(&rwlock);
+    printf("AtomicTryLockRead    tfret=%s lock=%d\n", tf(tfret), rwlock);
+    SDL_AtomicUnlockWrite(&rwlock);
+    tfret = (rwlock == 0);
+    printf("AtomicUnlockWrite    tfret=%s lock=%d\n", tf(tfret), rwlock);
+
     printf("\natomic -----------------------------------------\n\n");
      
     SDL_AtomicSet(&v, 0);
@@ -78,6 +99,49 @@ void RunBasicTest()
     value = SDL_AtomicGet(&v);
     tfret = (SDL_AtomicCAS(&v, value, 20) == SDL_TRUE);
     printf("AtomicCAS()          tfret=%s val=%d\n", tf(tfret), SDL_AtomicGet(&v));
+
+    SDL_AtomicSet(&v, 0x0C);
+    tfret = (SDL_AtomicOr(&v, 0x03) == 0x0C && SDL_AtomicGet(&v) == 0x0F);
+    printf("AtomicOr(0x03)       tfret=%s val=0x%x\n", tf(tfret), SDL_AtomicGet(&v));
+    tfret = (SDL_AtomicAnd(&v, 0x06) == 0x0F && SDL_AtomicGet(&v) == 0x06);
+    printf("AtomicAnd(0x06)      tfret=%s val=0x%x\n", tf(tfret), SDL_AtomicGet(&v));
+    tfret = (SDL_AtomicXor(&v, 0x05) == 0x06 && SDL_AtomicGet(&v) == 0x03);
+    printf("AtomicXor(0x05)      tfret=%s val=0x%x\n", tf(tfret), SDL_AtomicGet(&v));
+
+    SDL_AtomicSetRelease(&v, 30);
+    tfret = (SDL_AtomicGetAcquire(&v) == 30);
+    printf("AtomicSetRelease(30) tfret=%s val=%d\n", tf(tfret), SDL_AtomicGetAcquire(&v));
+    SDL_AtomicSetRelaxed(&v, 40);
+    tfret = (SDL_AtomicAddRelaxed(&v, 2) == 40 && SDL_AtomicGetRelaxed(&v) == 42);
+    printf("AtomicAddRelaxed(2)  tfret=%s val=%d\n", tf(tfret), SDL_AtomicGetRelaxed(&v));
+
+    printf("\natomic 64-bit ----------------------------------\n\n");
+
+    SDL_AtomicSet64(&v64, 0);
+    tfret = (SDL_AtomicSet64(&v64, 0x100000000LL) == 0);
+    printf("AtomicSet64(2^32)    tfret=%s val=%lld\n", tf(tfret), (long long)SDL_AtomicGet64(&v64));
+    tfret = (SDL_AtomicAdd64(&v64, -1) == 0x100000000LL && SDL_AtomicGet64(&v64) == 0xFFFFFFFFLL);
+    printf("AtomicAdd64(-1)      tfret=%s val=%lld\n", tf(tfret), (long long)SDL_AtomicGet64(&v64));
+    tfret = (SDL_AtomicCAS64(&v64, 0, 20) == SDL_FALSE);
+    printf("AtomicCAS64()        tfret=%s val=%lld\n", tf(tfret), (long long)SDL_AtomicGet64(&v64));
+    value64 = SDL_AtomicGet64(&v64);
+    tfret = (SDL_AtomicCAS64(&v64, value64, 0x7F00000000LL) == SDL_TRUE);
+    printf("AtomicCAS64()        tfret=%s val=%lld\n", tf(tfret), (long long)SDL_AtomicGet64(&v64));
+    tfret = (SDL_AtomicOr64(&v64, 0xFF) == 0x7F00000000LL &&
+             SDL_AtomicAnd64(&v64, 0x0F000000FFLL) == 0x7F000000FFLL &&
+             SDL_AtomicXor64(&v64, 0x0F00000000LL) == 0x0F000000FFLL &&
+             SDL_AtomicGet64(&v64) == 0xFF);
+    printf("AtomicOr/And/Xor64() tfret=%s val=%lld\n", tf(tfret), (long long)SDL_AtomicGet64(&v64));
+    SDL_AtomicSetRelease64(&v64, 0x123456789LL);
+    tfret = (SDL_AtomicGetAcquire64(&v64) == 0x123456789LL);
+    printf("AtomicSetRelease64() tfret=%s val=%lld\n", tf(tfret), (long long)SDL_AtomicGetAcquire64(&v64));
+    SDL_AtomicSetRelaxed64(&v64, 0);
+    tfret = (SDL_AtomicAddRelaxed64(&v64, 5) == 0 && SDL_AtomicGetRelaxed64(&v64) == 5);
+    printf("AtomicAddRelaxed64() tfret=%s val=%lld\n", tf(tfret), (long long)SDL_AtomicGetRelaxed64(&v64));
+
+    SDL_MemoryBarrierRelease();
+    SDL_MemoryBarrierAcquire();
+    SDL_MemoryBarrier();
 }
 
 /**************************************************************************/
@@ -243,6 +307,166 @@ void RunEpicTest()
 /* End atomic operation test */
 /**************************************************************************/
 
+/**************************************************************************/
+/* Lock scaling test
+ *
+ * Each thread mostly reads a shared table and occasionally updates it,
+ * under each kind of lock in turn.  Writers bump every entry, so a reader
+ * that sees different values caught a writer in the middle of an update.
+ */
+
+#define SCALING_MAX_THREADS     8
+#define SCALING_ITERATIONS      200000
+#define SCALING_WRITE_INTERVAL  10
+#define SCALING_TABLE_SIZE      16
+
+typedef enum
+{
+    LOCK_SPINLOCK,
+    LOCK_RWSPINLOCK,
+    LOCK_MUTEX,
+    LOCK_RWLOCK,
+    NUM_LOCK_TYPES
+} LockType;
+
+static const char *lockNames[NUM_LOCK_TYPES] = {
+    "SDL_SpinLock", "SDL_RWSpinLock", "SDL_mutex", "SDL_rwlock"
+};
+
+static SDL_SpinLock scalingSpinLock;
+static SDL_RWSpinLock scalingRWSpinLock;
+static SDL_mutex *scalingMutex;
+static SDL_rwlock *scalingRWLock;
+static volatile int scalingTable[SCALING_TABLE_SIZE];
+static SDL_atomic_t scalingTornReads;
+
+static void
+LockForScaling(LockType type, SDL_bool write)
+{
+    switch (type) {
+    case LOCK_SPINLOCK:
+        SDL_AtomicLock(&scalingSpinLock);
+        break;
+    case LOCK_RWSPINLOCK:
+        if (write) {
+            SDL_AtomicLockWrite(&scalingRWSpinLock);
+        } else {
+            SDL_AtomicLockRead(&scalingRWSpinLock);
+        }
+        break;
+    case LOCK_MUTEX:
+        SDL_LockMutex(scalingMutex);
+        break;
+    case LOCK_RWLOCK:
+        if (write) {
+            SDL_LockRWLockForWriting(scalingRWLock);
+        } else {
+            SDL_LockRWLockForReading(scalingRWLock);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+UnlockForScaling(LockType type, SDL_bool write)
+{
+    switch (type) {
+    case LOCK_SPINLOCK:
+        SDL_AtomicUnlock(&scalingSpinLock);
+        break;
+    case LOCK_RWSPINLOCK:
+        if (write) {
+            SDL_AtomicUnlockWrite(&scalingRWSpinLock);
+        } else {
+            SDL_AtomicUnlockRead(&scalingRWSpinLock);
+        }
+        break;
+    case LOCK_MUTEX:
+        SDL_UnlockMutex(scalingMutex);
+        break;
+    case LOCK_RWLOCK:
+        SDL_UnlockRWLock(scalingRWLock);
+        break;
+    default:
+        break;
+    }
+}
+
+static int
+ScalingThread(void *data)
+{
+    LockType type = *(LockType *)data;
+    SDL_bool write;
+    int i, j;
+
+    for (i = 0; i < SCALING_ITERATIONS; ++i) {
+        write = ((i % SCALING_WRITE_INTERVAL) == 0);
+        LockForScaling(type, write);
+        if (write) {
+            for (j = 0; j < SCALING_TABLE_SIZE; ++j) {
+                ++scalingTable[j];
+            }
+        } else {
+            for (j = 1; j < SCALING_TABLE_SIZE; ++j) {
+                if (scalingTable[j] != scalingTable[0]) {
+                    SDL_AtomicIncRef(&scalingTornReads);
+                    break;
+                }
+            }
+        }
+        UnlockForScaling(type, write);
+    }
+    return 0;
+}
+
+static
+void RunLockScalingTest()
+{
+    SDL_Thread *threads[SCALING_MAX_THREADS];
+    LockType type;
+    Uint64 start;
+    double ms;
+    int num_threads, i, expected;
+
+    printf("\nlock scaling test-------------------------------\n\n");
+
+    scalingMutex = SDL_CreateMutex();
+    scalingRWLock = SDL_CreateRWLock();
+    SDL_assert(scalingMutex && scalingRWLock);
+
+    for (type = LOCK_SPINLOCK; type < NUM_LOCK_TYPES; ++type) {
+        for (num_threads = 1; num_threads <= SCALING_MAX_THREADS; num_threads *= 2) {
+            SDL_memset((void *)scalingTable, 0, sizeof(scalingTable));
+            SDL_AtomicSet(&scalingTornReads, 0);
+
+            start = SDL_GetPerformanceCounter();
+            for (i = 0; i < num_threads; ++i) {
+                threads[i] = SDL_CreateThread(ScalingThread, "LockScaling", &type);
+            }
+            for (i = 0; i < num_threads; ++i) {
+                SDL_WaitThread(threads[i], NULL);
+            }
+            ms = (double)((SDL_GetPerformanceCounter() - start) * 1000) / SDL_GetPerformanceFrequency();
+
+            printf("%-16s %d threads: %10.3f ms, %8.0f locks per ms\n",
+                   lockNames[type], num_threads, ms,
+                   (num_threads * SCALING_ITERATIONS) / ms);
+
+            expected = num_threads * (SCALING_ITERATIONS / SCALING_WRITE_INTERVAL);
+            SDL_assert(scalingTable[0] == expected);
+            SDL_assert(SDL_AtomicGet(&scalingTornReads) == 0);
+        }
+    }
+
+    SDL_DestroyRWLock(scalingRWLock);
+    SDL_DestroyMutex(scalingMutex);
+}
+
+/* End lock scaling test */
+/**************************************************************************/
+
 /**************************************************************************/
 /* Lock-free FIFO test */
 
@@ -707,6 +931,7 @@ main(int argc, char *argv[])
 {
     RunBasicTest();
     RunEpicTest();
+    RunLockScalingTest();
 /* This test is really slow, so don't run it by default */
 #if 0
     RunFIFOTest(SDL_FALSE);
@@ -108,6 +108,8 @@ int platform_testEndianessAndSwap(void *arg)
  * http://wiki.libsdl.org/moin.cgi/SDL_GetPlatform
  * http://wiki.libsdl.org/moin.cgi/SDL_GetCPUCount
  * http://wiki.libsdl.org/moin.cgi/SDL_GetCPUCacheLineSize
+ * http://wiki.libsdl.org/moin.cgi/SDL_GetCPUPhysicalCoreCount
+ * http://wiki.libsdl.org/moin.cgi/SDL_GetCPUCacheSize
  * http://wiki.libsdl.org/moin.cgi/SDL_GetRevision
  * http://wiki.libsdl.org/moin.cgi/SDL_GetRevisionNumber
  */
@@ -141,6 +143,24 @@ int platform_testGetFunctions (void *arg)
              "SDL_GetCPUCacheLineSize(): expected size >= 0, was: %i",
              ret);
 
+   ret = SDL_GetCPUPhysicalCoreCount();
+   SDLTest_AssertPass("SDL_GetCPUPhysicalCoreCount()");
+   SDLTest_AssertCheck(ret > 0 && ret <= SDL_GetCPUCount(),
+             "SDL_GetCPUPhysicalCoreCount(): expected 0 < count <= %i, was: %i",
+             SDL_GetCPUCount(), ret);
+
+   ret = SDL_GetCPUCacheSize(1);
+   SDLTest_AssertPass("SDL_GetCPUCacheSize(1)");
+   SDLTest_AssertCheck(ret >= 0,
+             "SDL_GetCPUCacheSize(1): expected size >= 0, was: %i",
+             ret);
+
+   ret = SDL_GetCPUCacheSize(4);
+   SDLTest_AssertPass("SDL_GetCPUCacheSize(4)");
+   SDLTest_AssertCheck(ret == 0,
+             "SDL_GetCPUCacheSize(4): expected size == 0, was: %i",
+             ret);
+
    revision = (char *)SDL_GetRevision();
    SDLTest_AssertPass("SDL_GetRevision()");
    SDLTest_AssertCheck(revision != NULL, "SDL_GetRevision() != NULL");
@@ -163,6 +183,10 @@ int platform_testGetFunctions (void *arg)
  * http://wiki.libsdl.org/moin.cgi/SDL_HasSSE3
  * http://wiki.libsdl.org/moin.cgi/SDL_HasSSE41
  * http://wiki.libsdl.org/moin.cgi/SDL_HasSSE42
+ * http://wiki.libsdl.org/moin.cgi/SDL_HasAVX
+ * http://wiki.libsdl.org/moin.cgi/SDL_HasAVX2
+ * http://wiki.libsdl.org/moin.cgi/SDL_HasAVX512F
+ * http://wiki.libsdl.org/moin.cgi/SDL_HasNEON
  */
 int platform_testHasFunctions (void *arg)
 {
@@ -197,6 +221,34 @@ int platform_testHasFunctions (void *arg)
    ret = SDL_HasSSE42();
    SDLTest_AssertPass("SDL_HasSSE42()");
 
+   ret = SDL_HasAVX();
+   SDLTest_AssertPass("SDL_HasAVX()");
+
+   /* Each of these needs the OS support that AVX checks for */
+   ret = SDL_HasAVX2();
+   SDLTest_AssertPass("SDL_HasAVX2()");
+   SDLTest_AssertCheck(!ret || SDL_HasAVX(), "SDL_HasAVX2() implies SDL_HasAVX()");
+
+   ret = SDL_HasAVX512F();
+   SDLTest_AssertPass("SDL_HasAVX512F()");
+   SDLTest_AssertCheck(!ret || SDL_HasAVX(), "SDL_HasAVX512F() implies SDL_HasAVX()");
+
+   ret = SDL_HasFMA();
+   SDLTest_AssertPass("SDL_HasFMA()");
+   SDLTest_AssertCheck(!ret || SDL_HasAVX(), "SDL_HasFMA() implies SDL_HasAVX()");
+
+   ret = SDL_HasF16C();
+   SDLTest_AssertPass("SDL_HasF16C()");
+
+   ret = SDL_HasBMI1();
+   SDLTest_AssertPass("SDL_HasBMI1()");
+
+   ret = SDL_HasBMI2();
+   SDLTest_AssertPass("SDL_HasBMI2()");
+
+   ret = SDL_HasNEON();
+   SDLTest_AssertPass("SDL_HasNEON()");
+
    return TEST_COMPLETED;
 }
 
@@ -531,6 +531,378 @@ rwops_testFileWriteReadEndian(void)
 }
 
 
+/**
+ * @brief Tests buffering memory, and compares random reads, writes and
+ * seeks through the buffer with the same operations done directly.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWFromBufferedRW
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWClose
+ */
+int
+rwops_testBufferedRW(void)
+{
+   char mem[sizeof(RWopsHelloWorldTestString)];
+   Uint8 buffered[256], direct[256];
+   Uint8 readBuffered[32], readDirect[32];
+   SDL_RWops *rw, *rwDirect;
+   Sint64 posBuffered, posDirect;
+   size_t resultBuffered, resultDirect, n;
+   int i, offset, operation, mismatches = 0;
+
+   /* Open */
+   SDL_zero(mem);
+   rw = SDL_RWFromBufferedRW(SDL_RWFromMem(mem, sizeof(RWopsHelloWorldTestString)-1), 4, SDL_TRUE);
+   SDLTest_AssertPass("Call to SDL_RWFromBufferedRW() succeeded");
+   SDLTest_AssertCheck(rw != NULL, "Verify buffering memory with SDL_RWFromBufferedRW does not return NULL");
+   if (rw == NULL) return TEST_ABORTED;
+
+   /* Run generic tests */
+   _testGenericRWopsValidations(rw, 1);
+   SDL_RWclose(rw);
+   SDLTest_AssertPass("Call to SDL_RWclose() succeeded");
+
+   rw = SDL_RWFromBufferedRW(NULL, 0, SDL_FALSE);
+   SDLTest_AssertCheck(rw == NULL, "Verify SDL_RWFromBufferedRW(NULL, ...) returns NULL");
+
+   /* Random operations, through a buffer smaller than many of the reads */
+   for (i = 0; i < sizeof(buffered); ++i) {
+      buffered[i] = direct[i] = (Uint8) i;
+   }
+   rw = SDL_RWFromBufferedRW(SDL_RWFromMem(buffered, sizeof(buffered)), 16, SDL_TRUE);
+   rwDirect = SDL_RWFromMem(direct, sizeof(direct));
+   if (rw == NULL || rwDirect == NULL) return TEST_ABORTED;
+
+   for (i = 0; i < 2000; ++i) {
+      operation = SDLTest_RandomIntegerInRange(0, 3);
+      posDirect = SDL_RWtell(rwDirect);
+      switch (operation) {
+      case 0:
+         n = SDLTest_RandomIntegerInRange(1, sizeof(readDirect));
+         resultBuffered = SDL_RWread(rw, readBuffered, 1, n);
+         resultDirect = SDL_RWread(rwDirect, readDirect, 1, n);
+         if (resultBuffered != resultDirect ||
+             SDL_memcmp(readBuffered, readDirect, resultDirect) != 0) {
+            ++mismatches;
+         }
+         break;
+      case 1:
+         /* Stay inside the memory, where writes always complete */
+         n = SDLTest_RandomIntegerInRange(1, sizeof(readDirect));
+         n = SDL_min(n, sizeof(direct) - (size_t) posDirect);
+         if (n == 0) {
+            break;
+         }
+         SDL_memset(readDirect, i, n);
+         resultBuffered = SDL_RWwrite(rw, readDirect, 1, n);
+         resultDirect = SDL_RWwrite(rwDirect, readDirect, 1, n);
+         if (resultBuffered != resultDirect) {
+            ++mismatches;
+         }
+         break;
+      case 2:
+         offset = SDLTest_RandomIntegerInRange(-40, 40);
+         if (SDL_RWseek(rw, offset, RW_SEEK_CUR) != SDL_RWseek(rwDirect, offset, RW_SEEK_CUR)) {
+            ++mismatches;
+         }
+         break;
+      default:
+         offset = SDLTest_RandomIntegerInRange(0, sizeof(direct));
+         if (SDL_RWseek(rw, offset, RW_SEEK_SET) != SDL_RWseek(rwDirect, offset, RW_SEEK_SET)) {
+            ++mismatches;
+         }
+         break;
+      }
+      posBuffered = SDL_RWtell(rw);
+      posDirect = SDL_RWtell(rwDirect);
+      if (posBuffered != posDirect) {
+         ++mismatches;
+      }
+   }
+   SDLTest_AssertCheck(mismatches == 0, "Verify buffered and direct operations match, expected 0 mismatches, got %i", mismatches);
+   SDLTest_AssertCheck(SDL_RWsize(rw) == sizeof(buffered), "Verify size through the buffer");
+
+   SDL_RWclose(rw);
+   SDL_RWclose(rwDirect);
+   SDLTest_AssertCheck(SDL_memcmp(buffered, direct, sizeof(direct)) == 0, "Verify buffered writes reached memory after SDL_RWclose");
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests reading arrays with the endian aware functions.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_ReadLE16Array
+ * http://wiki.libsdl.org/moin.cgi/SDL_ReadBE64Array
+ */
+int
+rwops_testReadEndianArrays(void)
+{
+   Uint8 data[8 * 19];
+   Uint16 values16[8 * 19 / 2];
+   Uint32 values32[8 * 19 / 4];
+   Uint64 values64[19 + 1];
+   SDL_RWops *rw, *rwSingle;
+   size_t count;
+   int i, mismatches;
+
+   for (i = 0; i < sizeof(data); ++i) {
+      data[i] = (Uint8) SDLTest_RandomUint8();
+   }
+   rw = SDL_RWFromConstMem(data, sizeof(data));
+   rwSingle = SDL_RWFromConstMem(data, sizeof(data));
+   if (rw == NULL || rwSingle == NULL) return TEST_ABORTED;
+
+#define CHECK_ARRAY_READ(function, single, values) \
+   SDL_RWseek(rw, 0, RW_SEEK_SET); \
+   SDL_RWseek(rwSingle, 0, RW_SEEK_SET); \
+   count = function(rw, values, sizeof(data) / sizeof(values[0])); \
+   SDLTest_AssertPass("Call to " #function "()"); \
+   SDLTest_AssertCheck(count == sizeof(data) / sizeof(values[0]), "Verify number of values read, expected %i, got %i", (int) (sizeof(data) / sizeof(values[0])), (int) count); \
+   mismatches = 0; \
+   for (i = 0; i < (int) count; ++i) { \
+      if (values[i] != single(rwSingle)) { \
+         ++mismatches; \
+      } \
+   } \
+   SDLTest_AssertCheck(mismatches == 0, "Verify " #function "() matches " #single "(), expected 0 mismatches, got %i", mismatches);
+
+   CHECK_ARRAY_READ(SDL_ReadLE16Array, SDL_ReadLE16, values16);
+   CHECK_ARRAY_READ(SDL_ReadBE16Array, SDL_ReadBE16, values16);
+   CHECK_ARRAY_READ(SDL_ReadLE32Array, SDL_ReadLE32, values32);
+   CHECK_ARRAY_READ(SDL_ReadBE32Array, SDL_ReadBE32, values32);
+   CHECK_ARRAY_READ(SDL_ReadLE64Array, SDL_ReadLE64, values64);
+   CHECK_ARRAY_READ(SDL_ReadBE64Array, SDL_ReadBE64, values64);
+#undef CHECK_ARRAY_READ
+
+   /* Asking for more than there is reads what there is */
+   SDL_RWseek(rw, 4, RW_SEEK_SET);
+   count = SDL_ReadBE64Array(rw, values64, SDL_arraysize(values64));
+   SDLTest_AssertCheck(count == 18, "Verify short read of SDL_ReadBE64Array, expected 18, got %i", (int) count);
+
+   SDL_RWclose(rw);
+   SDL_RWclose(rwSingle);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests accessing memory and memory mapped files in place.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWGetPointer
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWFromFile
+ */
+int
+rwops_testMappedFile(void)
+{
+   SDL_RWops *rw;
+   const char *ptr;
+   int i;
+
+   /* Memory streams can always be accessed in place */
+   rw = SDL_RWFromConstMem(RWopsHelloWorldCompString, sizeof(RWopsHelloWorldCompString)-1);
+   SDLTest_AssertPass("Call to SDL_RWFromConstMem() succeeded");
+   if (rw == NULL) return TEST_ABORTED;
+   SDLTest_AssertCheck(rw->type == SDL_RWOPS_MEMORY_RO, "Verify RWops type is SDL_RWOPS_MEMORY_RO, got %u", rw->type);
+   ptr = (const char *) SDL_RWGetPointer(rw, 6, 6);
+   SDLTest_AssertPass("Call to SDL_RWGetPointer() succeeded");
+   SDLTest_AssertCheck(ptr == &RWopsHelloWorldCompString[6], "Verify pointer into const memory");
+   ptr = (const char *) SDL_RWGetPointer(rw, 10, 3);
+   SDLTest_AssertCheck(ptr == NULL, "Verify pointer past the end of the stream is NULL");
+   ptr = (const char *) SDL_RWGetPointer(rw, -1, 1);
+   SDLTest_AssertCheck(ptr == NULL, "Verify pointer before the start of the stream is NULL");
+   SDL_RWclose(rw);
+   ptr = (const char *) SDL_RWGetPointer(NULL, 0, 0);
+   SDLTest_AssertCheck(ptr == NULL, "Verify pointer into NULL context is NULL");
+
+   /* Files are mapped on platforms that support it, only when asked to */
+   for (i = 0; i < 2; ++i) {
+      if (i == 0) {
+         SDL_SetHint(SDL_HINT_FILE_MMAP, "1");
+         SDLTest_AssertPass("Call to SDL_SetHint(SDL_HINT_FILE_MMAP, \"1\") succeeded");
+      } else {
+         SDL_SetHint(SDL_HINT_FILE_MMAP, "0");
+         SDLTest_AssertPass("Call to SDL_SetHint(SDL_HINT_FILE_MMAP, \"0\") succeeded");
+      }
+      rw = SDL_RWFromFile(RWopsReadTestFilename, "rb");
+      SDLTest_AssertPass("Call to SDL_RWFromFile(..,\"rb\") succeeded");
+      SDLTest_AssertCheck(rw != NULL, "Verify opening file with SDL_RWFromFile in read mode does not return NULL");
+      if (rw == NULL) break;
+
+      ptr = (const char *) SDL_RWGetPointer(rw, 6, 6);
+      SDLTest_AssertPass("Call to SDL_RWGetPointer() succeeded");
+      if (rw->type == SDL_RWOPS_MAPPED) {
+         SDLTest_AssertCheck(i == 0, "Verify file isn't mapped when SDL_HINT_FILE_MMAP is \"0\"");
+         SDLTest_AssertCheck(ptr != NULL && SDL_memcmp(ptr, "World!", 6) == 0, "Verify pointer into mapped file");
+         ptr = (const char *) SDL_RWGetPointer(rw, 0, sizeof(RWopsHelloWorldTestString));
+         SDLTest_AssertCheck(ptr == NULL, "Verify pointer past the end of the mapped file is NULL");
+      } else {
+         SDLTest_AssertCheck(ptr == NULL, "Verify pointer into unmapped file is NULL");
+      }
+
+      _testGenericRWopsValidations( rw, 0 );
+
+      SDL_RWclose(rw);
+      SDLTest_AssertPass("Call to SDL_RWclose() succeeded");
+   }
+
+   return TEST_COMPLETED;
+}
+
+/* Callback for rwops_testAsyncRW(), counts the bytes read */
+static void SDLCALL
+_asyncReadCallback(void *userdata, void *ptr, size_t size)
+{
+   *(size_t *) userdata += size;
+}
+
+/**
+ * @brief Tests asynchronous reads and reading ahead of a stream.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWFromAsyncRW
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWreadAsync
+ * http://wiki.libsdl.org/moin.cgi/SDL_WaitAsyncRead
+ */
+int
+rwops_testAsyncRW(void)
+{
+   char mem[sizeof(RWopsHelloWorldTestString)];
+   char buf[sizeof(RWopsHelloWorldTestString)];
+   Uint8 async[4096], direct[4096];
+   Uint8 readAsync[600], readDirect[600];
+   SDL_RWops *rw, *rwDirect;
+   SDL_AsyncRead *request;
+   Sint64 posAsync, posDirect;
+   size_t resultAsync, resultDirect, n, callbackBytes;
+   int i, offset, operation, mismatches = 0;
+
+   /* Explicit reads */
+   rw = SDL_RWFromConstMem(RWopsHelloWorldCompString, sizeof(RWopsHelloWorldCompString)-1);
+   if (rw == NULL) return TEST_ABORTED;
+   SDL_zero(buf);
+   callbackBytes = 0;
+   request = SDL_RWreadAsync(rw, buf, 6, 6, _asyncReadCallback, &callbackBytes);
+   SDLTest_AssertPass("Call to SDL_RWreadAsync() succeeded");
+   SDLTest_AssertCheck(request != NULL, "Verify SDL_RWreadAsync() does not return NULL");
+   for (i = 0; i < 1000 && !SDL_PollAsyncRead(request); ++i) {
+      SDL_Delay(1);
+   }
+   SDLTest_AssertCheck(SDL_PollAsyncRead(request), "Verify SDL_PollAsyncRead() reports the read done");
+   SDLTest_AssertCheck(callbackBytes == 6, "Verify callback was called before the read was done, expected 6 bytes, got %i", (int) callbackBytes);
+   n = SDL_WaitAsyncRead(request);
+   SDLTest_AssertCheck(n == 6, "Verify bytes read, expected 6, got %i", (int) n);
+   SDLTest_AssertCheck(SDL_memcmp(buf, "World!", 6) == 0, "Verify read bytes match expected string, expected 'World!', got '%s'", buf);
+
+   request = SDL_RWreadAsync(rw, buf, 10, 10, NULL, NULL);
+   n = SDL_WaitAsyncRead(request);
+   SDLTest_AssertCheck(n == 2, "Verify read past the end is short, expected 2, got %i", (int) n);
+   request = SDL_RWreadAsync(rw, buf, -1, 1, NULL, NULL);
+   SDLTest_AssertCheck(request == NULL, "Verify SDL_RWreadAsync() at a negative offset returns NULL");
+   request = SDL_RWreadAsync(NULL, buf, 0, 1, NULL, NULL);
+   SDLTest_AssertCheck(request == NULL, "Verify SDL_RWreadAsync(NULL, ...) returns NULL");
+   SDL_RWclose(rw);
+
+   /* Open */
+   SDL_zero(mem);
+   rw = SDL_RWFromAsyncRW(SDL_RWFromMem(mem, sizeof(RWopsHelloWorldTestString)-1), 4, SDL_TRUE);
+   SDLTest_AssertPass("Call to SDL_RWFromAsyncRW() succeeded");
+   SDLTest_AssertCheck(rw != NULL, "Verify reading ahead of memory with SDL_RWFromAsyncRW does not return NULL");
+   if (rw == NULL) return TEST_ABORTED;
+   SDLTest_AssertCheck(rw->type == SDL_RWOPS_ASYNC, "Verify RWops type is SDL_RWOPS_ASYNC, got %u", rw->type);
+
+   /* Run generic tests */
+   _testGenericRWopsValidations(rw, 1);
+   SDL_RWclose(rw);
+   SDLTest_AssertPass("Call to SDL_RWclose() succeeded");
+
+   rw = SDL_RWFromAsyncRW(NULL, 0, SDL_FALSE);
+   SDLTest_AssertCheck(rw == NULL, "Verify SDL_RWFromAsyncRW(NULL, ...) returns NULL");
+
+   /* Random operations, with a window smaller than many of the reads */
+   for (i = 0; i < sizeof(async); ++i) {
+      async[i] = direct[i] = (Uint8) (i * 7);
+   }
+   rw = SDL_RWFromAsyncRW(SDL_RWFromMem(async, sizeof(async)), 256, SDL_TRUE);
+   rwDirect = SDL_RWFromMem(direct, sizeof(direct));
+   if (rw == NULL || rwDirect == NULL) return TEST_ABORTED;
+
+   for (i = 0; i < 2000; ++i) {
+      operation = SDLTest_RandomIntegerInRange(0, 4);
+      posDirect = SDL_RWtell(rwDirect);
+      switch (operation) {
+      case 0:
+      case 1:
+         n = SDLTest_RandomIntegerInRange(1, sizeof(readDirect));
+         resultAsync = SDL_RWread(rw, readAsync, 1, n);
+         resultDirect = SDL_RWread(rwDirect, readDirect, 1, n);
+         if (resultAsync != resultDirect ||
+             SDL_memcmp(readAsync, readDirect, resultDirect) != 0) {
+            ++mismatches;
+         }
+         break;
+      case 2:
+         /* Stay inside the memory, where writes always complete */
+         n = SDLTest_RandomIntegerInRange(1, 32);
+         n = SDL_min(n, sizeof(direct) - (size_t) posDirect);
+         if (n == 0) {
+            break;
+         }
+         SDL_memset(readDirect, i, n);
+         resultAsync = SDL_RWwrite(rw, readDirect, 1, n);
+         resultDirect = SDL_RWwrite(rwDirect, readDirect, 1, n);
+         if (resultAsync != resultDirect) {
+            ++mismatches;
+         }
+         break;
+      case 3:
+         offset = SDLTest_RandomIntegerInRange(-300, 300);
+         if (SDL_RWseek(rw, offset, RW_SEEK_CUR) != SDL_RWseek(rwDirect, offset, RW_SEEK_CUR)) {
+            ++mismatches;
+         }
+         break;
+      default:
+         offset = SDLTest_RandomIntegerInRange(0, sizeof(direct));
+         if (SDL_RWseek(rw, offset, RW_SEEK_SET) != SDL_RWseek(rwDirect, offset, RW_SEEK_SET)) {
+            ++mismatches;
+         }
+         break;
+      }
+      posAsync = SDL_RWtell(rw);
+      posDirect = SDL_RWtell(rwDirect);
+      if (posAsync != posDirect) {
+         ++mismatches;
+      }
+   }
+   SDLTest_AssertCheck(mismatches == 0, "Verify asynchronous and direct operations match, expected 0 mismatches, got %i", mismatches);
+   SDLTest_AssertCheck(SDL_RWsize(rw) == sizeof(async), "Verify size through the read-ahead");
+
+   /* Explicit reads through the read-ahead don't move it */
+   posAsync = SDL_RWtell(rw);
+   request = SDL_RWreadAsync(rw, readAsync, 100, 200, NULL, NULL);
+   n = SDL_WaitAsyncRead(request);
+   SDLTest_AssertCheck(n == 200 && SDL_memcmp(readAsync, &direct[100], 200) == 0, "Verify explicit read through the read-ahead");
+   SDLTest_AssertCheck(SDL_RWtell(rw) == posAsync, "Verify explicit read leaves the position alone");
+
+   /* Writes wait for explicit reads of the same data */
+   request = SDL_RWreadAsync(rw, readAsync, 0, 200, NULL, NULL);
+   SDL_memset(readDirect, 0xAA, 200);
+   SDL_RWseek(rw, 0, RW_SEEK_SET);
+   SDL_RWwrite(rw, readDirect, 1, 200);
+   n = SDL_WaitAsyncRead(request);
+   SDLTest_AssertCheck(n == 200 && SDL_memcmp(readAsync, direct, 200) == 0, "Verify explicit read finished before the write");
+   SDL_RWseek(rwDirect, 0, RW_SEEK_SET);
+   SDL_RWwrite(rwDirect, readDirect, 1, 200);
+
+   SDL_RWclose(rw);
+   SDL_RWclose(rwDirect);
+   SDLTest_AssertCheck(SDL_memcmp(async, direct, sizeof(direct)) == 0, "Verify writes reached memory");
+
+   return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* RWops test cases */
@@ -561,10 +933,22 @@ static const SDLTest_TestCaseReference rwopsTest8 =
 static const SDLTest_TestCaseReference rwopsTest9 =
 		{ (SDLTest_TestCaseFp)rwops_testFileWriteReadEndian, "rwops_testFileWriteReadEndian", "Test writing and reading via the Endian aware functions", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference rwopsTest10 =
+		{ (SDLTest_TestCaseFp)rwops_testBufferedRW, "rwops_testBufferedRW", "Test buffered reads, writes and seeks", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference rwopsTest11 =
+		{ (SDLTest_TestCaseFp)rwops_testReadEndianArrays, "rwops_testReadEndianArrays", "Test reading arrays via the Endian aware functions", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference rwopsTest12 =
+		{ (SDLTest_TestCaseFp)rwops_testMappedFile, "rwops_testMappedFile", "Test accessing memory and mapped files in place", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference rwopsTest13 =
+		{ (SDLTest_TestCaseFp)rwops_testAsyncRW, "rwops_testAsyncRW", "Test asynchronous reads and reading ahead", TEST_ENABLED };
+
 /* Sequence of RWops test cases */
 static const SDLTest_TestCaseReference *rwopsTests[] =  {
 	&rwopsTest1, &rwopsTest2, &rwopsTest3, &rwopsTest4, &rwopsTest5, &rwopsTest6, 
-	&rwopsTest7, &rwopsTest8, &rwopsTest9, NULL
+	&rwopsTest7, &rwopsTest8, &rwopsTest9, &rwopsTest10, &rwopsTest11, &rwopsTest12, &rwopsTest13, NULL
 };
 
 /* RWops test suite (global) */
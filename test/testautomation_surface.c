@@ -521,6 +521,701 @@ surface_testBlitBlendLoop(void *arg) {
 
 }
 
+/**
+ * @brief Tests that surface pixels are counted by SDL_GetMemoryStats()
+ */
+int
+surface_testMemoryStats(void *arg)
+{
+   SDL_MemoryStats before, during, after;
+   SDL_Surface *surface;
+   int ret;
+
+   ret = SDL_GetMemoryStats(SDL_MEMORY_SURFACE, &before);
+   SDLTest_AssertPass("Call to SDL_GetMemoryStats(SDL_MEMORY_SURFACE)");
+   SDLTest_AssertCheck(ret == 0, "Validate return value, expected: 0, got: %i", ret);
+
+   surface = SDL_CreateRGBSurface(0, 64, 32, 32, 0, 0, 0, 0);
+   SDLTest_AssertCheck(surface != NULL, "Verify 64x32 surface is not NULL");
+   if (surface == NULL) {
+      return TEST_ABORTED;
+   }
+
+   SDL_GetMemoryStats(SDL_MEMORY_SURFACE, &during);
+   SDLTest_AssertCheck(during.allocations == before.allocations + 1,
+      "Validate allocations, expected: %llu, got: %llu",
+      (unsigned long long)(before.allocations + 1), (unsigned long long)during.allocations);
+   SDLTest_AssertCheck(during.current_bytes >= before.current_bytes + surface->h * surface->pitch,
+      "Validate current_bytes grew by at least %i", surface->h * surface->pitch);
+   SDLTest_AssertCheck(during.peak_bytes >= during.current_bytes, "Validate peak_bytes >= current_bytes");
+
+   SDL_FreeSurface(surface);
+   SDLTest_AssertPass("Call to SDL_FreeSurface()");
+
+   SDL_GetMemoryStats(SDL_MEMORY_SURFACE, &after);
+   SDLTest_AssertCheck(after.frees == before.frees + 1,
+      "Validate frees, expected: %llu, got: %llu",
+      (unsigned long long)(before.frees + 1), (unsigned long long)after.frees);
+   SDLTest_AssertCheck(after.current_bytes == before.current_bytes,
+      "Validate current_bytes, expected: %llu, got: %llu",
+      (unsigned long long)before.current_bytes, (unsigned long long)after.current_bytes);
+
+   /* Invalid parameters */
+   ret = SDL_GetMemoryStats(SDL_NUM_MEMORY_SUBSYSTEMS, &after);
+   SDLTest_AssertCheck(ret == -1, "Validate return value for invalid subsystem, expected: -1, got: %i", ret);
+   ret = SDL_GetMemoryStats(SDL_MEMORY_SURFACE, NULL);
+   SDLTest_AssertCheck(ret == -1, "Validate return value for NULL stats, expected: -1, got: %i", ret);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests acquiring and releasing surfaces from the surface pool
+ */
+int
+surface_testSurfacePool(void *arg)
+{
+   SDL_Surface *surface, *other;
+   void *pixels;
+   Uint32 key;
+   int ret;
+
+   SDL_ClearSurfacePool();
+   SDLTest_AssertPass("Call to SDL_ClearSurfacePool()");
+
+   surface = SDL_AcquirePooledSurface(33, 17, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertPass("Call to SDL_AcquirePooledSurface(33, 17, SDL_PIXELFORMAT_ARGB8888)");
+   SDLTest_AssertCheck(surface != NULL, "Verify surface is not NULL");
+   if (surface == NULL) {
+      return TEST_ABORTED;
+   }
+   SDLTest_AssertCheck(surface->w == 33 && surface->h == 17, "Validate size, expected: 33x17, got: %ix%i", surface->w, surface->h);
+   SDLTest_AssertCheck(surface->format->format == SDL_PIXELFORMAT_ARGB8888, "Validate format, expected: %u, got: %u", SDL_PIXELFORMAT_ARGB8888, surface->format->format);
+   SDLTest_AssertCheck((surface->flags & SDL_POOLED) != 0, "Validate SDL_POOLED flag is set");
+   SDLTest_AssertCheck(((size_t)surface->pixels & 63) == 0, "Validate pixels are 64-byte aligned");
+
+   /* Change some state, which should be reset when it goes back to the pool */
+   pixels = surface->pixels;
+   SDL_SetColorKey(surface, SDL_TRUE, 0);
+   SDL_SetSurfaceAlphaMod(surface, 128);
+   SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_ADD);
+   SDL_ReleasePooledSurface(surface);
+   SDLTest_AssertPass("Call to SDL_ReleasePooledSurface()");
+
+   surface = SDL_AcquirePooledSurface(33, 17, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertCheck(surface != NULL && surface->pixels == pixels, "Validate the released surface was reused");
+   if (surface == NULL) {
+      return TEST_ABORTED;
+   }
+   ret = SDL_GetColorKey(surface, &key);
+   SDLTest_AssertCheck(ret == -1, "Validate colorkey was reset, expected: -1, got: %i", ret);
+   SDLTest_AssertCheck(surface->clip_rect.w == 33 && surface->clip_rect.h == 17, "Validate clip rect covers the surface");
+
+   /* A different size gets a different surface */
+   other = SDL_AcquirePooledSurface(17, 33, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertCheck(other != NULL && other != surface, "Validate a surface of another size is a different surface");
+
+   /* SDL_FreeSurface() also returns surfaces to the pool */
+   SDL_FreeSurface(other);
+   SDL_FreeSurface(surface);
+   SDLTest_AssertPass("Call to SDL_FreeSurface() on pooled surfaces");
+   surface = SDL_AcquirePooledSurface(33, 17, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertCheck(surface != NULL && surface->pixels == pixels, "Validate the freed surface was reused");
+   SDL_ReleasePooledSurface(surface);
+
+   /* Invalid parameters */
+   surface = SDL_AcquirePooledSurface(0, 17, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertCheck(surface == NULL, "Validate zero width fails");
+   surface = SDL_AcquirePooledSurface(33, 17, SDL_PIXELFORMAT_YV12);
+   SDLTest_AssertCheck(surface == NULL, "Validate YUV format fails");
+
+   SDL_ClearSurfacePool();
+   SDLTest_AssertPass("Call to SDL_ClearSurfacePool()");
+
+   return TEST_COMPLETED;
+}
+
+/* Nearest palette color by searching the whole palette */
+static Uint8
+_findNearestColor(const SDL_Palette *palette, Uint8 r, Uint8 g, Uint8 b)
+{
+   int i, dr, dg, db;
+   Uint32 distance, smallest = 0xFFFFFFFF;
+   Uint8 pixel = 0;
+
+   for (i = 0; i < palette->ncolors; i++) {
+      dr = palette->colors[i].r - r;
+      dg = palette->colors[i].g - g;
+      db = palette->colors[i].b - b;
+      distance = dr * dr + dg * dg + db * db;
+      if (distance < smallest) {
+         smallest = distance;
+         pixel = (Uint8)i;
+      }
+   }
+   return pixel;
+}
+
+/* Sum of the differences between the average brightness of 8x8 blocks */
+static int
+_blockError(SDL_Surface *indexed, SDL_Surface *source)
+{
+   int x, y, bx, by, error = 0;
+
+   for (by = 0; by < source->h; by += 8) {
+      for (bx = 0; bx < source->w; bx += 8) {
+         int expected = 0, actual = 0;
+         for (y = by; y < by + 8; y++) {
+            for (x = bx; x < bx + 8; x++) {
+               Uint32 pixel = ((Uint32 *)((Uint8 *)source->pixels + y * source->pitch))[x];
+               Uint8 index = ((Uint8 *)indexed->pixels)[y * indexed->pitch + x];
+               expected += pixel & 0xFF;
+               actual += indexed->format->palette->colors[index].b;
+            }
+         }
+         error += SDL_abs(expected - actual) / 64;
+      }
+   }
+   return error;
+}
+
+/**
+ * @brief Tests mapping colors to palettes, and dithering blits to paletted surfaces
+ */
+int
+surface_testPaletteMapping(void *arg)
+{
+   SDL_PixelFormat *format;
+   SDL_Palette *palette;
+   SDL_Color colors[256];
+   SDL_Surface *gradient, *indexed;
+   int i, pass, mismatches, error[3];
+   Uint8 r, g, b;
+   Uint32 pixel;
+   const char *dither[3] = { "0", "1", "2" };
+
+   format = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8);
+   palette = SDL_AllocPalette(256);
+   SDLTest_AssertCheck(format != NULL && palette != NULL, "Verify format and palette are not NULL");
+   if (format == NULL || palette == NULL) {
+      return TEST_ABORTED;
+   }
+   SDL_SetPixelFormatPalette(format, palette);
+
+   /* Random palettes, changed between passes, match the full search */
+   for (pass = 0; pass < 3; pass++) {
+      for (i = 0; i < 256; i++) {
+         colors[i].r = SDLTest_RandomUint8();
+         colors[i].g = SDLTest_RandomUint8();
+         colors[i].b = SDLTest_RandomUint8();
+         colors[i].unused = SDL_ALPHA_OPAQUE;
+      }
+      if (pass == 2) {
+         /* Duplicates must resolve to the first of them */
+         colors[200] = colors[100];
+      }
+      SDL_SetPaletteColors(palette, colors, 0, 256);
+      mismatches = 0;
+      for (i = 0; i < 5000; i++) {
+         if (pass == 2 && i == 0) {
+            r = colors[100].r;
+            g = colors[100].g;
+            b = colors[100].b;
+         } else {
+            r = SDLTest_RandomUint8();
+            g = SDLTest_RandomUint8();
+            b = SDLTest_RandomUint8();
+         }
+         pixel = SDL_MapRGB(format, r, g, b);
+         if (pixel != _findNearestColor(palette, r, g, b)) {
+            mismatches++;
+         }
+      }
+      SDLTest_AssertCheck(mismatches == 0, "Validate SDL_MapRGB() finds the nearest palette color, expected: 0 mismatches, got: %i", mismatches);
+   }
+
+   /* A gray ramp converted to a palette of a few grays */
+   for (i = 0; i < 256; i++) {
+      Uint8 level = (Uint8)(((i % 8) * 255) / 7);
+      colors[i].r = colors[i].g = colors[i].b = level;
+      colors[i].unused = SDL_ALPHA_OPAQUE;
+   }
+   SDL_SetPaletteColors(palette, colors, 0, 256);
+   gradient = SDL_CreateRGBSurface(0, 256, 64, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+   SDLTest_AssertCheck(gradient != NULL, "Verify gradient surface is not NULL");
+   if (gradient == NULL) {
+      SDL_FreeFormat(format);
+      SDL_FreePalette(palette);
+      return TEST_ABORTED;
+   }
+   for (i = 0; i < gradient->h; i++) {
+      int x;
+      for (x = 0; x < gradient->w; x++) {
+         ((Uint32 *)((Uint8 *)gradient->pixels + i * gradient->pitch))[x] = x * 0x010101;
+      }
+   }
+   for (i = 0; i < 3; i++) {
+      SDL_SetHint(SDL_HINT_SURFACE_DITHER, dither[i]);
+      indexed = SDL_ConvertSurface(gradient, format, 0);
+      SDLTest_AssertPass("Call to SDL_ConvertSurface() with SDL_SURFACE_DITHER=%s", dither[i]);
+      SDLTest_AssertCheck(indexed != NULL, "Verify converted surface is not NULL");
+      if (indexed == NULL) {
+         error[i] = 0;
+         continue;
+      }
+      error[i] = _blockError(indexed, gradient);
+      SDL_FreeSurface(indexed);
+   }
+   SDL_SetHint(SDL_HINT_SURFACE_DITHER, NULL);
+   SDLTest_AssertCheck(error[1] < error[0], "Validate ordered dithering keeps the average brightness closer, expected: < %i, got: %i", error[0], error[1]);
+   SDLTest_AssertCheck(error[2] < error[0], "Validate error diffusion keeps the average brightness closer, expected: < %i, got: %i", error[0], error[2]);
+   SDL_FreeSurface(gradient);
+
+   /* Large dithered blits match blits of a few rows at a time, even with job workers running */
+   SDL_GetJobWorkerCount();
+   gradient = SDL_CreateRGBSurface(0, 600, 600, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+   SDLTest_AssertCheck(gradient != NULL, "Verify large gradient surface is not NULL");
+   if (gradient != NULL) {
+      for (i = 0; i < gradient->h; i++) {
+         int x;
+         for (x = 0; x < gradient->w; x++) {
+            ((Uint32 *)((Uint8 *)gradient->pixels + i * gradient->pitch))[x] = ((x + i) % 256) * 0x010101;
+         }
+      }
+      for (pass = 1; pass < 3; pass++) {
+         SDL_Surface *whole, *bands;
+         SDL_Rect rect;
+         int y, firstRow = -1;
+
+         SDL_SetHint(SDL_HINT_SURFACE_DITHER, dither[pass]);
+         whole = SDL_CreateRGBSurface(0, gradient->w, gradient->h, 8, 0, 0, 0, 0);
+         bands = SDL_CreateRGBSurface(0, gradient->w, gradient->h, 8, 0, 0, 0, 0);
+         SDLTest_AssertCheck(whole != NULL && bands != NULL, "Verify indexed surfaces are not NULL");
+         if (whole == NULL || bands == NULL) {
+            SDL_FreeSurface(whole);
+            SDL_FreeSurface(bands);
+            continue;
+         }
+         SDL_SetPaletteColors(whole->format->palette, colors, 0, 256);
+         SDL_SetPaletteColors(bands->format->palette, colors, 0, 256);
+         SDL_BlitSurface(gradient, NULL, whole, NULL);
+         for (y = 0; y < gradient->h; y += 200) {
+            rect.x = 0;
+            rect.y = y;
+            rect.w = gradient->w;
+            rect.h = 200;
+            SDL_BlitSurface(gradient, &rect, bands, &rect);
+         }
+         /* Error diffusion restarts with each blit, so only the first band matches */
+         for (y = 0; y < (pass == 1 ? gradient->h : 200) && firstRow < 0; y++) {
+            if (SDL_memcmp((Uint8 *)whole->pixels + y * whole->pitch, (Uint8 *)bands->pixels + y * bands->pitch, gradient->w) != 0) {
+               firstRow = y;
+            }
+         }
+         SDLTest_AssertCheck(firstRow < 0, "Validate dithered blit with SDL_SURFACE_DITHER=%s matches blits of 200 rows, first different row: %i", dither[pass], firstRow);
+         SDL_FreeSurface(whole);
+         SDL_FreeSurface(bands);
+      }
+      SDL_SetHint(SDL_HINT_SURFACE_DITHER, NULL);
+      SDL_FreeSurface(gradient);
+   }
+
+   SDL_FreeFormat(format);
+   SDL_FreePalette(palette);
+
+   return TEST_COMPLETED;
+}
+
+/* Formats allocated concurrently by the format cache test threads */
+static const Uint32 _cachedFormats[] = {
+   SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_ARGB8888,
+   SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_RGBA4444, SDL_PIXELFORMAT_BGR24
+};
+#define NUM_CACHED_FORMATS (sizeof(_cachedFormats) / sizeof(_cachedFormats[0]))
+
+static int
+_formatCacheThread(void *data)
+{
+   SDL_PixelFormat *held[NUM_CACHED_FORMATS];
+   int *failures = (int *)data;
+   int i, j;
+
+   for (i = 0; i < 2000; i++) {
+      for (j = 0; j < (int)NUM_CACHED_FORMATS; j++) {
+         held[j] = SDL_AllocFormat(_cachedFormats[(i + j) % NUM_CACHED_FORMATS]);
+         if (held[j] == NULL || held[j]->format != _cachedFormats[(i + j) % NUM_CACHED_FORMATS]) {
+            ++*failures;
+         }
+      }
+      for (j = 0; j < (int)NUM_CACHED_FORMATS; j++) {
+         SDL_FreeFormat(held[j]);
+      }
+   }
+   return 0;
+}
+
+/**
+ * @brief Tests that pixel formats are shared and can be allocated from several threads
+ */
+int
+surface_testFormatCache(void *arg)
+{
+   SDL_PixelFormat *format, *other;
+   SDL_Thread *threads[4];
+   int failures[4];
+   int i;
+
+   format = SDL_AllocFormat(SDL_PIXELFORMAT_RGB565);
+   other = SDL_AllocFormat(SDL_PIXELFORMAT_RGB565);
+   SDLTest_AssertCheck(format != NULL && format == other, "Verify RGB formats are shared");
+   if (format == NULL) {
+      return TEST_ABORTED;
+   }
+   SDLTest_AssertCheck(format->Rshift == 11 && format->Gshift == 5 && format->Bshift == 0, "Verify shifts of RGB565");
+   SDLTest_AssertCheck(format->Rloss == 3 && format->Gloss == 2 && format->Bloss == 3 && format->Aloss == 8, "Verify losses of RGB565");
+   SDL_FreeFormat(other);
+
+   SDL_FreeFormat(format);
+
+   /* Released formats are set up again from scratch */
+   format = SDL_AllocFormat(SDL_PIXELFORMAT_ARGB4444);
+   SDLTest_AssertCheck(format != NULL && format->Ashift == 12 && format->Aloss == 4 && format->Rshift == 8, "Verify shifts and losses of ARGB4444");
+   SDL_FreeFormat(format);
+
+   format = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8);
+   other = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8);
+   SDLTest_AssertCheck(format != NULL && other != NULL && format != other, "Verify indexed formats are not shared");
+   SDL_FreeFormat(format);
+   SDL_FreeFormat(other);
+
+   for (i = 0; i < SDL_arraysize(threads); i++) {
+      failures[i] = 0;
+      threads[i] = SDL_CreateThread(_formatCacheThread, "FormatCache", &failures[i]);
+   }
+   for (i = 0; i < SDL_arraysize(threads); i++) {
+      SDL_WaitThread(threads[i], NULL);
+      SDLTest_AssertCheck(failures[i] == 0, "Verify thread %d allocated valid formats, failures: %d", i, failures[i]);
+   }
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests aligning surface rows with SDL_HINT_SURFACE_ALIGNMENT
+ */
+int
+surface_testSurfaceAlignment(void *arg)
+{
+   const int alignments[] = { 4, 16, 32, 64 };
+   const int widths[] = { 1, 3, 17, 100, 333 };
+   SDL_Surface *src, *dst;
+   SDL_Rect rect;
+   char value[8];
+   Uint32 *row;
+   int i, j, x, y, bad;
+
+   for (i = 0; i < SDL_arraysize(alignments); i++) {
+      SDL_snprintf(value, sizeof(value), "%d", alignments[i]);
+      SDL_SetHint(SDL_HINT_SURFACE_ALIGNMENT, value);
+
+      for (j = 0; j < SDL_arraysize(widths); j++) {
+         src = SDL_CreateRGBSurface(0, widths[j], 7, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+         dst = SDL_CreateRGBSurface(0, widths[j], 7, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+         SDLTest_AssertCheck(src != NULL && dst != NULL, "Verify surfaces of width %d are not NULL", widths[j]);
+         if (src == NULL || dst == NULL) {
+            SDL_FreeSurface(src);
+            SDL_FreeSurface(dst);
+            return TEST_ABORTED;
+         }
+         SDLTest_AssertCheck((src->pitch % alignments[i]) == 0 && ((uintptr_t)src->pixels % alignments[i]) == 0,
+            "Verify pitch %d and pixels are aligned to %d bytes", src->pitch, alignments[i]);
+         SDLTest_AssertCheck(((src->flags & SDL_SIMD_ALIGNED) != 0) == (alignments[i] > 4),
+            "Verify SDL_SIMD_ALIGNED is set only beyond 4 byte alignment");
+
+         /* Fill the whole surface, then a column inside it */
+         SDL_FillRect(src, NULL, 0x123456);
+         rect.x = widths[j] / 2;
+         rect.y = 1;
+         rect.w = 1;
+         rect.h = 5;
+         SDL_FillRect(src, &rect, 0xABCDEF);
+
+         SDL_BlitSurface(src, NULL, dst, NULL);
+         bad = 0;
+         for (y = 0; y < dst->h; y++) {
+            row = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+            for (x = 0; x < dst->w; x++) {
+               Uint32 expected = (x == rect.x && y >= 1 && y < 6) ? 0xABCDEF : 0x123456;
+               if (row[x] != expected) {
+                  bad++;
+               }
+            }
+         }
+         SDLTest_AssertCheck(bad == 0, "Verify filled and blitted pixels, wrong: %d", bad);
+
+         /* RLE encoding frees the pixels, decoding them keeps the alignment */
+         SDL_SetColorKey(src, SDL_TRUE, 0x123456);
+         SDL_SetSurfaceRLE(src, 1);
+         SDL_BlitSurface(src, NULL, dst, NULL);
+         SDL_LockSurface(src);
+         SDLTest_AssertCheck(src->pixels != NULL && ((uintptr_t)src->pixels % alignments[i]) == 0,
+            "Verify pixels are aligned to %d bytes after an RLE round trip", alignments[i]);
+         SDLTest_AssertCheck(((src->flags & SDL_SIMD_ALIGNED) != 0) == (alignments[i] > 4),
+            "Verify SDL_SIMD_ALIGNED is kept after an RLE round trip");
+         if (src->pixels != NULL) {
+            row = (Uint32 *)((Uint8 *)src->pixels + 2 * src->pitch);
+            SDLTest_AssertCheck((row[rect.x] & 0xFFFFFF) == 0xABCDEF,
+               "Verify decoded pixel, expected: 0xABCDEF, got: 0x%06X", row[rect.x] & 0xFFFFFF);
+         }
+         SDL_UnlockSurface(src);
+
+         SDL_FreeSurface(src);
+         SDL_FreeSurface(dst);
+      }
+   }
+   SDL_SetHint(SDL_HINT_SURFACE_ALIGNMENT, NULL);
+
+   return TEST_COMPLETED;
+}
+
+/* Build an in-memory BMP file with a BITMAPINFOHEADER and a gray palette */
+static int
+_buildBitmap(Uint8 *bmp, int w, int h, int bpp, int compression, int ncolors, const Uint8 *data, int size)
+{
+   const int offset = 14 + 40 + ncolors * 4;
+   const Uint32 values[] = { 40, w, h, 1 | (bpp << 16), compression, size, 0, 0, ncolors, 0 };
+   int i;
+
+   SDL_memset(bmp, 0, offset);
+   bmp[0] = 'B';
+   bmp[1] = 'M';
+   for (i = 0; i < 4; i++) {
+      bmp[2 + i] = (Uint8)((offset + size) >> (i * 8));
+      bmp[10 + i] = (Uint8)(offset >> (i * 8));
+   }
+   for (i = 0; i < 40; i++) {
+      bmp[14 + i] = (Uint8)(values[i / 4] >> ((i % 4) * 8));
+   }
+   for (i = 0; i < ncolors; i++) {
+      SDL_memset(&bmp[54 + i * 4], i * 16, 3);
+   }
+   SDL_memcpy(&bmp[offset], data, size);
+   return offset + size;
+}
+
+/* Check the pixels of an 8-bit surface loaded from a bitmap */
+static void
+_checkBitmapPixels(const char *name, SDL_Surface *surface, const Uint8 *expected, int w, int h)
+{
+   int x, y, bad = 0;
+
+   SDLTest_AssertCheck(surface != NULL, "Verify %s loaded, error: %s", name, surface ? "none" : SDL_GetError());
+   if (surface == NULL) {
+      return;
+   }
+   SDLTest_AssertCheck(surface->w == w && surface->h == h && surface->format->BitsPerPixel == 8,
+      "Verify %s is %dx%d with 8 bits per pixel, got: %dx%d %d", name, w, h, surface->w, surface->h, surface->format->BitsPerPixel);
+   if (surface->w == w && surface->h == h && surface->format->BitsPerPixel == 8) {
+      for (y = 0; y < h; y++) {
+         for (x = 0; x < w; x++) {
+            if (((Uint8 *)surface->pixels)[y * surface->pitch + x] != expected[y * w + x]) {
+               bad++;
+            }
+         }
+      }
+   }
+   SDLTest_AssertCheck(bad == 0, "Verify pixels of %s, wrong: %d", name, bad);
+   SDL_FreeSurface(surface);
+}
+
+/**
+ * @brief Tests loading run length encoded and low bit depth bitmaps
+ */
+int
+surface_testLoadBitmapFormats(void *arg)
+{
+   /* Bottom row: a run and a single pixel; top row: literals, then a delta off the edge */
+   const Uint8 rle8[] = { 3, 5, 1, 7, 0, 0, 0, 3, 1, 2, 3, 0, 0, 2, 1, 0, 0, 1 };
+   const Uint8 rle8Pixels[] = { 1, 2, 3, 0, 5, 5, 5, 7 };
+   /* Bottom row: five literal nibbles; top row: alternating run */
+   const Uint8 rle4[] = { 0, 5, 0x34, 0x56, 0x70, 0, 0, 0, 5, 0x12, 0, 1 };
+   const Uint8 rle4Pixels[] = { 1, 2, 1, 2, 1, 3, 4, 5, 6, 7 };
+   /* Rows are bottom-up and padded to 4 bytes */
+   const Uint8 mono[] = { 0xA5, 0x80, 0, 0, 0x0F, 0x00, 0, 0 };
+   const Uint8 monoPixels[] = {
+      0, 0, 0, 0, 1, 1, 1, 1, 0,
+      1, 0, 1, 0, 0, 1, 0, 1, 1
+   };
+   Uint8 bmp[14 + 40 + 16 * 4 + 32];
+   SDL_Surface *surface;
+   int size;
+
+   size = _buildBitmap(bmp, 4, 2, 8, 1, 8, rle8, sizeof(rle8));
+   surface = SDL_LoadBMP_RW(SDL_RWFromConstMem(bmp, size), 1);
+   _checkBitmapPixels("RLE8 bitmap", surface, rle8Pixels, 4, 2);
+
+   size = _buildBitmap(bmp, 5, 2, 4, 2, 16, rle4, sizeof(rle4));
+   surface = SDL_LoadBMP_RW(SDL_RWFromConstMem(bmp, size), 1);
+   _checkBitmapPixels("RLE4 bitmap", surface, rle4Pixels, 5, 2);
+
+   size = _buildBitmap(bmp, 9, 2, 1, 0, 2, mono, sizeof(mono));
+   surface = SDL_LoadBMP_RW(SDL_RWFromConstMem(bmp, size), 1);
+   _checkBitmapPixels("1-bit bitmap", surface, monoPixels, 9, 2);
+
+   /* Truncated pixel data fails to load */
+   size = _buildBitmap(bmp, 9, 2, 1, 0, 2, mono, sizeof(mono));
+   surface = SDL_LoadBMP_RW(SDL_RWFromConstMem(bmp, size - 1), 1);
+   SDLTest_AssertCheck(surface == NULL, "Verify truncated bitmap fails to load");
+   SDL_FreeSurface(surface);
+
+   /* An image without columns saves as just the headers */
+   surface = SDL_CreateRGBSurface(0, 0, 4, 24, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+   SDLTest_AssertCheck(surface != NULL, "Verify zero width surface is not NULL");
+   if (surface != NULL) {
+      SDL_RWops *rw = SDL_RWFromMem(bmp, sizeof(bmp));
+      int result = SDL_SaveBMP_RW(surface, rw, 0);
+      SDLTest_AssertCheck(result == 0, "Validate result from SDL_SaveBMP_RW with zero width, expected: 0, got: %i", result);
+      size = (int)SDL_RWtell(rw);
+      SDLTest_AssertCheck(size == 14 + 40, "Validate size of zero width bitmap, expected: %i, got: %i", 14 + 40, size);
+      SDL_RWclose(rw);
+      SDL_FreeSurface(surface);
+   }
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests mapping arrays of colors to pixels and back
+ */
+int
+surface_testPixelArrays(void *arg)
+{
+   const Uint32 formats[] = {
+      SDL_PIXELFORMAT_RGB332, SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_ARGB1555,
+      SDL_PIXELFORMAT_RGBA5551, SDL_PIXELFORMAT_ARGB4444, SDL_PIXELFORMAT_RGB24,
+      SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_RGB888
+   };
+   const int count = 65535;
+   Uint8 *colors, *result, *pixels;
+   float *values;
+   SDL_PixelFormat *format;
+   int f, i, mapFailures, getFailures, floatFailures;
+
+   colors = (Uint8 *)SDL_malloc(count * 4);
+   result = (Uint8 *)SDL_malloc(count * 4);
+   pixels = (Uint8 *)SDL_malloc(count * 4);
+   values = (float *)SDL_malloc(count * 4 * sizeof(float));
+   if (colors == NULL || result == NULL || pixels == NULL || values == NULL) {
+      SDLTest_AssertCheck(0, "Allocate test buffers");
+      SDL_free(colors);
+      SDL_free(result);
+      SDL_free(pixels);
+      SDL_free(values);
+      return TEST_ABORTED;
+   }
+   for (i = 0; i < count * 4; i++) {
+      colors[i] = (Uint8)SDLTest_RandomUint8();
+   }
+
+   for (f = 0; f < SDL_arraysize(formats); f++) {
+      const char *name = SDL_GetPixelFormatName(formats[f]);
+      int bpp;
+
+      format = SDL_AllocFormat(formats[f]);
+      SDLTest_AssertCheck(format != NULL, "Verify format %s was allocated", name);
+      if (format == NULL) {
+         continue;
+      }
+      bpp = format->BytesPerPixel;
+
+      /* An odd count leaves pixels for the per-pixel path too */
+      SDLTest_AssertCheck(SDL_MapRGBAArray(format, colors, pixels, count) == 0, "Call to SDL_MapRGBAArray(%s)", name);
+      mapFailures = 0;
+      for (i = 0; i < count; i++) {
+         const Uint8 *c = &colors[i * 4];
+         Uint32 expected = SDL_MapRGBA(format, c[0], c[1], c[2], c[3]);
+         Uint32 actual = 0;
+         SDL_memcpy(&actual, &pixels[i * bpp], bpp);
+         if (bpp < 4) {
+            expected &= (1u << (bpp * 8)) - 1;
+         }
+         if (expected != actual) {
+            mapFailures++;
+         }
+      }
+      SDLTest_AssertCheck(mapFailures == 0, "Verify mapped %s pixels match SDL_MapRGBA, failures: %d", name, mapFailures);
+
+      /* Every pixel value of the 16 bit formats, random ones of the others */
+      for (i = 0; i < count; i++) {
+         Uint32 pixel = (bpp == 2) ? (Uint32)i : SDLTest_RandomUint32();
+         SDL_memcpy(&pixels[i * bpp], &pixel, bpp);
+      }
+      SDLTest_AssertCheck(SDL_GetRGBAArray(format, pixels, result, count) == 0, "Call to SDL_GetRGBAArray(%s)", name);
+      SDLTest_AssertCheck(SDL_GetRGBAFloatArray(format, pixels, values, count) == 0, "Call to SDL_GetRGBAFloatArray(%s)", name);
+      getFailures = 0;
+      floatFailures = 0;
+      for (i = 0; i < count; i++) {
+         Uint32 pixel = 0;
+         Uint8 c[4];
+         int j;
+         SDL_memcpy(&pixel, &pixels[i * bpp], bpp);
+         SDL_GetRGBA(pixel, format, &c[0], &c[1], &c[2], &c[3]);
+         for (j = 0; j < 4; j++) {
+            if (result[i * 4 + j] != c[j]) {
+               getFailures++;
+            }
+            if (values[i * 4 + j] != c[j] / 255.0f) {
+               floatFailures++;
+            }
+         }
+      }
+      SDLTest_AssertCheck(getFailures == 0, "Verify %s colors match SDL_GetRGBA, failures: %d", name, getFailures);
+      SDLTest_AssertCheck(floatFailures == 0, "Verify %s float colors match SDL_GetRGBA, failures: %d", name, floatFailures);
+
+      SDL_FreeFormat(format);
+   }
+
+   /* Palettized pixels map to the nearest color */
+   format = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8);
+   if (format != NULL) {
+      SDL_Palette *palette = SDL_AllocPalette(256);
+      if (palette != NULL) {
+         for (i = 0; i < palette->ncolors; i++) {
+            palette->colors[i].r = (Uint8)i;
+            palette->colors[i].g = (Uint8)(255 - i);
+            palette->colors[i].b = (Uint8)(i * 7);
+         }
+         SDL_SetPixelFormatPalette(format, palette);
+         SDL_MapRGBAArray(format, colors, pixels, 1000);
+         mapFailures = 0;
+         for (i = 0; i < 1000; i++) {
+            const Uint8 *c = &colors[i * 4];
+            if (pixels[i] != SDL_MapRGBA(format, c[0], c[1], c[2], c[3])) {
+               mapFailures++;
+            }
+         }
+         SDLTest_AssertCheck(mapFailures == 0, "Verify mapped indexed pixels match SDL_MapRGBA, failures: %d", mapFailures);
+         SDL_FreePalette(palette);
+      }
+      SDL_FreeFormat(format);
+   }
+
+   /* Pixel formats that don't fill a byte aren't supported */
+   format = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX4MSB);
+   if (format != NULL) {
+      SDLTest_AssertCheck(SDL_GetRGBAArray(format, pixels, result, 1) == -1, "Verify SDL_GetRGBAArray fails for INDEX4MSB");
+      SDL_FreeFormat(format);
+   }
+   SDLTest_AssertCheck(SDL_MapRGBAArray(NULL, colors, pixels, 1) == -1, "Verify SDL_MapRGBAArray fails without a format");
+
+   SDL_free(colors);
+   SDL_free(result);
+   SDL_free(pixels);
+   SDL_free(values);
+
+   return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Surface test cases */
@@ -557,10 +1252,31 @@ static const SDLTest_TestCaseReference surfaceTest10 =
 static const SDLTest_TestCaseReference surfaceTest11 =
 		{ (SDLTest_TestCaseFp)surface_testBlitBlendMod, "surface_testBlitBlendMod", "Tests blitting routines with mod blending mode.", TEST_ENABLED};
 
+static const SDLTest_TestCaseReference surfaceTest12 =
+		{ (SDLTest_TestCaseFp)surface_testMemoryStats, "surface_testMemoryStats", "Tests that surface pixels are counted in the memory statistics.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest13 =
+		{ (SDLTest_TestCaseFp)surface_testSurfacePool, "surface_testSurfacePool", "Tests acquiring and releasing surfaces from the surface pool.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest14 =
+		{ (SDLTest_TestCaseFp)surface_testPaletteMapping, "surface_testPaletteMapping", "Tests mapping colors to palettes and dithering.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest15 =
+		{ (SDLTest_TestCaseFp)surface_testFormatCache, "surface_testFormatCache", "Tests sharing pixel formats between threads.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest16 =
+		{ (SDLTest_TestCaseFp)surface_testSurfaceAlignment, "surface_testSurfaceAlignment", "Tests aligning surface rows for SIMD.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest17 =
+		{ (SDLTest_TestCaseFp)surface_testLoadBitmapFormats, "surface_testLoadBitmapFormats", "Tests loading compressed and low bit depth bitmaps.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest18 =
+		{ (SDLTest_TestCaseFp)surface_testPixelArrays, "surface_testPixelArrays", "Tests mapping arrays of colors to pixels and back.", TEST_ENABLED};
+
 /* Sequence of Surface test cases */
 static const SDLTest_TestCaseReference *surfaceTests[] =  {
 	&surfaceTest1, &surfaceTest2, &surfaceTest3, &surfaceTest4, &surfaceTest5,
-	&surfaceTest6, &surfaceTest7, &surfaceTest8, &surfaceTest9, &surfaceTest10, &surfaceTest11, NULL
+	&surfaceTest6, &surfaceTest7, &surfaceTest8, &surfaceTest9, &surfaceTest10, &surfaceTest11, &surfaceTest12, &surfaceTest13, &surfaceTest14, &surfaceTest15, &surfaceTest16, &surfaceTest17, &surfaceTest18, NULL
 };
 
 /* Surface test suite (global) */
@@ -173,6 +173,108 @@ timer_addRemoveTimer(void *arg)
   return TEST_COMPLETED;
 }
 
+/**
+ * @brief Call to SDL_DelayNS, SDL_DelayPrecise and SDL_GetTicksNS
+ */
+int
+timer_delayNSAndGetTicksNS(void *arg)
+{
+  const Uint64 testDelay = 20000000;
+  const Uint64 marginOfError = 10000000;
+  Uint64 result;
+  Uint64 result2;
+  Uint64 difference;
+
+  /* Zero delay */
+  SDL_DelayNS(0);
+  SDLTest_AssertPass("Call to SDL_DelayNS(0)");
+  SDL_DelayPrecise(0);
+  SDLTest_AssertPass("Call to SDL_DelayPrecise(0)");
+
+  /* Get ticks count */
+  result = SDL_GetTicksNS();
+  SDLTest_AssertPass("Call to SDL_GetTicksNS()");
+  SDLTest_AssertCheck(result > 0, "Check result value, expected: >0, got: %llu", (unsigned long long)result);
+
+  /* Delay and verify difference */
+  SDL_DelayNS(testDelay);
+  SDLTest_AssertPass("Call to SDL_DelayNS(%llu)", (unsigned long long)testDelay);
+  result2 = SDL_GetTicksNS();
+  difference = result2 - result;
+  SDLTest_AssertCheck(difference >= testDelay, "Check difference, expected: >=%llu, got: %llu", (unsigned long long)testDelay, (unsigned long long)difference);
+  SDLTest_AssertCheck(difference < (testDelay + marginOfError), "Check difference, expected: <%llu, got: %llu", (unsigned long long)(testDelay + marginOfError), (unsigned long long)difference);
+
+  /* Precise delay should never return early */
+  result = SDL_GetTicksNS();
+  SDL_DelayPrecise(testDelay);
+  SDLTest_AssertPass("Call to SDL_DelayPrecise(%llu)", (unsigned long long)testDelay);
+  result2 = SDL_GetTicksNS();
+  difference = result2 - result;
+  SDLTest_AssertCheck(difference >= testDelay, "Check difference, expected: >=%llu, got: %llu", (unsigned long long)testDelay, (unsigned long long)difference);
+
+  return TEST_COMPLETED;
+}
+
+/* Calls of a nanosecond timer, and ticks it skipped after falling behind */
+typedef struct
+{
+   int calls;
+   int skipped;
+   Uint64 last;
+} _timerTestCountNS;
+
+/* Test callback for nanosecond timers */
+Uint64 _timerTestCallbackNS(Uint64 interval, void *param)
+{
+   _timerTestCountNS *count = (_timerTestCountNS *)param;
+   Uint64 now = SDL_GetTicksNS();
+
+   /* A timer thread that wasn't scheduled for a whole interval skips the
+      missed ticks, which shows up as a gap of several intervals */
+   if (count->calls > 0 && now - count->last >= interval + interval / 2) {
+      count->skipped += (int)((now - count->last + interval / 2) / interval) - 1;
+   }
+   count->last = now;
+   count->calls++;
+   return interval;
+}
+
+/**
+ * @brief Call to SDL_AddTimerNS and SDL_RemoveTimer
+ */
+int
+timer_addRemoveTimerNS(void *arg)
+{
+  const Uint64 interval = 1500000;
+  SDL_TimerID id;
+  SDL_bool result;
+  _timerTestCountNS count;
+  int expected;
+  Uint64 start, elapsed;
+
+  /* Set a 1.5 ms periodic timer and let it run for a while */
+  SDL_zero(count);
+  start = SDL_GetTicksNS();
+  id = SDL_AddTimerNS(interval, _timerTestCallbackNS, (void *)&count);
+  SDLTest_AssertPass("Call to SDL_AddTimerNS(1500000, ...)");
+  SDLTest_AssertCheck(id > 0, "Check result value, expected: >0, got: %d", id);
+
+  SDL_Delay(150);
+  SDLTest_AssertPass("Call to SDL_Delay(150)");
+
+  result = SDL_RemoveTimer(id);
+  elapsed = SDL_GetTicksNS() - start;
+  SDLTest_AssertPass("Call to SDL_RemoveTimer()");
+  SDLTest_AssertCheck(result == SDL_TRUE, "Check result value, expected: %i, got: %i", SDL_TRUE, result);
+
+  /* Periodic timers don't drift, so there is a call for each interval
+     other than those skipped while the timer thread couldn't run */
+  expected = (int)(elapsed / interval) - count.skipped;
+  SDLTest_AssertCheck(count.calls >= expected - 3 && count.calls <= expected + 3, "Check callback count, expected: %i +/- 3 (%i skipped), got: %i", expected, count.skipped, count.calls);
+
+  return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Timer test cases */
@@ -188,9 +290,15 @@ static const SDLTest_TestCaseReference timerTest3 =
 static const SDLTest_TestCaseReference timerTest4 =
 		{ (SDLTest_TestCaseFp)timer_addRemoveTimer, "timer_addRemoveTimer", "Call to SDL_AddTimer and SDL_RemoveTimer", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference timerTest5 =
+		{ (SDLTest_TestCaseFp)timer_delayNSAndGetTicksNS, "timer_delayNSAndGetTicksNS", "Call to SDL_DelayNS, SDL_DelayPrecise and SDL_GetTicksNS", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference timerTest6 =
+		{ (SDLTest_TestCaseFp)timer_addRemoveTimerNS, "timer_addRemoveTimerNS", "Call to SDL_AddTimerNS and SDL_RemoveTimer", TEST_ENABLED };
+
 /* Sequence of Timer test cases */
 static const SDLTest_TestCaseReference *timerTests[] =  {
-	&timerTest1, &timerTest2, &timerTest3, &timerTest4, NULL
+	&timerTest1, &timerTest2, &timerTest3, &timerTest4, &timerTest5, &timerTest6, NULL
 };
 
 /* Timer test suite (global) */
@@ -313,6 +313,406 @@ video_getWindowFlags(void *arg)
   return TEST_COMPLETED;
 }
 
+/* Frames passed to the capture callback */
+static int _captureFrames;
+static Uint32 _captureLastFrame;
+static Uint32 _capturePixels[64 * 48];
+
+static void SDLCALL
+_captureCallback(void *userdata, Uint32 windowID, Uint32 frame, Uint32 format, const void *pixels, int pitch, int w, int h)
+{
+  int y;
+
+  _captureFrames++;
+  _captureLastFrame = frame;
+  if (format == SDL_PIXELFORMAT_RGB888 && w == 64 && h == 48) {
+    for (y = 0; y < h; y++) {
+      SDL_memcpy(&_capturePixels[y * w], (const Uint8 *)pixels + y * pitch, w * 4);
+    }
+  }
+}
+
+/**
+ * @brief Captures window frames with the dummy video driver
+ */
+int
+video_captureWindow(void *arg)
+{
+  const char *filename = "capture_test%d.y4m";
+  const int numFrames = 10;
+  SDL_Window* window;
+  SDL_Surface* surface;
+  SDL_WindowCaptureStats stats;
+  SDL_Rect rect;
+  SDL_RWops *rw;
+  Uint32 expectedPixels[64 * 48];
+  char file[64];
+  char header[64];
+  Sint64 size, expected;
+  int result, i, y;
+
+  result = SDL_SetWindowCaptureCallback(_captureCallback, NULL);
+  SDLTest_AssertPass("Call to SDL_SetWindowCaptureCallback");
+  if (result != 0) {
+    SDLTest_Log("Window capture not supported by this video driver, skipping");
+    return TEST_SKIPPED;
+  }
+
+  /* Partial updates of every frame, which must all reach the callback in order */
+  _captureFrames = 0;
+  window = SDL_CreateWindow("video_captureWindow Test Window", 0, 0, 64, 48, SDL_WINDOW_HIDDEN);
+  SDLTest_AssertCheck(window != NULL, "Validate that returned window struct is not NULL");
+  if (window == NULL) {
+    SDL_SetWindowCaptureCallback(NULL, NULL);
+    return TEST_ABORTED;
+  }
+  surface = SDL_GetWindowSurface(window);
+  SDLTest_AssertCheck(surface != NULL, "Validate that window surface is not NULL");
+  if (surface == NULL) {
+    SDL_DestroyWindow(window);
+    SDL_SetWindowCaptureCallback(NULL, NULL);
+    return TEST_ABORTED;
+  }
+  SDL_FillRect(surface, NULL, 0);
+  for (i = 0; i < numFrames; i++) {
+    rect.x = SDLTest_RandomIntegerInRange(0, 55);
+    rect.y = SDLTest_RandomIntegerInRange(0, 39);
+    rect.w = SDLTest_RandomIntegerInRange(1, 20);
+    rect.h = SDLTest_RandomIntegerInRange(1, 20);
+    SDL_FillRect(surface, &rect, SDLTest_RandomUint32() & 0xFFFFFF);
+    result = SDL_UpdateWindowSurfaceRects(window, &rect, 1);
+    SDLTest_AssertCheck(result == 0, "Validate result from SDL_UpdateWindowSurfaceRects, expected: 0, got: %i", result);
+  }
+  result = SDL_GetWindowCaptureStats(window, &stats);
+  SDLTest_AssertPass("Call to SDL_GetWindowCaptureStats");
+  SDLTest_AssertCheck(result == 0, "Validate result from SDL_GetWindowCaptureStats, expected: 0, got: %i", result);
+  SDLTest_AssertCheck(stats.frames == numFrames, "Validate frames presented, expected: %i, got: %u", numFrames, stats.frames);
+  SDLTest_AssertCheck(stats.dropped == 0, "Validate frames dropped, expected: 0, got: %u", stats.dropped);
+  SDLTest_AssertCheck(stats.min_frame_ns <= stats.max_frame_ns, "Validate frame time range");
+
+  /* Destroying the window finishes the capture */
+  for (y = 0; y < 48; y++) {
+    SDL_memcpy(&expectedPixels[y * 64], (Uint8 *)surface->pixels + y * surface->pitch, 64 * 4);
+  }
+  SDL_DestroyWindow(window);
+  SDLTest_AssertPass("Call to SDL_DestroyWindow");
+  result = SDL_memcmp(_capturePixels, expectedPixels, sizeof(expectedPixels));
+  SDLTest_AssertCheck(result == 0, "Validate that the last captured frame matches the window surface");
+  SDLTest_AssertCheck(_captureFrames == numFrames, "Validate frames captured, expected: %i, got: %i", numFrames, _captureFrames);
+  SDLTest_AssertCheck(_captureLastFrame == numFrames, "Validate last frame number, expected: %i, got: %u", numFrames, _captureLastFrame);
+  SDL_SetWindowCaptureCallback(NULL, NULL);
+
+  /* Write a YUV4MPEG2 file of an odd sized window */
+  SDL_SetHint(SDL_HINT_VIDEO_DUMMY_CAPTURE, filename);
+  window = SDL_CreateWindow("video_captureWindow Test Window", 0, 0, 33, 17, SDL_WINDOW_HIDDEN);
+  SDLTest_AssertCheck(window != NULL, "Validate that returned window struct is not NULL");
+  if (window != NULL) {
+    surface = SDL_GetWindowSurface(window);
+    for (i = 0; surface != NULL && i < 3; i++) {
+      SDL_FillRect(surface, NULL, SDLTest_RandomUint32() & 0xFFFFFF);
+      SDL_UpdateWindowSurface(window);
+    }
+    SDL_DestroyWindow(window);
+  }
+  SDL_SetHint(SDL_HINT_VIDEO_DUMMY_CAPTURE, NULL);
+
+  /* The capture counter is shared with earlier captures, find the file */
+  rw = NULL;
+  for (i = 1; rw == NULL && i <= 8; i++) {
+    SDL_snprintf(file, sizeof(file), "capture_test%d.y4m", i);
+    rw = SDL_RWFromFile(file, "rb");
+  }
+  SDLTest_AssertCheck(rw != NULL, "Validate that the capture file was written");
+  if (rw != NULL) {
+    size = SDL_RWsize(rw);
+    SDL_RWclose(rw);
+    remove(file);
+    SDL_snprintf(header, sizeof(header), "YUV4MPEG2 W33 H17 F60:1 Ip A1:1 C420jpeg\n");
+    expected = SDL_strlen(header) + 3 * (6 + 33 * 17 + 2 * 17 * 9);
+    SDLTest_AssertCheck(size == expected, "Validate capture file size, expected: %lld, got: %lld", expected, size);
+  }
+
+  return TEST_COMPLETED;
+}
+
+/**
+ * @brief Keeps the window surface contents over a series of partial updates
+ */
+int
+video_updateWindowSurfaceRects(void *arg)
+{
+  const int w = 96, h = 64, numFrames = 12;
+  SDL_Window* window;
+  SDL_Surface* surface;
+  SDL_Surface* shadow;
+  SDL_Rect rect;
+  int result, i, y, mismatches;
+
+  window = SDL_CreateWindow("video_updateWindowSurfaceRects Test Window", 0, 0, w, h, SDL_WINDOW_SHOWN);
+  SDLTest_AssertCheck(window != NULL, "Validate that returned window struct is not NULL");
+  if (window == NULL) {
+    return TEST_ABORTED;
+  }
+  surface = SDL_GetWindowSurface(window);
+  SDLTest_AssertCheck(surface != NULL, "Validate that window surface is not NULL");
+  if (surface == NULL) {
+    SDL_DestroyWindow(window);
+    return TEST_ABORTED;
+  }
+  shadow = SDL_CreateRGBSurface(0, w, h, surface->format->BitsPerPixel,
+                                surface->format->Rmask, surface->format->Gmask,
+                                surface->format->Bmask, surface->format->Amask);
+  SDLTest_AssertCheck(shadow != NULL, "Validate that shadow surface is not NULL");
+  if (shadow == NULL) {
+    SDL_DestroyWindow(window);
+    return TEST_ABORTED;
+  }
+
+  SDL_FillRect(surface, NULL, 0);
+  SDL_FillRect(shadow, NULL, 0);
+  result = SDL_UpdateWindowSurface(window);
+  SDLTest_AssertCheck(result == 0, "Validate result from SDL_UpdateWindowSurface, expected: 0, got: %i", result);
+
+  /* The surface pixels may move with each update, but not its contents */
+  mismatches = 0;
+  for (i = 0; i < numFrames; i++) {
+    Uint32 color = SDLTest_RandomUint32();
+    rect.x = SDLTest_RandomIntegerInRange(-8, w - 1);
+    rect.y = SDLTest_RandomIntegerInRange(-8, h - 1);
+    rect.w = SDLTest_RandomIntegerInRange(1, 40);
+    rect.h = SDLTest_RandomIntegerInRange(1, 40);
+    SDL_FillRect(surface, &rect, color);
+    SDL_FillRect(shadow, &rect, color);
+    result = SDL_UpdateWindowSurfaceRects(window, &rect, 1);
+    SDLTest_AssertCheck(result == 0, "Validate result from SDL_UpdateWindowSurfaceRects, expected: 0, got: %i", result);
+    for (y = 0; y < h; y++) {
+      if (SDL_memcmp((Uint8 *)surface->pixels + y * surface->pitch,
+                     (Uint8 *)shadow->pixels + y * shadow->pitch,
+                     w * surface->format->BytesPerPixel) != 0) {
+        mismatches++;
+      }
+    }
+  }
+  SDLTest_AssertCheck(mismatches == 0, "Validate that the surface kept its contents, expected: 0 mismatched rows, got: %i", mismatches);
+
+  SDL_FreeSurface(shadow);
+  SDL_DestroyWindow(window);
+  SDLTest_AssertPass("Call to SDL_DestroyWindow");
+
+  return TEST_COMPLETED;
+}
+
+/* Uploads reported by the upload callback */
+static int _uploadCalls;
+static int _uploadRects;
+static Uint32 _uploadBytes;
+
+static void SDLCALL
+_uploadCallback(void *userdata, Uint32 windowID, int numrects, Uint32 bytes)
+{
+  _uploadCalls++;
+  _uploadRects = numrects;
+  _uploadBytes = bytes;
+}
+
+/**
+ * @brief Checks that window surfaces emulated with a texture upload only the updated rects
+ */
+int
+video_uploadWindowSurfaceRects(void *arg)
+{
+  const int w = 320, h = 240;
+  SDL_Window* window;
+  SDL_Surface* surface;
+  SDL_Rect rects[2];
+  int result, status = TEST_COMPLETED;
+
+  result = SDL_SetWindowUploadCallback(_uploadCallback, NULL);
+  SDLTest_AssertPass("Call to SDL_SetWindowUploadCallback");
+  SDLTest_AssertCheck(result == 0, "Validate result from SDL_SetWindowUploadCallback, expected: 0, got: %i", result);
+
+  window = SDL_CreateWindow("video_uploadWindowSurfaceRects Test Window", 0, 0, w, h, SDL_WINDOW_SHOWN);
+  SDLTest_AssertCheck(window != NULL, "Validate that returned window struct is not NULL");
+  if (window == NULL) {
+    SDL_SetWindowUploadCallback(NULL, NULL);
+    return TEST_ABORTED;
+  }
+  surface = SDL_GetWindowSurface(window);
+  SDLTest_AssertCheck(surface != NULL, "Validate that window surface is not NULL");
+
+  /* Two small rectangles in opposite corners are uploaded separately */
+  _uploadCalls = 0;
+  rects[0].x = 0;
+  rects[0].y = 0;
+  rects[0].w = 16;
+  rects[0].h = 16;
+  rects[1].x = w - 16;
+  rects[1].y = h - 16;
+  rects[1].w = 16;
+  rects[1].h = 16;
+  result = SDL_UpdateWindowSurfaceRects(window, rects, 2);
+  SDLTest_AssertCheck(result == 0, "Validate result from SDL_UpdateWindowSurfaceRects, expected: 0, got: %i", result);
+  if (_uploadCalls == 0) {
+    SDLTest_Log("Window surface isn't emulated with a texture, skipping");
+    status = TEST_SKIPPED;
+  } else {
+    SDLTest_AssertCheck(_uploadRects == 2, "Validate rects uploaded, expected: 2, got: %i", _uploadRects);
+    SDLTest_AssertCheck(_uploadBytes == 2 * 16 * 16 * surface->format->BytesPerPixel,
+                        "Validate bytes uploaded, expected: %i, got: %u",
+                        2 * 16 * 16 * surface->format->BytesPerPixel, _uploadBytes);
+  }
+
+  SDL_DestroyWindow(window);
+  SDLTest_AssertPass("Call to SDL_DestroyWindow");
+  SDL_SetWindowUploadCallback(NULL, NULL);
+
+  return status;
+}
+
+/* Updates the window surface with the given rects and checks the upload */
+static void
+_checkWindowTextureUpload(SDL_Window *window, const SDL_Rect *rects, int numrects,
+                          int expectedRects, int expectedPixels, const char *what)
+{
+  SDL_Surface *surface = SDL_GetWindowSurface(window);
+  Uint32 expectedBytes = expectedPixels * surface->format->BytesPerPixel;
+  int result;
+
+  _uploadCalls = 0;
+  _uploadRects = 0;
+  _uploadBytes = 0;
+  result = SDL_UpdateWindowSurfaceRects(window, rects, numrects);
+  SDLTest_AssertCheck(result == 0, "Validate result from SDL_UpdateWindowSurfaceRects with %s, expected: 0, got: %i", what, result);
+  SDLTest_AssertCheck(_uploadCalls == 1, "Validate uploads of %s, expected: 1, got: %i", what, _uploadCalls);
+  SDLTest_AssertCheck(_uploadRects == expectedRects, "Validate rects uploaded for %s, expected: %i, got: %i", what, expectedRects, _uploadRects);
+  SDLTest_AssertCheck(_uploadBytes == expectedBytes, "Validate bytes uploaded for %s, expected: %u, got: %u", what, expectedBytes, _uploadBytes);
+}
+
+/**
+ * @brief Checks how a window surface forced to use a texture merges the rects it uploads
+ */
+int
+video_uploadWindowTextureRects(void *arg)
+{
+  const int w = 320, h = 240;
+  const char *current = SDL_GetCurrentVideoDriver();
+  char driver[64];
+  SDL_Window* window = NULL;
+  SDL_Rect rects[3];
+  int result, status = TEST_COMPLETED;
+
+  SDLTest_AssertCheck(current != NULL, "Validate that a video driver is initialized");
+  if (current == NULL) {
+    return TEST_ABORTED;
+  }
+  SDL_strlcpy(driver, current, sizeof(driver));
+
+  /* The window texture is chosen when the video driver starts */
+  SDL_VideoQuit();
+  SDL_SetHint(SDL_HINT_FRAMEBUFFER_ACCELERATION, "1");
+  result = SDL_VideoInit(driver);
+  SDLTest_AssertPass("Call to SDL_VideoInit(\"%s\") with SDL_HINT_FRAMEBUFFER_ACCELERATION set", driver);
+  SDLTest_AssertCheck(result == 0, "Validate result from SDL_VideoInit, expected: 0, got: %i", result);
+  if (result == 0) {
+    SDL_SetWindowUploadCallback(_uploadCallback, NULL);
+    window = SDL_CreateWindow("video_uploadWindowTextureRects Test Window", 0, 0, w, h, SDL_WINDOW_HIDDEN);
+    SDLTest_AssertCheck(window != NULL, "Validate that returned window struct is not NULL");
+  }
+  if (window != NULL && SDL_GetWindowSurface(window) == NULL) {
+    SDLTest_Log("No accelerated renderer for the window texture (%s), skipping", SDL_GetError());
+    status = TEST_SKIPPED;
+  } else if (window != NULL) {
+    /* Rects far apart cost less to upload separately */
+    rects[0].x = 0;
+    rects[0].y = 0;
+    rects[0].w = 16;
+    rects[0].h = 16;
+    rects[1].x = w - 16;
+    rects[1].y = h - 16;
+    rects[1].w = 16;
+    rects[1].h = 16;
+    _checkWindowTextureUpload(window, rects, 2, 2, 2 * 16 * 16, "distant rects");
+
+    /* Rects whose union costs little more are merged */
+    rects[1].x = 20;
+    rects[1].y = 0;
+    rects[2].x = 8;
+    rects[2].y = 8;
+    rects[2].w = 16;
+    rects[2].h = 16;
+    _checkWindowTextureUpload(window, rects, 3, 1, 36 * 24, "nearby rects");
+
+    /* Rects are clipped to the window, and those outside it are dropped */
+    rects[0].x = -8;
+    rects[0].y = h - 8;
+    rects[1].x = w;
+    rects[1].y = 0;
+    _checkWindowTextureUpload(window, rects, 2, 1, 8 * 8, "rects outside the window");
+
+    /* Covering the window with small rects uploads it in one go */
+    rects[0].x = 0;
+    rects[0].y = 0;
+    rects[0].w = w;
+    rects[0].h = h / 2;
+    rects[1].x = 0;
+    rects[1].y = h / 2;
+    rects[1].w = w;
+    rects[1].h = h - h / 2;
+    _checkWindowTextureUpload(window, rects, 2, 1, w * h, "the whole window");
+  }
+
+  if (window != NULL) {
+    SDL_DestroyWindow(window);
+    SDLTest_AssertPass("Call to SDL_DestroyWindow");
+  }
+  SDL_SetWindowUploadCallback(NULL, NULL);
+
+  /* Go back to the driver's own choice of window surface */
+  SDL_VideoQuit();
+  SDL_SetHint(SDL_HINT_FRAMEBUFFER_ACCELERATION, NULL);
+  result = SDL_VideoInit(driver);
+  SDLTest_AssertCheck(result == 0, "Validate result from restarting video, expected: 0, got: %i", result);
+
+  return status;
+}
+
+/**
+ * @brief Checks the file descriptor for waiting on video events
+ */
+int
+video_getVideoEventFD(void *arg)
+{
+  const char *driver = SDL_GetCurrentVideoDriver();
+  int fd, timeout;
+
+  SDLTest_AssertCheck(driver != NULL, "Validate that a video driver is initialized");
+  if (driver == NULL) {
+    return TEST_ABORTED;
+  }
+
+  fd = SDL_GetVideoEventFD();
+  SDLTest_AssertPass("Call to SDL_GetVideoEventFD");
+  if (SDL_strcmp(driver, "x11") == 0) {
+    SDLTest_AssertCheck(fd >= 0, "Validate X11 connection descriptor, expected: >= 0, got: %i", fd);
+  } else if (fd < 0) {
+    SDLTest_AssertCheck(fd == -1, "Validate result from SDL_GetVideoEventFD without a descriptor, expected: -1, got: %i", fd);
+    SDLTest_Log("Video driver %s doesn't have an event descriptor", driver);
+  }
+
+  /* Pumping events leaves the descriptor as it was */
+  SDL_PumpEvents();
+  SDLTest_AssertPass("Call to SDL_PumpEvents");
+  SDLTest_AssertCheck(SDL_GetVideoEventFD() == fd, "Validate that the descriptor doesn't change");
+
+  /* Without windows or a suspended screensaver there are no timers */
+  SDL_EnableScreenSaver();
+  timeout = SDL_GetVideoEventTimeout();
+  SDLTest_AssertPass("Call to SDL_GetVideoEventTimeout");
+  SDLTest_AssertCheck(timeout == -1, "Validate timeout without pending work, expected: -1, got: %i", timeout);
+
+  return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Video test cases */
@@ -331,9 +731,24 @@ static const SDLTest_TestCaseReference videoTest4 =
 static const SDLTest_TestCaseReference videoTest5 =
 		{ (SDLTest_TestCaseFp)video_getWindowFlags, "video_getWindowFlags",  "Set and get window flags", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference videoTest6 =
+		{ (SDLTest_TestCaseFp)video_captureWindow, "video_captureWindow",  "Capture window frames to a callback and a file", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference videoTest7 =
+		{ (SDLTest_TestCaseFp)video_updateWindowSurfaceRects, "video_updateWindowSurfaceRects",  "Update parts of the window surface", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference videoTest8 =
+		{ (SDLTest_TestCaseFp)video_uploadWindowSurfaceRects, "video_uploadWindowSurfaceRects",  "Upload only the updated parts of a window surface texture", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference videoTest9 =
+		{ (SDLTest_TestCaseFp)video_getVideoEventFD, "video_getVideoEventFD",  "Get the file descriptor for waiting on video events", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference videoTest10 =
+		{ (SDLTest_TestCaseFp)video_uploadWindowTextureRects, "video_uploadWindowTextureRects",  "Merge the rects uploaded to a window surface forced to use a texture", TEST_ENABLED };
+
 /* Sequence of Video test cases */
 static const SDLTest_TestCaseReference *videoTests[] =  {
-	&videoTest1, &videoTest2, &videoTest3, &videoTest4, &videoTest5, NULL
+	&videoTest1, &videoTest2, &videoTest3, &videoTest4, &videoTest5, &videoTest6, &videoTest7, &videoTest8, &videoTest9, &videoTest10, NULL
 };
 
 /* Video test suite (global) */
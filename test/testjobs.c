@@ -0,0 +1,171 @@
+/*
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Test and benchmark of the SDL job system */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define NUM_ITEMS   (4 * 1024 * 1024)
+#define NUM_JOBS    10000
+
+static float *items;
+static SDL_atomic_t jobs_run;
+static SDL_atomic_t stage;
+static int failures;
+
+static void SDLCALL
+ScaleItems(int start, int end, void *data)
+{
+    const float scale = *(float *)data;
+    int i;
+
+    for (i = start; i < end; ++i) {
+        items[i] = SDL_sqrt(items[i] * scale);
+    }
+}
+
+static void SDLCALL
+CountJob(void *data)
+{
+    SDL_AtomicIncRef(&jobs_run);
+}
+
+static void SDLCALL
+FirstStage(void *data)
+{
+    SDL_Delay(10);
+    SDL_AtomicIncRef(&stage);
+}
+
+static void SDLCALL
+SecondStage(void *data)
+{
+    if (SDL_AtomicGet(&stage) != *(int *)data) {
+        printf("Dependent job ran before its dependencies finished!\n");
+        ++failures;
+    }
+}
+
+static void SDLCALL
+SpawnJobs(void *data)
+{
+    /* Jobs started from inside a job go on the worker's own queue */
+    SDL_JobCounter *counter = SDL_CreateJobCounter();
+    int i;
+
+    for (i = 0; i < 100; ++i) {
+        SDL_RunJob(CountJob, NULL, counter);
+    }
+    SDL_WaitJobCounter(counter);
+    SDL_DestroyJobCounter(counter);
+}
+
+static double
+elapsed_ms(Uint64 start)
+{
+    return (double)((SDL_GetPerformanceCounter() - start) * 1000) / SDL_GetPerformanceFrequency();
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_JobCounter *first, *second;
+    float scale = 2.0f;
+    int i, expected;
+    Uint64 start;
+
+    if (SDL_Init(0) < 0) {
+        fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    printf("Job system has %d worker threads on %d CPUs\n",
+           SDL_GetJobWorkerCount(), SDL_GetCPUCount());
+
+    items = (float *)SDL_malloc(NUM_ITEMS * sizeof(*items));
+    if (!items) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    /* Compare a serial loop with a parallel one */
+    for (i = 0; i < NUM_ITEMS; ++i) {
+        items[i] = (float)i;
+    }
+    start = SDL_GetPerformanceCounter();
+    ScaleItems(0, NUM_ITEMS, &scale);
+    printf("Serial loop over %d items: %f ms\n", NUM_ITEMS, elapsed_ms(start));
+
+    for (i = 0; i < NUM_ITEMS; ++i) {
+        items[i] = (float)i;
+    }
+    start = SDL_GetPerformanceCounter();
+    SDL_ParallelFor(0, NUM_ITEMS, 0, ScaleItems, &scale);
+    printf("Parallel loop over %d items: %f ms\n", NUM_ITEMS, elapsed_ms(start));
+
+    for (i = 0; i < NUM_ITEMS; i += NUM_ITEMS / 16) {
+        if (items[i] != (float)SDL_sqrt((float)i * scale)) {
+            printf("Item %d wasn't processed correctly\n", i);
+            ++failures;
+        }
+    }
+
+    /* Lots of tiny jobs */
+    SDL_AtomicSet(&jobs_run, 0);
+    first = SDL_CreateJobCounter();
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < NUM_JOBS; ++i) {
+        SDL_RunJob(CountJob, NULL, first);
+    }
+    SDL_WaitJobCounter(first);
+    printf("Ran %d jobs in %f ms\n", SDL_AtomicGet(&jobs_run), elapsed_ms(start));
+    if (SDL_AtomicGet(&jobs_run) != NUM_JOBS) {
+        ++failures;
+    }
+
+    /* Jobs spawning jobs */
+    SDL_AtomicSet(&jobs_run, 0);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < 100; ++i) {
+        SDL_RunJob(SpawnJobs, NULL, first);
+    }
+    SDL_WaitJobCounter(first);
+    printf("Ran %d nested jobs in %f ms\n", SDL_AtomicGet(&jobs_run), elapsed_ms(start));
+    if (SDL_AtomicGet(&jobs_run) != 100 * 100) {
+        ++failures;
+    }
+
+    /* Dependencies between groups of jobs */
+    expected = 8;
+    SDL_AtomicSet(&stage, 0);
+    second = SDL_CreateJobCounter();
+    for (i = 0; i < expected; ++i) {
+        SDL_RunJob(FirstStage, NULL, first);
+    }
+    for (i = 0; i < expected; ++i) {
+        SDL_RunJobAfter(SecondStage, &expected, first, second);
+    }
+    SDL_WaitJobCounter(second);
+    SDL_DestroyJobCounter(second);
+    SDL_DestroyJobCounter(first);
+
+    SDL_free(items);
+    SDL_Quit();
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
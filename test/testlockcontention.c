@@ -0,0 +1,235 @@
+/*
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Benchmark of SDL mutexes and semaphores under contention.
+   When SDL is built on POSIX threads the same workloads are also run
+   directly on pthread mutexes and semaphores for comparison.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#if SDL_THREAD_PTHREAD && !defined(__MACOSX__) && !defined(__IPHONEOS__)
+#define HAVE_PTHREAD_COMPARISON 1
+#include <pthread.h>
+#include <semaphore.h>
+#endif
+
+#define DEFAULT_THREADS     4
+#define DEFAULT_ITERATIONS  250000
+#define PINGPONG_ROUNDS     50000
+
+static int num_threads;
+static int num_iterations;
+static volatile int counter;
+static int failures;
+
+static SDL_mutex *mutex;
+static SDL_sem *ping, *pong;
+
+static int SDLCALL
+SDLMutexThread(void *data)
+{
+    int i;
+
+    for (i = 0; i < num_iterations; ++i) {
+        SDL_LockMutex(mutex);
+        ++counter;
+        SDL_UnlockMutex(mutex);
+    }
+    return 0;
+}
+
+static int SDLCALL
+SDLPongThread(void *data)
+{
+    int i;
+
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        SDL_SemWait(ping);
+        SDL_SemPost(pong);
+    }
+    return 0;
+}
+
+#ifdef HAVE_PTHREAD_COMPARISON
+static pthread_mutex_t pmutex;
+static sem_t pping, ppong;
+
+static int SDLCALL
+PthreadMutexThread(void *data)
+{
+    int i;
+
+    for (i = 0; i < num_iterations; ++i) {
+        pthread_mutex_lock(&pmutex);
+        ++counter;
+        pthread_mutex_unlock(&pmutex);
+    }
+    return 0;
+}
+
+static int SDLCALL
+PthreadPongThread(void *data)
+{
+    int i;
+
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        sem_wait(&pping);
+        sem_post(&ppong);
+    }
+    return 0;
+}
+#endif /* HAVE_PTHREAD_COMPARISON */
+
+static double
+elapsed_ms(Uint64 start)
+{
+    return (double)((SDL_GetPerformanceCounter() - start) * 1000) / SDL_GetPerformanceFrequency();
+}
+
+static void
+RunContention(const char *name, SDL_ThreadFunction fn)
+{
+    SDL_Thread **threads;
+    Uint64 start;
+    double ms;
+    int i, expected;
+
+    threads = (SDL_Thread **)SDL_malloc(num_threads * sizeof(*threads));
+    if (!threads) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    counter = 0;
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < num_threads; ++i) {
+        threads[i] = SDL_CreateThread(fn, name, NULL);
+    }
+    for (i = 0; i < num_threads; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    ms = elapsed_ms(start);
+    SDL_free(threads);
+
+    expected = num_threads * num_iterations;
+    printf("%-16s %d threads x %d locks: %10.3f ms, %6.1f ns per lock\n",
+           name, num_threads, num_iterations, ms, (ms * 1000000.0) / expected);
+    if (counter != expected) {
+        printf("%s: counter is %d, expected %d!\n", name, counter, expected);
+        ++failures;
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_Thread *thread;
+    Uint64 start;
+    Uint32 then;
+    int i, contending_threads;
+
+    contending_threads = DEFAULT_THREADS;
+    num_iterations = DEFAULT_ITERATIONS;
+    if (argc > 1) {
+        contending_threads = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        num_iterations = atoi(argv[2]);
+    }
+    if (contending_threads <= 0 || num_iterations <= 0) {
+        fprintf(stderr, "Usage: %s [threads] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    if (SDL_Init(0) < 0) {
+        fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    mutex = SDL_CreateMutex();
+    ping = SDL_CreateSemaphore(0);
+    pong = SDL_CreateSemaphore(0);
+    if (!mutex || !ping || !pong) {
+        fprintf(stderr, "Couldn't create locks: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    /* Uncontended cost of a lock/unlock pair */
+    num_threads = 1;
+    RunContention("SDL_mutex", SDLMutexThread);
+#ifdef HAVE_PTHREAD_COMPARISON
+    pthread_mutex_init(&pmutex, NULL);
+    RunContention("pthread_mutex", PthreadMutexThread);
+#endif
+
+    /* All threads hammering the same lock */
+    num_threads = contending_threads;
+    RunContention("SDL_mutex", SDLMutexThread);
+#ifdef HAVE_PTHREAD_COMPARISON
+    RunContention("pthread_mutex", PthreadMutexThread);
+    pthread_mutex_destroy(&pmutex);
+#endif
+
+    /* Handing control back and forth between two threads */
+    thread = SDL_CreateThread(SDLPongThread, "SDLPong", NULL);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        SDL_SemPost(ping);
+        SDL_SemWait(pong);
+    }
+    printf("%-16s %d round trips: %10.3f ms\n", "SDL_sem",
+           PINGPONG_ROUNDS, elapsed_ms(start));
+    SDL_WaitThread(thread, NULL);
+
+#ifdef HAVE_PTHREAD_COMPARISON
+    sem_init(&pping, 0, 0);
+    sem_init(&ppong, 0, 0);
+    thread = SDL_CreateThread(PthreadPongThread, "PthreadPong", NULL);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        sem_post(&pping);
+        sem_wait(&ppong);
+    }
+    printf("%-16s %d round trips: %10.3f ms\n", "sem_t",
+           PINGPONG_ROUNDS, elapsed_ms(start));
+    SDL_WaitThread(thread, NULL);
+    sem_destroy(&pping);
+    sem_destroy(&ppong);
+#endif
+
+    /* Timeouts should expire on time and leave the semaphore alone */
+    then = SDL_GetTicks();
+    if (SDL_SemWaitTimeout(ping, 100) != SDL_MUTEX_TIMEDOUT) {
+        printf("SDL_SemWaitTimeout() didn't time out!\n");
+        ++failures;
+    }
+    then = SDL_GetTicks() - then;
+    printf("SDL_SemWaitTimeout(100) took %u ms\n", then);
+    if (then < 100) {
+        printf("SDL_SemWaitTimeout() returned early!\n");
+        ++failures;
+    }
+
+    SDL_DestroySemaphore(pong);
+    SDL_DestroySemaphore(ping);
+    SDL_DestroyMutex(mutex);
+    SDL_Quit();
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -143,7 +143,10 @@ TestCPUInfo(SDL_bool verbose)
 {
     if (verbose) {
         printf("CPU count: %d\n", SDL_GetCPUCount());
+        printf("CPU physical cores: %d\n", SDL_GetCPUPhysicalCoreCount());
         printf("CPU cache line size: %d\n", SDL_GetCPUCacheLineSize());
+        printf("CPU cache sizes: L1 %d KB, L2 %d KB, L3 %d KB\n",
+               SDL_GetCPUCacheSize(1), SDL_GetCPUCacheSize(2), SDL_GetCPUCacheSize(3));
         printf("RDTSC %s\n", SDL_HasRDTSC()? "detected" : "not detected");
         printf("AltiVec %s\n", SDL_HasAltiVec()? "detected" : "not detected");
         printf("MMX %s\n", SDL_HasMMX()? "detected" : "not detected");
@@ -153,6 +156,14 @@ TestCPUInfo(SDL_bool verbose)
         printf("SSE3 %s\n", SDL_HasSSE3()? "detected" : "not detected");
         printf("SSE4.1 %s\n", SDL_HasSSE41()? "detected" : "not detected");
         printf("SSE4.2 %s\n", SDL_HasSSE42()? "detected" : "not detected");
+        printf("AVX %s\n", SDL_HasAVX()? "detected" : "not detected");
+        printf("AVX2 %s\n", SDL_HasAVX2()? "detected" : "not detected");
+        printf("AVX-512F %s\n", SDL_HasAVX512F()? "detected" : "not detected");
+        printf("FMA %s\n", SDL_HasFMA()? "detected" : "not detected");
+        printf("F16C %s\n", SDL_HasF16C()? "detected" : "not detected");
+        printf("BMI1 %s\n", SDL_HasBMI1()? "detected" : "not detected");
+        printf("BMI2 %s\n", SDL_HasBMI2()? "detected" : "not detected");
+        printf("NEON %s\n", SDL_HasNEON()? "detected" : "not detected");
     }
     return (0);
 }
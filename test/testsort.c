@@ -0,0 +1,283 @@
+/*
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks SDL_qsort() and SDL_RadixSort(), and benchmarks them against the
+   C library's qsort() on integers and on sprites sorted by depth.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define DEFAULT_COUNT   50000
+#define REPEATS         10
+
+typedef struct
+{
+    float depth;
+    int id;
+    SDL_Rect rect;
+} Sprite;
+
+static int failures;
+static Uint32 seed = 1;
+
+static Uint32
+random_number(void)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed;
+}
+
+static int SDLCALL
+compare_ints(const void *a, const void *b)
+{
+    int x = *(const int *) a;
+    int y = *(const int *) b;
+    return (x < y) ? -1 : (x > y);
+}
+
+static int SDLCALL
+compare_sprites(const void *a, const void *b)
+{
+    const Sprite *x = (const Sprite *) a;
+    const Sprite *y = (const Sprite *) b;
+    if (x->depth != y->depth) {
+        return (x->depth < y->depth) ? -1 : 1;
+    }
+    /* Break ties by id so that the sort order is fully defined */
+    return (x->id < y->id) ? -1 : (x->id > y->id);
+}
+
+static int SDLCALL
+compare_bytes(const void *a, const void *b)
+{
+    return SDL_memcmp(a, b, 3);
+}
+
+static void
+fill_ints(int *array, int count, int pattern)
+{
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        switch (pattern) {
+        case 0:     /* random */
+            array[i] = (int) random_number();
+            break;
+        case 1:     /* sorted */
+            array[i] = i;
+            break;
+        case 2:     /* reversed */
+            array[i] = count - i;
+            break;
+        case 3:     /* few distinct values */
+            array[i] = random_number() % 4;
+            break;
+        case 4:     /* organ pipe */
+            array[i] = (i < count / 2) ? i : count - i;
+            break;
+        }
+    }
+}
+
+static void
+fill_sprites(Sprite *sprites, int count)
+{
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        /* Coarse depths so there are plenty of ties to test stability */
+        sprites[i].depth = (float) ((int) (random_number() % 1024) - 512) / 8.0f;
+        sprites[i].id = i;
+        sprites[i].rect.x = i;
+        sprites[i].rect.y = -i;
+        sprites[i].rect.w = 32;
+        sprites[i].rect.h = 32;
+    }
+}
+
+static void
+check(SDL_bool condition, const char *what)
+{
+    if (!condition) {
+        printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static double
+elapsed_ms(Uint64 start)
+{
+    return (double)((SDL_GetPerformanceCounter() - start) * 1000) / SDL_GetPerformanceFrequency();
+}
+
+static void
+test_ints(int count)
+{
+    static const char *patterns[] = {
+        "random", "sorted", "reversed", "few values", "organ pipe"
+    };
+    int *input = (int *) SDL_malloc(count * sizeof(int));
+    int *array = (int *) SDL_malloc(count * sizeof(int));
+    int *expected = (int *) SDL_malloc(count * sizeof(int));
+    double ms_libc, ms_sdl, ms_radix;
+    Uint64 start;
+    int pattern, i;
+
+    if (!input || !array || !expected) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    for (pattern = 0; pattern < SDL_arraysize(patterns); ++pattern) {
+        ms_libc = ms_sdl = ms_radix = 0.0;
+        for (i = 0; i < REPEATS; ++i) {
+            fill_ints(input, count, pattern);
+            SDL_memcpy(expected, input, count * sizeof(int));
+            SDL_memcpy(array, input, count * sizeof(int));
+            start = SDL_GetPerformanceCounter();
+            qsort(expected, count, sizeof(int), compare_ints);
+            ms_libc += elapsed_ms(start);
+
+            start = SDL_GetPerformanceCounter();
+            SDL_qsort(array, count, sizeof(int), compare_ints);
+            ms_sdl += elapsed_ms(start);
+            check(SDL_memcmp(array, expected, count * sizeof(int)) == 0,
+                  "SDL_qsort() of ints matches qsort()");
+
+            SDL_memcpy(array, input, count * sizeof(int));
+            start = SDL_GetPerformanceCounter();
+            SDL_RadixSort(array, count, sizeof(int), 0, SDL_SORTKEY_SINT32);
+            ms_radix += elapsed_ms(start);
+            check(SDL_memcmp(array, expected, count * sizeof(int)) == 0,
+                  "SDL_RadixSort() of ints matches qsort()");
+        }
+        printf("%d ints, %-10s: qsort %8.3f ms, SDL_qsort %8.3f ms, SDL_RadixSort %8.3f ms\n",
+               count, patterns[pattern], ms_libc / REPEATS, ms_sdl / REPEATS,
+               ms_radix / REPEATS);
+    }
+
+    SDL_free(expected);
+    SDL_free(array);
+    SDL_free(input);
+}
+
+static void
+test_sprites(int count)
+{
+    Sprite *input = (Sprite *) SDL_malloc(count * sizeof(Sprite));
+    Sprite *sprites = (Sprite *) SDL_malloc(count * sizeof(Sprite));
+    Sprite *expected = (Sprite *) SDL_malloc(count * sizeof(Sprite));
+    double ms_libc = 0.0, ms_sdl = 0.0, ms_radix = 0.0;
+    Uint64 start;
+    int i;
+
+    if (!input || !sprites || !expected) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    for (i = 0; i < REPEATS; ++i) {
+        fill_sprites(input, count);
+        SDL_memcpy(expected, input, count * sizeof(Sprite));
+        SDL_memcpy(sprites, input, count * sizeof(Sprite));
+        start = SDL_GetPerformanceCounter();
+        qsort(expected, count, sizeof(Sprite), compare_sprites);
+        ms_libc += elapsed_ms(start);
+
+        start = SDL_GetPerformanceCounter();
+        SDL_qsort(sprites, count, sizeof(Sprite), compare_sprites);
+        ms_sdl += elapsed_ms(start);
+        check(SDL_memcmp(sprites, expected, count * sizeof(Sprite)) == 0,
+              "SDL_qsort() of sprites matches qsort()");
+
+        /* The ids are in order, so a stable sort by depth alone must give
+           the same result as sorting by depth and then id.
+         */
+        SDL_memcpy(sprites, input, count * sizeof(Sprite));
+        start = SDL_GetPerformanceCounter();
+        SDL_RadixSort(sprites, count, sizeof(Sprite),
+                      offsetof(Sprite, depth), SDL_SORTKEY_FLOAT);
+        ms_radix += elapsed_ms(start);
+        check(SDL_memcmp(sprites, expected, count * sizeof(Sprite)) == 0,
+              "SDL_RadixSort() of sprites is stable and matches qsort()");
+    }
+    printf("%d sprites by depth: qsort %8.3f ms, SDL_qsort %8.3f ms, SDL_RadixSort %8.3f ms\n",
+           count, ms_libc / REPEATS, ms_sdl / REPEATS, ms_radix / REPEATS);
+
+    SDL_free(expected);
+    SDL_free(sprites);
+    SDL_free(input);
+}
+
+static void
+test_edge_cases(void)
+{
+    double doubles[] = { 3.5, -0.0, -1e300, 0.0, 1e-300, -2.25, 7.0 };
+    double sorted_doubles[] = { -1e300, -2.25, -0.0, 0.0, 1e-300, 3.5, 7.0 };
+    Sint64 longs[] = { 5, -0x7FFFFFFFFFFFFFFFLL, 0, 0x7FFFFFFFFFFFFFFFLL, -1, 2 };
+    Sint64 sorted_longs[] = { -0x7FFFFFFFFFFFFFFFLL, -1, 0, 2, 5, 0x7FFFFFFFFFFFFFFFLL };
+    char bytes[3 * 64];
+    int small[] = { 2, 1 };
+    int i;
+
+    check(SDL_RadixSort(doubles, SDL_arraysize(doubles), sizeof(double), 0,
+                        SDL_SORTKEY_DOUBLE) == 0, "SDL_RadixSort() of doubles succeeds");
+    check(SDL_memcmp(doubles, sorted_doubles, sizeof(doubles)) == 0,
+          "SDL_RadixSort() of doubles is sorted");
+    check(SDL_RadixSort(longs, SDL_arraysize(longs), sizeof(Sint64), 0,
+                        SDL_SORTKEY_SINT64) == 0, "SDL_RadixSort() of Sint64 succeeds");
+    check(SDL_memcmp(longs, sorted_longs, sizeof(longs)) == 0,
+          "SDL_RadixSort() of Sint64 is sorted");
+
+    /* Unaligned three byte elements go through the bytewise swap */
+    for (i = 0; i < sizeof(bytes); ++i) {
+        bytes[i] = (char) random_number();
+    }
+    SDL_qsort(bytes, 64, 3, compare_bytes);
+    for (i = 1; i < 64; ++i) {
+        check(SDL_memcmp(&bytes[(i - 1) * 3], &bytes[i * 3], 3) <= 0,
+              "SDL_qsort() of 3 byte elements is sorted");
+    }
+
+    check(SDL_RadixSort(small, 2, sizeof(int), 2, SDL_SORTKEY_SINT32) == -1,
+          "SDL_RadixSort() rejects a key past the end of the element");
+    check(SDL_RadixSort(small, 2, sizeof(int), 0, (SDL_SortKeyType) 99) == -1,
+          "SDL_RadixSort() rejects an invalid key type");
+    SDL_qsort(small, 1, sizeof(int), compare_ints);
+    check(small[0] == 2, "SDL_qsort() of one element leaves it alone");
+}
+
+int
+main(int argc, char *argv[])
+{
+    int count = DEFAULT_COUNT;
+
+    if (argc > 1) {
+        count = atoi(argv[1]);
+    }
+    if (count <= 0) {
+        fprintf(stderr, "Usage: %s [count]\n", argv[0]);
+        return 1;
+    }
+
+    test_edge_cases();
+    test_ints(count);
+    test_sprites(count);
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
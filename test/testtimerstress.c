@@ -0,0 +1,125 @@
+/*
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Stress test and benchmark for adding and removing lots of SDL timers */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define DEFAULT_TIMERS  20000
+#define MAX_INTERVAL    100
+
+static SDL_atomic_t fired;
+
+static Uint32 SDLCALL
+oneshot(Uint32 interval, void *param)
+{
+    SDL_AtomicIncRef(&fired);
+    return 0;
+}
+
+static Uint32 SDLCALL
+periodic(Uint32 interval, void *param)
+{
+    SDL_AtomicIncRef(&fired);
+    return interval;
+}
+
+static double
+elapsed_ms(Uint64 start)
+{
+    return (double)((SDL_GetPerformanceCounter() - start) * 1000) / SDL_GetPerformanceFrequency();
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, num_timers, removed, expected;
+    SDL_TimerID *ids;
+    Uint64 start;
+
+    num_timers = DEFAULT_TIMERS;
+    if (argv[1]) {
+        num_timers = atoi(argv[1]);
+    }
+    if (num_timers <= 0) {
+        fprintf(stderr, "Usage: %s [number of timers]\n", argv[0]);
+        return 1;
+    }
+
+    if (SDL_Init(SDL_INIT_TIMER) < 0) {
+        fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    ids = (SDL_TimerID *)SDL_malloc(num_timers * sizeof(*ids));
+    if (!ids) {
+        fprintf(stderr, "Out of memory\n");
+        SDL_Quit();
+        return 1;
+    }
+    srand(0);
+
+    /* One-shot timers, half of which are removed before they fire */
+    SDL_AtomicSet(&fired, 0);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < num_timers; ++i) {
+        ids[i] = SDL_AddTimer(MAX_INTERVAL + 1 + (rand() % MAX_INTERVAL), oneshot, NULL);
+        if (!ids[i]) {
+            fprintf(stderr, "Couldn't add timer %d: %s\n", i, SDL_GetError());
+            SDL_Quit();
+            return 1;
+        }
+    }
+    printf("Added %d timers in %f ms\n", num_timers, elapsed_ms(start));
+
+    removed = 0;
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < num_timers; i += 2) {
+        if (SDL_RemoveTimer(ids[i])) {
+            ++removed;
+        }
+    }
+    printf("Removed %d timers in %f ms\n", removed, elapsed_ms(start));
+
+    SDL_Delay(3 * MAX_INTERVAL);
+    expected = num_timers - removed;
+    printf("%d of %d remaining one-shot timers fired\n", SDL_AtomicGet(&fired), expected);
+    if (SDL_AtomicGet(&fired) != expected) {
+        fprintf(stderr, "Timer count mismatch!\n");
+    }
+
+    /* Periodic timers, recycling the structures freed above */
+    SDL_AtomicSet(&fired, 0);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < num_timers; ++i) {
+        ids[i] = SDL_AddTimer(1 + (rand() % MAX_INTERVAL), periodic, NULL);
+    }
+    printf("Added %d periodic timers in %f ms\n", num_timers, elapsed_ms(start));
+
+    SDL_Delay(1000);
+
+    start = SDL_GetPerformanceCounter();
+    for (i = num_timers - 1; i >= 0; --i) {
+        SDL_RemoveTimer(ids[i]);
+    }
+    printf("Removed %d periodic timers in %f ms\n", num_timers, elapsed_ms(start));
+    printf("Periodic timers fired %d times in one second\n", SDL_AtomicGet(&fired));
+
+    SDL_free(ids);
+    SDL_Quit();
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
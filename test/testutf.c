@@ -0,0 +1,305 @@
+/*
+  Copyright (C) 1997-2013 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks the direct UTF-8, UTF-16 and UTF-32 conversions in SDL_iconv()
+   against conversions that go through big endian UCS-4, on both valid and
+   malformed text, and times them on a few megabytes of text.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define TEXT_SIZE   (4 * 1024 * 1024)
+#define REPEATS     5
+
+static int failures;
+static Uint32 seed = 1;
+
+static Uint32
+random_number(void)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+static void
+check(SDL_bool condition, const char *what)
+{
+    if (!condition) {
+        printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+static double
+elapsed_ms(Uint64 start)
+{
+    return (double)((SDL_GetPerformanceCounter() - start) * 1000) / SDL_GetPerformanceFrequency();
+}
+
+/* Append a random character, mostly ASCII with some of every length */
+static size_t
+random_utf8(char *text, SDL_bool malformed)
+{
+    Uint8 *p = (Uint8 *) text;
+    Uint32 ch, kind = random_number() % 16;
+
+    if (malformed && (random_number() % 8) == 0) {
+        /* Stray continuation bytes, overlong forms, surrogates and so on */
+        static const char *bad[] = {
+            "\x80", "\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80", "\xEF\xBF\xBF",
+            "\xF4\x90\x80\x80", "\xF8\x88\x80\x80\x80", "\xE4\xB8", "\xFF"
+        };
+        const char *seq = bad[random_number() % SDL_arraysize(bad)];
+        SDL_memcpy(text, seq, SDL_strlen(seq));
+        return SDL_strlen(seq);
+    }
+
+    if (kind < 10) {
+        p[0] = (Uint8) (0x20 + random_number() % 0x5F);
+        return 1;
+    } else if (kind < 12) {
+        ch = 0x80 + random_number() % 0x780;
+        p[0] = 0xC0 | (Uint8) (ch >> 6);
+        p[1] = 0x80 | (Uint8) (ch & 0x3F);
+        return 2;
+    } else if (kind < 15) {
+        do {
+            ch = 0x800 + random_number() % 0xF7FE;
+        } while (ch >= 0xD800 && ch <= 0xDFFF);
+        p[0] = 0xE0 | (Uint8) (ch >> 12);
+        p[1] = 0x80 | (Uint8) ((ch >> 6) & 0x3F);
+        p[2] = 0x80 | (Uint8) (ch & 0x3F);
+        return 3;
+    } else {
+        ch = 0x10000 + random_number() % 0x100000;
+        p[0] = 0xF0 | (Uint8) (ch >> 18);
+        p[1] = 0x80 | (Uint8) ((ch >> 12) & 0x3F);
+        p[2] = 0x80 | (Uint8) ((ch >> 6) & 0x3F);
+        p[3] = 0x80 | (Uint8) (ch & 0x3F);
+        return 4;
+    }
+}
+
+static size_t
+random_text(char *text, size_t size, SDL_bool malformed)
+{
+    size_t len = 0;
+
+    while (len + 8 < size) {
+        len += random_utf8(&text[len], malformed);
+    }
+    text[len] = '\0';
+    return len;
+}
+
+/* Size of a string including its terminating zero, in bytes */
+static size_t
+string_size(const char *string, size_t unit)
+{
+    size_t len = 0;
+
+    while (SDL_memcmp(&string[len], "\0\0\0\0", unit) != 0) {
+        len += unit;
+    }
+    return len + unit;
+}
+
+/* Convert text by way of big endian UCS-4, which is never done directly */
+static char *
+convert_slowly(const char *tocode, const char *fromcode,
+               const char *text, size_t len)
+{
+    char *ucs4 = SDL_iconv_string("UCS-4", fromcode, text, len);
+    char *string = NULL;
+
+    if (ucs4) {
+        string = SDL_iconv_string(tocode, "UCS-4", ucs4, string_size(ucs4, 4));
+        SDL_free(ucs4);
+    }
+    return string;
+}
+
+static void
+test_conversion(const char *tocode, size_t to_unit,
+                const char *fromcode, const char *text, size_t len)
+{
+    char *fast = SDL_iconv_string(tocode, fromcode, text, len);
+    char *slow = convert_slowly(tocode, fromcode, text, len);
+    char message[128];
+
+    SDL_snprintf(message, sizeof(message), "%s to %s matches the general conversion",
+                 fromcode, tocode);
+    check(fast && slow && string_size(fast, to_unit) == string_size(slow, to_unit) &&
+          SDL_memcmp(fast, slow, string_size(slow, to_unit)) == 0, message);
+    SDL_free(fast);
+    SDL_free(slow);
+}
+
+/* Convert a piece at a time with a tiny output buffer, to exercise the
+   incomplete input and full output cases.
+ */
+static void
+test_streaming(const char *text, size_t len)
+{
+    char *expected = SDL_iconv_string("UTF-16LE", "UTF-8", text, len);
+    char *result = (char *) SDL_malloc(len * 2 + 16);
+    SDL_iconv_t cd = SDL_iconv_open("UTF-16LE", "UTF-8");
+    const char *inbuf = text;
+    const char *available = text;
+    char *outbuf = result;
+    size_t inbytesleft, outbytesleft, retCode;
+
+    if (!expected || !result || cd == (SDL_iconv_t) - 1) {
+        check(SDL_FALSE, "streaming conversion could be started");
+        return;
+    }
+
+    while (available < text + len) {
+        /* Give it up to 7 more bytes at a time, which often splits characters */
+        available += SDL_min(1 + random_number() % 7, (size_t) (text + len - available));
+        while ((inbytesleft = available - inbuf) > 0) {
+            outbytesleft = 1 + random_number() % 6;
+            retCode = SDL_iconv(cd, &inbuf, &inbytesleft, &outbuf, &outbytesleft);
+            if (retCode == SDL_ICONV_EINVAL) {
+                /* Wait for the rest of the character */
+                break;
+            }
+            check(retCode != SDL_ICONV_ERROR && retCode != SDL_ICONV_EILSEQ,
+                  "streaming conversion succeeds");
+        }
+    }
+    check(inbuf == text + len, "streaming conversion uses all of the input");
+    check((size_t) (outbuf - result) == string_size(expected, 2) &&
+          SDL_memcmp(result, expected, outbuf - result) == 0,
+          "streaming conversion matches converting all at once");
+
+    SDL_iconv_close(cd);
+    SDL_free(result);
+    SDL_free(expected);
+}
+
+static void
+test_edge_cases(void)
+{
+    static const struct
+    {
+        const char *utf8;
+        Uint32 ucs4[3];
+    } cases[] = {
+        { "\xC3\xA9", { 0xE9, 0 } },
+        { "\xE0\xA0\x80", { 0x800, 0 } },
+        { "\xE4\xB8\xAD", { 0x4E2D, 0 } },
+        { "\xF0\x90\x80\x80", { 0x10000, 0 } },
+        { "\xF0\x9F\x98\x80", { 0x1F600, 0 } },
+        { "\xF4\x8F\xBF\xBF", { 0x10FFFF, 0 } },
+        { "\xC0\xAF!", { 0xFFFD, '!', 0 } },
+        { "\xE0\x80\xAF", { 0xFFFD, 0 } },
+        { "\xED\xA0\x80", { 0xFFFD, 0 } },
+        { "\xEF\xBF\xBE", { 0xFFFD, 0 } },
+    };
+    int i;
+
+    for (i = 0; i < SDL_arraysize(cases); ++i) {
+        Uint32 *ucs4 = (Uint32 *) SDL_iconv_string("UCS-4-INTERNAL", "UTF-8",
+                                                   cases[i].utf8,
+                                                   SDL_strlen(cases[i].utf8) + 1);
+        check(ucs4 && ucs4[0] == cases[i].ucs4[0] &&
+              (cases[i].ucs4[0] == 0 || ucs4[1] == cases[i].ucs4[1]),
+              "UTF-8 decodes to the expected character");
+        SDL_free(ucs4);
+    }
+}
+
+static void
+benchmark(const char *tocode, const char *fromcode, const char *text, size_t len)
+{
+    double ms = 0.0;
+    Uint64 start;
+    int i;
+
+    for (i = 0; i < REPEATS; ++i) {
+        char *string;
+        start = SDL_GetPerformanceCounter();
+        string = SDL_iconv_string(tocode, fromcode, text, len);
+        ms += elapsed_ms(start);
+        SDL_free(string);
+    }
+    printf("%-8s to %-14s: %8.3f ms, %7.1f MB/s\n", fromcode, tocode,
+           ms / REPEATS, (len / (1024.0 * 1024.0)) / (ms / REPEATS / 1000.0));
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const struct
+    {
+        const char *name;
+        size_t unit;
+    } formats[] = {
+        { "UTF-8", 1 },
+        { "UTF-16LE", 2 },
+        { "UTF-32LE", 4 },
+        { "UCS-4-INTERNAL", 4 },
+    };
+    char *text = (char *) SDL_malloc(TEXT_SIZE);
+    char *ascii = (char *) SDL_malloc(TEXT_SIZE);
+    size_t len;
+    int i, j, pass;
+
+    if (!text || !ascii) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    test_edge_cases();
+
+    for (pass = 0; pass < 2; ++pass) {
+        SDL_bool malformed = (pass == 1);
+        len = random_text(text, 64 * 1024, malformed) + 1;
+        for (i = 0; i < SDL_arraysize(formats); ++i) {
+            /* Malformed UTF-16 and UTF-32 is replaced while converting */
+            char *source = (i == 0) ? SDL_strdup(text) :
+                SDL_iconv_string(formats[i].name, "UTF-8", text, len);
+            size_t size = string_size(source, formats[i].unit);
+            for (j = 0; j < SDL_arraysize(formats); ++j) {
+                test_conversion(formats[j].name, formats[j].unit,
+                                formats[i].name, source, size);
+            }
+            SDL_free(source);
+        }
+        test_streaming(text, len);
+    }
+
+    len = random_text(text, TEXT_SIZE, SDL_FALSE) + 1;
+    SDL_memset(ascii, 'a', TEXT_SIZE - 1);
+    ascii[TEXT_SIZE - 1] = '\0';
+    for (i = 1; i < SDL_arraysize(formats); ++i) {
+        char *wide = SDL_iconv_string(formats[i].name, "UTF-8", ascii, TEXT_SIZE);
+        benchmark(formats[i].name, "UTF-8", ascii, TEXT_SIZE);
+        benchmark("UTF-8", formats[i].name, wide, TEXT_SIZE * formats[i].unit);
+        SDL_free(wide);
+        benchmark(formats[i].name, "UTF-8", text, len);
+    }
+    benchmark("UTF-8", "UTF-8", text, len);
+    benchmark("UCS-4", "UTF-8", text, len);
+
+    SDL_free(ascii);
+    SDL_free(text);
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */